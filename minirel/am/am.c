@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
 #include <sys/types.h>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -22,16 +24,33 @@
 #define NODE_LEAF 'l'
 #define NODE_NULLPTR (-1)
 #define NODE_INTNULL (-2)
-#define NODE_PARENT (-3)
+#define NODE_POSTING (-4) /* recnum of a leaf entry's pointer to the posting list of its key */
 #define LEAFIDX_PREV (-1)
 #define LEAFIDX_NEXT (-2)
 #define BTR_LT (-1)
 #define BTR_EQ 0
 #define BTR_GT 1
 #define BTR_NODENUM_INIT 3
+#define BTR_MAXHEIGHT 32 /* levels of a B+ tree */
+#define BTR_CACHENODES 256 /* internal nodes of a B+ tree kept in memory by Btr_readNode() */
+#define BTR_MAXKEYS(keyLength) ((int) ((PAGE_SIZE - sizeof(BtrHdr) - 2 * sizeof(RECID)) / (sizeof(RECID) + (keyLength))))
+#define BTR_MINKEYS(maxKeys) (((maxKeys) - 1) / 2) /* fewest entries a deletion leaves in a node, as many as a split leaves */
+#define BTR_POSTKEYS ((int) ((PAGE_SIZE - sizeof(BtrPostHdr)) / sizeof(RECID)))
+#define HASH_BUCKETS_INIT 4 /* buckets of a new hash index */
+#define HASH_MAXDIR 64 /* directory pages of a hash index */
+#define HASH_DIRENTS ((int) (PAGE_SIZE / sizeof(int))) /* bucket page numbers in a directory page */
+#define HASH_MAXKEYS(attrLength) ((int) ((PAGE_SIZE - sizeof(HashHdr)) / (sizeof(RECID) + (attrLength))))
+#define HASH_LOADFACTOR 75 /* percentage of the buckets' room filled before a bucket is split */
+#define HASH_NBUCKETS(amhdr) ((HASH_BUCKETS_INIT << (amhdr)->level) + (amhdr)->split)
+#define HASH_ENTRY(pbuf, attrLength, i) ((pbuf) + sizeof(HashHdr) + (i) * (sizeof(RECID) + (attrLength)))
 #define INAME_LEN 1000
 #define ITOA_DECIMAL 10
 
+/* bytes of entries AM_BulkLoad() sorts in memory at a time */
+#ifndef AM_LOADMEM
+#define AM_LOADMEM (4 * 1024 * 1024)
+#endif
+
 /*
 	when set to 1, all the messages supposed to print by this code are ignored.
 	when set to 0, shows all the messages written in this code using 'printf'
@@ -54,13 +73,26 @@ typedef struct AMhdr_str{
 	int indexNo;
 	char attrType;
 	int attrLength;
+	int keyLength; /* length of the key slots of the nodes, the attribute's length */
 	int maxKeys; /* maximum number of keys a B+ tree node can contain */
 	int numNodes; /* number of nodes the B+ tree corresponding to this AM index table element now contains */
 	int numRecs; /* number of records the B+ tree corresponding to this AM index table element now contains */
 	bool_t isUnique;
 	RECID root; /* contains the page number to root node of the B+ tree */
+	int method; /* access method of the index, AM_METHOD_BTREE or AM_METHOD_HASH */
+	int level; /* hash index: number of times the buckets were doubled since the HASH_BUCKETS_INIT first ones */
+	int split; /* hash index: next bucket to be split */
+	int dir[HASH_MAXDIR]; /* hash index: page numbers of the directory pages, which hold the page numbers of the buckets */
+	int nattrs; /* number of attributes the values are made of, one after another, 1 for most indexes */
+	int nkeys; /* number of key attributes, the first ones; the others are only kept with the keys */
+	char attrTypes[AM_MAXATTRS]; /* types of the attributes of an index of several attributes */
+	int attrLengths[AM_MAXATTRS]; /* lengths of the attributes, adding up to attrLength */
+	int attrOffsets[AM_MAXATTRS]; /* offsets of the attributes in the records of the heap file, for AM_BulkLoad() */
 } AMhdr_str;
 
+/* comparator of two keys, returning BTR_LT, BTR_EQ or BTR_GT */
+typedef int (*Btr_comparator)(char * a, char * b, int attrLength);
+
 /* struct of AM index table element */
 typedef struct AMitab_ele{
 	bool_t valid;
@@ -68,6 +100,13 @@ typedef struct AMitab_ele{
 	int pfd;
 	AMhdr_str hdr;
 	short hdrchanged;
+	Btr_comparator comp; /* comparator for the index's attribute type, chosen by AM_OpenIndex() */
+	int path[BTR_MAXHEIGHT]; /* page numbers of the internal nodes on the way from the root to the last leaf inserted into or deleted from */
+	int depth; /* number of page numbers in 'path' */
+	int * buckets; /* hash index: page numbers of the buckets, read from the directory pages by AM_OpenIndex() */
+	char ** nodes; /* copies of the internal nodes read by Btr_readNode(), by page number; NULL for the ones not read */
+	int nnodes; /* length of 'nodes' */
+	int ncached; /* number of copies in 'nodes' */
 } AMitab_ele;
 
 /* struct of AM scan table element */
@@ -80,17 +119,41 @@ typedef struct AMstab_ele {
 	char *value;
 	RECID current;
 	RECID currentNode;
+	RECID post; /* page and index of the current record id in a posting list, pagenum NODE_NULLPTR if none */
+	Btr_comparator comp;
+	int nmatch; /* number of attributes of 'value' the entries are compared on, for an index of several attributes */
+	char *seek; /* 'value' with the other attributes set lowest, or highest for GT_OP, where a B+ tree scan starts; NULL if not needed */
+	char *found; /* value of the last entry found, key and included attributes */
 }AMstab_ele;
 
 /* struct of B+ tree node's header */
 typedef struct Btr_nodeHdr{
 	int entries; /* number of records this node contains */
-	RECID parent; /* pointer to parent node */
-	bool_t duplicate; /* TRUE if it only contains duplicate values */
 } BtrHdr;
 
+/* struct of a posting list page's header, followed by the record ids of a key in ascending order */
+typedef struct Btr_postHdr{
+	int entries; /* number of record ids this page contains */
+	int next; /* page number of the next page of the posting list, NODE_NULLPTR for the last one */
+} BtrPostHdr;
+
+/* struct of a hash bucket page's header, followed by the entries, each one a record id and a key */
+typedef struct Hash_pageHdr{
+	int entries; /* number of entries this page contains */
+	int overflow; /* page number of the next page of the bucket, NODE_NULLPTR for the last one */
+} HashHdr;
+
+/* AM index and scan tables, grown on demand */
 AMitab_ele *ait = NULL;
 AMstab_ele *ast = NULL;
+int AM_itab_size = 0;
+int AM_stab_size = 0;
+
+/* stacks of unused index and scan descriptors, the most recently freed one on top */
+int *AM_freefd = NULL;
+int AM_nfreefd = 0;
+int *AM_freesd = NULL;
+int AM_nfreesd = 0;
 
 /*
 	checks whether the index with the same file name exists
@@ -148,18 +211,201 @@ int AM_validAttr(char attrType, int attrLength){
 }
 
 /*
-	initialize the AM index table
-	- invoke HF_Init()
-	- initialize AM index table
-	- initialize AM scan table
+	compare two keys of each attribute type, without checking the type again
+	the key length is only needed for strings, which are compared as strncmp() does
+
+	*** parameters ***
+	char * a - points to a key to be compared
+	char * b - points to another key to be compared
+	int attrLength - attribute length of a and b
+
+	*** return values ***
+	BTR_LT(-1) if a < b
+	BTR_EQ(0) if a == b
+	BTR_GT(1) if a > b
 */
-void AM_Init(void){
+int Btr_compInt(char * a, char * b, int attrLength){
+	int x, y;
+	memcpy(&x, a, sizeof(int));
+	memcpy(&y, b, sizeof(int));
+	return (x > y) - (x < y);
+}
+
+int Btr_compReal(char * a, char * b, int attrLength){
+	float x, y;
+	memcpy(&x, a, sizeof(float));
+	memcpy(&y, b, sizeof(float));
+	return (x > y) - (x < y);
+}
+
+int Btr_compString(char * a, char * b, int attrLength){
+	int res = strncmp(a, b, attrLength);
+	return (res > 0) - (res < 0);
+}
+
+/*
+	chooses the comparator for keys of the given attribute type
+
+	*** parameters ***
+	char attrType - type of the attribute
+
+	*** return values ***
+	the comparator if the type is valid
+	NULL otherwise
+*/
+Btr_comparator Btr_getComp(char attrType){
+	if (attrType == INT_TYPE){
+		return Btr_compInt;
+	} else if (attrType == REAL_TYPE){
+		return Btr_compReal;
+	} else if (attrType == STRING_TYPE){
+		return Btr_compString;
+	}
+	return NULL;
+}
+
+/*
+	compares the first attributes of two values of an index, one after another:
+	the key attributes by the comparator of their type, the included ones byte by byte
+
+	*** parameters ***
+	AMhdr_str * amhdr - header of the index
+	char * a - points to a value to be compared
+	char * b - points to another value to be compared
+	int n - number of attributes compared, ignored for an index on one attribute
+
+	*** return values ***
+	BTR_LT(-1) if a < b
+	BTR_EQ(0) if a == b
+	BTR_GT(1) if a > b
+*/
+int AM_compAttrs(AMhdr_str * amhdr, char * a, char * b, int n){
+	int i, res, off = 0;
+
+	if (amhdr->nattrs <= 1){
+		return Btr_getComp(amhdr->attrType)(a, b, amhdr->attrLength);
+	}
+	for (i = 0; i < n; i++){
+		if (i < amhdr->nkeys){
+			res = Btr_getComp(amhdr->attrTypes[i])(a + off, b + off, amhdr->attrLengths[i]);
+		} else {
+			res = memcmp(a + off, b + off, amhdr->attrLengths[i]);
+			res = (res > 0) - (res < 0);
+		}
+		if (res != BTR_EQ){
+			return res;
+		}
+		off += amhdr->attrLengths[i];
+	}
+	return BTR_EQ;
+}
+
+/*
+	makes the value of an index from a record of its heap file
+
+	*** parameters ***
+	AMhdr_str * amhdr - header of the index
+	char * record - points to the record
+	int attrOffset - offset of the attribute of an index on one attribute
+	char * value - points to where the value is written
+
+	*** return values ***
+	none
+*/
+void AM_makeValue(AMhdr_str * amhdr, char * record, int attrOffset, char * value){
 	int i;
 
-	HF_Init();
+	if (amhdr->nattrs <= 1){
+		memcpy(value, record + attrOffset, amhdr->attrLength);
+		return;
+	}
+	for (i = 0; i < amhdr->nattrs; i++){
+		memcpy(value, record + amhdr->attrOffsets[i], amhdr->attrLengths[i]);
+		value += amhdr->attrLengths[i];
+	}
+}
+
+/*
+	copies the first attributes of a value of an index, setting the other ones
+	to their lowest or highest values in the order of AM_compAttrs()
+
+	*** parameters ***
+	AMhdr_str * amhdr - header of the index
+	char * value - points to the value, of which only the first attributes are read
+	int n - number of attributes copied
+	bool_t high - TRUE to set the other attributes highest, FALSE to set them lowest
+	char * padded - points to where the value is written
+
+	*** return values ***
+	none
+*/
+void AM_padValue(AMhdr_str * amhdr, char * value, int n, bool_t high, char * padded){
+	int i, x, off = 0;
+	float f;
+
+	for (i = 0; i < amhdr->nattrs; i++){
+		if (i < n){
+			memcpy(padded + off, value + off, amhdr->attrLengths[i]);
+		} else if ((i < amhdr->nkeys) && (amhdr->attrTypes[i] == INT_TYPE)){
+			x = high ? INT_MAX : INT_MIN;
+			memcpy(padded + off, &x, sizeof(int));
+		} else if ((i < amhdr->nkeys) && (amhdr->attrTypes[i] == REAL_TYPE)){
+			f = (float) (high ? HUGE_VAL : -HUGE_VAL);
+			memcpy(padded + off, &f, sizeof(float));
+		} else {
+			memset(padded + off, high ? UCHAR_MAX : 0, amhdr->attrLengths[i]);
+		}
+		off += amhdr->attrLengths[i];
+	}
+}
+
+/*
+	compares the value of an index entry with the value of a scan,
+	by the attributes the scan matches on
+
+	*** parameters ***
+	int scanDesc - scan descriptor
+	char * record - points to the value of the entry
+
+	*** return values ***
+	BTR_LT(-1) if the entry's value is smaller
+	BTR_EQ(0) if they match
+	BTR_GT(1) if the entry's value is bigger
+*/
+int AM_scanComp(int scanDesc, char * record){
+	AMstab_ele * scan = &(ast[scanDesc]);
+
+	if (ait[scan->fd].hdr.nattrs <= 1){
+		return scan->comp(record, scan->value, scan->attrLength);
+	}
+	return AM_compAttrs(&(ait[scan->fd].hdr), record, scan->value, scan->nmatch);
+}
+
+/*
+	doubles the AM index table, which starts with AM_ITAB_SIZE entries
+
+	*** return values ***
+	AME_OK if successful
+	AME_FULLTABLE if there is no memory to grow the table
+*/
+int AM_GrowITable(void){
+	int i;
+	int newsize = AM_itab_size == 0 ? AM_ITAB_SIZE : 2 * AM_itab_size;
+	AMitab_ele * newtab;
+	int * newfree;
+
+	if ((newtab = (AMitab_ele *)realloc(ait, newsize * sizeof(AMitab_ele))) == NULL){
+		return AME_FULLTABLE;
+	}
+	ait = newtab;
+	if ((newfree = (int *)realloc(AM_freefd, newsize * sizeof(int))) == NULL){
+		return AME_FULLTABLE;
+	}
+	AM_freefd = newfree;
 
-	ait = (AMitab_ele *)calloc(AM_ITAB_SIZE, sizeof(AMitab_ele));
-	for (i = 0; i < AM_ITAB_SIZE; i++){
+	/* initialize each new entry, pushing the highest descriptor first */
+	for (i = newsize - 1; i >= AM_itab_size; i--){
+		AM_freefd[AM_nfreefd++] = i;
 		ait[i].valid = FALSE;
 		ait[i].fname = NULL;
 		ait[i].pfd = AMI_PFD_INVALID;
@@ -173,12 +419,60 @@ void AM_Init(void){
 		ait[i].hdrchanged = FALSE;
 		ait[i].hdr.root.pagenum = NODE_NULLPTR;
 		ait[i].hdr.root.recnum = NODE_INTNULL;
+		ait[i].buckets = NULL;
+		ait[i].nodes = NULL;
+		ait[i].nnodes = 0;
+		ait[i].ncached = 0;
+	}
+	AM_itab_size = newsize;
+
+	return AME_OK;
+}
+
+/*
+	doubles the AM scan table, which starts with MAXISCANS entries
+
+	*** return values ***
+	AME_OK if successful
+	AME_SCANTABLEFULL if there is no memory to grow the table
+*/
+int AM_GrowSTable(void){
+	int i;
+	int newsize = AM_stab_size == 0 ? MAXISCANS : 2 * AM_stab_size;
+	AMstab_ele * newtab;
+	int * newfree;
+
+	if ((newtab = (AMstab_ele *)realloc(ast, newsize * sizeof(AMstab_ele))) == NULL){
+		return AME_SCANTABLEFULL;
 	}
+	ast = newtab;
+	if ((newfree = (int *)realloc(AM_freesd, newsize * sizeof(int))) == NULL){
+		return AME_SCANTABLEFULL;
+	}
+	AM_freesd = newfree;
 
-	ast = (AMstab_ele *)calloc(MAXISCANS, sizeof(AMstab_ele));
-	for (i = 0; i < MAXISCANS; i++){
+	for (i = newsize - 1; i >= AM_stab_size; i--){
+		AM_freesd[AM_nfreesd++] = i;
 		ast[i].valid = FALSE;
+		ast[i].seek = NULL;
+		ast[i].found = NULL;
 	}
+	AM_stab_size = newsize;
+
+	return AME_OK;
+}
+
+/*
+	initialize the AM index table
+	- invoke HF_Init()
+	- initialize AM index table
+	- initialize AM scan table
+*/
+void AM_Init(void){
+	HF_Init();
+
+	AM_GrowITable();
+	AM_GrowSTable();
 }
 
 /*
@@ -192,9 +486,6 @@ void AM_Init(void){
 */
 int Btr_initHdr(BtrHdr * hdr){
 	hdr->entries = 0;
-	hdr->parent.pagenum = NODE_NULLPTR; /* -1 */
-	hdr->parent.recnum = NODE_NULLPTR;
-	hdr->duplicate = FALSE;
 	return AME_OK;
 }
 
@@ -208,13 +499,12 @@ int Btr_initHdr(BtrHdr * hdr){
 	int keyNum - the maximum number of keys a B+ tree node can contain
 	int * pagenum - pointer to the page number of newly assigned node if successful
 	char ** pbuf - address of the pointer to the newly assigned B+ tree node if successful
-	RECID parent - pointer to the parent of newly assigned B+ tree node
 
 	*** return values ***
 	AME_OK if successful
 	error codes (< 0) if a problem occurred
 */
-int Btr_assignNode(int pfd, char nodeType, int attrLength, int keyNum, int *pagenum, char ** pbuf, RECID parent){
+int Btr_assignNode(int pfd, char nodeType, int attrLength, int keyNum, int *pagenum, char ** pbuf){
 	int err;
 	int initnum = 0;
 	int *writeres;
@@ -229,9 +519,7 @@ int Btr_assignNode(int pfd, char nodeType, int attrLength, int keyNum, int *page
 
 		bhdr = (BtrHdr *) *pbuf;
 		Btr_initHdr(bhdr);
-		/* setting parent information */
-		bhdr->parent.pagenum = parent.pagenum;
-		printf("testing Btr_initHdr: BtrHdr_size: %d, hdr->entries: %d, hdr->parent.pagenum: %d, hdr->duplicate: %d\n", (int)sizeof(BtrHdr), bhdr->entries, bhdr->parent.pagenum, bhdr->duplicate);
+		printf("testing Btr_initHdr: BtrHdr_size: %d, hdr->entries: %d\n", (int)sizeof(BtrHdr), bhdr->entries);
 		/* root & internal node */
 		if ((nodeType == NODE_ROOT) || (nodeType == NODE_INT)){
 			initRid.recnum = NODE_INTNULL;
@@ -296,6 +584,29 @@ int Btr_getNode(char ** pbuf, int AM_fd, RECID adr){
 	return AME_OK;
 }
 
+/*
+	frees the copies of the internal nodes of a B+ tree, to be called whenever an internal node is changed
+	so that Btr_readNode() reads them again
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+
+	*** return values ***
+	void
+*/
+void Btr_dropNodes(int AM_fd){
+	int i;
+
+	for (i = 0; (i < ait[AM_fd].nnodes) && (ait[AM_fd].ncached > 0); i++){
+		if (ait[AM_fd].nodes[i] != NULL){
+			free(ait[AM_fd].nodes[i]);
+			ait[AM_fd].nodes[i] = NULL;
+			ait[AM_fd].ncached--;
+		}
+	}
+	ait[AM_fd].ncached = 0;
+}
+
 /*
 	reads a pointer from a specified position of B+ tree node
 
@@ -313,14 +624,7 @@ int Btr_getNode(char ** pbuf, int AM_fd, RECID adr){
 */
 int Btr_getPtr(char ** pbuf, char nodeType, int attrLength, int idx, int keyNum, RECID * rid){
 
-	BtrHdr * bhdr = (BtrHdr *) *pbuf;
-
-	if (idx == NODE_PARENT){
-		if (memcpy(rid, &(bhdr->parent), sizeof(RECID)) == NULL){
-			printf("Btr_getPtr failed: 'memcpy' for reading ptr of parent node\n");
-			return AME_UNIX;
-		}
-	} else if ((nodeType == NODE_ROOT) || (nodeType == NODE_INT)){
+	if ((nodeType == NODE_ROOT) || (nodeType == NODE_INT)){
 		if ((idx > keyNum) || (idx < 0)){
 			printf("Btr_getPtr failed: invalid 'idx' value: %d, keyNum: %d\n", idx, keyNum);
 			return AME_INVALIDPARA;
@@ -415,14 +719,8 @@ int Btr_getKey(char ** pbuf, char nodeType, int attrLength, int idx, int keyNum,
 */
 int Btr_setPtr(char ** pbuf, char nodeType, int attrLength, int idx, int keyNum, RECID * rid){
 	RECID temp;
-	BtrHdr * bhdr = (BtrHdr *) pbuf;
 	printf("Btr_setPtr: going to write pagenum %d, recnum %d at idx %d\n", rid->pagenum, rid->recnum, idx);
-	if (idx == NODE_PARENT){
-		if (memcpy(&(bhdr->parent), rid, sizeof(RECID)) == NULL){
-			printf("Btr_setPtr failed: 'memcpy' for writing ptr of parent node\n");
-			return AME_UNIX;
-		}
-	} else if ((nodeType == NODE_ROOT) || (nodeType == NODE_INT)){
+	if ((nodeType == NODE_ROOT) || (nodeType == NODE_INT)){
 		if ((idx > keyNum) || (idx < 0)){
 			printf("Btr_setPtr failed: invalid 'idx' value: %d, keyNum: %d\n", idx, keyNum);
 			return AME_INVALIDPARA;
@@ -505,1645 +803,3564 @@ int Btr_setKey(char ** pbuf, char nodeType, int attrLength, int idx, int keyNum,
 }
 
 /*
-	creates an index
+	builds the B+ tree of an empty index: a root node with two empty leaf nodes as its children
 
 	*** parameters ***
-	char * fileName - points to the specified file's name
-	int indexNo - index number for the specified file
-	char attrType - attribute type of the index
-	int attrLength - attribute length of the index
-	bool_t isUnique - specifies whether this index must be unique, set to FALSE
+	int pfd - file descriptor of the PF file of the index
+	AMhdr_str * amhdr - header of the index, whose root is set
 
 	*** return values ***
 	AME_OK if successful
 	error codes (< 0) if a problem occurred
 */
-int AM_CreateIndex(char *fileName, int indexNo, char attrType, int attrLength, bool_t isUnique){
+int Btr_initTree(int pfd, AMhdr_str * amhdr){
 	int err;
-	int pfd;
-	int keyNum;
-	AMhdr_str amhdr;
-	PFftab_ele *pfte;
-	char iname[INAME_LEN];
-	char cache[INAME_LEN];
 	int pagenum[BTR_NODENUM_INIT];
 	char * pbuf[BTR_NODENUM_INIT];
 	RECID rid;
-	RECID parent;
 	RECID temp;
 
-	/* initializing 'parent' */
-	parent.pagenum = NODE_NULLPTR;
-	parent.recnum = NODE_NULLPTR;
-
-	strcpy(iname, fileName);
-	sprintf(cache, "%d", indexNo);
-	strcat(iname, cache);
-
-	if (PF_CreateFile(iname) != PFE_OK){
-		printf("AM_CreateIndex failed: PF_CreateFile with %s\n", iname);
-		return AME_PF;
-	}
-
-	if ((pfd = PF_OpenFile(iname)) < PFE_OK) {
-		printf("AM_CreateIndex failed: PF_OpenFile with %s\n", iname);
-		return AME_PF;
-	}
-
-	pfte = &(pft[pfd]);
-
-	if ((err = AM_validAttr(attrType, attrLength)) != AME_OK){
-		printf("AM_CreateIndex failed: attribute type or length not valid\n");
-		return err;
-	}
-
-	/* determine the number of pointers which can fit into each b+ tree node */
-	keyNum = (PAGE_SIZE - sizeof(BtrHdr) - 2*sizeof(RECID)) / (sizeof(RECID) + attrLength);
-	printf("RECID size: %d, attrLength: %d, num. of entries in each node: %d\n", (int)sizeof(RECID), attrLength, keyNum);
-
-	amhdr.indexNo = indexNo;
-	amhdr.attrType = attrType;
-	amhdr.attrLength = attrLength;
-	amhdr.maxKeys = keyNum;
-	amhdr.numNodes = BTR_NODENUM_INIT; /* 3: one root node, two leaf nodes*/
-	amhdr.numRecs = 0;
-	amhdr.isUnique = FALSE;
+	amhdr->numNodes = BTR_NODENUM_INIT; /* 3: one root node, two leaf nodes*/
 
 	/* root node */
-	if ((err = Btr_assignNode(pfd, NODE_ROOT, attrLength, keyNum, pagenum, &pbuf[0], parent)) != AME_OK){
-		printf("AM_CreateIndex failed: Btr_assignNode to NODE_ROOT\n");
+	if ((err = Btr_assignNode(pfd, NODE_ROOT, amhdr->keyLength, amhdr->maxKeys, pagenum, &pbuf[0])) != AME_OK){
+		printf("Btr_initTree failed: Btr_assignNode to NODE_ROOT\n");
 		return err;
 	}
 	/* assigning root node's PF page number to AM header */
-	amhdr.root.pagenum = pagenum[0];
-	amhdr.root.recnum = NODE_NULLPTR;
-	parent.pagenum = amhdr.root.pagenum;
+	amhdr->root.pagenum = pagenum[0];
+	amhdr->root.recnum = NODE_NULLPTR;
 
 	/* first child(leaf) node */
-	if ((err = Btr_assignNode(pfd, NODE_LEAF, attrLength, keyNum, pagenum+1, &pbuf[1], parent)) != AME_OK){
-		printf("AM_CreateIndex failed: Btr_assignNode to first NODE_LEAF\n");
+	if ((err = Btr_assignNode(pfd, NODE_LEAF, amhdr->keyLength, amhdr->maxKeys, pagenum+1, &pbuf[1])) != AME_OK){
+		printf("Btr_initTree failed: Btr_assignNode to first NODE_LEAF\n");
 		return err;
 	}
 	rid.pagenum = pagenum[1];
 	rid.recnum = NODE_INTNULL;
-	if ((err = Btr_setPtr(&pbuf[0], NODE_ROOT, attrLength, 0, keyNum, &rid)) != AME_OK){
-		printf("AM_CreateIndex failed: Btr_setPtr at NODE_ROOT to first NODE_LEAF\n");
+	if ((err = Btr_setPtr(&pbuf[0], NODE_ROOT, amhdr->keyLength, 0, amhdr->maxKeys, &rid)) != AME_OK){
+		printf("Btr_initTree failed: Btr_setPtr at NODE_ROOT to first NODE_LEAF\n");
 		return err;
 	}
-	if ((err = Btr_getPtr(&pbuf[0], NODE_ROOT, attrLength, 0, keyNum, &temp)) != AME_OK){
-		printf("AM_CreateIndex failed: Btr_setPtr at NODE_ROOT to second NODE_LEAF\n");
+	if ((err = Btr_getPtr(&pbuf[0], NODE_ROOT, amhdr->keyLength, 0, amhdr->maxKeys, &temp)) != AME_OK){
+		printf("Btr_initTree failed: Btr_setPtr at NODE_ROOT to second NODE_LEAF\n");
 		return err;
 	}
 	/* second child(leaf) node */
-	if ((err = Btr_assignNode(pfd, NODE_LEAF, attrLength, keyNum, pagenum+2, &pbuf[2], parent)) != AME_OK){
-		printf("AM_CreateIndex failed: Btr_assignNode to second NODE_LEAF\n");
+	if ((err = Btr_assignNode(pfd, NODE_LEAF, amhdr->keyLength, amhdr->maxKeys, pagenum+2, &pbuf[2])) != AME_OK){
+		printf("Btr_initTree failed: Btr_assignNode to second NODE_LEAF\n");
 		return err;
 	}
 	rid.pagenum = pagenum[2];
-	if ((err = Btr_setPtr(&pbuf[0], NODE_ROOT, attrLength, 1, keyNum, &rid)) != AME_OK){
-		printf("AM_CreateIndex failed: Btr_setPtr at NODE_ROOT to second NODE_LEAF\n");
+	if ((err = Btr_setPtr(&pbuf[0], NODE_ROOT, amhdr->keyLength, 1, amhdr->maxKeys, &rid)) != AME_OK){
+		printf("Btr_initTree failed: Btr_setPtr at NODE_ROOT to second NODE_LEAF\n");
 		return err;
 	}
-	if ((err = Btr_getPtr(&pbuf[0], NODE_ROOT, attrLength, 1, keyNum, &temp)) != AME_OK){
-		printf("AM_CreateIndex failed: Btr_setPtr at NODE_ROOT to second NODE_LEAF\n");
+	if ((err = Btr_getPtr(&pbuf[0], NODE_ROOT, amhdr->keyLength, 1, amhdr->maxKeys, &temp)) != AME_OK){
+		printf("Btr_initTree failed: Btr_setPtr at NODE_ROOT to second NODE_LEAF\n");
 		return err;
 	}
 
 	if((err = PF_UnpinPage(pfd, pagenum[0], TRUE)) != PFE_OK){
-		printf("AM_CreateIndex failed: PF_UnpinPage of root node\n");
+		printf("Btr_initTree failed: PF_UnpinPage of root node\n");
 		return err;
 	}
 
 	/* links between leaf nodes */
-	if ((err = Btr_getPtr(&pbuf[1], NODE_LEAF, attrLength, LEAFIDX_PREV, keyNum, &temp)) != AME_OK){
-		printf("AM_CreateIndex failed: linking first leaf node to the second one\n");
+	if ((err = Btr_getPtr(&pbuf[1], NODE_LEAF, amhdr->keyLength, LEAFIDX_PREV, amhdr->maxKeys, &temp)) != AME_OK){
+		printf("Btr_initTree failed: linking first leaf node to the second one\n");
 		return err;
 	}
 
-	if ((err = Btr_getPtr(&pbuf[1], NODE_LEAF, attrLength, LEAFIDX_NEXT, keyNum, &temp)) != AME_OK){
-		printf("AM_CreateIndex failed: linking first leaf node to the second one\n");
+	if ((err = Btr_getPtr(&pbuf[1], NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &temp)) != AME_OK){
+		printf("Btr_initTree failed: linking first leaf node to the second one\n");
 		return err;
 	}
 
 	rid.recnum = NODE_NULLPTR;
-	if ((err = Btr_setPtr(&pbuf[1], NODE_LEAF, attrLength, LEAFIDX_NEXT, keyNum, &rid)) != AME_OK){
-		printf("AM_CreateIndex failed: linking first leaf node to the second one\n");
+	if ((err = Btr_setPtr(&pbuf[1], NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &rid)) != AME_OK){
+		printf("Btr_initTree failed: linking first leaf node to the second one\n");
 		return err;
 	}
 	rid.pagenum = pagenum[1];
-	if ((err = Btr_setPtr(&pbuf[2], NODE_LEAF, attrLength, LEAFIDX_PREV, keyNum, &rid)) != AME_OK){
-		printf("AM_CreateIndex failed: linking second leaf node to the first one\n");
+	if ((err = Btr_setPtr(&pbuf[2], NODE_LEAF, amhdr->keyLength, LEAFIDX_PREV, amhdr->maxKeys, &rid)) != AME_OK){
+		printf("Btr_initTree failed: linking second leaf node to the first one\n");
 		return err;
 	}
-	if (memcpy(pfte->hdr.hdrrest, &amhdr, sizeof(AMhdr_str)) == NULL){
-		printf("AM_CreateIndex failed: copying AMhdr_str to PF header\n");
-		return AME_UNIX;
-	}
-	pfte->hdrchanged = TRUE;
-
 	if((err = PF_UnpinPage(pfd, pagenum[1], TRUE)) != PFE_OK){
-		printf("AM_CreateIndex failed: PF_UnpinPage of first leaf node\n");
+		printf("Btr_initTree failed: PF_UnpinPage of first leaf node\n");
 		return err;
 	}
 	if((err = PF_UnpinPage(pfd, pagenum[2], TRUE)) != PFE_OK){
-		printf("AM_CreateIndex failed: PF_UnpinPage of second node\n");
+		printf("Btr_initTree failed: PF_UnpinPage of second node\n");
 		return err;
 	}
 
-	return PF_CloseFile(pfd) == PFE_OK ? AME_OK : AME_PF;
+	return AME_OK;
 }
 
 /*
-	destroys the specified index
+	hashes a key of the given attribute type, keys equal to each other giving the same value
+	strings are hashed with FNV-1a up to their end, and every hash is mixed as MurmurHash3 finishes its own,
+	so that the low bits picking the bucket depend on all the bits of the key
 
 	*** parameters ***
-	char * fileName - points to the specified file's name
-	int indexNo - index number for the specified file
+	char attrType - type of the attribute
+	int attrLength - attribute length of the key
+	char * value - points to the key
 
 	*** return values ***
-	AME_OK if successful
-	error codes (< 0) if a problem occurred
+	the hash value of the key
 */
-int AM_DestroyIndex(char *fileName, int indexNo){
-	char iname[INAME_LEN];
-	char cache[INAME_LEN];
-	strcpy(iname, fileName);
-	sprintf(cache, "%d", indexNo);
-	strcat(iname, cache);
+unsigned int Hash_value(char attrType, int attrLength, char * value){
+	unsigned int h;
+	float f;
+	int i;
 
-	return PF_DestroyFile(iname) == PFE_OK ? AME_OK : AME_PF;
+	if (attrType == STRING_TYPE){
+		h = 2166136261U;
+		for (i = 0; (i < attrLength) && (value[i] != '\0'); i++){
+			h = (h ^ (unsigned char) value[i]) * 16777619U;
+		}
+	} else if (attrType == REAL_TYPE){
+		memcpy(&f, value, sizeof(float));
+		/* -0.0 is equal to 0.0 */
+		if (f == 0.0){
+			f = 0.0;
+		}
+		memcpy(&h, &f, sizeof(float));
+	} else {
+		memcpy(&h, value, sizeof(int));
+	}
+
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+	return h;
 }
 
 /*
-	opens an AM index table entry
+	hashes the key attributes of a value of an index, one after another
 
 	*** parameters ***
-	char * fileName - points to the specified file's name
-	int indexNo - index number for the specified file
+	AMhdr_str * amhdr - header of the index
+	char * value - points to the value, of which only the key attributes are read
 
 	*** return values ***
-	AME_OK if successful
-	error codes (< 0) if a problem occurred
+	the hash value of the key
 */
-int AM_OpenIndex(char *fileName, int indexNo){
-	int err;
-	int pfd;
-	int aid;
-	char * pbuf;
-	AMitab_ele * aite;
-	RECID temp;
+unsigned int Hash_key(AMhdr_str * amhdr, char * value){
+	unsigned int h = Hash_value(amhdr->attrTypes[0], amhdr->attrLengths[0], value);
+	int i, off = amhdr->attrLengths[0];
 
-	char iname[INAME_LEN];
-	char cache[INAME_LEN];
+	for (i = 1; i < amhdr->nkeys; i++){
+		h = h * 31 + Hash_value(amhdr->attrTypes[i], amhdr->attrLengths[i], value + off);
+		off += amhdr->attrLengths[i];
+	}
+	return h;
+}
 
-	strcpy(iname, fileName);
-	sprintf(cache, "%d", indexNo);
-	strcat(iname, cache);
+/*
+	finds the bucket of a key in a hash index, by linear hashing:
+	the buckets before the split pointer were split, and tell their keys apart by one more bit
 
-	if ((pfd = PF_OpenFile(iname)) < PFE_OK) {
-		printf("AM_OpenIndex failed: PF_OpenFile\n");
-		return AME_PF;
-	}
+	*** parameters ***
+	AMhdr_str * amhdr - header of the index
+	char * value - points to the key
 
-	for (aid = 0; aid < AM_ITAB_SIZE; aid++){
-		aite = &(ait[aid]);
-		if (aite->valid == FALSE){
-			if (memcpy(&(aite->hdr), pft[pfd].hdr.hdrrest, sizeof(AMhdr_str)) == NULL || aite->hdr.maxKeys < 0 || aite->hdr.numNodes < 0 || aite->hdr.numRecs < 0 || aite->hdr.root.pagenum < 0) {
-				PF_CloseFile(pfd);
-				printf("AM_OpenIndex failed: copying AM header from the file to AM index table\n");
-				return AME_PF;
-			}
-			aite->valid = TRUE;
-			aite->fname = (char *)calloc(strlen(iname), sizeof(char));
-			strcpy(aite->fname, iname);
-			aite->pfd = pfd;
+	*** return values ***
+	the number of the bucket
+*/
+int Hash_bucket(AMhdr_str * amhdr, char * value){
+	unsigned int h = Hash_key(amhdr, value);
+	unsigned int b = h % ((unsigned int) HASH_BUCKETS_INIT << amhdr->level);
 
-			return aid;
-		}
+	if ((int) b < amhdr->split){
+		b = h % ((unsigned int) HASH_BUCKETS_INIT << (amhdr->level + 1));
 	}
-
-	PF_CloseFile(pfd);
-	printf("AM_OpenIndex failed: AM index table full\n");
-	return AME_FULLTABLE;
+	return (int) b;
 }
 
-
 /*
-	closes the specified AM index table entry
+	makes the first directory page and the HASH_BUCKETS_INIT empty buckets of a new hash index
 
 	*** parameters ***
-	int AM_fd - file descriptor to the specified AM index table entry
+	int pfd - file descriptor of the PF file of the index
+	AMhdr_str * amhdr - header of the index, whose directory is set
 
 	*** return values ***
 	AME_OK if successful
 	error codes (< 0) if a problem occurred
 */
-int AM_CloseIndex(int AM_fd){
-	int pfd = ait[AM_fd].pfd;
-	PFftab_ele * pfte = &(pft[pfd]);
-	pfte->hdrchanged = TRUE;
+int Hash_initTable(int pfd, AMhdr_str * amhdr){
+	int i;
+	int pagenum;
+	char * dbuf;
+	char * pbuf;
+	HashHdr * hhdr;
 
-	if (memcpy(pfte->hdr.hdrrest, &(ait[AM_fd].hdr), sizeof(AMhdr_str)) == NULL){
-		printf("AM_CloseIndex failed: copying AMhdr_str to PF header\n");
-		return AME_UNIX;
+	amhdr->level = 0;
+	amhdr->split = 0;
+	for (i = 0; i < HASH_MAXDIR; i++){
+		amhdr->dir[i] = NODE_NULLPTR;
 	}
-
-	if (PF_CloseFile(pfd) != PFE_OK){
-		printf("AM_CloseIndex failed: PF_CloseFile\n");
+	if (PF_AllocPage(pfd, &(amhdr->dir[0]), &dbuf) != PFE_OK){
+		printf("Hash_initTable failed: PF_AllocPage of the directory\n");
 		return AME_PF;
 	}
-	ait[AM_fd].valid = FALSE;
-	ait[AM_fd].fname = NULL;
-	ait[AM_fd].pfd = AMI_PFD_INVALID;
-	ait[AM_fd].hdr.indexNo = AMIHDR_INVALID;
-	ait[AM_fd].hdr.attrType = AMIHDR_INVALID;
-	ait[AM_fd].hdr.attrLength = AMIHDR_INVALID;
-	ait[AM_fd].hdr.maxKeys = AMIHDR_INVALID;
-	ait[AM_fd].hdr.numNodes = AMIHDR_INVALID;
-	ait[AM_fd].hdr.numRecs = AMIHDR_INVALID;
-	ait[AM_fd].hdr.isUnique = FALSE;
-	ait[AM_fd].hdrchanged = FALSE;
-	ait[AM_fd].hdr.root.pagenum = NODE_NULLPTR;
-	ait[AM_fd].hdr.root.recnum = NODE_INTNULL;
+	for (i = 0; i < HASH_BUCKETS_INIT; i++){
+		if (PF_AllocPage(pfd, &pagenum, &pbuf) != PFE_OK){
+			printf("Hash_initTable failed: PF_AllocPage of a bucket\n");
+			PF_UnpinPage(pfd, amhdr->dir[0], TRUE);
+			return AME_PF;
+		}
+		hhdr = (HashHdr *) pbuf;
+		hhdr->entries = 0;
+		hhdr->overflow = NODE_NULLPTR;
+		memcpy(dbuf + i * sizeof(int), &pagenum, sizeof(int));
+		if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK){
+			PF_UnpinPage(pfd, amhdr->dir[0], TRUE);
+			return AME_PF;
+		}
+	}
+	amhdr->numNodes = HASH_BUCKETS_INIT + 1;
 
-	return AME_OK;
+	return PF_UnpinPage(pfd, amhdr->dir[0], TRUE) == PFE_OK ? AME_OK : AME_PF;
 }
 
 /*
-	tells if the specified B+ tree node is a leaf node
+	reads the page numbers of the buckets of a hash index from its directory pages
 
 	*** parameters ***
-	char * pbuf - pointer to a B+ tree node
+	int AM_fd - file descriptor of the AM index table
 
 	*** return values ***
-	TRUE if specified B+ tree node is a leaf node
-	FALSE otherwise
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
 */
-bool_t Btr_isLeaf(char * pbuf){
-	RECID res;
-	memcpy(&res, pbuf + sizeof(BtrHdr), sizeof(RECID));
-	if (res.recnum == NODE_NULLPTR){
-		return TRUE;
+int Hash_loadDir(int AM_fd){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int n = HASH_NBUCKETS(amhdr);
+	int i, count;
+	char * pbuf;
+
+	if ((ait[AM_fd].buckets = (int *) malloc(n * sizeof(int))) == NULL){
+		return AME_NOMEM;
 	}
-	return FALSE;
+	for (i = 0; i * HASH_DIRENTS < n; i++){
+		if ((i >= HASH_MAXDIR) || (PF_GetThisPage(ait[AM_fd].pfd, amhdr->dir[i], &pbuf) != PFE_OK)){
+			printf("Hash_loadDir failed: PF_GetThisPage of directory page %d\n", i);
+			free(ait[AM_fd].buckets);
+			ait[AM_fd].buckets = NULL;
+			return AME_PF;
+		}
+		count = (n - i * HASH_DIRENTS < HASH_DIRENTS) ? n - i * HASH_DIRENTS : HASH_DIRENTS;
+		memcpy(ait[AM_fd].buckets + i * HASH_DIRENTS, pbuf, count * sizeof(int));
+		if (PF_UnpinPage(ait[AM_fd].pfd, amhdr->dir[i], FALSE) != PFE_OK){
+			free(ait[AM_fd].buckets);
+			ait[AM_fd].buckets = NULL;
+			return AME_PF;
+		}
+	}
+	return AME_OK;
 }
 
 /*
-	compares values, tell which one is bigger or smaller
+	records the page of the bucket after the last one, in memory and in the directory pages,
+	a new directory page being made when the last one is full
 
 	*** parameters ***
-	char * a - points to a value to be compared
-	char * b - points to another value to be compared
-	char attrType - attribute type of a and b (must be the same)
-	int attrLength - attribute length of a and b (must be the same)
+	int AM_fd - file descriptor of the AM index table
+	int pagenum - page number of the new bucket
 
 	*** return values ***
-	BTR_LT(-1) if a < b
-	BTR_EQ(0) if a == b
-	BTR_GT(1) if a > b
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
 */
-int Btr_valComp(char * a, char * b, char attrType, int attrLength){
+int Hash_addBucket(int AM_fd, int pagenum){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int pfd = ait[AM_fd].pfd;
+	int n = HASH_NBUCKETS(amhdr);
+	int d = n / HASH_DIRENTS;
+	int * grown;
+	char * pbuf;
 	int err;
-	int result;
 
-	if ((err = AM_validAttr(attrType, attrLength)) != AME_OK){
-		printf("Btr_valComp failed: AM_validAttr\n");
-		return err;
+	if ((grown = (int *) realloc(ait[AM_fd].buckets, (n + 1) * sizeof(int))) == NULL){
+		return AME_NOMEM;
 	}
+	ait[AM_fd].buckets = grown;
+	grown[n] = pagenum;
 
-	if (attrType == INT_TYPE){
-		int temp1, temp2;
-		memcpy(&temp1, a, sizeof(attrLength));
-		memcpy(&temp2, b, sizeof(attrLength));
-		if (temp1 < temp2) return BTR_LT;
-		if (temp1 == temp2) return BTR_EQ;
-		if (temp1 > temp2) return BTR_GT;
-	} else if (attrType == REAL_TYPE){
-		float temp1, temp2;
-		memcpy(&temp1, a, sizeof(attrLength));
-		memcpy(&temp2, b, sizeof(attrLength));
-		if (temp1 < temp2) return BTR_LT;
-		if (temp1 == temp2) return BTR_EQ;
-		if (temp1 > temp2) return BTR_GT;
-	} else if (attrType == STRING_TYPE){
-		result = strncmp(a, b, attrLength);
-		if (result < 0) return BTR_LT;
-		if (result == 0) return BTR_EQ;
-		if (result > 0) return BTR_GT;
+	if (amhdr->dir[d] == NODE_NULLPTR){
+		if ((err = PF_AllocPage(pfd, &(amhdr->dir[d]), &pbuf)) == PFE_OK){
+			amhdr->numNodes++;
+		}
+	} else {
+		err = PF_GetThisPage(pfd, amhdr->dir[d], &pbuf);
+	}
+	if (err != PFE_OK){
+		printf("Hash_addBucket failed: directory page %d\n", d);
+		return AME_PF;
 	}
-   return AME_UNIX;
+	memcpy(pbuf + (n % HASH_DIRENTS) * sizeof(int), &pagenum, sizeof(int));
+	ait[AM_fd].hdrchanged = TRUE;
+
+	return PF_UnpinPage(pfd, amhdr->dir[d], TRUE) == PFE_OK ? AME_OK : AME_PF;
 }
 
 /*
-	performs split at specified node if necessary
-	recursively called, copying values upward
+	writes entries packed into the given pages of a bucket, linked in their order
 
 	*** parameters ***
 	int AM_fd - file descriptor of the AM index table
-	char * value - points to the value to be inserted in the specified node
-	RECID recId - record id of the value to be inserted
-	RECID adr -	pointer to the B+ tree node to split when needed
-	bool_t duplicate - tells whether a special split for duplicate values is needed
+	int * pages - page numbers of the bucket, the first one being the bucket's own page
+	int npages - number of pages, enough to hold the entries and at least one
+	char * ents - the entries, each one a record id and a key
+	int nents - number of entries
 
 	*** return values ***
 	AME_OK if successful
 	error codes (< 0) if a problem occurred
 */
-int Btr_recSplit(int AM_fd, char * value, RECID recId, RECID adr, bool_t duplicate){
-
-	int err;
-	int entries;
-	int entries2;
-	int res;
-	int i, j;
+int Hash_writeChain(int AM_fd, int * pages, int npages, char * ents, int nents){
+	int maxKeys = ait[AM_fd].hdr.maxKeys;
+	int entlen = sizeof(RECID) + ait[AM_fd].hdr.attrLength;
+	int i;
 	char * pbuf;
-	RECID parent;
-	RECID tempRid_new;
-	RECID tempRid_new2;
-	RECID tempRid_nbr;
-	RECID tempRid;
-	RECID rid_empty;
-	char * tempValue = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
-	char * tempValue_par = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
-
-	char * tempValue2 = (char *)calloc(sizeof(RECID) + ait[AM_fd].hdr.attrLength, sizeof(char));
-	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
-	BtrHdr * bhdr;
-	BtrHdr * bhdr_new;
-	BtrHdr * bhdr_new2;
+	HashHdr * hhdr;
 
-	char * value_empty = (char *)calloc(amhdr->attrLength, sizeof(char));
-	int mid; /* values GE to this are moved to the new node */
-	int new; /* idx where the new value is supposed to be at */
-	int newNode; /* pagenum of the newly assigned node */
-	int newNode2; /* pagenum of the newly assigned node */
-	int newRoot; /* pagenum of the new root node, if newly assigned */
+	for (i = 0; i < npages; i++){
+		if (PF_GetThisPage(ait[AM_fd].pfd, pages[i], &pbuf) != PFE_OK){
+			return AME_PF;
+		}
+		hhdr = (HashHdr *) pbuf;
+		hhdr->entries = (nents - i * maxKeys > maxKeys) ? maxKeys : nents - i * maxKeys;
+		hhdr->overflow = (i + 1 < npages) ? pages[i + 1] : NODE_NULLPTR;
+		memcpy(HASH_ENTRY(pbuf, ait[AM_fd].hdr.attrLength, 0), ents + i * maxKeys * entlen, hhdr->entries * entlen);
+		if (PF_UnpinPage(ait[AM_fd].pfd, pages[i], TRUE) != PFE_OK){
+			return AME_PF;
+		}
+	}
+	return AME_OK;
+}
 
-	char * pbuf_new; /* points to the created node */
-	char * pbuf_new2; /* points to the created node */
-	char * pbuf_par; /* points to the parent node */
-	char * pbuf_nbr; /* points to the newly created neighboring node (on the right) */
+/*
+	splits the bucket at the split pointer of a hash index:
+	the entries whose keys tell the next bit apart move to a new bucket after the last one,
+	both buckets are written packed, and the overflow pages left over are disposed of.
+	the entries keep their order, so a scan in the bucket is moved after the entries it passed
 
-	printf("Btr_recSplit at pagenum %d, recnum %d, duplicate %d, value %s\n", adr.pagenum, adr.recnum, duplicate, value);
-	/* retrieving node information */
-	if ((err = Btr_getNode(&pbuf, AM_fd, adr)) != AME_OK){
-		printf("Btr_recSplit failed: Btr_getNode\n");
-		return err;
-	}
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
 
-	/* retrieving number of entries, but we already know it is FULL at leaf nodes */
-	bhdr = (BtrHdr *) pbuf;
-	entries = bhdr->entries;
+	*** return values ***
+	AME_OK if successful, or if the directory cannot take another bucket
+	error codes (< 0) if a problem occurred
+*/
+int Hash_split(int AM_fd){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int pfd = ait[AM_fd].pfd;
+	int entlen = sizeof(RECID) + amhdr->attrLength;
+	int nb = HASH_NBUCKETS(amhdr);
+	unsigned int mod = (unsigned int) HASH_BUCKETS_INIT << (amhdr->level + 1);
+	int * pages = NULL;
+	int * newPages = NULL;
+	int * passed = NULL;
+	int * grownPages;
+	char * ents = NULL;
+	char * grownEnts;
+	char * dest = NULL;
+	char * part[2];
+	int nents = 0, npages = 0, cap = 0;
+	int count[2], need[2];
+	int pagenum, next, i, j, c, d, err = AME_OK;
+	char * pbuf;
+	HashHdr * hhdr;
 
-	printf("Btr_recSplit: currently contains %d entries\n", entries);
+	if (nb >= HASH_MAXDIR * HASH_DIRENTS){
+		return AME_OK;
+	}
+	if ((passed = (int *) malloc(AM_stab_size * sizeof(int))) == NULL){
+		return AME_NOMEM;
+	}
+	for (j = 0; j < AM_stab_size; j++){
+		passed[j] = -1;
+	}
 
-	/* at leaf node */
-	if (Btr_isLeaf(pbuf) == TRUE){
-		/* check if function was called for duplicate keys */
-		if (duplicate == TRUE){
-
-			/*
-			   determine the position of the duplicate key
-			   split nodes according to the position
-			   distribute keys
-			   adjust links between leaf nodes
-			   copy up the key(s) - twice if the duplicate key is not at one of the ends
-			*/
-
-			/* find the position of the duplicate key */
-			for (i = 0; i < entries; i++){
-				if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: reading %d th value for finding duplicate value\n", i);
-					return err;
-				}
-				if ((res = Btr_valComp(value, tempValue, amhdr->attrType, amhdr->attrLength)) == BTR_LT){
-					/* duplicate value not found */
-					printf("Btr_recSplit failed: called for duplicate keys but could not find one?\n");
-					return AME_KEYNOTFOUND;
-				} else if (res == BTR_EQ) {
-					/* found the duplicate value */
-					break;
-				} else if (res == BTR_GT) {
-					/* scan further */
-					continue;
-				}
+	/* the entries of the bucket are read in order, noting how many of them each scan in it passed */
+	pagenum = ait[AM_fd].buckets[amhdr->split];
+	while ((pagenum != NODE_NULLPTR) && (err == AME_OK)){
+		if (PF_GetThisPage(pfd, pagenum, &pbuf) != PFE_OK){
+			err = AME_PF;
+			break;
+		}
+		hhdr = (HashHdr *) pbuf;
+		if (nents + hhdr->entries > cap){
+			cap = 2 * (nents + hhdr->entries);
+			if ((grownEnts = (char *) realloc(ents, cap * entlen)) == NULL){
+				err = AME_NOMEM;
+			} else {
+				ents = grownEnts;
 			}
-			if (i == entries){
-				printf("Btr_recSplit failed: called for duplicate keys but could not find one?\n");
-				return AME_KEYNOTFOUND;
+		}
+		if ((grownPages = (int *) realloc(pages, (npages + 1) * sizeof(int))) == NULL){
+			err = AME_NOMEM;
+		} else {
+			pages = grownPages;
+		}
+		if (err == AME_OK){
+			pages[npages++] = pagenum;
+			for (j = 0; j < AM_stab_size; j++){
+				if ((ast[j].valid == TRUE) && (ast[j].fd == AM_fd) && (ast[j].currentNode.pagenum == pagenum)){
+					passed[j] = nents + ast[j].currentNode.recnum + 1;
+				}
 			}
+			memcpy(ents + nents * entlen, HASH_ENTRY(pbuf, amhdr->attrLength, 0), hhdr->entries * entlen);
+			nents += hhdr->entries;
+		}
+		next = hhdr->overflow;
+		if (PF_UnpinPage(pfd, pagenum, FALSE) != PFE_OK){
+			err = AME_PF;
+		}
+		pagenum = next;
+	}
 
-			/* parent of the current node */
-			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, NODE_PARENT, amhdr->maxKeys, &parent)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving the parent ptr of an leaf node\n");
-				return err;
-			}
+	/* each entry stays or moves by the next bit of its hash value, the two parts keeping their order */
+	part[0] = part[1] = NULL;
+	if ((err == AME_OK) && (((dest = (char *) malloc(nents + 1)) == NULL)
+		|| ((part[0] = (char *) malloc(nents * entlen + 1)) == NULL)
+		|| ((part[1] = (char *) malloc(nents * entlen + 1)) == NULL))){
+		err = AME_NOMEM;
+	}
+	count[0] = count[1] = 0;
+	for (i = 0; (i < nents) && (err == AME_OK); i++){
+		d = (int) (Hash_key(amhdr, ents + i * entlen + sizeof(RECID)) % mod) == nb;
+		memcpy(part[d] + count[d] * entlen, ents + i * entlen, entlen);
+		count[d]++;
+		dest[i] = (char) d;
+	}
 
-			/* assign a new node */
-			if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_LEAF, amhdr->attrLength, amhdr->maxKeys, &newNode, &pbuf_new, parent)) != AME_OK){
-				printf("Btr_recSplit failed: assigning a new leaf node\n");
-				return err;
-			}
-			bhdr_new = (BtrHdr *)pbuf_new;
+	/* the bucket keeps as many of its pages as it needs, the new one is given new pages */
+	for (d = 0; d < 2; d++){
+		need[d] = (count[d] + amhdr->maxKeys - 1) / amhdr->maxKeys;
+		need[d] = (need[d] == 0) ? 1 : need[d];
+	}
+	if ((err == AME_OK) && ((newPages = (int *) malloc(need[1] * sizeof(int))) == NULL)){
+		err = AME_NOMEM;
+	}
+	for (i = 0; (i < need[1]) && (err == AME_OK); i++){
+		if ((PF_AllocPage(pfd, &(newPages[i]), &pbuf) != PFE_OK) || (PF_UnpinPage(pfd, newPages[i], TRUE) != PFE_OK)){
+			err = AME_PF;
+		} else {
 			amhdr->numNodes++;
-			ait[AM_fd].hdrchanged = TRUE;
+		}
+	}
+	if (err == AME_OK){
+		err = Hash_writeChain(AM_fd, pages, need[0], part[0], count[0]);
+	}
+	if (err == AME_OK){
+		err = Hash_writeChain(AM_fd, newPages, need[1], part[1], count[1]);
+	}
+	if (err == AME_OK){
+		err = Hash_addBucket(AM_fd, newPages[0]);
+	}
 
-			/* adjust links between leaf nodes */
-			/* right neighbor of the current leaf node */
+	/* a page the free page map cannot record is merely left unused */
+	for (i = need[0]; (i < npages) && (err == AME_OK); i++){
+		if (((err = PF_DisposePage(pfd, pages[i])) != PFE_OK) && (err != PFE_FREEMAPFULL)){
+			err = AME_PF;
+		} else {
+			amhdr->numNodes--;
+			err = AME_OK;
+		}
+	}
 
-			adr.recnum = NODE_NULLPTR;
-			if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &adr)) != AME_OK){
-				printf("Btr_recSplit failed: setting PREV ptr of new node\n");
-				return err;
-			}
+	if (err == AME_OK){
+		if (++(amhdr->split) == (HASH_BUCKETS_INIT << amhdr->level)){
+			amhdr->level++;
+			amhdr->split = 0;
+		}
+		ait[AM_fd].hdrchanged = TRUE;
 
-			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving NEXT ptr of a leaf node\n");
-				return err;
+		/* a scan goes after the entries it passed that are in the bucket of its value */
+		for (j = 0; j < AM_stab_size; j++){
+			if (passed[j] < 0){
+				continue;
 			}
-
-			if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-				printf("Btr_recSplit failed: setting NEXT ptr of new node\n");
-				return err;
+			d = (int) (Hash_key(amhdr, ast[j].value) % mod) == nb;
+			for (i = 0, c = 0; i < passed[j]; i++){
+				c += (dest[i] == d);
 			}
-
-			tempRid_new.pagenum = newNode;
-			tempRid_new.recnum = NODE_NULLPTR;
-
-			if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-				printf("Btr_recSplit failed: setting NEXT ptr of new leaf node\n");
-				return err;
+			if (c == 0){
+				ast[j].currentNode.pagenum = (d ? newPages : pages)[0];
+				ast[j].currentNode.recnum = -1;
+			} else {
+				ast[j].currentNode.pagenum = (d ? newPages : pages)[(c - 1) / amhdr->maxKeys];
+				ast[j].currentNode.recnum = (c - 1) % amhdr->maxKeys;
 			}
+		}
+	}
 
-			if (tempRid_nbr.pagenum != NODE_NULLPTR){
-				if ((err = Btr_getNode(&pbuf_nbr, AM_fd, tempRid_nbr)) != AME_OK){
-					printf("Btr_recSplit failed: Btr_getNode for neighboring leaf node\n");
-					return err;
-				}
-
-				if ((err = Btr_setPtr(&pbuf_nbr, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-					printf("Btr_recSplit failed: setting PREV ptr of neighboring leaf node\n");
-					return err;
-				}
-			}
+	free(newPages);
+	free(part[1]);
+	free(part[0]);
+	free(dest);
+	free(pages);
+	free(ents);
+	free(passed);
+	return err;
+}
 
-			/* duplicate value at the leftmost position */
-			if (i == 0) {
-				/* move values - all but the first value */
-				for (j = 1; j < entries; j++){
-					if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recSplit failed: retrieving %d th ptr of current leaf node\n", j);
-						return err;
-					}
-					if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, tempValue)) != AME_OK){
-						printf("Btr_recSplit failed: retrieving %d th value of current leaf node\n", j);
-						return err;
-					}
-					if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, j-1, amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recSplit failed: writing %d th ptr of current leaf node to new one\n", j);
-						return err;
-					}
-					if ((err = Btr_setKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, j-1, amhdr->maxKeys, tempValue)) != AME_OK){
-						printf("Btr_recSplit failed: writing %d th value of current leaf node to new one\n", j);
-						return err;
-					}
+/*
+	inserts an entry in its bucket of a hash index, in the first page with room or in a new page
+	at the end of the bucket, and splits a bucket when the buckets are filled past HASH_LOADFACTOR
 
-					if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, &rid_empty)) != AME_OK){
-						printf("Btr_recSplit failed: emptying %d th ptr of current leaf node\n", j);
-						return err;
-					}
-					if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, value_empty)) != AME_OK){
-						printf("Btr_recSplit failed: emptying %d th value of current leaf node\n", j);
-						return err;
-					}
-					bhdr->entries--;
-					bhdr_new->entries++;
-				}
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * value - points to the value to be inserted
+	RECID recId - record id of the value to be inserted
 
-				/* add duplicate value to the current node, set duplicate attribute to TRUE */
-				if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, 1, amhdr->maxKeys, &recId)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th ptr of duplicate value at a leaf node\n", 1);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, 1, amhdr->maxKeys, value)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th value of duplicate value at a leaf node\n", 1);
-					return err;
-				}
-				bhdr->duplicate = TRUE;
-				bhdr->entries++;
-				amhdr->numRecs++;
-				ait[AM_fd].hdrchanged = TRUE;
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Hash_insert(int AM_fd, char * value, RECID recId){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int pfd = ait[AM_fd].pfd;
+	int pagenum = ait[AM_fd].buckets[Hash_bucket(amhdr, value)];
+	int next;
+	char * pbuf;
+	char * newBuf;
+	char * ent;
+	HashHdr * hhdr;
 
-				/* copy up the second value, with new node's ptr */
-				tempRid_new.recnum = NODE_INTNULL;
-				if ((err = Btr_getKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving first value of new leaf node\n");
-					return err;
-				}
-				if ((err = Btr_recSplit(AM_fd, tempValue, tempRid_new, parent, FALSE)) != AME_OK){
-					printf("Btr_recSplit failed: copying up the new leaf node's first key value to parent from leaf\n");
-					return err;
-				}
+	while (1){
+		if (PF_GetThisPage(pfd, pagenum, &pbuf) != PFE_OK){
+			printf("Hash_insert failed: PF_GetThisPage\n");
+			return AME_PF;
+		}
+		hhdr = (HashHdr *) pbuf;
+		if ((hhdr->entries < amhdr->maxKeys) || (hhdr->overflow == NODE_NULLPTR)){
+			break;
+		}
+		next = hhdr->overflow;
+		if (PF_UnpinPage(pfd, pagenum, FALSE) != PFE_OK){
+			return AME_PF;
+		}
+		pagenum = next;
+	}
 
-				/* modify the key value of the parent node, whose right side ptr points to current node */
-				if ((err = Btr_getNode(&pbuf_par, AM_fd, parent)) != AME_OK){
-					printf("Btr_recSplit failed: Btr_getNode for the parent node\n");
-					return err;
-				}
-				bhdr_new2 = (BtrHdr *)pbuf_par;
-				entries2 = bhdr_new2->entries;
+	if (hhdr->entries == amhdr->maxKeys){
+		if (PF_AllocPage(pfd, &next, &newBuf) != PFE_OK){
+			printf("Hash_insert failed: PF_AllocPage of an overflow page\n");
+			PF_UnpinPage(pfd, pagenum, FALSE);
+			return AME_PF;
+		}
+		hhdr->overflow = next;
+		if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK){
+			PF_UnpinPage(pfd, next, TRUE);
+			return AME_PF;
+		}
+		amhdr->numNodes++;
+		pagenum = next;
+		pbuf = newBuf;
+		hhdr = (HashHdr *) pbuf;
+		hhdr->entries = 0;
+		hhdr->overflow = NODE_NULLPTR;
+	}
 
-				if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving first value of current node\n");
-					return err;
-				}
+	ent = HASH_ENTRY(pbuf, amhdr->attrLength, hhdr->entries);
+	memcpy(ent, &recId, sizeof(RECID));
+	memcpy(ent + sizeof(RECID), value, amhdr->attrLength);
+	hhdr->entries++;
+	amhdr->numRecs++;
+	ait[AM_fd].hdrchanged = TRUE;
+	if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK){
+		return AME_PF;
+	}
 
-				for (j = 0; j < entries2; j++){
-					if ((err = Btr_getPtr(&pbuf_par, NODE_INT, amhdr->attrLength, j, amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recSplit failed: reading %d th ptr for finding key value to replace\n", j);
-						return err;
-					}
-					if (tempRid.pagenum == adr.pagenum){
-						/* found the key to be replaced */
-						if (j == 0){
-							/* when there is no key left to the found ptr */
-							/* assign a new leaf node to the original ptr's place */
-							/* assign a new node */
-							if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_LEAF, amhdr->attrLength, amhdr->maxKeys, &newNode2, &pbuf_new2, parent)) != AME_OK){
-								printf("Btr_recSplit failed: assigning a new leaf node\n");
-								return err;
-							}
-							amhdr->numNodes++;
-							ait[AM_fd].hdrchanged = TRUE;
-
-							/* adjust the pointers */
-							tempRid.pagenum = newNode2;
-							tempRid.recnum = NODE_INTNULL;
-							if ((err = Btr_setPtr(&pbuf_par, NODE_INT, amhdr->attrLength, j, amhdr->maxKeys, &tempRid)) != AME_OK){
-								printf("Btr_recSplit failed: assigning ptr at a parent node to newly assigned node\n");
-								return err;
-							}
+	if (amhdr->numRecs > HASH_NBUCKETS(amhdr) * (amhdr->maxKeys * HASH_LOADFACTOR / 100)){
+		return Hash_split(AM_fd);
+	}
+	return AME_OK;
+}
 
-							adr.recnum = NODE_NULLPTR;
-							if ((err = Btr_setPtr(&pbuf_new2, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &adr)) != AME_OK){
-								printf("Btr_recSplit failed: assigning NEXT ptr of newly assigned leaf node \n");
-								return err;
-							}
-							if(tempRid_nbr.pagenum != NODE_NULLPTR){
-								if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
-									printf("Btr_recSplit failed: PF_UnpinPage of NEXT neighbor\n");
-									return err;
-								}
-							}
-							if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-								printf("Btr_recSplit failed: retrieving PREV ptr of a leaf node\n");
-								return err;
-							}
+/*
+	deletes an entry from its bucket of a hash index, pulling the entries after it in its page one place back;
+	an overflow page left empty is unlinked from the bucket and disposed of, buckets are never merged
 
-							if ((err = Btr_setPtr(&pbuf_new2, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-								printf("Btr_recSplit failed: setting PREV ptr of new left leaf node\n");
-								return err;
-							}
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * value - points to the value to be deleted
+	RECID recId - record id of the value to be deleted
 
-							tempRid.recnum = NODE_NULLPTR;
-							if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid)) != AME_OK){
-								printf("Btr_recSplit failed: assigning PREV ptr of current leaf node \n");
-								return err;
-							}
+	*** return values ***
+	AME_OK if successful
+	AME_KEYNOTFOUND if the value is not in the index
+	AME_RECNOTFOUND if the value is there with other record ids only
+	error codes (< 0) if a problem occurred
+*/
+int Hash_delete(int AM_fd, char * value, RECID recId){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int pfd = ait[AM_fd].pfd;
+	int entlen = sizeof(RECID) + amhdr->attrLength;
+	int pagenum = ait[AM_fd].buckets[Hash_bucket(amhdr, value)];
+	int prev = NODE_NULLPTR;
+	int prevEntries = 0;
+	int next, i, j;
+	int res = AME_KEYNOTFOUND;
+	char * pbuf;
+	char * ent;
+	HashHdr * hhdr;
+	RECID rid;
+
+	while (pagenum != NODE_NULLPTR){
+		if (PF_GetThisPage(pfd, pagenum, &pbuf) != PFE_OK){
+			printf("Hash_delete failed: PF_GetThisPage\n");
+			return AME_PF;
+		}
+		hhdr = (HashHdr *) pbuf;
+		for (i = 0; i < hhdr->entries; i++){
+			ent = HASH_ENTRY(pbuf, amhdr->attrLength, i);
+			if (AM_compAttrs(amhdr, ent + sizeof(RECID), value, amhdr->nattrs) != BTR_EQ){
+				continue;
+			}
+			memcpy(&rid, ent, sizeof(RECID));
+			if ((rid.pagenum != recId.pagenum) || (rid.recnum != recId.recnum)){
+				res = AME_RECNOTFOUND;
+				continue;
+			}
+
+			/* the scans past the entry are pulled back with the entries */
+			memmove(ent, ent + entlen, (hhdr->entries - i - 1) * entlen);
+			hhdr->entries--;
+			amhdr->numRecs--;
+			ait[AM_fd].hdrchanged = TRUE;
+			for (j = 0; j < AM_stab_size; j++){
+				if ((ast[j].valid == TRUE) && (ast[j].fd == AM_fd) && (ast[j].currentNode.pagenum == pagenum)
+					&& (ast[j].currentNode.recnum >= i)){
+					ast[j].currentNode.recnum--;
+				}
+			}
+
+			next = hhdr->overflow;
+			if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK){
+				return AME_PF;
+			}
+			if ((hhdr->entries > 0) || (prev == NODE_NULLPTR)){
+				return AME_OK;
+			}
+
+			/* the scans in the empty page go after the last entry of the page before it */
+			if (PF_GetThisPage(pfd, prev, &pbuf) != PFE_OK){
+				return AME_PF;
+			}
+			((HashHdr *) pbuf)->overflow = next;
+			if (PF_UnpinPage(pfd, prev, TRUE) != PFE_OK){
+				return AME_PF;
+			}
+			for (j = 0; j < AM_stab_size; j++){
+				if ((ast[j].valid == TRUE) && (ast[j].fd == AM_fd) && (ast[j].currentNode.pagenum == pagenum)){
+					ast[j].currentNode.pagenum = prev;
+					ast[j].currentNode.recnum = prevEntries - 1;
+				}
+			}
+			/* a page the free page map cannot record is merely left unused */
+			if (((i = PF_DisposePage(pfd, pagenum)) != PFE_OK) && (i != PFE_FREEMAPFULL)){
+				return AME_PF;
+			}
+			amhdr->numNodes--;
+			return AME_OK;
+		}
+
+		prev = pagenum;
+		prevEntries = hhdr->entries;
+		next = hhdr->overflow;
+		if (PF_UnpinPage(pfd, pagenum, FALSE) != PFE_OK){
+			return AME_PF;
+		}
+		pagenum = next;
+	}
+
+	printf("Hash_delete failed: entry not found\n");
+	return res;
+}
+
+/*
+	finds the next entry of a hash index scan, whose value is looked for in its bucket only
+
+	*** parameters ***
+	int scanDesc - scan descriptor of the index
+
+	*** return values ***
+	RECID of the next entry if successful
+	RECID containing NODE_NULLPTR(-1) if there is no more entry or a problem occurred, AMerrno telling which
+*/
+RECID Hash_findNext(int scanDesc){
+	AMstab_ele * scan = &(ast[scanDesc]);
+	int pfd = ait[scan->fd].pfd;
+	int next, i;
+	char * pbuf;
+	char * ent;
+	HashHdr * hhdr;
+	RECID recid;
+
+	recid.pagenum = NODE_NULLPTR;
+	recid.recnum = NODE_NULLPTR;
+	if (scan->current.pagenum == AME_EOF){
+		AMerrno = AME_EOF;
+		return recid;
+	}
+	/* the scan starts before the first entry of the bucket */
+	if (scan->currentNode.pagenum == NODE_NULLPTR){
+		scan->currentNode.pagenum = ait[scan->fd].buckets[Hash_bucket(&(ait[scan->fd].hdr), scan->value)];
+		scan->currentNode.recnum = -1;
+	}
+
+	while (1){
+		if (PF_GetThisPage(pfd, scan->currentNode.pagenum, &pbuf) != PFE_OK){
+			AMerrno = AME_PF;
+			return recid;
+		}
+		hhdr = (HashHdr *) pbuf;
+		for (i = scan->currentNode.recnum + 1; i < hhdr->entries; i++){
+			ent = HASH_ENTRY(pbuf, scan->attrLength, i);
+			if (AM_scanComp(scanDesc, ent + sizeof(RECID)) == BTR_EQ){
+				memcpy(&recid, ent, sizeof(RECID));
+				memcpy(scan->found, ent + sizeof(RECID), scan->attrLength);
+				scan->currentNode.recnum = i;
+				scan->current = recid;
+				if (PF_UnpinPage(pfd, scan->currentNode.pagenum, FALSE) != PFE_OK){
+					AMerrno = AME_PF;
+					recid.pagenum = NODE_NULLPTR;
+					recid.recnum = NODE_NULLPTR;
+				}
+				return recid;
+			}
+		}
+		next = hhdr->overflow;
+		if (PF_UnpinPage(pfd, scan->currentNode.pagenum, FALSE) != PFE_OK){
+			AMerrno = AME_PF;
+			return recid;
+		}
+		if (next == NODE_NULLPTR){
+			scan->current.pagenum = AME_EOF;
+			scan->current.recnum = AME_EOF;
+			AMerrno = AME_EOF;
+			return recid;
+		}
+		scan->currentNode.pagenum = next;
+		scan->currentNode.recnum = -1;
+	}
+}
+
+/*
+	fills an empty hash index with the records of a heap file, inserted one by one
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	int HFfd - file descriptor of the heap file the index is on
+	int attrOffset - offset of the indexed attribute in the records, not used for an index of several attributes
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Hash_load(int AM_fd, int HFfd, int attrOffset){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	HFview view;
+	RECID recId;
+	int sd, err = AME_OK;
+	char * value;
+
+	if ((value = (char *) malloc(amhdr->attrLength)) == NULL){
+		return AME_NOMEM;
+	}
+	if ((sd = HF_OpenFileScan(HFfd, amhdr->attrType, amhdr->attrLength, attrOffset, EQ_OP, NULL)) < 0){
+		free(value);
+		return AME_PF;
+	}
+	recId = HF_FindNextView(sd, &view);
+	while ((err == AME_OK) && HF_ValidRecId(HFfd, recId)){
+		AM_makeValue(amhdr, view.record, attrOffset, value);
+		err = Hash_insert(AM_fd, value, recId);
+		if ((HF_ReleaseView(&view) != HFE_OK) && (err == AME_OK)){
+			err = AME_PF;
+		}
+		if (err == AME_OK){
+			recId = HF_FindNextView(sd, &view);
+		}
+	}
+	if ((HF_CloseFileScan(sd) != HFE_OK) && (err == AME_OK)){
+		err = AME_PF;
+	}
+	free(value);
+	return err;
+}
+
+/*
+	creates a B+ tree index
+
+	*** parameters ***
+	char * fileName - points to the specified file's name
+	int indexNo - index number for the specified file
+	char attrType - attribute type of the index
+	int attrLength - attribute length of the index
+	bool_t isUnique - specifies whether this index must be unique, set to FALSE
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int AM_CreateIndex(char *fileName, int indexNo, char attrType, int attrLength, bool_t isUnique){
+	return AM_CreateIndexMethod(fileName, indexNo, attrType, attrLength, isUnique, AM_METHOD_BTREE);
+}
+
+/*
+	creates an index of the given access method
+
+	*** parameters ***
+	char * fileName - points to the specified file's name
+	int indexNo - index number for the specified file
+	char attrType - attribute type of the index
+	int attrLength - attribute length of the index
+	bool_t isUnique - specifies whether this index must be unique, set to FALSE
+	int method - access method of the index, AM_METHOD_BTREE or AM_METHOD_HASH
+
+	*** return values ***
+	AME_OK if successful
+	AME_INVALIDPARA if the access method is not valid
+	error codes (< 0) if a problem occurred
+*/
+int AM_CreateIndexMethod(char *fileName, int indexNo, char attrType, int attrLength, bool_t isUnique, int method){
+	AM_ATTRDESC attr;
+
+	attr.attrType = attrType;
+	attr.attrLength = attrLength;
+	attr.attrOffset = 0;
+	return AM_CreateIndexAttrs(fileName, indexNo, 1, &attr, 1, method);
+}
+
+/*
+	creates an index whose values are made of several attributes of the records, one after another:
+	the entries are ordered and looked for by the first 'nkeys' of them, the key attributes,
+	while the others are only kept in the entries, for scans to give them back without the records
+
+	*** parameters ***
+	char * fileName - points to the specified file's name
+	int indexNo - index number for the specified file
+	int nattrs - number of attributes, from 1 to AM_MAXATTRS
+	AM_ATTRDESC * attrs - points to the attributes, the key attributes first
+	int nkeys - number of key attributes, from 1 to nattrs
+	int method - access method of the index, AM_METHOD_BTREE or AM_METHOD_HASH
+
+	*** return values ***
+	AME_OK if successful
+	AME_INVALIDPARA if the access method or the number of attributes is not valid
+	error codes (< 0) if a problem occurred
+*/
+int AM_CreateIndexAttrs(char *fileName, int indexNo, int nattrs, AM_ATTRDESC *attrs, int nkeys, int method){
+	int err;
+	int pfd;
+	int i, attrLength;
+	AMhdr_str amhdr;
+	PFftab_ele *pfte;
+	char iname[INAME_LEN];
+	char cache[INAME_LEN];
+
+	if ((method != AM_METHOD_BTREE) && (method != AM_METHOD_HASH)){
+		printf("AM_CreateIndex failed: invalid access method\n");
+		return AME_INVALIDPARA;
+	}
+	if ((nattrs < 1) || (nattrs > AM_MAXATTRS) || (nkeys < 1) || (nkeys > nattrs)){
+		printf("AM_CreateIndex failed: invalid number of attributes\n");
+		return AME_INVALIDPARA;
+	}
+
+	strcpy(iname, fileName);
+	sprintf(cache, "%d", indexNo);
+	strcat(iname, cache);
+
+	if (PF_CreateFile(iname) != PFE_OK){
+		printf("AM_CreateIndex failed: PF_CreateFile with %s\n", iname);
+		return AME_PF;
+	}
+
+	if ((pfd = PF_OpenFile(iname)) < PFE_OK) {
+		printf("AM_CreateIndex failed: PF_OpenFile with %s\n", iname);
+		return AME_PF;
+	}
+
+	pfte = &(pft[pfd]);
+
+	memset(&amhdr, 0, sizeof(AMhdr_str));
+	for (i = 0, attrLength = 0; i < nattrs; i++){
+		if ((err = AM_validAttr(attrs[i].attrType, attrs[i].attrLength)) != AME_OK){
+			printf("AM_CreateIndex failed: attribute type or length not valid\n");
+			return err;
+		}
+		amhdr.attrTypes[i] = attrs[i].attrType;
+		amhdr.attrLengths[i] = attrs[i].attrLength;
+		amhdr.attrOffsets[i] = attrs[i].attrOffset;
+		attrLength += attrs[i].attrLength;
+	}
+	if (attrLength > AM_MAXVALUE){
+		printf("AM_CreateIndex failed: attributes too long\n");
+		return AME_INVALIDATTRLENGTH;
+	}
+
+	amhdr.indexNo = indexNo;
+	amhdr.attrType = attrs[0].attrType;
+	amhdr.attrLength = attrLength;
+	amhdr.nattrs = nattrs;
+	amhdr.nkeys = nkeys;
+	amhdr.method = method;
+	amhdr.numRecs = 0;
+	amhdr.isUnique = FALSE;
+
+	if (method == AM_METHOD_HASH){
+		/* the buckets hold whole keys */
+		amhdr.keyLength = attrLength;
+		amhdr.maxKeys = HASH_MAXKEYS(attrLength);
+		amhdr.root.pagenum = NODE_NULLPTR;
+		amhdr.root.recnum = NODE_NULLPTR;
+		if ((err = Hash_initTable(pfd, &amhdr)) != AME_OK){
+			printf("AM_CreateIndex failed: Hash_initTable\n");
+			return err;
+		}
+	} else {
+		/* the key slots are sized once, for the longest value of the attribute */
+		amhdr.keyLength = attrLength;
+		amhdr.maxKeys = BTR_MAXKEYS(amhdr.keyLength);
+		printf("RECID size: %d, attrLength: %d, num. of entries in each node: %d\n", (int)sizeof(RECID), attrLength, amhdr.maxKeys);
+		if ((err = Btr_initTree(pfd, &amhdr)) != AME_OK){
+			printf("AM_CreateIndex failed: Btr_initTree\n");
+			return err;
+		}
+	}
+
+	if (memcpy(pfte->hdr.hdrrest, &amhdr, sizeof(AMhdr_str)) == NULL){
+		printf("AM_CreateIndex failed: copying AMhdr_str to PF header\n");
+		return AME_UNIX;
+	}
+	pfte->hdrchanged = TRUE;
+
+	return PF_CloseFile(pfd) == PFE_OK ? AME_OK : AME_PF;
+}
+
+/*
+	destroys the specified index
+
+	*** parameters ***
+	char * fileName - points to the specified file's name
+	int indexNo - index number for the specified file
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int AM_DestroyIndex(char *fileName, int indexNo){
+	char iname[INAME_LEN];
+	char cache[INAME_LEN];
+	strcpy(iname, fileName);
+	sprintf(cache, "%d", indexNo);
+	strcat(iname, cache);
+
+	return PF_DestroyFile(iname) == PFE_OK ? AME_OK : AME_PF;
+}
+
+/*
+	opens an AM index table entry
+
+	*** parameters ***
+	char * fileName - points to the specified file's name
+	int indexNo - index number for the specified file
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int AM_OpenIndex(char *fileName, int indexNo){
+	int err;
+	int pfd;
+	int aid;
+	char * pbuf;
+	AMitab_ele * aite;
+	RECID temp;
+
+	char iname[INAME_LEN];
+	char cache[INAME_LEN];
+
+	strcpy(iname, fileName);
+	sprintf(cache, "%d", indexNo);
+	strcat(iname, cache);
+
+	if ((pfd = PF_OpenFile(iname)) < PFE_OK) {
+		printf("AM_OpenIndex failed: PF_OpenFile\n");
+		return AME_PF;
+	}
+
+	if (AM_nfreefd == 0 && AM_GrowITable() != AME_OK){
+		PF_CloseFile(pfd);
+		printf("AM_OpenIndex failed: AM index table full\n");
+		return AME_FULLTABLE;
+	}
+	aid = AM_freefd[AM_nfreefd - 1];
+	aite = &(ait[aid]);
+
+	if (memcpy(&(aite->hdr), pft[pfd].hdr.hdrrest, sizeof(AMhdr_str)) == NULL || aite->hdr.keyLength <= 0 || aite->hdr.keyLength > aite->hdr.attrLength || aite->hdr.maxKeys < 0 || aite->hdr.numNodes < 0 || aite->hdr.numRecs < 0 || (aite->hdr.method != AM_METHOD_HASH && aite->hdr.root.pagenum < 0)) {
+		PF_CloseFile(pfd);
+		printf("AM_OpenIndex failed: copying AM header from the file to AM index table\n");
+		return AME_PF;
+	}
+	/* indexes made before there were other access methods are B+ trees */
+	if (aite->hdr.method != AM_METHOD_HASH){
+		aite->hdr.method = AM_METHOD_BTREE;
+	}
+	/* and are on one attribute */
+	if ((aite->hdr.nattrs < 1) || (aite->hdr.nattrs > AM_MAXATTRS) || (aite->hdr.nkeys < 1) || (aite->hdr.nkeys > aite->hdr.nattrs)){
+		aite->hdr.nattrs = 1;
+		aite->hdr.nkeys = 1;
+		aite->hdr.attrTypes[0] = aite->hdr.attrType;
+		aite->hdr.attrLengths[0] = aite->hdr.attrLength;
+		aite->hdr.attrOffsets[0] = 0;
+	}
+	aite->pfd = pfd;
+	if ((aite->hdr.method == AM_METHOD_HASH) && ((err = Hash_loadDir(aid)) != AME_OK)){
+		PF_CloseFile(pfd);
+		aite->pfd = AMI_PFD_INVALID;
+		printf("AM_OpenIndex failed: Hash_loadDir\n");
+		return err;
+	}
+	AM_nfreefd--;
+	aite->valid = TRUE;
+	aite->comp = Btr_getComp(aite->hdr.attrType);
+	aite->fname = (char *)calloc(strlen(iname) + 1, sizeof(char));
+	strcpy(aite->fname, iname);
+
+	return aid;
+}
+
+
+/*
+	closes the specified AM index table entry
+
+	*** parameters ***
+	int AM_fd - file descriptor to the specified AM index table entry
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int AM_CloseIndex(int AM_fd){
+	int pfd;
+	PFftab_ele * pfte;
+
+	if (AM_fd < 0 || AM_fd >= AM_itab_size || ait[AM_fd].valid == FALSE){
+		printf("AM_CloseIndex failed: invalid index descriptor\n");
+		return AME_FD;
+	}
+	pfd = ait[AM_fd].pfd;
+	pfte = &(pft[pfd]);
+	pfte->hdrchanged = TRUE;
+
+	if (memcpy(pfte->hdr.hdrrest, &(ait[AM_fd].hdr), sizeof(AMhdr_str)) == NULL){
+		printf("AM_CloseIndex failed: copying AMhdr_str to PF header\n");
+		return AME_UNIX;
+	}
+
+	if (PF_CloseFile(pfd) != PFE_OK){
+		printf("AM_CloseIndex failed: PF_CloseFile\n");
+		return AME_PF;
+	}
+	ait[AM_fd].valid = FALSE;
+	free(ait[AM_fd].fname);
+	ait[AM_fd].fname = NULL;
+	free(ait[AM_fd].buckets);
+	ait[AM_fd].buckets = NULL;
+	Btr_dropNodes(AM_fd);
+	free(ait[AM_fd].nodes);
+	ait[AM_fd].nodes = NULL;
+	ait[AM_fd].nnodes = 0;
+	ait[AM_fd].pfd = AMI_PFD_INVALID;
+	ait[AM_fd].hdr.indexNo = AMIHDR_INVALID;
+	ait[AM_fd].hdr.attrType = AMIHDR_INVALID;
+	ait[AM_fd].hdr.attrLength = AMIHDR_INVALID;
+	ait[AM_fd].hdr.maxKeys = AMIHDR_INVALID;
+	ait[AM_fd].hdr.numNodes = AMIHDR_INVALID;
+	ait[AM_fd].hdr.numRecs = AMIHDR_INVALID;
+	ait[AM_fd].hdr.isUnique = FALSE;
+	ait[AM_fd].hdrchanged = FALSE;
+	ait[AM_fd].hdr.root.pagenum = NODE_NULLPTR;
+	ait[AM_fd].hdr.root.recnum = NODE_INTNULL;
+	AM_freefd[AM_nfreefd++] = AM_fd;
+
+	return AME_OK;
+}
+
+/*
+	tells the access method of an open index
+
+	*** parameters ***
+	int AM_fd - file descriptor to the specified AM index table entry
+
+	*** return values ***
+	AM_METHOD_BTREE or AM_METHOD_HASH if successful
+	AME_FD if the index descriptor is not valid
+*/
+int AM_IndexMethod(int AM_fd){
+	if (AM_fd < 0 || AM_fd >= AM_itab_size || ait[AM_fd].valid == FALSE){
+		return AME_FD;
+	}
+	return ait[AM_fd].hdr.method;
+}
+
+/*
+	tells the attributes an open index is made on
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	AM_ATTRDESC * attrs - points to where the AM_MAXATTRS attributes at most are written, in order
+	int * nkeys - points to where the number of key attributes is written
+
+	*** return values ***
+	the number of attributes if successful
+	AME_FD if the index is not open
+*/
+int AM_IndexAttrs(int AM_fd, AM_ATTRDESC * attrs, int * nkeys){
+	AMhdr_str * amhdr;
+	int i;
+
+	if (AM_fd < 0 || AM_fd >= AM_itab_size || ait[AM_fd].valid == FALSE){
+		return AME_FD;
+	}
+	amhdr = &(ait[AM_fd].hdr);
+	for (i = 0; i < amhdr->nattrs; i++){
+		attrs[i].attrType = amhdr->attrTypes[i];
+		attrs[i].attrLength = amhdr->attrLengths[i];
+		attrs[i].attrOffset = amhdr->attrOffsets[i];
+	}
+	*nkeys = amhdr->nkeys;
+	return amhdr->nattrs;
+}
+
+/*
+	makes the value of an open index from a record of its heap file, to be inserted or deleted
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * record - points to the record
+	int attrOffset - offset of the indexed attribute in the records, not used for an index of several attributes
+	char * value - points to where the value is written
+
+	*** return values ***
+	the length of the value if successful
+	AME_FD if the index is not open
+*/
+int AM_MakeValue(int AM_fd, char * record, int attrOffset, char * value){
+	if (AM_fd < 0 || AM_fd >= AM_itab_size || ait[AM_fd].valid == FALSE){
+		return AME_FD;
+	}
+	AM_makeValue(&(ait[AM_fd].hdr), record, attrOffset, value);
+	return ait[AM_fd].hdr.attrLength;
+}
+
+/*
+	tells if the specified B+ tree node is a leaf node
+
+	*** parameters ***
+	char * pbuf - pointer to a B+ tree node
+
+	*** return values ***
+	TRUE if specified B+ tree node is a leaf node
+	FALSE otherwise
+*/
+bool_t Btr_isLeaf(char * pbuf){
+	RECID res;
+	memcpy(&res, pbuf + sizeof(BtrHdr), sizeof(RECID));
+	if (res.recnum == NODE_NULLPTR){
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+	retrieves a B+ tree node for reading only, as Btr_getNode() does
+	the internal nodes, up to BTR_CACHENODES of them, are copied once and then read from memory without going
+	through the buffer pool, which is too small to keep them pinned; so a descent from the root only asks the
+	buffer pool for its leaf. leaves are returned pinned. the node must be given back with Btr_releaseNode()
+
+	*** parameters ***
+	char ** pbuf - address of the pointer to the specified B+ tree node if successful
+	int AM_fd - file descriptor of the AM index table
+	RECID adr - pointer to the specified B+ tree node
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_readNode(char ** pbuf, int AM_fd, RECID adr){
+	AMitab_ele * aite = &(ait[AM_fd]);
+	char ** nodes;
+	char * copy;
+	int nnodes, err;
+
+	if ((adr.pagenum < aite->nnodes) && (aite->nodes[adr.pagenum] != NULL)){
+		*pbuf = aite->nodes[adr.pagenum];
+		return AME_OK;
+	}
+	if ((err = Btr_getNode(pbuf, AM_fd, adr)) != AME_OK){
+		return err;
+	}
+	if ((Btr_isLeaf(*pbuf) == TRUE) || (aite->ncached >= BTR_CACHENODES)){
+		return AME_OK;
+	}
+
+	/* making room for the page number, failing which the node is simply left pinned */
+	if (adr.pagenum >= aite->nnodes){
+		for (nnodes = (aite->nnodes == 0) ? BTR_CACHENODES : aite->nnodes; nnodes <= adr.pagenum; nnodes *= 2);
+		if ((nodes = (char **) realloc(aite->nodes, nnodes * sizeof(char *))) == NULL){
+			return AME_OK;
+		}
+		memset(nodes + aite->nnodes, 0, (nnodes - aite->nnodes) * sizeof(char *));
+		aite->nodes = nodes;
+		aite->nnodes = nnodes;
+	}
+	if ((copy = (char *) malloc(PAGE_SIZE)) == NULL){
+		return AME_OK;
+	}
+	memcpy(copy, *pbuf, PAGE_SIZE);
+	if (PF_UnpinPage(aite->pfd, adr.pagenum, FALSE) != PFE_OK){
+		free(copy);
+		printf("Btr_readNode failed: PF_UnpinPage\n");
+		return AME_PF;
+	}
+	aite->nodes[adr.pagenum] = copy;
+	aite->ncached++;
+	*pbuf = copy;
+	return AME_OK;
+}
+
+/*
+	gives back a B+ tree node retrieved by Btr_readNode(), unpinning it unless it was read from memory
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	RECID adr - pointer to the B+ tree node
+	char * pbuf - pointer Btr_readNode() returned for the node
+
+	*** return values ***
+	AME_OK if successful
+	AME_PF if the node could not be unpinned
+*/
+int Btr_releaseNode(int AM_fd, RECID adr, char * pbuf){
+	if ((adr.pagenum < ait[AM_fd].nnodes) && (ait[AM_fd].nodes[adr.pagenum] == pbuf)){
+		return AME_OK;
+	}
+	if (PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, FALSE) != PFE_OK){
+		return AME_PF;
+	}
+	return AME_OK;
+}
+
+/*
+	compares values, tell which one is bigger or smaller
+
+	*** parameters ***
+	char * a - points to a value to be compared
+	char * b - points to another value to be compared
+	char attrType - attribute type of a and b (must be the same)
+	int attrLength - attribute length of a and b (must be the same)
+
+	*** return values ***
+	BTR_LT(-1) if a < b
+	BTR_EQ(0) if a == b
+	BTR_GT(1) if a > b
+*/
+int Btr_valComp(char * a, char * b, char attrType, int attrLength){
+	Btr_comparator comp = Btr_getComp(attrType);
+
+	if (comp == NULL){
+		printf("Btr_valComp failed: invalid attrType\n");
+		return AME_INVALIDATTRTYPE;
+	}
+	return comp(a, b, attrLength);
+}
+
+/*
+	compares two values of an index, by all of their attributes
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * a - points to a value to be compared
+	char * b - points to another value to be compared
+
+	*** return values ***
+	BTR_LT(-1) if a < b
+	BTR_EQ(0) if a == b
+	BTR_GT(1) if a > b
+*/
+int Btr_compare(int AM_fd, char * a, char * b){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+
+	if (amhdr->nattrs <= 1){
+		return ait[AM_fd].comp(a, b, amhdr->attrLength);
+	}
+	return AM_compAttrs(amhdr, a, b, amhdr->nattrs);
+}
+
+/*
+	finds the position of a value among the keys of a B+ tree node by binary search
+	keys are compared in place; INT and REAL keys are compared without branching
+
+	*** parameters ***
+	char * pbuf - points to the B+ tree node
+	char nodeType - type of the node (root, internal, leaf)
+	int AM_fd - file descriptor of the AM index table
+	char * value - points to the value to look for
+	bool_t upper - TRUE if keys equal to the value are to be counted as smaller
+
+	*** return values ***
+	number of keys smaller than the value (not bigger than the value, if upper is TRUE)
+*/
+int Btr_search(char * pbuf, char nodeType, int AM_fd, char * value, bool_t upper){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int entlen = sizeof(RECID) + amhdr->keyLength;
+	char * key = pbuf + sizeof(BtrHdr) + sizeof(RECID);
+	int n = ((BtrHdr *) pbuf)->entries;
+	int base = 0;
+	int up = (upper == TRUE);
+	int half, res;
+
+	if (nodeType == NODE_LEAF){
+		key += sizeof(RECID);
+	}
+	if (n <= 0){
+		return 0;
+	}
+
+	/* 'base' moves up to the last key known to be smaller, halving the range each time */
+	if (amhdr->nattrs > 1){
+		while (n > 1){
+			half = n / 2;
+			res = Btr_compare(AM_fd, key + (base + half) * entlen, value);
+			base += ((res < 0) || ((res == 0) && up)) * half;
+			n -= half;
+		}
+		res = Btr_compare(AM_fd, key + base * entlen, value);
+		return base + ((res < 0) || ((res == 0) && up));
+	} else if (amhdr->attrType == INT_TYPE){
+		int v, k;
+		memcpy(&v, value, sizeof(int));
+		while (n > 1){
+			half = n / 2;
+			memcpy(&k, key + (base + half) * entlen, sizeof(int));
+			base += ((k < v) | (up & (k == v))) * half;
+			n -= half;
+		}
+		memcpy(&k, key + base * entlen, sizeof(int));
+		return base + ((k < v) | (up & (k == v)));
+	} else if (amhdr->attrType == REAL_TYPE){
+		float v, k;
+		memcpy(&v, value, sizeof(float));
+		while (n > 1){
+			half = n / 2;
+			memcpy(&k, key + (base + half) * entlen, sizeof(float));
+			base += ((k < v) | (up & (k == v))) * half;
+			n -= half;
+		}
+		memcpy(&k, key + base * entlen, sizeof(float));
+		return base + ((k < v) | (up & (k == v)));
+	}
+
+	while (n > 1){
+		half = n / 2;
+		res = strncmp(key + (base + half) * entlen, value, amhdr->attrLength);
+		if ((res < 0) || ((res == 0) && up)){
+			base += half;
+		}
+		n -= half;
+	}
+	res = strncmp(key + base * entlen, value, amhdr->attrLength);
+	return base + ((res < 0) || ((res == 0) && up));
+}
+
+/*
+	makes the separator of two neighboring leaf nodes from the first value of the right one
+	a string is cut right after its first character that differs from the last value of the left one,
+	so that it is still bigger than every value on the left, and no bigger than any on the right
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * left - points to the last value of the left node
+	char * right - points to the first value of the right node
+	char * sep - points to where the separator is written, which may be 'left' or 'right'
+
+	*** return values ***
+	none
+*/
+void Btr_separator(int AM_fd, char * left, char * right, char * sep){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int i;
+
+	if ((amhdr->attrType != STRING_TYPE) || (amhdr->nattrs > 1)){
+		memmove(sep, right, amhdr->attrLength);
+		return;
+	}
+	for (i = 0; (i < amhdr->attrLength - 1) && (left[i] == right[i]) && (right[i] != '\0'); i++);
+	memmove(sep, right, i + 1);
+	memset(sep + i + 1, 0, amhdr->attrLength - i - 1);
+}
+
+/* moves the positions of the scans in a leaf node along with its entries, defined with the deletion */
+void Btr_leafMoveScans(int AM_fd, int pagenum, int from, int to, int newPage, int shift);
+
+/*
+	performs split at specified node if necessary
+	recursively called, copying values upward
+	the parent of a node is taken from the path Btr_recInsert() went down by, so nodes keep no pointer to their parents
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * value - points to the value to be inserted in the specified node
+	RECID recId - record id of the value to be inserted
+	RECID adr -	pointer to the B+ tree node to split when needed
+	int level - position of the node's parent in the path of the AM index table, -1 if the node is the root
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_recSplit(int AM_fd, char * value, RECID recId, RECID adr, int level){
+
+	int err;
+	int entries;
+	int res;
+	int i;
+	char * pbuf;
+	RECID parent;
+	RECID tempRid_new;
+	RECID tempRid_nbr;
+	RECID tempRid;
+	RECID rid_empty;
+	char * tempValue = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
+	char * tempValue_par = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
+
+	char * tempValue2 = (char *)calloc(sizeof(RECID) + ait[AM_fd].hdr.attrLength, sizeof(char));
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	BtrHdr * bhdr;
+	BtrHdr * bhdr_new;
+
+	char * value_empty = (char *)calloc(amhdr->attrLength, sizeof(char));
+	int mid; /* values GE to this are moved to the new node */
+	int new; /* idx where the new value is supposed to be at */
+	int newNode; /* pagenum of the newly assigned node */
+	int newRoot; /* pagenum of the new root node, if newly assigned */
+
+	char * pbuf_new; /* points to the created node */
+	char * pbuf_nbr; /* points to the newly created neighboring node (on the right) */
+
+	printf("Btr_recSplit at pagenum %d, recnum %d, value %s\n", adr.pagenum, adr.recnum, value);
+	/* the parent, and maybe the nodes above, gain a key */
+	Btr_dropNodes(AM_fd);
+	/* retrieving node information */
+	if ((err = Btr_getNode(&pbuf, AM_fd, adr)) != AME_OK){
+		printf("Btr_recSplit failed: Btr_getNode\n");
+		return err;
+	}
+
+	/* retrieving number of entries, but we already know it is FULL at leaf nodes */
+	bhdr = (BtrHdr *) pbuf;
+	entries = bhdr->entries;
+
+	printf("Btr_recSplit: currently contains %d entries\n", entries);
+
+	/* at leaf node */
+	if (Btr_isLeaf(pbuf) == TRUE){
+		/* Things to do:
+			determine to which node the inserted key belongs - left or new
+			determine mid key
+			assign new node
+				move keys - including the mid key
+				remove moved keys from the left node
+				adjust links
+					links between leaf nodes
+					parent to leaf - through copying up the key
+			copy up the key
+				at internal nodes, 'recId' becomes new nodes' link?
+		*/
+
+		/* checking whether this leaf node is full */
+		if (entries != amhdr->maxKeys){
+			printf("Btr_recSplit failed: entries %d, amhdr->maxKeys %d?\n", entries, amhdr->maxKeys);
+			return AME_PF;
+		}
+
+		/* determine where 'mid' is */
+		mid = amhdr->maxKeys / 2; /* if maxKeys = 4 or 5 then mid = 2 */
+
+		/* parent of the current node, on the path down to it */
+		if (level < 0){
+			printf("Btr_recSplit failed: no parent of a leaf node on the path\n");
+			return AME_PF;
+		}
+		parent.pagenum = ait[AM_fd].path[level];
+		parent.recnum = NODE_INTNULL;
+
+		/* determine where the new key is supposed to be at */
+		if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, mid, amhdr->maxKeys, tempValue)) != AME_OK){
+			printf("Btr_recSplit failed: retrieving the middle key of an leaf node\n");
+			return err;
+		}
+		new = Btr_compare(AM_fd, value, tempValue);
+
+		/* assign a new node */
+		if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_LEAF, amhdr->keyLength, amhdr->maxKeys, &newNode, &pbuf_new)) != AME_OK){
+			printf("Btr_recSplit failed: assigning a new leaf node\n");
+			return err;
+		}
+		bhdr_new = (BtrHdr *)pbuf_new;
+
+		/* adjust links between leaf nodes */
+		/* right neighbor of the current leaf node */
+
+		adr.recnum = NODE_NULLPTR;
+		if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->keyLength, LEAFIDX_PREV, amhdr->maxKeys, &adr)) != AME_OK){
+			printf("Btr_recSplit failed: setting PREV ptr of new node\n");
+			return err;
+		}
+
+		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
+			printf("Btr_recSplit failed: retrieving NEXT ptr of a leaf node\n");
+			return err;
+		}
+
+		if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
+			printf("Btr_recSplit failed: setting NEXT ptr of new node\n");
+			return err;
+		}
+
+		tempRid_new.pagenum = newNode;
+		tempRid_new.recnum = NODE_NULLPTR;
+
+		if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_new)) != AME_OK){
+			printf("Btr_recSplit failed: setting NEXT ptr of new leaf node\n");
+			return err;
+		}
+
+		if (tempRid_nbr.pagenum != NODE_NULLPTR){
+			if ((err = Btr_getNode(&pbuf_nbr, AM_fd, tempRid_nbr)) != AME_OK){
+				printf("Btr_recSplit failed: Btr_getNode for neighboring leaf node\n");
+				return err;
+			}
+
+			if ((err = Btr_setPtr(&pbuf_nbr, NODE_LEAF, amhdr->keyLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_new)) != AME_OK){
+				printf("Btr_recSplit failed: setting PREV ptr of neighboring leaf node\n");
+				return err;
+			}
+		}
+
+		/* moving keys, removing moved keys from the original node */
+		rid_empty.pagenum = NODE_NULLPTR;
+		rid_empty.recnum = NODE_NULLPTR;
+		for (i = mid; i < entries; i++){
+			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
+				printf("Btr_recSplit failed: retrieving %d th ptr of current leaf node\n", i);
+				return err;
+			}
+			if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
+				printf("Btr_recSplit failed: retrieving %d th value of current leaf node\n", i);
+				return err;
+			}
+			if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->keyLength, i-mid, amhdr->maxKeys, &tempRid)) != AME_OK){
+				printf("Btr_recSplit failed: writing %d th ptr of current leaf node to new one\n", i);
+				return err;
+			}
+			if ((err = Btr_setKey(&pbuf_new, NODE_LEAF, amhdr->keyLength, i-mid, amhdr->maxKeys, tempValue)) != AME_OK){
+				printf("Btr_recSplit failed: writing %d th value of current leaf node to new one\n", i);
+				return err;
+			}
+
+			if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, &rid_empty)) != AME_OK){
+				printf("Btr_recSplit failed: emptying %d th ptr of current leaf node\n", i);
+				return err;
+			}
+			if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, value_empty)) != AME_OK){
+				printf("Btr_recSplit failed: emptying %d th value of current leaf node\n", i);
+				return err;
+			}
+			bhdr->entries--;
+			bhdr_new->entries++;
+		}
+		/* the scans on the entries moved follow them to the new node */
+		Btr_leafMoveScans(AM_fd, adr.pagenum, mid, amhdr->maxKeys, newNode, -mid);
+		if (tempRid_nbr.pagenum != NODE_NULLPTR){
+			if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
+				printf("Btr_recSplit failed: PF_UnpinPage of NEXT neighbor\n");
+				return err;
+			}
+		}
+		if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+			printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
+			return err;
+		}
+		/* inserting the new value into one of the nodes */
+		if (new == BTR_LT){
+			if ((err = Btr_recInsert(AM_fd, value, recId, adr)) != AME_OK){
+				printf("Btr_recSplit failed: inserting new value in current leaf node\n");
+				return err;
+			}
+		} else {
+			if ((err = Btr_recInsert(AM_fd, value, recId, tempRid_new)) != AME_OK){
+				printf("Btr_recSplit failed: inserting new value in new leaf node\n");
+				return err;
+			}
+		}
+		amhdr->numNodes++;
+		ait[AM_fd].hdrchanged = TRUE;
+
+		/* copying up the mid value, with new node's ptr, cut short of the last value left of it */
+		tempRid_new.recnum = NODE_INTNULL;
+		if ((err = Btr_getKey(&pbuf_new, NODE_LEAF, amhdr->keyLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
+			printf("Btr_recSplit failed: retrieving mid value of current leaf node\n");
+			return err;
+		}
+		if ((err = Btr_getNode(&pbuf, AM_fd, adr)) != AME_OK){
+			printf("Btr_recSplit failed: Btr_getNode of adr\n");
+			return err;
+		}
+		memset(tempValue_par, 0, amhdr->attrLength);
+		if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, ((BtrHdr *) pbuf)->entries - 1, amhdr->maxKeys, tempValue_par)) != AME_OK){
+			printf("Btr_recSplit failed: retrieving last value of current leaf node\n");
+			return err;
+		}
+		if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, FALSE)) != PFE_OK){
+			printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
+			return err;
+		}
+		Btr_separator(AM_fd, tempValue_par, tempValue, tempValue);
+		if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
+			printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
+			return err;
+		}
+		if ((err = Btr_recSplit(AM_fd, tempValue, tempRid_new, parent, level - 1)) != AME_OK){
+			printf("Btr_recSplit failed: copying up the mid key value to parent from leaf\n");
+			return err;
+		}
+		printf("Btr_recSplit: value successfully copied up from a leaf node\n");
+		return AME_OK;
+
+	} /* at internal node */
+	else {
+
+		/* internal node not full */
+		if (entries < amhdr->maxKeys){
+			/* insert the key and ptr at an appropriate position */
+			/* inserting the new value into one of the nodes */
+			printf("Btr_recSplit: internal node not full\n");
+			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+				printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
+				return err;
+			}
+			adr.recnum = NODE_INTNULL;
+			if ((err = Btr_recInsert(AM_fd, value, recId, adr)) != AME_OK){
+				printf("Btr_recSplit failed: inserting new value in current internal node(without splitting)\n");
+				return err;
+			}
+			printf("Btr_recSplit: internal node not full. entry added\n");
+			return AME_OK;
+		} /* internal node full, split again */
+		else {
+
+			/* checking whether this internal node is full */
+			if (entries != amhdr->maxKeys){
+				printf("Btr_recSplit failed(internal node): entries %d, amhdr->maxKeys %d?\n", entries, amhdr->maxKeys);
+				return AME_PF;
+			}
 
-							if (tempRid_nbr.pagenum != NODE_NULLPTR){
-								if ((err = Btr_getNode(&pbuf_nbr, AM_fd, tempRid_nbr)) != AME_OK){
-									printf("Btr_recSplit failed: Btr_getNode for neighboring leaf node\n");
-									return err;
-								}
+			/* determine where 'mid' is */
+			mid = amhdr->maxKeys / 2; /* if maxKeys = 4 or 5 then mid = 2 */
+
+			/* parent of the current node, on the path down to it */
+			parent.pagenum = (level < 0) ? NODE_NULLPTR : ait[AM_fd].path[level];
+			parent.recnum = NODE_INTNULL;
+
+			/* the key left of 'mid' separates the two nodes, and is moved up */
+			if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->keyLength, mid-1, amhdr->maxKeys, tempValue_par)) != AME_OK){
+				printf("Btr_recSplit failed: retrieving the middle key of an internal node\n");
+				return err;
+			}
+			/* determine where the new key is supposed to be at */
+			new = Btr_compare(AM_fd, value, tempValue_par);
+
+			/* assign a new node */
+			if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_INT, amhdr->keyLength, amhdr->maxKeys, &newNode, &pbuf_new)) != AME_OK){
+				printf("Btr_recSplit failed: assigning a new internal node\n");
+				return err;
+			}
+			bhdr_new = (BtrHdr *)pbuf_new;
+			tempRid_new.pagenum = newNode;
+			tempRid_new.recnum = NODE_INTNULL;
+
+			/* no direct link between internal nodes of the same height */
+			adr.recnum = NODE_INTNULL;
+
+
+			/* moving keys, removing moved keys from the original node */
+			rid_empty.pagenum = NODE_NULLPTR;
+			rid_empty.recnum = NODE_NULLPTR;
+			for (i = mid; i < entries; i++){
+				if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, i+1, amhdr->maxKeys, &tempRid)) != AME_OK){
+					printf("Btr_recSplit failed: retrieving %d th ptr of current internal node\n", i+1);
+					return err;
+				}
+				if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
+					printf("Btr_recSplit failed: retrieving %d th value of current internal node\n", i);
+					return err;
+				}
+				if ((err = Btr_setPtr(&pbuf_new, NODE_INT, amhdr->keyLength, (i-mid+1), amhdr->maxKeys, &tempRid)) != AME_OK){
+					printf("Btr_recSplit failed: writing %d th ptr of current internal node to new one\n", i+1);
+					return err;
+				}
+				if ((err = Btr_setKey(&pbuf_new, NODE_INT, amhdr->keyLength, i-mid, amhdr->maxKeys, tempValue)) != AME_OK){
+					printf("Btr_recSplit failed: writing %d th value of current internal node to new one\n", i);
+					return err;
+				}
+
+				if ((err = Btr_setPtr(&pbuf, NODE_INT, amhdr->keyLength, i+1, amhdr->maxKeys, &rid_empty)) != AME_OK){
+					printf("Btr_recSplit failed: emptying %d th ptr of current internal node\n", i+1);
+					return err;
+				}
+				if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, value_empty)) != AME_OK){
+					printf("Btr_recSplit failed: emptying %d th value of current internal node\n", i);
+					return err;
+				}
+				bhdr->entries--;
+				bhdr_new->entries++;
+			}
+			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, mid, amhdr->maxKeys, &tempRid)) != AME_OK){
+				printf("Btr_recSplit failed: retrieving %d th ptr of current internal node\n", mid);
+				return err;
+			}
+			if ((err = Btr_setPtr(&pbuf_new, NODE_INT, amhdr->keyLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
+				printf("Btr_recSplit failed: writing %d th ptr of current internal node to new one\n", 0);
+				return err;
+			}
+			/* will not work if mid = 0(amhdr->maxKeys = 1)... */
+			/* the separating key is kept in 'tempValue_par' */
+			if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->keyLength, mid-1, amhdr->maxKeys, value_empty)) != AME_OK){
+				printf("Btr_recSplit failed: emptying %d th value of current internal node\n", mid-1);
+				return err;
+			}
+			bhdr->entries--;
+			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+				printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
+				return err;
+			}
+			/* inserting the new value into one of the nodes */
+			if (new == BTR_LT){
+				adr.recnum = NODE_INTNULL;
+				if ((err = Btr_recInsert(AM_fd, value, recId, adr)) != AME_OK){
+					printf("Btr_recSplit failed: inserting new value in current internal node\n");
+					return err;
+				}
+			} else {
+				if ((err = Btr_recInsert(AM_fd, value, recId, tempRid_new)) != AME_OK){
+					printf("Btr_recSplit failed: inserting new value in new internal node\n");
+					return err;
+				}
+			}
+			amhdr->numNodes++;
+			ait[AM_fd].hdrchanged = TRUE;
+
+			/* if there is no parent node (current node is root), create new root holding the separating key */
+			if (parent.pagenum == NODE_NULLPTR){
+				printf("root node full, assigning a new root\n");
+				if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_INT, amhdr->keyLength, amhdr->maxKeys, &newRoot, &pbuf_nbr)) != AME_OK){
+					printf("Btr_recSplit failed(internal): assigning a new root node\n");
+					return err;
+				}
+				/* updating the pointers from the root to the child nodes */
+				adr.recnum = NODE_INTNULL;
+				if ((err = Btr_setPtr(&pbuf_nbr, NODE_ROOT, amhdr->keyLength, 0, amhdr->maxKeys, &adr)) != AME_OK){
+					printf("Btr_recSplit failed: setting the left child of a new root node\n");
+					return err;
+				}
+				if ((err = Btr_setKey(&pbuf_nbr, NODE_ROOT, amhdr->keyLength, 0, amhdr->maxKeys, tempValue_par)) != AME_OK){
+					printf("Btr_recSplit failed: setting the key of a new root node\n");
+					return err;
+				}
+				if ((err = Btr_setPtr(&pbuf_nbr, NODE_ROOT, amhdr->keyLength, 1, amhdr->maxKeys, &tempRid_new)) != AME_OK){
+					printf("Btr_recSplit failed: setting the right child of a new root node\n");
+					return err;
+				}
+				((BtrHdr *) pbuf_nbr)->entries = 1;
+
+				/* updating the pointer to the new root node */
+				amhdr->root.pagenum = newRoot;
+				amhdr->numNodes++;
+				ait[AM_fd].hdrchanged = TRUE;
+				if ((err = PF_UnpinPage(ait[AM_fd].pfd, newRoot, TRUE)) != PFE_OK){
+					printf("Btr_recSplit failed: PF_UnpinPage of new root node\n");
+					return err;
+				}
+				if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
+					printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
+					return err;
+				}
+				printf("root node full, assigning a new root: ended\n");
+				return AME_OK;
+			}
+
+			/* copying up the separating key, with new node's ptr */
+			if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
+				printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
+				return err;
+			}
+			if ((err = Btr_recSplit(AM_fd, tempValue_par, tempRid_new, parent, level - 1)) != AME_OK){
+				printf("Btr_recSplit failed: copying up the mid key value to parent from an internal node\n");
+				return err;
+			}
+			return AME_OK;
+
+		}
+		printf("Btr_recSplit failed: not supposed to reach here?\n");
+		return AME_PF;
+	}
+	printf("Btr_recSplit failed: not supposed to reach here?\n");
+	return AME_PF;
+}
+
+/*
+	compares two record ids, by their page numbers, then by their slot numbers
+
+	*** parameters ***
+	RECID * a - points to a record id
+	RECID * b - points to another record id
+
+	*** return values ***
+	BTR_LT, BTR_EQ or BTR_GT as the record id at a is smaller than, equal to or bigger than the one at b
+*/
+int Btr_ridComp(RECID * a, RECID * b){
+	if (a->pagenum != b->pagenum){
+		return (a->pagenum > b->pagenum) - (a->pagenum < b->pagenum);
+	}
+	return (a->recnum > b->recnum) - (a->recnum < b->recnum);
+}
+
+/*
+	finds where a record id is or would be in a posting list page, by binary search
+
+	*** parameters ***
+	char * page - points to the posting list page
+	RECID * recId - points to the record id
+
+	*** return values ***
+	index of the first record id of the page not smaller than the given one, or the number of record ids
+*/
+int Btr_postSearch(char * page, RECID * recId){
+	RECID * rids = (RECID *) (page + sizeof(BtrPostHdr));
+	int lo = 0;
+	int hi = ((BtrPostHdr *) page)->entries;
+	int mid;
+
+	while (lo < hi){
+		mid = (lo + hi) / 2;
+		if (Btr_ridComp(&rids[mid], recId) == BTR_LT){
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/*
+	moves the positions of the scans in a posting list page along with the record ids moved
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	int pagenum - page number of the posting list page
+	int from - index of the first record id moved, -1 for all the scans in the page
+	int newPage - page number the record ids are moved to, NODE_NULLPTR if they are gone
+	int shift - number added to the indexes of the record ids moved
+
+	*** return values ***
+	void
+*/
+void Btr_postMoveScans(int AM_fd, int pagenum, int from, int newPage, int shift){
+	int j;
+
+	for (j = 0; j < AM_stab_size; j++){
+		if ((ast[j].valid == TRUE) && (ast[j].fd == AM_fd) && (ast[j].post.pagenum == pagenum) && (ast[j].post.recnum >= from)){
+			ast[j].post.pagenum = newPage;
+			ast[j].post.recnum += shift;
+		}
+	}
+}
+
+/*
+	inserts a record id in a posting list, in order
+	a full page is split, half of its record ids going to a new page linked after it
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	int head - page number of the first page of the posting list
+	RECID recId - record id to be inserted
+
+	*** return values ***
+	AME_OK if successful
+	AME_DUPLICATERECID if the record id is already in the list
+	error codes (< 0) if a problem occurred
+*/
+int Btr_postInsert(int AM_fd, int head, RECID recId){
+	int pfd = ait[AM_fd].pfd;
+	int pagenum = head;
+	int newPage, next, half, i;
+	char * page;
+	char * page_new;
+	BtrPostHdr * phdr;
+	BtrPostHdr * phdr_new;
+	RECID * rids;
+
+	/* the page to take the record id: the first one whose last record id is not smaller */
+	while (1){
+		if (PF_GetThisPage(pfd, pagenum, &page) != PFE_OK){
+			printf("Btr_postInsert failed: PF_GetThisPage\n");
+			return AME_PF;
+		}
+		phdr = (BtrPostHdr *) page;
+		rids = (RECID *) (page + sizeof(BtrPostHdr));
+		if ((phdr->next == NODE_NULLPTR) || (Btr_ridComp(&recId, &rids[phdr->entries - 1]) != BTR_GT)){
+			break;
+		}
+		next = phdr->next;
+		if (PF_UnpinPage(pfd, pagenum, FALSE) != PFE_OK){
+			return AME_PF;
+		}
+		pagenum = next;
+	}
+
+	i = Btr_postSearch(page, &recId);
+	if ((i < phdr->entries) && (Btr_ridComp(&rids[i], &recId) == BTR_EQ)){
+		PF_UnpinPage(pfd, pagenum, FALSE);
+		return AME_DUPLICATERECID;
+	}
+
+	if (phdr->entries == BTR_POSTKEYS){
+		if (PF_AllocPage(pfd, &newPage, &page_new) != PFE_OK){
+			printf("Btr_postInsert failed: PF_AllocPage\n");
+			PF_UnpinPage(pfd, pagenum, FALSE);
+			return AME_PF;
+		}
+		half = phdr->entries / 2;
+		phdr_new = (BtrPostHdr *) page_new;
+		phdr_new->entries = phdr->entries - half;
+		phdr_new->next = phdr->next;
+		memcpy(page_new + sizeof(BtrPostHdr), &rids[half], phdr_new->entries * sizeof(RECID));
+		phdr->entries = half;
+		phdr->next = newPage;
+		Btr_postMoveScans(AM_fd, pagenum, half, newPage, -half);
+
+		/* the record id goes to the half it belongs to */
+		if (i > half){
+			if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK){
+				return AME_PF;
+			}
+			pagenum = newPage;
+			page = page_new;
+			phdr = phdr_new;
+			rids = (RECID *) (page + sizeof(BtrPostHdr));
+			i -= half;
+		} else if (PF_UnpinPage(pfd, newPage, TRUE) != PFE_OK){
+			return AME_PF;
+		}
+	}
+
+	memmove(&rids[i + 1], &rids[i], (phdr->entries - i) * sizeof(RECID));
+	rids[i] = recId;
+	phdr->entries++;
+	Btr_postMoveScans(AM_fd, pagenum, i, pagenum, 1);
+	return PF_UnpinPage(pfd, pagenum, TRUE) == PFE_OK ? AME_OK : AME_PF;
+}
+
+/*
+	adds a record id to a key of a leaf node, the key's record ids being kept in a posting list
+	a key with a single record id keeps it in the node, and its posting list is started with the second one
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * pbuf - points to the pinned leaf node
+	int idx - index of the key in the leaf node
+	RECID recId - record id to be added
+
+	*** return values ***
+	AME_OK if successful
+	AME_DUPLICATERECID if the key already has the record id
+	error codes (< 0) if a problem occurred
+*/
+int Btr_postAdd(int AM_fd, char * pbuf, int idx, RECID recId){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	BtrPostHdr * phdr;
+	RECID * rids;
+	RECID rid;
+	char * page;
+	int pagenum, err;
+
+	if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, idx, amhdr->maxKeys, &rid)) != AME_OK){
+		return err;
+	}
+
+	if (rid.recnum != NODE_POSTING){
+		if (Btr_ridComp(&rid, &recId) == BTR_EQ){
+			printf("Btr_postAdd failed: duplicate value with duplicate record ID\n");
+			return AME_DUPLICATERECID;
+		}
+		if (PF_AllocPage(ait[AM_fd].pfd, &pagenum, &page) != PFE_OK){
+			printf("Btr_postAdd failed: PF_AllocPage\n");
+			return AME_PF;
+		}
+		phdr = (BtrPostHdr *) page;
+		rids = (RECID *) (page + sizeof(BtrPostHdr));
+		phdr->entries = 2;
+		phdr->next = NODE_NULLPTR;
+		rids[0] = (Btr_ridComp(&rid, &recId) == BTR_LT) ? rid : recId;
+		rids[1] = (Btr_ridComp(&rid, &recId) == BTR_LT) ? recId : rid;
+		if (PF_UnpinPage(ait[AM_fd].pfd, pagenum, TRUE) != PFE_OK){
+			return AME_PF;
+		}
+
+		rid.pagenum = pagenum;
+		rid.recnum = NODE_POSTING;
+		if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, idx, amhdr->maxKeys, &rid)) != AME_OK){
+			return err;
+		}
+	} else if ((err = Btr_postInsert(AM_fd, rid.pagenum, recId)) != AME_OK){
+		return err;
+	}
+
+	amhdr->numRecs++;
+	ait[AM_fd].hdrchanged = TRUE;
+	return AME_OK;
+}
+
+/*
+	removes a record id from a posting list
+	a page left empty is taken out of the list and disposed of;
+	the first page takes the record ids of the second one instead, as the leaf node points to it
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	int head - page number of the first page of the posting list
+	RECID recId - record id to be removed
+
+	*** return values ***
+	AME_OK if successful
+	AME_EOF if the list was left empty, its last page being disposed of
+	AME_RECNOTFOUND if the record id is not in the list
+	error codes (< 0) if a problem occurred
+*/
+int Btr_postRemove(int AM_fd, int head, RECID recId){
+	int pfd = ait[AM_fd].pfd;
+	int pagenum = head;
+	int prev = NODE_NULLPTR;
+	int next, i, err;
+	char * page;
+	char * page_nbr;
+	BtrPostHdr * phdr;
+	RECID * rids;
+
+	while (1){
+		if (PF_GetThisPage(pfd, pagenum, &page) != PFE_OK){
+			printf("Btr_postRemove failed: PF_GetThisPage\n");
+			return AME_PF;
+		}
+		phdr = (BtrPostHdr *) page;
+		rids = (RECID *) (page + sizeof(BtrPostHdr));
+		i = Btr_postSearch(page, &recId);
+		if ((i < phdr->entries) || (phdr->next == NODE_NULLPTR)){
+			break;
+		}
+		next = phdr->next;
+		if (PF_UnpinPage(pfd, pagenum, FALSE) != PFE_OK){
+			return AME_PF;
+		}
+		prev = pagenum;
+		pagenum = next;
+	}
+	if ((i == phdr->entries) || (Btr_ridComp(&rids[i], &recId) != BTR_EQ)){
+		PF_UnpinPage(pfd, pagenum, FALSE);
+		return AME_RECNOTFOUND;
+	}
+
+	memmove(&rids[i], &rids[i + 1], (phdr->entries - i - 1) * sizeof(RECID));
+	phdr->entries--;
+	Btr_postMoveScans(AM_fd, pagenum, i, pagenum, -1);
+	if (phdr->entries > 0){
+		return PF_UnpinPage(pfd, pagenum, TRUE) == PFE_OK ? AME_OK : AME_PF;
+	}
+
+	next = phdr->next;
+	err = AME_OK;
+	if (prev != NODE_NULLPTR){
+		/* the empty page is unlinked, its scans going to the end of the page before it */
+		if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK || PF_GetThisPage(pfd, prev, &page_nbr) != PFE_OK){
+			return AME_PF;
+		}
+		((BtrPostHdr *) page_nbr)->next = next;
+		Btr_postMoveScans(AM_fd, pagenum, -1, prev, ((BtrPostHdr *) page_nbr)->entries);
+		if (PF_UnpinPage(pfd, prev, TRUE) != PFE_OK){
+			return AME_PF;
+		}
+	} else if (next != NODE_NULLPTR){
+		/* the first page takes over the second one */
+		if (PF_GetThisPage(pfd, next, &page_nbr) != PFE_OK){
+			PF_UnpinPage(pfd, pagenum, TRUE);
+			return AME_PF;
+		}
+		memcpy(page, page_nbr, sizeof(BtrPostHdr) + ((BtrPostHdr *) page_nbr)->entries * sizeof(RECID));
+		Btr_postMoveScans(AM_fd, next, -1, pagenum, 0);
+		if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK || PF_UnpinPage(pfd, next, FALSE) != PFE_OK){
+			return AME_PF;
+		}
+		pagenum = next;
+	} else {
+		/* the list is gone, and so are the scans' positions in it */
+		Btr_postMoveScans(AM_fd, pagenum, -1, NODE_NULLPTR, 0);
+		if (PF_UnpinPage(pfd, pagenum, TRUE) != PFE_OK){
+			return AME_PF;
+		}
+		err = AME_EOF;
+	}
+
+	/* a page the free page map cannot record is merely left unused */
+	if (((i = PF_DisposePage(pfd, pagenum)) != PFE_OK) && (i != PFE_FREEMAPFULL)){
+		return AME_PF;
+	}
+	return err;
+}
 
-								if ((err = Btr_setPtr(&pbuf_nbr, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid)) != AME_OK){
-									printf("Btr_recSplit failed: setting NEXT ptr of neighboring leaf node\n");
-									return err;
-								}
-							}
+/*
+	finds the record id next to a scan's position in a posting list
 
-							/* reinsert the key and ptr to this node */
-							adr.recnum = NODE_INTNULL;
-							if ((err = Btr_recInsert(AM_fd, value, adr, parent)) != AME_OK){
-								printf("Btr_recSplit failed: Btr_recInsert, inserting new empty node \n");
-								return err;
-							}
-						} else {
-							/* leave the other entries, just replace the key */
-							if ((err = Btr_setKey(&pbuf_par, NODE_INT, amhdr->attrLength, j-1, amhdr->maxKeys, value)) != AME_OK){
-								printf("Btr_recSplit failed: replacing the parent node's key for duplicate node\n");
-								return err;
-							}
-						}
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, parent.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recSplit failed: PF_UnpinPage of parent\n");
-							return err;
-						}
-						if (tempRid_nbr.pagenum != NODE_NULLPTR){
-							if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
-								printf("Btr_recSplit failed: PF_UnpinPage of PREV neighbor\n");
-								return err;
-							}
-						}
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
-							return err;
-						}
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recSplit failed: PF_UnpinPage of newnode 2\n");
-							return err;
-						}
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
-							return err;
-						}
-						return AME_OK;
-					} else {
-						continue;
-					}
-				}
+	*** parameters ***
+	int fd - file descriptor for the AM index table
+	RECID * post - position in the posting list: page number and index of the last record id found,
+		the index being -1 at the start of a page; set to NODE_NULLPTR at the end of the list
 
-				printf("Btr_recSplit failed: rid for the current node not found on the parent node?\n");
-				return AME_PF;
+	*** return values ***
+	the next record id if there is one
+	RECID containing NODE_NULLPTR(-1) at the end of the list or if a problem occurred
+*/
+RECID Btr_postNext(int fd, RECID * post){
+	RECID res;
+	char * page;
+	int i = post->recnum + 1;
+	int next;
 
+	res.pagenum = NODE_NULLPTR;
+	res.recnum = NODE_NULLPTR;
+	while (post->pagenum != NODE_NULLPTR){
+		if (PF_GetThisPage(ait[fd].pfd, post->pagenum, &page) != PFE_OK){
+			printf("Btr_postNext failed: PF_GetThisPage\n");
+			break;
+		}
+		if (i < ((BtrPostHdr *) page)->entries){
+			memcpy(&res, page + sizeof(BtrPostHdr) + i * sizeof(RECID), sizeof(RECID));
+			PF_UnpinPage(ait[fd].pfd, post->pagenum, FALSE);
+			post->recnum = i;
+			return res;
+		}
+		next = ((BtrPostHdr *) page)->next;
+		PF_UnpinPage(ait[fd].pfd, post->pagenum, FALSE);
+		post->pagenum = next;
+		i = 0;
+	}
+	post->pagenum = NODE_NULLPTR;
+	return res;
+}
 
-			} /* duplicate value at the rightmost position */
-			else if (i == entries - 1){
-				/* move values - just the last value */
-				if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving %d th ptr of current leaf node\n", i);
-					return err;
-				}
-				if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving %d th value of current leaf node\n", i);
-					return err;
-				}
-				if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th ptr of current leaf node to new one\n", 0);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th value of current leaf node to new one\n", 0);
-					return err;
-				}
+/*
+	records an internal node on the path an insertion or deletion goes down by,
+	for Btr_recSplit() and Btr_rebalance() to find the parents of the nodes they change
 
-				if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &rid_empty)) != AME_OK){
-					printf("Btr_recSplit failed: emptying %d th ptr of current leaf node\n", i);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, value_empty)) != AME_OK){
-					printf("Btr_recSplit failed: emptying %d th value of current leaf node\n", i);
-					return err;
-				}
-				bhdr->entries--;
-				bhdr_new->entries++;
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	RECID adr - pointer to the internal node
 
-				/* add duplicate value to the new node , set duplicate attribute to TRUE*/
-				if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, 1, amhdr->maxKeys, &recId)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th ptr of duplicate value at a new leaf node\n", 1);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, 1, amhdr->maxKeys, value)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th value of duplicate value at a new leaf node\n", 1);
-					return err;
-				}
-				bhdr_new->duplicate = TRUE;
-				bhdr_new->entries++;
-				amhdr->numRecs++;
-				ait[AM_fd].hdrchanged = TRUE;
+	*** return values ***
+	AME_OK if successful
+	AME_PF if the path is longer than BTR_MAXHEIGHT
+*/
+int Btr_pushPath(int AM_fd, RECID adr){
+	if (ait[AM_fd].depth >= BTR_MAXHEIGHT){
+		printf("Btr_pushPath failed: B+ tree higher than %d\n", BTR_MAXHEIGHT);
+		return AME_PF;
+	}
+	ait[AM_fd].path[ait[AM_fd].depth++] = adr.pagenum;
+	return AME_OK;
+}
 
-				/* copy up the new value, with new node's ptr */
-				tempRid_new.recnum = NODE_INTNULL;
-				if ((err = Btr_getKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving first value of new leaf node\n");
-					return err;
-				}
+/*
+	inserts the specified value in the B+ tree
+	recursively called
+	the internal nodes gone through are recorded in the path of the AM index table, which the caller empties at the root
 
-				if (tempRid_nbr.pagenum != NODE_NULLPTR){
-					if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
-						printf("Btr_recSplit failed: PF_UnpinPage of NEXT neighbor\n");
-						return err;
-					}
-				}
-				if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
-					return err;
-				}
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * value - points to the value to be inserted in B+ tree
+	RECID recId - record id of the value to be inserted
+	RECID adr -	pointer to the B+ tree node to start searching
 
-				if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
-					return err;
-				}
-				if ((err = Btr_recSplit(AM_fd, tempValue, tempRid_new, parent, FALSE)) != AME_OK){
-					printf("Btr_recSplit failed: copying up the new leaf node's first key value to parent from leaf\n");
-					return err;
-				}
-				return AME_OK;
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_recInsert(int AM_fd, char * value, RECID recId, RECID adr){
+	int err;
+	int entries;
+	int i, j;
+	char * pbuf;
+	RECID tempRid;
+	char * tempValue = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
+	char * tempValue_par = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
+	char * tempValue2 = (char *)calloc(sizeof(RECID) + ait[AM_fd].hdr.attrLength, sizeof(char));
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	BtrHdr * bhdr;
 
-			} /* otherwise: split twice */
-			else {
-				/* assign another node */
-				if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_LEAF, amhdr->attrLength, amhdr->maxKeys, &newNode2, &pbuf_new2, parent)) != AME_OK){
-					printf("Btr_recSplit failed: assigning a new leaf node\n");
-					return err;
-				}
-				bhdr_new2 = (BtrHdr *)pbuf_new2;
-				amhdr->numNodes++;
-				ait[AM_fd].hdrchanged = TRUE;
+	/* retrieving node information */
+	if ((err = Btr_getNode(&pbuf, AM_fd, adr)) != AME_OK){
+		printf("Btr_recInsert failed: Btr_getNode\n");
+		return err;
+	}
 
-				if ((err = Btr_setPtr(&pbuf_new2, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-					printf("Btr_recSplit failed: setting PREV ptr of new node\n");
-					return err;
-				}
-				if (tempRid_nbr.pagenum != NODE_NULLPTR){
-					if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
-						printf("Btr_recSplit failed: PF_UnpinPage of NEXT neighbor\n");
-						return err;
-					}
-				}
-				if ((err = Btr_getPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving NEXT ptr of a leaf node\n");
-					return err;
-				}
+	printf("Btr_recInsert at page %d, with value %s\n", adr.pagenum, value);
 
-				if ((err = Btr_setPtr(&pbuf_new2, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-					printf("Btr_recSplit failed: setting NEXT ptr of new node\n");
-					return err;
-				}
+	/* retrieving number of entries */
+	bhdr = (BtrHdr *) pbuf;
+	entries = bhdr->entries;
 
-				tempRid_new2.pagenum = newNode2;
-				tempRid_new2.recnum = NODE_NULLPTR;
+	/* at leaf node */
+	if (Btr_isLeaf(pbuf) == TRUE){
+		if (entries > amhdr->maxKeys){
+			printf("Btr_recInsert failed: entries more than maxKeys??\n");
+			return AME_PF;
+		}
 
-				if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_new2)) != AME_OK){
-					printf("Btr_recSplit failed: setting NEXT ptr of new leaf node\n");
-					return err;
+		/* looking for a place to fit: the first key not smaller */
+		i = Btr_search(pbuf, NODE_LEAF, AM_fd, value, FALSE);
+		if (i < entries){
+			if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
+				printf("Btr_recInsert failed(looking for fitting place): retrieving %d th value of current leaf node\n", i);
+				return err;
+			}
+			/* a value equal to a key of the node joins the key's posting list, taking no room in the node */
+			if (Btr_compare(AM_fd, value, tempValue) == BTR_EQ){
+				err = Btr_postAdd(AM_fd, pbuf, i, recId);
+				if (PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE) != PFE_OK){
+					printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
+					return AME_PF;
 				}
+				return err;
+			}
+		}
 
-				if (tempRid_nbr.pagenum != NODE_NULLPTR){
-					if ((err = Btr_getNode(&pbuf_nbr, AM_fd, tempRid_nbr)) != AME_OK){
-						printf("Btr_recSplit failed: Btr_getNode for neighboring leaf node\n");
-						return err;
-					}
+		/* when the node is full with entries */
+		if (entries == amhdr->maxKeys){
+			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+				printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
+				return err;
+			}
 
-					if ((err = Btr_setPtr(&pbuf_nbr, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_new2)) != AME_OK){
-						printf("Btr_recSplit failed: setting PREV ptr of neighboring leaf node\n");
-						return err;
-					}
-				}
-				/* move values - values larger than duplicate one */
-				for (j = i+1; j < entries; j++){
-					if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recSplit failed: retrieving %d th ptr of current leaf node\n", j);
-						return err;
-					}
-					if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, tempValue)) != AME_OK){
-						printf("Btr_recSplit failed: retrieving %d th value of current leaf node\n", j);
-						return err;
-					}
-					if ((err = Btr_setPtr(&pbuf_new2, NODE_LEAF, amhdr->attrLength, j-(i+1), amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recSplit failed: writing %d th ptr of current leaf node to new one\n", j);
+			/* split, the leaf's parent being the last node on the path */
+			if ((err = Btr_recSplit(AM_fd, value, recId, adr, ait[AM_fd].depth - 1)) != AME_OK){
+				printf("Btr_recInsert failed: Btr_recSplit at node %d\n", adr.pagenum);
+				return err;
+			}
+			printf("Btr_recInsert: successfully split at a leaf node\n");
+			return AME_OK;
+		} else {
+			/* moving entries that are bigger than 'value' */
+			if (i < entries){
+				for (j = 0; j < entries - i; j++){
+					/*
+					   copy from (entries - (j+1)) th entry to (entries - j) th entry
+					   j = 0 to (entries - i - 1) : (entries - 1)th to (entries - 0), ..., i th to i+1 th
+					*/
+					if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, entries - (j+1), amhdr->maxKeys, &tempRid)) != AME_OK){
+						printf("Btr_recInsert failed: retrieving %d th ptr of current leaf node\n", entries - (j+1));
 						return err;
 					}
-					if ((err = Btr_setKey(&pbuf_new2, NODE_LEAF, amhdr->attrLength, j-(i+1), amhdr->maxKeys, tempValue)) != AME_OK){
-						printf("Btr_recSplit failed: writing %d th value of current leaf node to new one\n", j);
+					if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, entries - (j+1), amhdr->maxKeys, tempValue)) != AME_OK){
+						printf("Btr_recInsert failed: retrieving %d th value of current leaf node\n", entries - (j+1));
 						return err;
 					}
-
-					if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, &rid_empty)) != AME_OK){
-						printf("Btr_recSplit failed: emptying %d th ptr of current leaf node\n", j);
+					if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, entries - j, amhdr->maxKeys, &tempRid)) != AME_OK){
+						printf("Btr_recInsert failed: moving %d th ptr of current leaf node right\n", entries - (j+1));
 						return err;
 					}
-					if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, value_empty)) != AME_OK){
-						printf("Btr_recSplit failed: emptying %d th value of current leaf node\n", j);
+					if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->keyLength, entries - j, amhdr->maxKeys, tempValue)) != AME_OK){
+						printf("Btr_recInsert failed: moving %d th value of current leaf node right\n", entries - (j+1));
 						return err;
 					}
-					bhdr->entries--;
-					bhdr_new2->entries++;
-				}
-				/* move values - duplicate value into newly assigned node */
-				if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving %d th ptr of current leaf node\n", i);
-					return err;
-				}
-				if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving %d th value of current leaf node\n", i);
-					return err;
-				}
-				if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th ptr of current leaf node to new one\n", 0);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th value of current leaf node to new one\n", 0);
-					return err;
 				}
+			}
 
-				if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &rid_empty)) != AME_OK){
-					printf("Btr_recSplit failed: emptying %d th ptr of current leaf node\n", i);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, value_empty)) != AME_OK){
-					printf("Btr_recSplit failed: emptying %d th value of current leaf node\n", i);
-					return err;
-				}
-				bhdr->entries--;
-				bhdr_new->entries++;
+			/* inserting value, with determined 'i' value */
+			if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, &recId)) != AME_OK){
+				printf("Btr_recInsert failed: inserting new ptr at %d th entry\n", i);
+				return err;
+			}
+			if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, value)) != AME_OK){
+				printf("Btr_recInsert failed: inserting new key at %d th entry\n", i);
+				return err;
+			}
+			printf("Btr_recInsert: new value %s inserted at %d of pagenum %d\n", value, i, adr.pagenum);
+			/* the scans on the entries moved right stay on them */
+			Btr_leafMoveScans(AM_fd, adr.pagenum, i, amhdr->maxKeys, adr.pagenum, 1);
 
-				/* add duplicate value to the middle node , set duplicate attribute to TRUE*/
-				if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, 1, amhdr->maxKeys, &recId)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th ptr of current leaf node to new one\n", 1);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, 1, amhdr->maxKeys, value)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th value of current leaf node to new one\n", 1);
-					return err;
+			/* updating 'entries' of the leaf node and header's 'numRecs' */
+			entries++;
+			amhdr->numRecs++;
+			ait[AM_fd].hdrchanged = TRUE;
+			bhdr->entries = entries;
+
+			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+				printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
+				return err;
+			}
+			return AME_OK;
+		}
+	} /* at internal node */
+	else {
+		printf("Btr_recInsert: at internal\n");
+		if (entries > amhdr->maxKeys){
+			printf("Btr_recInsert failed: entries more than maxKeys(internal node)??\n");
+			return AME_PF;
+		} /* node is empty */
+		else if (entries == 0) {
+			/* fill the entry with this key, go to the right child */
+			Btr_dropNodes(AM_fd);
+
+			if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->keyLength, 0, amhdr->maxKeys, value)) != AME_OK){
+				printf("Btr_recInsert failed: filling in an empty node with a key\n");
+				return err;
+			}
+
+			entries++;
+			bhdr->entries = entries;
+
+			if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+				printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
+				return err;
+			}
+			if ((err = Btr_pushPath(AM_fd, adr)) != AME_OK){
+				return err;
+			}
+			/* receiving pointer information */
+			printf("Btr_recInsert: adr before: pagenum %d, recnum %d\n", adr.pagenum, adr.recnum);
+			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, 1, amhdr->maxKeys, &adr)) != AME_OK){
+				printf("Btr_recInsert failed: Btr_getPtr of right child at an empty internal node\n");
+				return err;
+			}
+			printf("Btr_recInsert: adr updated: pagenum %d, recnum %d\n", adr.pagenum, adr.recnum);
+
+			return Btr_recInsert(AM_fd, value, recId, adr);
+		} /* node is not empty, find the way */
+		else {
+			/* looking for a place to fit: the first key bigger than the value */
+			/* duplicate keys? - no need to worry, problems are dealt with at the leaf node level */
+			i = Btr_search(pbuf, NODE_INT, AM_fd, value, TRUE);
+
+			/* checking whether the inserted value is from actual record or a key for internal nodes */
+			if (recId.recnum == NODE_NULLPTR){
+				printf("Btr_recInsert failed: recId.recnum < 0 and recnum == NODE_NULLPTR?\n");
+				return AME_PF;
+			}
+			if (recId.recnum == NODE_INTNULL){
+				printf("Btr_recInsert: adding an entry at INTERNAL NODE\n");
+				/* moving entries that are bigger than 'value', with ptrs on the RIGHT, not left */
+				if (i < entries){
+					for (j = 0; j < entries - i; j++){
+						if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, (entries - j), amhdr->maxKeys, &tempRid)) != AME_OK){
+							printf("Btr_recInsert failed: retrieving %d th ptr of current internal node\n", entries - j);
+							return err;
+						}
+						if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->keyLength, (entries - (j+1)), amhdr->maxKeys, tempValue)) != AME_OK){
+							printf("Btr_recInsert failed: retrieving %d th value of current internal node\n", entries - (j+1));
+							return err;
+						}
+						if ((err = Btr_setPtr(&pbuf, NODE_INT, amhdr->keyLength, (entries - j + 1), amhdr->maxKeys, &tempRid)) != AME_OK){
+							printf("Btr_recInsert failed: moving %d th ptr of current internal node right\n", entries - j);
+							return err;
+						}
+						if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->keyLength, (entries - j), amhdr->maxKeys, tempValue)) != AME_OK){
+							printf("Btr_recInsert failed: moving %d th value of current internal node right\n", entries - (j+1));
+							return err;
+						}
+					}
 				}
-				bhdr_new->entries++;
-				amhdr->numRecs++;
-				bhdr_new->duplicate = TRUE;
-
-				/* copy up the values */
-				if ((err = Btr_getKey(&pbuf_new2, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving %d th value of current leaf node\n", 0);
+				printf("Btr_recInsert: adding an entry at INTERNAL NODE, about to add an entry\n");
+				if ((err = Btr_setPtr(&pbuf, NODE_INT, amhdr->keyLength, (i+1), amhdr->maxKeys, &recId)) != AME_OK){
+					printf("Btr_recInsert failed: inserting new ptr(on the right) at %d th entry\n", j);
 					return err;
 				}
-				if (tempRid_nbr.pagenum != NODE_NULLPTR){
-					if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
-						printf("Btr_recSplit failed: PF_UnpinPage of NEXT neighbor\n");
-						return err;
-					}
-				}
-				if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
+				if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, value)) != AME_OK){
+					printf("Btr_recInsert failed: inserting new key at %d th entry\n", j);
 					return err;
 				}
-				if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new2.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recSplit failed: PF_UnpinPage of newnode 2\n");
+				entries++;
+				bhdr->entries = entries;
+				if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+					printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
 					return err;
 				}
-
-				if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
+				printf("Btr_recInsert: adding an entry at INTERNAL NODE ended\n");
+				return AME_OK;
+			} /* the inserted value is from actual record. proceed to child nodes */
+			else {
+				if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+					printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
 					return err;
 				}
-				tempRid_new.recnum = NODE_INTNULL;
-				if ((err = Btr_recSplit(AM_fd, value, tempRid_new, parent, FALSE)) != AME_OK){
-					printf("Btr_recSplit failed: copying up the new leaf node's first key value to parent from leaf\n");
+				if ((err = Btr_pushPath(AM_fd, adr)) != AME_OK){
 					return err;
 				}
-				tempRid_new2.recnum = NODE_INTNULL;
-				if ((err = Btr_recSplit(AM_fd, tempValue, tempRid_new2, parent, FALSE)) != AME_OK){
-					printf("Btr_recSplit failed: copying up the new leaf node's first key value to parent from leaf\n");
+				/* receiving pointer information */
+				if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, &adr)) != AME_OK){
+					printf("Btr_recInsert failed: receiving pointer for a child at a nonempty internal node\n");
 					return err;
 				}
+				printf("adr updated: pagenum %d, recnum %d\n", adr.pagenum, adr.recnum);
 
-				return AME_OK;
+				return Btr_recInsert(AM_fd, value, recId, adr);
 			}
-			printf("Btr_recSplit failed: Why are you here?\n");
+		}
+	}
+	return AME_PF;
+}
+
+
+/*
+	commits an insertion or deletion to the log kept by PF, if any
+	the index header is copied into the PF header first, so that it is logged with the changed nodes
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+
+	*** return values ***
+	AME_OK if successful
+	AME_PF if the operation could not be committed
+*/
+int AM_Commit(int AM_fd){
+	if (ait[AM_fd].hdrchanged == TRUE) {
+		memcpy(pft[ait[AM_fd].pfd].hdr.hdrrest, &(ait[AM_fd].hdr), sizeof(AMhdr_str));
+		pft[ait[AM_fd].pfd].hdrchanged = TRUE;
+	}
+
+	if (PF_Commit() != PFE_OK) {
+		printf("AM_Commit failed: PF_Commit\n");
+		return AME_PF;
+	}
+	return AME_OK;
+}
+
+/* state of the B+ tree being built by AM_BulkLoad(), level by level from the leaves up */
+typedef struct Btr_loader {
+	int AM_fd;
+	int leafCap; /* number of entries a leaf node is filled with */
+	int intCap; /* number of keys an internal node is filled with */
+	int height; /* number of levels, the leaf level included */
+	int node[BTR_MAXHEIGHT]; /* page number of the rightmost node of each level, leaves at 0 */
+	char * leaf; /* points to the rightmost leaf node, kept pinned */
+	char * last; /* the last value loaded */
+	int post; /* page number of the last page of the last value's posting list */
+} Btr_loader;
+
+/*
+	adds a key and the node on its right to the rightmost node of a level, for AM_BulkLoad()
+	a full node is left as it is and a new one is started with the node, the key going a level up
+
+	*** parameters ***
+	Btr_loader * ld - points to the state of the B+ tree being built
+	int level - level the key is added to, 1 for the parents of leaf nodes
+	char * key - points to the key, the smallest value under 'right'
+	int left - page number of the node left to the key, if the level has to be started
+	int right - page number of the node right to the key
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_loadUp(Btr_loader * ld, int level, char * key, int left, int right){
+	AMhdr_str * amhdr = &(ait[ld->AM_fd].hdr);
+	BtrHdr * bhdr;
+	RECID adr, ptr;
+	char * pbuf;
+	int pagenum, full, err;
+
+	ptr.recnum = NODE_INTNULL;
+
+	/* the level above the top one: a new root with 'left' and 'right' as its children */
+	if (level == ld->height){
+		if (level == BTR_MAXHEIGHT){
+			printf("Btr_loadUp failed: too many levels\n");
+			return AME_TREETOODEEP;
+		}
+		if ((err = Btr_assignNode(ait[ld->AM_fd].pfd, NODE_INT, amhdr->keyLength, amhdr->maxKeys, &pagenum, &pbuf)) != AME_OK){
+			printf("Btr_loadUp failed: assigning a new root node\n");
+			return err;
+		}
+		amhdr->numNodes++;
+		ptr.pagenum = left;
+		Btr_setPtr(&pbuf, NODE_INT, amhdr->keyLength, 0, amhdr->maxKeys, &ptr);
+		ptr.pagenum = right;
+		Btr_setPtr(&pbuf, NODE_INT, amhdr->keyLength, 1, amhdr->maxKeys, &ptr);
+		Btr_setKey(&pbuf, NODE_INT, amhdr->keyLength, 0, amhdr->maxKeys, key);
+		((BtrHdr *) pbuf)->entries = 1;
+		if (PF_UnpinPage(ait[ld->AM_fd].pfd, pagenum, TRUE) != PFE_OK){
 			return AME_PF;
 		}
+		ld->node[ld->height++] = pagenum;
+		return AME_OK;
+	}
 
-		/* Things to do:
-			determine to which node the inserted key belongs - left or new
-			determine mid key
-			assign new node
-				move keys - including the mid key
-				remove moved keys from the left node
-				adjust links
-					links between leaf nodes
-					parent to leaf - through copying up the key
-			copy up the key
-				at internal nodes, 'recId' becomes new nodes' link?
-		*/
+	adr.pagenum = ld->node[level];
+	adr.recnum = NODE_NULLPTR;
+	if ((err = Btr_getNode(&pbuf, ld->AM_fd, adr)) != AME_OK){
+		printf("Btr_loadUp failed: Btr_getNode\n");
+		return err;
+	}
+	bhdr = (BtrHdr *) pbuf;
 
-		/* checking whether this leaf node is full */
-		if (entries != amhdr->maxKeys){
-			printf("Btr_recSplit failed: entries %d, amhdr->maxKeys %d?\n", entries, amhdr->maxKeys);
+	/* room left: the key and its right pointer are appended */
+	if (bhdr->entries < ld->intCap){
+		ptr.pagenum = right;
+		Btr_setKey(&pbuf, NODE_INT, amhdr->keyLength, bhdr->entries, amhdr->maxKeys, key);
+		Btr_setPtr(&pbuf, NODE_INT, amhdr->keyLength, bhdr->entries + 1, amhdr->maxKeys, &ptr);
+		bhdr->entries++;
+		return PF_UnpinPage(ait[ld->AM_fd].pfd, adr.pagenum, TRUE) == PFE_OK ? AME_OK : AME_PF;
+	}
+	if (PF_UnpinPage(ait[ld->AM_fd].pfd, adr.pagenum, FALSE) != PFE_OK){
+		return AME_PF;
+	}
+
+	/* the node is full: a new one starts with 'right' as its first child */
+	if ((err = Btr_assignNode(ait[ld->AM_fd].pfd, NODE_INT, amhdr->keyLength, amhdr->maxKeys, &pagenum, &pbuf)) != AME_OK){
+		printf("Btr_loadUp failed: assigning a new internal node\n");
+		return err;
+	}
+	amhdr->numNodes++;
+	ptr.pagenum = right;
+	Btr_setPtr(&pbuf, NODE_INT, amhdr->keyLength, 0, amhdr->maxKeys, &ptr);
+	if (PF_UnpinPage(ait[ld->AM_fd].pfd, pagenum, TRUE) != PFE_OK){
+		return AME_PF;
+	}
+	full = ld->node[level];
+	ld->node[level] = pagenum;
+	return Btr_loadUp(ld, level + 1, key, full, pagenum);
+}
+
+/*
+	appends a record id to the posting list of the last value loaded by AM_BulkLoad(), record ids coming in ascending order
+	the list is started with the record id kept in the leaf node if there is none yet
+
+	*** parameters ***
+	Btr_loader * ld - points to the state of the B+ tree being built
+	RECID recId - record id to be appended
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_loadPost(Btr_loader * ld, RECID recId){
+	AMhdr_str * amhdr = &(ait[ld->AM_fd].hdr);
+	int pfd = ait[ld->AM_fd].pfd;
+	char * entry = ld->leaf + sizeof(BtrHdr) + sizeof(RECID) + (((BtrHdr *) ld->leaf)->entries - 1) * (sizeof(RECID) + amhdr->keyLength);
+	BtrPostHdr * phdr;
+	RECID rid;
+	char * page;
+	int pagenum;
+
+	memcpy(&rid, entry, sizeof(RECID));
+	if (rid.recnum != NODE_POSTING){
+		if (PF_AllocPage(pfd, &pagenum, &page) != PFE_OK){
 			return AME_PF;
 		}
+		phdr = (BtrPostHdr *) page;
+		phdr->entries = 1;
+		phdr->next = NODE_NULLPTR;
+		memcpy(page + sizeof(BtrPostHdr), &rid, sizeof(RECID));
+		rid.pagenum = pagenum;
+		rid.recnum = NODE_POSTING;
+		memcpy(entry, &rid, sizeof(RECID));
+		ld->post = pagenum;
+	} else if (PF_GetThisPage(pfd, ld->post, &page) != PFE_OK){
+		return AME_PF;
+	}
+	phdr = (BtrPostHdr *) page;
 
-		/* determine where 'mid' is */
-		mid = amhdr->maxKeys / 2; /* if maxKeys = 4 or 5 then mid = 2 */
+	if (phdr->entries == BTR_POSTKEYS){
+		/* a full page is followed by a new one */
+		if (PF_AllocPage(pfd, &pagenum, &page) != PFE_OK){
+			PF_UnpinPage(pfd, ld->post, FALSE);
+			return AME_PF;
+		}
+		phdr->next = pagenum;
+		if (PF_UnpinPage(pfd, ld->post, TRUE) != PFE_OK){
+			return AME_PF;
+		}
+		ld->post = pagenum;
+		phdr = (BtrPostHdr *) page;
+		phdr->entries = 0;
+		phdr->next = NODE_NULLPTR;
+	}
+
+	memcpy(page + sizeof(BtrPostHdr) + phdr->entries * sizeof(RECID), &recId, sizeof(RECID));
+	phdr->entries++;
+	amhdr->numRecs++;
+	return PF_UnpinPage(pfd, ld->post, TRUE) == PFE_OK ? AME_OK : AME_PF;
+}
+
+/*
+	appends an entry to the B+ tree built by AM_BulkLoad(), values coming in ascending order
+	the rightmost leaf node takes it until it holds the number of entries asked for;
+	a value equal to the last one goes to its posting list instead
+
+	*** parameters ***
+	Btr_loader * ld - points to the state of the B+ tree being built
+	char * value - points to the value to be loaded
+	RECID recId - record id of the value
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_loadEntry(Btr_loader * ld, char * value, RECID recId){
+	AMhdr_str * amhdr = &(ait[ld->AM_fd].hdr);
+	int entlen = sizeof(RECID) + amhdr->keyLength;
+	BtrHdr * bhdr = (BtrHdr *) ld->leaf;
+	RECID adr;
+	char * pbuf;
+	int pagenum, full, err;
+
+	if ((bhdr->entries > 0) && (Btr_compare(ld->AM_fd, value, ld->last) == BTR_EQ)){
+		return Btr_loadPost(ld, recId);
+	}
 
-		/* parent of the current node */
-		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, NODE_PARENT, amhdr->maxKeys, &parent)) != AME_OK){
-			printf("Btr_recSplit failed: retrieving the parent ptr of an leaf node\n");
+	if (bhdr->entries >= ld->leafCap){
+		/* a new leaf node next to the full one */
+		if ((err = Btr_assignNode(ait[ld->AM_fd].pfd, NODE_LEAF, amhdr->keyLength, amhdr->maxKeys, &pagenum, &pbuf)) != AME_OK){
+			printf("Btr_loadEntry failed: assigning a new leaf node\n");
 			return err;
 		}
+		amhdr->numNodes++;
 
-		/* determine where the new key is supposed to be at */
-		if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, mid, amhdr->maxKeys, tempValue)) != AME_OK){
-			printf("Btr_recSplit failed: retrieving the middle key of an leaf node\n");
-			return err;
+		adr.pagenum = ld->node[0];
+		adr.recnum = NODE_NULLPTR;
+		Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, LEAFIDX_PREV, amhdr->maxKeys, &adr);
+		adr.pagenum = pagenum;
+		Btr_setPtr(&ld->leaf, NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &adr);
+		if (PF_UnpinPage(ait[ld->AM_fd].pfd, ld->node[0], TRUE) != PFE_OK){
+			return AME_PF;
 		}
-		new = Btr_valComp(value, tempValue, amhdr->attrType, amhdr->attrLength);
 
-		/* assign a new node */
-		if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_LEAF, amhdr->attrLength, amhdr->maxKeys, &newNode, &pbuf_new, parent)) != AME_OK){
-			printf("Btr_recSplit failed: assigning a new leaf node\n");
+		full = ld->node[0];
+		ld->node[0] = pagenum;
+		ld->leaf = pbuf;
+		bhdr = (BtrHdr *) pbuf;
+		Btr_separator(ld->AM_fd, ld->last, value, ld->last);
+		if ((err = Btr_loadUp(ld, 1, ld->last, full, pagenum)) != AME_OK){
 			return err;
 		}
-		bhdr_new = (BtrHdr *)pbuf_new;
+	} else if (bhdr->entries == 0){
+		/* the first entry of the first leaf node filled: the root's only key is set, as by Btr_recInsert() */
+		if ((err = Btr_loadUp(ld, 1, value, NODE_NULLPTR, ld->node[0])) != AME_OK){
+			return err;
+		}
+	}
 
-		/* adjust links between leaf nodes */
-		/* right neighbor of the current leaf node */
+	pbuf = ld->leaf + sizeof(BtrHdr) + sizeof(RECID) + bhdr->entries * entlen;
+	memcpy(pbuf, &recId, sizeof(RECID));
+	memcpy(pbuf + sizeof(RECID), value, amhdr->keyLength);
+	memcpy(ld->last, value, amhdr->attrLength);
+	bhdr->entries++;
+	amhdr->numRecs++;
+	return AME_OK;
+}
 
-		adr.recnum = NODE_NULLPTR;
-		if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &adr)) != AME_OK){
-			printf("Btr_recSplit failed: setting PREV ptr of new node\n");
+/*
+	gives a key to the rightmost node of each level left without one by AM_BulkLoad()
+	the last key and child of its left neighbor are moved into it, from the top level down
+
+	*** parameters ***
+	Btr_loader * ld - points to the state of the B+ tree being built
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_loadFinish(Btr_loader * ld){
+	AMhdr_str * amhdr = &(ait[ld->AM_fd].hdr);
+	int keyLength = amhdr->keyLength;
+	int keyNum = amhdr->maxKeys;
+	char * pbuf, * pbuf_par, * pbuf_nbr;
+	BtrHdr * bhdr, * bhdr_par, * bhdr_nbr;
+	RECID adr, par, nbr, ptr, rid_empty;
+	char * key = ld->last;
+	int level, err;
+
+	rid_empty.pagenum = NODE_NULLPTR;
+	rid_empty.recnum = NODE_INTNULL;
+	adr.recnum = NODE_NULLPTR;
+	par.recnum = NODE_NULLPTR;
+
+	for (level = ld->height - 2; level >= 1; level--){
+		adr.pagenum = ld->node[level];
+		if ((err = Btr_getNode(&pbuf, ld->AM_fd, adr)) != AME_OK){
 			return err;
 		}
+		bhdr = (BtrHdr *) pbuf;
+		if (bhdr->entries > 0){
+			PF_UnpinPage(ait[ld->AM_fd].pfd, adr.pagenum, FALSE);
+			continue;
+		}
 
-		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-			printf("Btr_recSplit failed: retrieving NEXT ptr of a leaf node\n");
+		/* the node is the last child of its parent, its left neighbor being a full node */
+		par.pagenum = ld->node[level + 1];
+		if ((err = Btr_getNode(&pbuf_par, ld->AM_fd, par)) != AME_OK){
 			return err;
 		}
-
-		if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-			printf("Btr_recSplit failed: setting NEXT ptr of new node\n");
+		bhdr_par = (BtrHdr *) pbuf_par;
+		Btr_getPtr(&pbuf_par, NODE_INT, keyLength, bhdr_par->entries - 1, keyNum, &nbr);
+		nbr.recnum = NODE_NULLPTR;
+		if ((err = Btr_getNode(&pbuf_nbr, ld->AM_fd, nbr)) != AME_OK){
 			return err;
 		}
+		bhdr_nbr = (BtrHdr *) pbuf_nbr;
+
+		/* the parent's key comes down, the neighbor's last key goes up in its place */
+		Btr_getPtr(&pbuf, NODE_INT, keyLength, 0, keyNum, &ptr);
+		Btr_setPtr(&pbuf, NODE_INT, keyLength, 1, keyNum, &ptr);
+		Btr_getKey(&pbuf_par, NODE_INT, keyLength, bhdr_par->entries - 1, keyNum, key);
+		Btr_setKey(&pbuf, NODE_INT, keyLength, 0, keyNum, key);
+		Btr_getPtr(&pbuf_nbr, NODE_INT, keyLength, bhdr_nbr->entries, keyNum, &ptr);
+		Btr_setPtr(&pbuf, NODE_INT, keyLength, 0, keyNum, &ptr);
+		bhdr->entries = 1;
+		Btr_getKey(&pbuf_nbr, NODE_INT, keyLength, bhdr_nbr->entries - 1, keyNum, key);
+		Btr_setKey(&pbuf_par, NODE_INT, keyLength, bhdr_par->entries - 1, keyNum, key);
+		Btr_setPtr(&pbuf_nbr, NODE_INT, keyLength, bhdr_nbr->entries, keyNum, &rid_empty);
+		bhdr_nbr->entries--;
+
+		if (PF_UnpinPage(ait[ld->AM_fd].pfd, nbr.pagenum, TRUE) != PFE_OK
+			|| PF_UnpinPage(ait[ld->AM_fd].pfd, par.pagenum, TRUE) != PFE_OK
+			|| PF_UnpinPage(ait[ld->AM_fd].pfd, adr.pagenum, TRUE) != PFE_OK){
+			return AME_PF;
+		}
+	}
+	return AME_OK;
+}
 
-		tempRid_new.pagenum = newNode;
-		tempRid_new.recnum = NODE_NULLPTR;
+/*
+	starts building the B+ tree of an empty index from the leaves up, for AM_BulkLoad()
+	the leaf node filled first is the second child of the root, as Btr_recInsert() leaves the first one empty
 
-		if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-			printf("Btr_recSplit failed: setting NEXT ptr of new leaf node\n");
-			return err;
-		}
+	*** parameters ***
+	Btr_loader * ld - points to the state of the B+ tree to be built
+	int AM_fd - file descriptor of the AM index table
+	int fillFactor - percentage of a node's room filled, from 1 to 100
 
-		if (tempRid_nbr.pagenum != NODE_NULLPTR){
-			if ((err = Btr_getNode(&pbuf_nbr, AM_fd, tempRid_nbr)) != AME_OK){
-				printf("Btr_recSplit failed: Btr_getNode for neighboring leaf node\n");
-				return err;
-			}
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int Btr_loadStart(Btr_loader * ld, int AM_fd, int fillFactor){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	char * pbuf;
+	RECID adr;
+	int err;
 
-			if ((err = Btr_setPtr(&pbuf_nbr, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-				printf("Btr_recSplit failed: setting PREV ptr of neighboring leaf node\n");
-				return err;
-			}
-		}
+	Btr_dropNodes(AM_fd);
+	ld->AM_fd = AM_fd;
+	ld->leafCap = amhdr->maxKeys * fillFactor / 100;
+	ld->leafCap = (ld->leafCap < 1) ? 1 : ld->leafCap;
+	ld->intCap = amhdr->maxKeys * fillFactor / 100;
+	ld->intCap = (ld->intCap < 2) ? 2 : ld->intCap;
+	ld->height = 2;
+	ld->node[1] = amhdr->root.pagenum;
+	ld->leaf = NULL;
+	ld->post = NODE_NULLPTR;
+	if ((ld->last = (char *) malloc(amhdr->attrLength)) == NULL){
+		return AME_NOMEM;
+	}
 
-		/* moving keys, removing moved keys from the original node */
-		rid_empty.pagenum = NODE_NULLPTR;
-		rid_empty.recnum = NODE_NULLPTR;
-		for (i = mid; i < entries; i++){
-			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving %d th ptr of current leaf node\n", i);
-				return err;
-			}
-			if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving %d th value of current leaf node\n", i);
-				return err;
-			}
-			if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, i-mid, amhdr->maxKeys, &tempRid)) != AME_OK){
-				printf("Btr_recSplit failed: writing %d th ptr of current leaf node to new one\n", i);
-				return err;
-			}
-			if ((err = Btr_setKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, i-mid, amhdr->maxKeys, tempValue)) != AME_OK){
-				printf("Btr_recSplit failed: writing %d th value of current leaf node to new one\n", i);
-				return err;
-			}
+	if ((err = Btr_getNode(&pbuf, AM_fd, amhdr->root)) != AME_OK){
+		return err;
+	}
+	Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, 1, amhdr->maxKeys, &adr);
+	if (PF_UnpinPage(ait[AM_fd].pfd, amhdr->root.pagenum, FALSE) != PFE_OK){
+		return AME_PF;
+	}
+	ld->node[0] = adr.pagenum;
+	return Btr_getNode(&ld->leaf, AM_fd, adr);
+}
+
+/*
+	ends building a B+ tree started by Btr_loadStart(), making its top node the root
+
+	*** parameters ***
+	Btr_loader * ld - points to the state of the B+ tree being built
+	int err - AME_OK, or the error that stopped the building
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred, or 'err'
+*/
+int Btr_loadEnd(Btr_loader * ld, int err){
+	if ((ld->leaf != NULL) && (PF_UnpinPage(ait[ld->AM_fd].pfd, ld->node[0], TRUE) != PFE_OK) && (err == AME_OK)){
+		err = AME_PF;
+	}
+	if (err == AME_OK){
+		err = Btr_loadFinish(ld);
+	}
+	if (err == AME_OK){
+		ait[ld->AM_fd].hdr.root.pagenum = ld->node[ld->height - 1];
+		ait[ld->AM_fd].hdrchanged = TRUE;
+	}
+	free(ld->last);
+	ld->last = NULL;
+	return err;
+}
+
+/*
+	inserts the specified value in the B+ tree
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * value - points to the value to be inserted in B+ tree
+	RECID recId - record id of the value to be inserted
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int AM_InsertEntry(int AM_fd, char *value, RECID recId) {
+	int err;
+	
+	if (ait[AM_fd].valid != TRUE) {
+		printf("AM_InsertEntry failed: given AM_fd invalid\n");
+		return AME_INVALIDPARA;
+	}
 
-			if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &rid_empty)) != AME_OK){
-				printf("Btr_recSplit failed: emptying %d th ptr of current leaf node\n", i);
-				return err;
-			}
-			if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, value_empty)) != AME_OK){
-				printf("Btr_recSplit failed: emptying %d th value of current leaf node\n", i);
-				return err;
-			}
-			bhdr->entries--;
-			bhdr_new->entries++;
-		}
-		if (tempRid_nbr.pagenum != NODE_NULLPTR){
-			if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
-				printf("Btr_recSplit failed: PF_UnpinPage of NEXT neighbor\n");
-				return err;
-			}
-		}
-		if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-			printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
+	/* a hash index puts the entry in the bucket of its value */
+	if (ait[AM_fd].hdr.method == AM_METHOD_HASH) {
+		if ((err = Hash_insert(AM_fd, value, recId)) != AME_OK) {
+			printf("AM_InsertEntry failed: Hash_insert\n");
 			return err;
 		}
-		/* inserting the new value into one of the nodes */
-		if (new == BTR_LT){
-			if ((err = Btr_recInsert(AM_fd, value, recId, adr)) != AME_OK){
-				printf("Btr_recSplit failed: inserting new value in current leaf node\n");
-				return err;
-			}
-		} else {
-			if ((err = Btr_recInsert(AM_fd, value, recId, tempRid_new)) != AME_OK){
-				printf("Btr_recSplit failed: inserting new value in new leaf node\n");
-				return err;
-			}
-		}
-		amhdr->numNodes++;
-		ait[AM_fd].hdrchanged = TRUE;
+		return AM_Commit(AM_fd);
+	}
 
-		/* copying up the mid value, with new node's ptr */
-		tempRid_new.recnum = NODE_INTNULL;
-		if ((err = Btr_getKey(&pbuf_new, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-			printf("Btr_recSplit failed: retrieving mid value of current leaf node\n");
-			return err;
-		}
-		if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
-			printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
-			return err;
-		}
-		if ((err = Btr_recSplit(AM_fd, tempValue, tempRid_new, parent, FALSE)) != AME_OK){
-			printf("Btr_recSplit failed: copying up the mid key value to parent from leaf\n");
-			return err;
-		}
-		printf("Btr_recSplit: value successfully copied up from a leaf node\n");
-		return AME_OK;
+	/* search begins at root node, with an empty path */
+	ait[AM_fd].depth = 0;
+	if ((err = Btr_recInsert(AM_fd, value, recId, ait[AM_fd].hdr.root)) != AME_OK) {
+		printf("AM_InsertEntry failed: Btr_recInsert\n");
+		return AME_PF;
+	}
 
-	} /* at internal node */
-	else {
+	return AM_Commit(AM_fd);
+}
 
-		/* internal node not full */
-		if (entries < amhdr->maxKeys){
-			/* insert the key and ptr at an appropriate position */
-			/* inserting the new value into one of the nodes */
-			printf("Btr_recSplit: internal node not full\n");
-			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-				printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
-				return err;
-			}
-			adr.recnum = NODE_INTNULL;
-			if ((err = Btr_recInsert(AM_fd, value, recId, adr)) != AME_OK){
-				printf("Btr_recSplit failed: inserting new value in current internal node(without splitting)\n");
-				return err;
-			}
-			printf("Btr_recSplit: internal node not full. entry added\n");
-			return AME_OK;
-		} /* internal node full, split again */
-		else {
+/* values of the batch being sorted by AM_InsertEntries() */
+char * Btr_sortValues = NULL;
+int Btr_sortFd; /* index the values are compared for, by Btr_compare() */
+int Btr_sortLength;
 
-			/* checking whether this internal node is full */
-			if (entries != amhdr->maxKeys){
-				printf("Btr_recSplit failed(internal node): entries %d, amhdr->maxKeys %d?\n", entries, amhdr->maxKeys);
-				return AME_PF;
-			}
+/*
+	compares two positions of the batch by their values, then by their positions
+	called by qsort() in AM_InsertEntries()
 
-			/* determine where 'mid' is */
-			mid = amhdr->maxKeys / 2; /* if maxKeys = 4 or 5 then mid = 2 */
+	*** parameters ***
+	const void * a - points to a position in the batch
+	const void * b - points to another position in the batch
 
-			/* parent of the current node */
-			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, NODE_PARENT, amhdr->maxKeys, &parent)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving the parent ptr of an internal node\n");
-				return err;
-			}
+	*** return values ***
+	negative, zero or positive as the value at a is smaller than, equal to or bigger than the one at b
+*/
+int Btr_sortComp(const void * a, const void * b){
+	int i = *(const int *) a;
+	int j = *(const int *) b;
+	int res;
 
-			/* determine where the new key is supposed to be at */
-			if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->attrLength, mid, amhdr->maxKeys, tempValue)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving the middle key of an internal node\n");
-				return err;
-			}
-			new = Btr_valComp(value, tempValue, amhdr->attrType, amhdr->attrLength);
+	res = Btr_compare(Btr_sortFd, Btr_sortValues + i * Btr_sortLength, Btr_sortValues + j * Btr_sortLength);
+	if (res != BTR_EQ){
+		return res;
+	}
+	return (i > j) - (i < j);
+}
 
-			/* assign a new node */
-			if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_INT, amhdr->attrLength, amhdr->maxKeys, &newNode, &pbuf_new, parent)) != AME_OK){
-				printf("Btr_recSplit failed: assigning a new internal node\n");
-				return err;
-			}
-			bhdr_new = (BtrHdr *)pbuf_new;
-			tempRid_new.pagenum = newNode;
-			tempRid_new.recnum = NODE_INTNULL;
+/*
+	finds the leaf node where the specified value is to be inserted, descending from the root
+	the smallest key on the way that is bigger than the value is kept, as no other leaf takes a value below it
 
-			/* no direct link between internal nodes of the same height */
-			adr.recnum = NODE_INTNULL;
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * value - points to the value to be inserted
+	RECID * leaf - points to the pointer to contain the leaf node
+	char * bound - points to where that key is copied
+	bool_t * bounded - points to the variable set to FALSE if there is no such key
 
-			/* if there is no parent node (current node is root), create new root and update */
-			if (parent.pagenum == NODE_NULLPTR){
-				printf("root node full, assigning a new root\n");
-				if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_INT, amhdr->attrLength, amhdr->maxKeys, &newRoot, &pbuf_nbr, parent)) != AME_OK){
-					printf("Btr_recSplit failed(internal): assigning a new root node\n");
-					return err;
-				}
-				/* updating the pointers to the new root node */
-				amhdr->root.pagenum = newRoot;
-				parent.pagenum = newRoot;
-				if ((err = Btr_setPtr(&pbuf, NODE_INT, amhdr->attrLength, NODE_PARENT, amhdr->maxKeys, &parent)) != AME_OK){
-					printf("Btr_recSplit failed: updating the current internal node's parent information after assigning a new root node\n");
-					return err;
-				}
-				if ((err = Btr_setPtr(&pbuf_new, NODE_INT, amhdr->attrLength, NODE_PARENT, amhdr->maxKeys, &parent)) != AME_OK){
-					printf("Btr_recSplit failed: updating the new internal node's parent information after assigning a new root node\n");
-					return err;
-				}
-				/* updating the pointers from the root to the child nodes */
-				if ((err = Btr_setPtr(&pbuf_nbr, NODE_ROOT, amhdr->attrLength, 0, amhdr->maxKeys, &adr)) != AME_OK){
-					printf("Btr_recSplit failed: updating the current internal node's parent information after assigning a new root node\n");
-					return err;
-				}
-				if ((err = Btr_setPtr(&pbuf_nbr, NODE_ROOT, amhdr->attrLength, 1, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-					printf("Btr_recSplit failed: updating the new internal node's parent information after assigning a new root node\n");
-					return err;
-				}
-				amhdr->numNodes++;
-				ait[AM_fd].hdrchanged = TRUE;
-				if ((err = PF_UnpinPage(ait[AM_fd].pfd, parent.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recSplit failed: PF_UnpinPage of new root node\n");
-					return err;
-				}
-				printf("root node full, assigning a new root: ended\n");
-			}
+	*** return values ***
+	AME_OK if successful
+	AME_EOF if an internal node on the way is empty, so that Btr_recInsert() must fill it
+	error codes (< 0) if a problem occurred
+*/
+int Btr_findLeaf(int AM_fd, char * value, RECID * leaf, char * bound, bool_t * bounded){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	RECID adr = amhdr->root;
+	RECID child;
+	char * pbuf;
+	char * key;
+	int entries;
+	int i, err;
 
-			/* moving keys, removing moved keys from the original node */
-			rid_empty.pagenum = NODE_NULLPTR;
-			rid_empty.recnum = NODE_NULLPTR;
-			for (i = mid; i < entries; i++){
-				if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, i+1, amhdr->maxKeys, &tempRid)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving %d th ptr of current internal node\n", i+1);
-					return err;
-				}
-				if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: retrieving %d th value of current internal node\n", i);
-					return err;
-				}
-				if ((err = Btr_setPtr(&pbuf_new, NODE_INT, amhdr->attrLength, (i-mid+1), amhdr->maxKeys, &tempRid)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th ptr of current internal node to new one\n", i+1);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf_new, NODE_INT, amhdr->attrLength, i-mid, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recSplit failed: writing %d th value of current internal node to new one\n", i);
-					return err;
-				}
+	*bounded = FALSE;
+	while (1) {
+		if ((err = Btr_readNode(&pbuf, AM_fd, adr)) != AME_OK){
+			printf("Btr_findLeaf failed: Btr_readNode\n");
+			return err;
+		}
+		if (Btr_isLeaf(pbuf) == TRUE){
+			*leaf = adr;
+			break;
+		}
 
-				if ((err = Btr_setPtr(&pbuf, NODE_INT, amhdr->attrLength, i+1, amhdr->maxKeys, &rid_empty)) != AME_OK){
-					printf("Btr_recSplit failed: emptying %d th ptr of current internal node\n", i+1);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, value_empty)) != AME_OK){
-					printf("Btr_recSplit failed: emptying %d th value of current internal node\n", i);
-					return err;
-				}
-				bhdr->entries--;
-				bhdr_new->entries++;
-			}
-			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, mid, amhdr->maxKeys, &tempRid)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving %d th ptr of current internal node\n", mid);
-				return err;
-			}
-			if ((err = Btr_setPtr(&pbuf_new, NODE_INT, amhdr->attrLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
-				printf("Btr_recSplit failed: writing %d th ptr of current internal node to new one\n", 0);
-				return err;
-			}
-			/* will not work if mid = 0(amhdr->maxKeys = 1)... */
-			if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->attrLength, mid-1, amhdr->maxKeys, value_empty)) != AME_OK){
-				printf("Btr_recSplit failed: emptying %d th value of current internal node\n", mid-1);
-				return err;
-			}
-			bhdr->entries--;
-			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-				printf("Btr_recSplit failed: PF_UnpinPage of adr\n");
-				return err;
-			}
-			/* inserting the new value into one of the nodes */
-			if (new == BTR_LT){
-				adr.recnum = NODE_INTNULL;
-				if ((err = Btr_recInsert(AM_fd, value, recId, adr)) != AME_OK){
-					printf("Btr_recSplit failed: inserting new value in current internal node\n");
-					return err;
-				}
-			} else {
-				if ((err = Btr_recInsert(AM_fd, value, recId, tempRid_new)) != AME_OK){
-					printf("Btr_recSplit failed: inserting new value in new internal node\n");
-					return err;
-				}
-			}
-			amhdr->numNodes++;
-			ait[AM_fd].hdrchanged = TRUE;
+		entries = ((BtrHdr *) pbuf)->entries;
+		if (entries == 0){
+			Btr_releaseNode(AM_fd, adr, pbuf);
+			return AME_EOF;
+		}
 
-			/* copying up the mid value, with new node's ptr */
-			tempRid_new.recnum = NODE_INTNULL;
-			if ((err = Btr_getKey(&pbuf_new, NODE_INT, amhdr->attrLength, 0, amhdr->maxKeys, tempValue)) != AME_OK){
-				printf("Btr_recSplit failed: retrieving mid value of current internal node\n");
-				return err;
-			}
-			if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_new.pagenum, TRUE)) != PFE_OK){
-				printf("Btr_recSplit failed: PF_UnpinPage of newnode 1\n");
-				return err;
-			}
-			if ((err = Btr_recSplit(AM_fd, tempValue, tempRid_new, parent, FALSE)) != AME_OK){
-				printf("Btr_recSplit failed: copying up the mid key value to parent from an internal node\n");
-				return err;
-			}
-			return AME_OK;
+		/* the first key bigger than the value leads the way, as in Btr_recInsert() */
+		if ((i = Btr_search(pbuf, NODE_INT, AM_fd, value, TRUE)) < entries){
+			key = pbuf + sizeof(BtrHdr) + i * (sizeof(RECID) + amhdr->keyLength) + sizeof(RECID);
+			memcpy(bound, key, amhdr->keyLength);
+			*bounded = TRUE;
+		}
 
+		if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, &child)) != AME_OK){
+			printf("Btr_findLeaf failed: Btr_getPtr of child\n");
+			Btr_releaseNode(AM_fd, adr, pbuf);
+			return err;
 		}
-		printf("Btr_recSplit failed: not supposed to reach here?\n");
+		if (Btr_releaseNode(AM_fd, adr, pbuf) != AME_OK){
+			printf("Btr_findLeaf failed: PF_UnpinPage of adr\n");
+			return AME_PF;
+		}
+		adr = child;
+	}
+
+	if (PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, FALSE) != PFE_OK){
+		printf("Btr_findLeaf failed: PF_UnpinPage of leaf\n");
 		return AME_PF;
 	}
-	printf("Btr_recSplit failed: not supposed to reach here?\n");
-	return AME_PF;
+	return AME_OK;
 }
 
 /*
-	inserts the specified value in the B+ tree
-	recursively called
+	inserts the specified value in a leaf node which has room for it
+	a value equal to a key of the node joins the key's posting list; values that call for a split are left to Btr_recInsert()
 
 	*** parameters ***
 	int AM_fd - file descriptor of the AM index table
-	char * value - points to the value to be inserted in B+ tree
+	char * value - points to the value to be inserted
 	RECID recId - record id of the value to be inserted
-	RECID adr -	pointer to the B+ tree node to start searching
+	int pagenum - page number of the leaf node
+	char * pbuf - points to the pinned leaf node
 
 	*** return values ***
 	AME_OK if successful
-	error codes (< 0) if a problem occurred
+	AME_EOF if the value was not inserted
+	error codes (< 0) if the value could not join a posting list
 */
-int Btr_recInsert(int AM_fd, char * value, RECID recId, RECID adr){
-	int err;
-	int entries;
-	int res;
-	int i, j;
-	char * pbuf;
-	RECID tempRid;
-	RECID tempRid_new;
-	RECID tempRid_nbr;
-	RECID tempRid_par;
-	char * tempValue = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
-	char * tempValue_par = (char *)calloc(ait[AM_fd].hdr.attrLength, sizeof(char));
-	char * tempValue2 = (char *)calloc(sizeof(RECID) + ait[AM_fd].hdr.attrLength, sizeof(char));
+int Btr_leafInsert(int AM_fd, char * value, RECID recId, int pagenum, char * pbuf){
 	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
-	BtrHdr * bhdr;
-	BtrHdr * bhdr_new;
-
-	int newNode;
-	char * pbuf_nbr;
-	char * pbuf_new;
-	char * pbuf_par;
+	BtrHdr * bhdr = (BtrHdr *) pbuf;
+	int entlen = sizeof(RECID) + amhdr->keyLength;
+	char * entry = pbuf + sizeof(BtrHdr) + sizeof(RECID);
+	int i;
 
-	/* retrieving node information */
-	if ((err = Btr_getNode(&pbuf, AM_fd, adr)) != AME_OK){
-		printf("Btr_recInsert failed: Btr_getNode\n");
-		return err;
+	i = Btr_search(pbuf, NODE_LEAF, AM_fd, value, FALSE);
+	if ((i < bhdr->entries) && (Btr_compare(AM_fd, value, entry + i * entlen + sizeof(RECID)) == BTR_EQ)){
+		return Btr_postAdd(AM_fd, pbuf, i, recId);
+	}
+	if (bhdr->entries >= amhdr->maxKeys){
+		return AME_EOF;
 	}
 
-	printf("Btr_recInsert at page %d, with value %s\n", adr.pagenum, value);
+	/* moving entries that are bigger than 'value' by one */
+	memmove(entry + (i + 1) * entlen, entry + i * entlen, (bhdr->entries - i) * entlen);
+	memcpy(entry + i * entlen, &recId, sizeof(RECID));
+	memcpy(entry + i * entlen + sizeof(RECID), value, amhdr->keyLength);
+	Btr_leafMoveScans(AM_fd, pagenum, i, amhdr->maxKeys, pagenum, 1);
+
+	bhdr->entries++;
+	amhdr->numRecs++;
+	ait[AM_fd].hdrchanged = TRUE;
+	return AME_OK;
+}
+
+/*
+	inserts a batch of values in the B+ tree
+	the values are sorted first, so that each leaf node is reached once for the values it takes,
+	and the insertion is committed once for the whole batch
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	char * values - points to n values of the attribute's length, one after another
+	RECID * recIds - record ids of the values, in the same order
+	int n - number of values to be inserted
+
+	*** return values ***
+	AME_OK if successful
+	error codes (< 0) if a problem occurred
+*/
+int AM_InsertEntries(int AM_fd, char *values, RECID *recIds, int n) {
+	AMhdr_str * amhdr;
+	int * order;
+	char * bound;
+	char * value;
+	char * pbuf;
+	bool_t bounded;
+	RECID leaf;
+	int i, first, err;
 
-	/* retrieving number of entries */
-	bhdr = (BtrHdr *) pbuf;
-	entries = bhdr->entries;
+	if ((AM_fd < 0) || (AM_fd >= AM_itab_size) || (ait[AM_fd].valid != TRUE)) {
+		printf("AM_InsertEntries failed: given AM_fd invalid\n");
+		return AME_INVALIDPARA;
+	}
+	if (n <= 0) {
+		return n == 0 ? AME_OK : AME_INVALIDPARA;
+	}
+	amhdr = &(ait[AM_fd].hdr);
 
-	/* at leaf node */
-	if (Btr_isLeaf(pbuf) == TRUE){
-		if (entries > amhdr->maxKeys){
-			printf("Btr_recInsert failed: entries more than maxKeys??\n");
-			return AME_PF;
-		} /* when the node is full with entries */
-		else if (entries == amhdr->maxKeys){
-			/* if this leaf node contains duplicate values, raise error */
-			if (bhdr->duplicate == TRUE){
-				printf("Btr_recInsert failed: this node is full of duplicate values!!\n");
-				return AME_TOOMANYRECSPERKEY;
-			}
-			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-				printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
+	/* a hash index has no order to sort the batch into */
+	if (amhdr->method == AM_METHOD_HASH) {
+		for (i = 0; i < n; i++) {
+			if ((err = Hash_insert(AM_fd, values + i * amhdr->attrLength, recIds[i])) != AME_OK) {
 				return err;
 			}
+		}
+		return AM_Commit(AM_fd);
+	}
 
-			/* split */
-			if ((err = Btr_recSplit(AM_fd, value, recId, adr, FALSE)) != AME_OK){
-				printf("Btr_recInsert failed: Btr_recSplit at node %d\n", adr.pagenum);
-				return err;
+	if ((order = (int *) malloc(n * sizeof(int))) == NULL) {
+		return AME_NOMEM;
+	}
+	if ((bound = (char *) malloc(amhdr->attrLength)) == NULL) {
+		free(order);
+		return AME_NOMEM;
+	}
+
+	for (i = 0; i < n; i++) {
+		order[i] = i;
+	}
+	Btr_sortValues = values;
+	Btr_sortFd = AM_fd;
+	Btr_sortLength = amhdr->attrLength;
+	qsort(order, n, sizeof(int), Btr_sortComp);
+
+	i = 0;
+	while (i < n) {
+		value = values + order[i] * amhdr->attrLength;
+		first = i;
+
+		if ((err = Btr_findLeaf(AM_fd, value, &leaf, bound, &bounded)) == AME_OK) {
+			if ((err = Btr_getNode(&pbuf, AM_fd, leaf)) != AME_OK) {
+				break;
 			}
-			printf("Btr_recInsert: successfully split at a leaf node\n");
-			return AME_OK;
-		} else {
-			/* looking for a place to fit */
-			for (i = 0; i < entries; i++){
-				if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recInsert failed(looking for fitting place): retrieving %d th value of current leaf node\n", i);
-					return err;
+			/* the values up to the leaf's bound are put in place while it is pinned */
+			while (i < n) {
+				value = values + order[i] * amhdr->attrLength;
+				if ((bounded == TRUE) && (Btr_compare(AM_fd, value, bound) != BTR_LT)) {
+					break;
 				}
-
-				if ((res = Btr_valComp(value, tempValue, amhdr->attrType, amhdr->attrLength)) == BTR_LT){
-					/* found place to insert, get out of this for loop */
+				if (Btr_leafInsert(AM_fd, value, recIds[order[i]], leaf.pagenum, pbuf) != AME_OK) {
 					break;
-				} else if (res == BTR_EQ) {
-					/* if recId is the same, raise error */
-					if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recInsert failed(looking for fitting place): checking duplciate record ID \n");
-						return err;
-					}
-					if ((tempRid.pagenum == recId.pagenum) && (tempRid.recnum == recId.recnum)){
-						printf("Btr_recInsert failed(looking for fitting place): duplicate value with duplicate record ID \n");
-						return AME_DUPLICATERECID;
-					}
-
-					/* if duplicate attribute is TRUE, continue */
-					if (bhdr->duplicate == TRUE){
-						continue;
-					} else {
-						/* otherwise, split for duplicate values */
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-							return err;
-						}
-						if ((err = Btr_recSplit(AM_fd, value, recId, adr, TRUE)) != AME_OK){
-							printf("Btr_recInsert failed: Btr_recSplit for duplicate values at node %d\n", adr.pagenum);
-							return err;
-						}
-						return AME_OK;
-					}
-
-				} else if (res == BTR_GT) {
-					/* current node is for duplicate values but 'value' is bigger */
-					if (bhdr->duplicate == TRUE){
-						/* find current leaf node's NEXT node */
-						if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-							printf("Btr_recInsert failed: obtaining NEXT ptr of current leaf node\n");
-							return err;
-						}
+				}
+				i++;
+			}
+			if (PF_UnpinPage(ait[AM_fd].pfd, leaf.pagenum, i > first) != PFE_OK) {
+				err = AME_PF;
+				break;
+			}
+		} else if (err != AME_EOF) {
+			break;
+		}
 
-						/* assign a new node with this value inserted */
-						if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, NODE_PARENT, amhdr->maxKeys, &tempRid_par)) != AME_OK){
-							printf("Btr_recInsert failed: obtaining PARENT ptr of current leaf node\n");
-							return err;
-						}
-						/* retrieving node information */
-						if ((err = Btr_getNode(&pbuf_par, AM_fd, tempRid_par)) != AME_OK){
-							printf("Btr_recInsert failed: Btr_getNode for parent node\n");
-							return err;
-						}
+		/* the value the leaf could not take goes through the usual path */
+		if (i == first) {
+			ait[AM_fd].depth = 0;
+			if (Btr_recInsert(AM_fd, value, recIds[order[i]], amhdr->root) != AME_OK) {
+				printf("AM_InsertEntries failed: Btr_recInsert\n");
+				err = AME_PF;
+				break;
+			}
+			i++;
+		}
+		err = AME_OK;
+	}
 
-						/* assign a new node, adjust links */
-						if ((err = Btr_assignNode(ait[AM_fd].pfd, NODE_LEAF, amhdr->attrLength, amhdr->maxKeys, &newNode, &pbuf_new, tempRid_par)) != AME_OK){
-							printf("Btr_recInsert failed: assigning a new leaf node\n");
-							return err;
-						}
-						bhdr_new = (BtrHdr *)pbuf_new;
-						amhdr->numNodes++;
-						ait[AM_fd].hdrchanged = TRUE;
+	free(bound);
+	free(order);
+	if (err != AME_OK) {
+		return err;
+	}
+	return AM_Commit(AM_fd);
+}
 
-						/* adjust links between leaf nodes */
-						adr.recnum = NODE_NULLPTR;
-						if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &adr)) != AME_OK){
-							printf("Btr_recInsert failed: setting PREV ptr of new node\n");
-							return err;
-						}
+/* length of the keys of the entries sorted by AM_BulkLoad() */
+int Btr_loadLength;
 
-						if ((err = Btr_setPtr(&pbuf_new, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_nbr)) != AME_OK){
-							printf("Btr_recSplit failed: setting NEXT ptr of new node\n");
-							return err;
-						}
+/*
+	compares two entries of AM_BulkLoad() by their values, then by their record ids
+	called by qsort() in AM_BulkLoad()
 
-						tempRid_new.pagenum = newNode;
-						tempRid_new.recnum = NODE_NULLPTR;
+	*** parameters ***
+	const void * a - points to an entry, its value followed by its record id
+	const void * b - points to another entry
 
-						if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-							printf("Btr_recSplit failed: setting NEXT ptr of new leaf node\n");
-							return err;
-						}
+	*** return values ***
+	negative, zero or positive as the entry at a comes before, with or after the one at b
+*/
+int Btr_loadComp(const void * a, const void * b){
+	RECID x, y;
+	int res;
 
-						if (tempRid_nbr.pagenum != NODE_NULLPTR){
-							if ((err = Btr_getNode(&pbuf_nbr, AM_fd, tempRid_nbr)) != AME_OK){
-								printf("Btr_recSplit failed: Btr_getNode for neighboring leaf node\n");
-								return err;
-							}
+	res = Btr_compare(Btr_sortFd, (char *) a, (char *) b);
+	if (res != BTR_EQ){
+		return res;
+	}
+	memcpy(&x, (const char *) a + Btr_loadLength, sizeof(RECID));
+	memcpy(&y, (const char *) b + Btr_loadLength, sizeof(RECID));
+	if (x.pagenum != y.pagenum){
+		return (x.pagenum > y.pagenum) - (x.pagenum < y.pagenum);
+	}
+	return (x.recnum > y.recnum) - (x.recnum < y.recnum);
+}
 
-							if ((err = Btr_setPtr(&pbuf_nbr, NODE_LEAF, amhdr->attrLength, LEAFIDX_PREV, amhdr->maxKeys, &tempRid_new)) != AME_OK){
-								printf("Btr_recSplit failed: setting PREV ptr of neighboring leaf node\n");
-								return err;
-							}
-						}
+/*
+	builds the B+ tree of an empty index from the records of a heap file, from the leaves up
+	the (value, record id) entries are sorted in runs that fit in AM_LOADMEM bytes;
+	runs but the last one are written to temporary files and merged.
+	leaf nodes are filled left to right, and each one's first value goes up to the level above,
+	so that every node is written once and pages are allocated in order
 
-						/* insert value in the new node */
-						if ((err = Btr_recInsert(AM_fd, value, recId, tempRid_new)) != AME_OK){
-							printf("Btr_recInsert failed: inserting new value in new leaf node\n");
-							return err;
-						}
-						bhdr_new->entries++;
-						amhdr->numRecs++;
-						ait[AM_fd].hdrchanged = TRUE;
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	int HFfd - file descriptor of the heap file the index is on
+	int attrOffset - offset of the indexed attribute in the records, not used for an index of several attributes
+	int fillFactor - percentage of a node's room filled, from 1 to 100
 
-						/* copy up the value with key toward the new node */
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_par.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-							return err;
-						}
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, tempRid_nbr.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-							return err;
-						}
-						if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-							printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-							return err;
-						}
-						tempRid_new.recnum = NODE_INTNULL;
-						if ((err = Btr_recSplit(AM_fd, value, tempRid_new, tempRid_par, FALSE)) != AME_OK){
-							printf("Btr_recInsert failed: copying up the value with ptr to the new leaf node\n");
-							return err;
-						}
-						return AME_OK;
-					}
+	*** return values ***
+	AME_OK if successful
+	AME_NOTEMPTY if the index already has entries
+	error codes (< 0) if a problem occurred
+*/
+int AM_BulkLoad(int AM_fd, int HFfd, int attrOffset, int fillFactor){
+	AMhdr_str * amhdr;
+	Btr_loader ld;
+	HFview view;
+	RECID recId;
+	FILE ** runs = NULL;
+	FILE ** grown;
+	char * buf = NULL;
+	char * heads = NULL;
+	int entlen, runCap, nruns = 0, n, i, best, sd, err = AME_OK;
+
+	if ((AM_fd < 0) || (AM_fd >= AM_itab_size) || (ait[AM_fd].valid != TRUE)) {
+		printf("AM_BulkLoad failed: given AM_fd invalid\n");
+		return AME_INVALIDPARA;
+	}
+	if ((fillFactor < 1) || (fillFactor > 100)) {
+		return AME_INVALIDPARA;
+	}
+	amhdr = &(ait[AM_fd].hdr);
+	if (amhdr->numRecs != 0) {
+		printf("AM_BulkLoad failed: the index is not empty\n");
+		return AME_NOTEMPTY;
+	}
+	/* a hash index takes the records in the order they come, the fill factor being for B+ trees */
+	if (amhdr->method == AM_METHOD_HASH) {
+		if ((err = Hash_load(AM_fd, HFfd, attrOffset)) != AME_OK) {
+			printf("AM_BulkLoad failed: %d\n", err);
+			return err;
+		}
+		return AM_Commit(AM_fd);
+	}
 
-					/* scan further */
-					continue;
-				}
+	entlen = amhdr->attrLength + sizeof(RECID);
+	runCap = AM_LOADMEM / entlen;
+	if ((buf = (char *) malloc(runCap * entlen)) == NULL) {
+		return AME_NOMEM;
+	}
+	if ((sd = HF_OpenFileScan(HFfd, amhdr->attrType, amhdr->attrLength, attrOffset, EQ_OP, NULL)) < 0) {
+		free(buf);
+		return AME_PF;
+	}
+	Btr_sortFd = AM_fd;
+	Btr_loadLength = amhdr->attrLength;
+
+	/* sorted runs, written out while there are more entries than fit in memory */
+	n = 0;
+	recId = HF_FindNextView(sd, &view);
+	while (1) {
+		if ((n == runCap) || !HF_ValidRecId(HFfd, recId)) {
+			qsort(buf, n, entlen, Btr_loadComp);
+			if (!HF_ValidRecId(HFfd, recId) && (nruns == 0)) {
+				break;
 			}
-			/* moving entries that are bigger than 'value' */
-			if (i < entries){
-				for (j = 0; j < entries - i; j++){
-					/*
-					   copy from (entries - (j+1)) th entry to (entries - j) th entry
-					   j = 0 to (entries - i - 1) : (entries - 1)th to (entries - 0), ..., i th to i+1 th
-					*/
-					if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, entries - (j+1), amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recInsert failed: retrieving %d th ptr of current leaf node\n", entries - (j+1));
-						return err;
-					}
-					if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, entries - (j+1), amhdr->maxKeys, tempValue)) != AME_OK){
-						printf("Btr_recInsert failed: retrieving %d th value of current leaf node\n", entries - (j+1));
-						return err;
-					}
-					if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, entries - j, amhdr->maxKeys, &tempRid)) != AME_OK){
-						printf("Btr_recInsert failed: moving %d th ptr of current leaf node right\n", entries - (j+1));
-						return err;
-					}
-					if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, entries - j, amhdr->maxKeys, tempValue)) != AME_OK){
-						printf("Btr_recInsert failed: moving %d th value of current leaf node right\n", entries - (j+1));
-						return err;
-					}
-				}
+			if ((grown = (FILE **) realloc(runs, (nruns + 1) * sizeof(FILE *))) == NULL) {
+				err = AME_NOMEM;
+				break;
 			}
-
-			/* inserting value, with determined 'i' value */
-			if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &recId)) != AME_OK){
-				printf("Btr_recInsert failed: inserting new ptr at %d th entry\n", i);
-				return err;
+			runs = grown;
+			if ((runs[nruns] = tmpfile()) == NULL) {
+				err = AME_UNIX;
+				break;
 			}
-			if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, value)) != AME_OK){
-				printf("Btr_recInsert failed: inserting new key at %d th entry\n", i);
-				return err;
+			if ((n > 0) && ((int) fwrite(buf, entlen, n, runs[nruns]) != n)) {
+				fclose(runs[nruns]);
+				err = AME_UNIX;
+				break;
 			}
-			printf("Btr_recInsert: new value %s inserted at %d of pagenum %d\n", value, i, adr.pagenum);
+			rewind(runs[nruns++]);
+			n = 0;
+			if (!HF_ValidRecId(HFfd, recId)) {
+				break;
+			}
+		}
+		AM_makeValue(amhdr, view.record, attrOffset, buf + n * entlen);
+		memcpy(buf + n * entlen + amhdr->attrLength, &recId, sizeof(RECID));
+		n++;
+		if (HF_ReleaseView(&view) != HFE_OK) {
+			err = AME_PF;
+			break;
+		}
+		recId = HF_FindNextView(sd, &view);
+	}
+	if ((HF_CloseFileScan(sd) != HFE_OK) && (err == AME_OK)) {
+		err = AME_PF;
+	}
+	if ((err == AME_OK) && (nruns > 0) && ((heads = (char *) malloc(nruns * entlen)) == NULL)) {
+		err = AME_NOMEM;
+	}
 
-			/* updating 'entries' of the leaf node and header's 'numRecs' */
-			entries++;
-			amhdr->numRecs++;
-			ait[AM_fd].hdrchanged = TRUE;
-			bhdr->entries = entries;
+	ld.leaf = NULL;
+	ld.last = NULL;
+	if (err == AME_OK) {
+		err = Btr_loadStart(&ld, AM_fd, fillFactor);
+	}
 
-			if ((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-				printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-				return err;
+	if ((err == AME_OK) && (nruns == 0)) {
+		for (i = 0; (i < n) && (err == AME_OK); i++) {
+			memcpy(&recId, buf + i * entlen + amhdr->attrLength, sizeof(RECID));
+			err = Btr_loadEntry(&ld, buf + i * entlen, recId);
+		}
+	} else if (err == AME_OK) {
+		/* the runs are merged, taking the smallest head entry each time; runs run dry are closed */
+		for (i = 0; i < nruns; i++) {
+			if (fread(heads + i * entlen, entlen, 1, runs[i]) != 1) {
+				fclose(runs[i]);
+				runs[i] = NULL;
 			}
-			return AME_OK;
 		}
-	} /* at internal node */
-	else {
-		printf("Btr_recInsert: at internal\n");
-		if (entries > amhdr->maxKeys){
-			printf("Btr_recInsert failed: entries more than maxKeys(internal node)??\n");
-			return AME_PF;
-		} /* node is empty */
-		else if (entries == 0) {
-			/* fill the entry with this key, go to the right child */
-
-			if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->attrLength, 0, amhdr->maxKeys, value)) != AME_OK){
-				printf("Btr_recInsert failed: filling in an empty node with a key\n");
-				return err;
+		while (err == AME_OK) {
+			best = -1;
+			for (i = 0; i < nruns; i++) {
+				if ((runs[i] != NULL) && ((best < 0) || (Btr_loadComp(heads + i * entlen, heads + best * entlen) < 0))) {
+					best = i;
+				}
 			}
-
-			entries++;
-			bhdr->entries = entries;
-
-			if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-				printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-				return err;
+			if (best < 0) {
+				break;
 			}
-			/* receiving pointer information */
-			printf("Btr_recInsert: adr before: pagenum %d, recnum %d\n", adr.pagenum, adr.recnum);
-			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, 1, amhdr->maxKeys, &adr)) != AME_OK){
-				printf("Btr_recInsert failed: Btr_getPtr of right child at an empty internal node\n");
-				return err;
+			memcpy(&recId, heads + best * entlen + amhdr->attrLength, sizeof(RECID));
+			err = Btr_loadEntry(&ld, heads + best * entlen, recId);
+			if (fread(heads + best * entlen, entlen, 1, runs[best]) != 1) {
+				fclose(runs[best]);
+				runs[best] = NULL;
 			}
-			printf("Btr_recInsert: adr updated: pagenum %d, recnum %d\n", adr.pagenum, adr.recnum);
-
-			return Btr_recInsert(AM_fd, value, recId, adr);
-		} /* node is not empty, find the way */
-		else {
-			/* looking for a place to fit */
-			for (i = 0; i < entries; i++){
-				if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recInsert failed(looking for fitting place): retrieving %d th value of current internal node\n", i);
-					return err;
-				}
+		}
+	}
 
-				if ((res = Btr_valComp(value, tempValue, amhdr->attrType, amhdr->attrLength)) == BTR_LT){
-					/* found way, get out of this for loop */
-					break;
-				} else if (res == BTR_EQ) {
-					/* duplicate keys? - no need to worry, problems are dealt with at the leaf node level */
-					continue;
-				} else if (res == BTR_GT) {
-					/* scan further */
-					continue;
-				}
-			}
+	err = Btr_loadEnd(&ld, err);
 
-			/* checking whether the inserted value is from actual record or a key for internal nodes */
-			if (recId.recnum == NODE_NULLPTR){
-				printf("Btr_recInsert failed: recId.recnum < 0 and recnum == NODE_NULLPTR?\n");
-				return AME_PF;
-			}
-			if (recId.recnum == NODE_INTNULL){
-				printf("Btr_recInsert: adding an entry at INTERNAL NODE\n");
-				/* moving entries that are bigger than 'value', with ptrs on the RIGHT, not left */
-				if (i < entries){
-					for (j = 0; j < entries - i; j++){
-						if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, (entries - j), amhdr->maxKeys, &tempRid)) != AME_OK){
-							printf("Btr_recInsert failed: retrieving %d th ptr of current internal node\n", entries - j);
-							return err;
-						}
-						if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->attrLength, (entries - (j+1)), amhdr->maxKeys, tempValue)) != AME_OK){
-							printf("Btr_recInsert failed: retrieving %d th value of current internal node\n", entries - (j+1));
-							return err;
-						}
-						if ((err = Btr_setPtr(&pbuf, NODE_INT, amhdr->attrLength, (entries - j + 1), amhdr->maxKeys, &tempRid)) != AME_OK){
-							printf("Btr_recInsert failed: moving %d th ptr of current internal node right\n", entries - j);
-							return err;
-						}
-						if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->attrLength, (entries - j), amhdr->maxKeys, tempValue)) != AME_OK){
-							printf("Btr_recInsert failed: moving %d th value of current internal node right\n", entries - (j+1));
-							return err;
-						}
-					}
-				}
-				printf("Btr_recInsert: adding an entry at INTERNAL NODE, about to add an entry\n");
-				if ((err = Btr_setPtr(&pbuf, NODE_INT, amhdr->attrLength, (i+1), amhdr->maxKeys, &recId)) != AME_OK){
-					printf("Btr_recInsert failed: inserting new ptr(on the right) at %d th entry\n", j);
-					return err;
-				}
-				if ((err = Btr_setKey(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, value)) != AME_OK){
-					printf("Btr_recInsert failed: inserting new key at %d th entry\n", j);
-					return err;
-				}
-				entries++;
-				bhdr->entries = entries;
-				if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-					return err;
-				}
-				printf("Btr_recInsert: adding an entry at INTERNAL NODE ended\n");
-				return AME_OK;
-			} /* the inserted value is from actual record. proceed to child nodes */
-			else {
-				if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
-					printf("Btr_recInsert failed: PF_UnpinPage of adr\n");
-					return err;
-				}
-				/* receiving pointer information */
-				if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, &adr)) != AME_OK){
-					printf("Btr_recInsert failed: receiving pointer for a child at a nonempty internal node\n");
-					return err;
-				}
-				printf("adr updated: pagenum %d, recnum %d\n", adr.pagenum, adr.recnum);
+	for (i = 0; i < nruns; i++) {
+		if (runs[i] != NULL) {
+			fclose(runs[i]);
+		}
+	}
+	free(runs);
+	free(heads);
+	free(buf);
+	if (err != AME_OK) {
+		printf("AM_BulkLoad failed: %d\n", err);
+		return err;
+	}
+	return AM_Commit(AM_fd);
+}
 
-				return Btr_recInsert(AM_fd, value, recId, adr);
-			}
+/*
+	moves the positions of the scans in a leaf node along with the entries moved
+
+	*** parameters ***
+	int AM_fd - file descriptor of the AM index table
+	int pagenum - page number of the leaf node
+	int from - index of the first entry moved, -1 to take the scans before the first entry as well
+	int to - index past the last entry moved
+	int newPage - page number of the leaf node the entries are moved to
+	int shift - number added to the indexes of the entries moved
+
+	*** return values ***
+	void
+*/
+void Btr_leafMoveScans(int AM_fd, int pagenum, int from, int to, int newPage, int shift){
+	int j;
+
+	for (j = 0; j < AM_stab_size; j++){
+		if ((ast[j].valid == TRUE) && (ast[j].fd == AM_fd) && (ast[j].currentNode.pagenum == pagenum)
+			&& (ast[j].currentNode.recnum >= from) && (ast[j].currentNode.recnum < to)){
+			ast[j].currentNode.pagenum = newPage;
+			ast[j].currentNode.recnum += shift;
 		}
 	}
-	return AME_PF;
 }
 
-
 /*
-	inserts the specified value in the B+ tree
+	keeps a node at least BTR_MINKEYS full after a deletion, recursively called up the path
+	the node borrows an entry from its neighbor under the same parent, or is merged with it when the two fit in one node,
+	the right one of the two being disposed of; a root left with a single child gives its place to the child.
+	two leaf nodes under a root with a single key are not merged, as the root must keep a key
 
 	*** parameters ***
 	int AM_fd - file descriptor of the AM index table
-	char * value - points to the value to be inserted in B+ tree
-	RECID recId - record id of the value to be inserted
+	char * value - points to the value deleted, which leads to the node from its parent
+	RECID adr - pointer to the node
+	int level - position of the node's parent in the path of the AM index table, -1 if the node is the root
 
 	*** return values ***
 	AME_OK if successful
 	error codes (< 0) if a problem occurred
 */
-int AM_InsertEntry(int AM_fd, char *value, RECID recId) {
-	int err;
-	
-	if (ait[AM_fd].valid != TRUE) {
-		printf("AM_InsertEntry failed: given AM_fd invalid\n");
-		return AME_INVALIDPARA;
+int Btr_rebalance(int AM_fd, char * value, RECID adr, int level){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
+	int pfd = ait[AM_fd].pfd;
+	int entlen = sizeof(RECID) + amhdr->keyLength;
+	char * pbuf, * pbuf_par, * pbuf_nbr, * pbuf_l, * pbuf_r;
+	char * base_l, * base_r, * sep;
+	char * key_l, * key_r;
+	BtrHdr * bhdr_par, * bhdr_l, * bhdr_r;
+	RECID par, nbr, next, left, right, rid_empty;
+	int i, s, nl, nr, leaf, err;
+
+	if (level < 0){
+		return AME_OK;
 	}
-
-	/* search begins at root node */
-	if ((err = Btr_recInsert(AM_fd, value, recId, ait[AM_fd].hdr.root)) != AME_OK) {
-		printf("AM_InsertEntry failed: Btr_recInsert\n");
+	if ((err = Btr_getNode(&pbuf, AM_fd, adr)) != AME_OK){
+		printf("Btr_rebalance failed: Btr_getNode\n");
+		return err;
+	}
+	if (((BtrHdr *) pbuf)->entries >= BTR_MINKEYS(amhdr->maxKeys)){
+		return (PF_UnpinPage(pfd, adr.pagenum, FALSE) == PFE_OK) ? AME_OK : AME_PF;
+	}
+	Btr_dropNodes(AM_fd);
+
+	/* the node's place in its parent, found by the value as on the way down */
+	par.pagenum = ait[AM_fd].path[level];
+	par.recnum = NODE_INTNULL;
+	if ((err = Btr_getNode(&pbuf_par, AM_fd, par)) != AME_OK){
+		printf("Btr_rebalance failed: Btr_getNode of parent\n");
+		PF_UnpinPage(pfd, adr.pagenum, FALSE);
+		return err;
+	}
+	bhdr_par = (BtrHdr *) pbuf_par;
+	i = Btr_search(pbuf_par, NODE_INT, AM_fd, value, TRUE);
+	Btr_getPtr(&pbuf_par, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, &nbr);
+	if ((bhdr_par->entries == 0) || (nbr.pagenum != adr.pagenum)){
+		printf("Btr_rebalance failed: node %d not found in its parent %d\n", adr.pagenum, par.pagenum);
+		PF_UnpinPage(pfd, par.pagenum, FALSE);
+		PF_UnpinPage(pfd, adr.pagenum, FALSE);
 		return AME_PF;
 	}
 
-	return AME_OK;
+	/* the neighbor on the left, or on the right for the first child; 's' is the key between the two */
+	s = (i > 0) ? i - 1 : 0;
+	Btr_getPtr(&pbuf_par, NODE_INT, amhdr->keyLength, (i > 0) ? i - 1 : 1, amhdr->maxKeys, &nbr);
+	if ((err = Btr_getNode(&pbuf_nbr, AM_fd, nbr)) != AME_OK){
+		printf("Btr_rebalance failed: Btr_getNode of neighbor\n");
+		PF_UnpinPage(pfd, par.pagenum, FALSE);
+		PF_UnpinPage(pfd, adr.pagenum, FALSE);
+		return err;
+	}
+	if (i > 0){
+		left = nbr;
+		right = adr;
+		pbuf_l = pbuf_nbr;
+		pbuf_r = pbuf;
+	} else {
+		left = adr;
+		right = nbr;
+		pbuf_l = pbuf;
+		pbuf_r = pbuf_nbr;
+	}
+	bhdr_l = (BtrHdr *) pbuf_l;
+	bhdr_r = (BtrHdr *) pbuf_r;
+	nl = bhdr_l->entries;
+	nr = bhdr_r->entries;
+	leaf = (Btr_isLeaf(pbuf) == TRUE);
+	base_l = pbuf_l + sizeof(BtrHdr) + (leaf ? sizeof(RECID) : 0);
+	base_r = pbuf_r + sizeof(BtrHdr) + (leaf ? sizeof(RECID) : 0);
+	sep = pbuf_par + sizeof(BtrHdr) + s * entlen + sizeof(RECID);
+	rid_empty.pagenum = NODE_NULLPTR;
+	rid_empty.recnum = leaf ? NODE_NULLPTR : NODE_INTNULL;
+
+	if ((nl + nr + (leaf ? 0 : 1) <= amhdr->maxKeys) && !(leaf && (level == 0) && (bhdr_par->entries == 1))){
+		/* merging: the right node's entries are appended to the left one, with the key between them if internal */
+		if (leaf){
+			memcpy(base_l + nl * entlen, base_r, nr * entlen);
+			Btr_leafMoveScans(AM_fd, right.pagenum, -1, amhdr->maxKeys, left.pagenum, nl);
+
+			/* the NEXT pointer of the right node goes to the left one, and the node after it points back to the left one */
+			memcpy(&next, base_r + amhdr->maxKeys * entlen, sizeof(RECID));
+			memcpy(base_l + amhdr->maxKeys * entlen, &next, sizeof(RECID));
+			if (next.pagenum != NODE_NULLPTR){
+				if ((err = Btr_getNode(&pbuf_nbr, AM_fd, next)) != AME_OK){
+					printf("Btr_rebalance failed: Btr_getNode of NEXT neighbor\n");
+					return err;
+				}
+				nbr.pagenum = left.pagenum;
+				nbr.recnum = NODE_NULLPTR;
+				Btr_setPtr(&pbuf_nbr, NODE_LEAF, amhdr->keyLength, LEAFIDX_PREV, amhdr->maxKeys, &nbr);
+				if (PF_UnpinPage(pfd, next.pagenum, TRUE) != PFE_OK){
+					return AME_PF;
+				}
+			}
+			bhdr_l->entries = nl + nr;
+		} else {
+			memcpy(base_l + nl * entlen + sizeof(RECID), sep, amhdr->keyLength);
+			memcpy(base_l + (nl + 1) * entlen, base_r, nr * entlen + sizeof(RECID));
+			bhdr_l->entries = nl + nr + 1;
+		}
+
+		/* the key between the two and the pointer to the right node leave the parent */
+		memmove(sep, sep + entlen, (bhdr_par->entries - s - 1) * entlen);
+		bhdr_par->entries--;
+		memset(pbuf_par + sizeof(BtrHdr) + bhdr_par->entries * entlen + sizeof(RECID), 0, amhdr->keyLength);
+		rid_empty.recnum = NODE_INTNULL;
+		memcpy(pbuf_par + sizeof(BtrHdr) + (bhdr_par->entries + 1) * entlen, &rid_empty, sizeof(RECID));
+
+		/* a page the free page map cannot record is merely left unused */
+		if ((PF_UnpinPage(pfd, right.pagenum, FALSE) != PFE_OK) || (PF_UnpinPage(pfd, left.pagenum, TRUE) != PFE_OK)
+			|| (((err = PF_DisposePage(pfd, right.pagenum)) != PFE_OK) && (err != PFE_FREEMAPFULL))){
+			PF_UnpinPage(pfd, par.pagenum, TRUE);
+			return AME_PF;
+		}
+		amhdr->numNodes--;
+		ait[AM_fd].hdrchanged = TRUE;
+
+		/* a root left with no key has the merged node as its only child, which becomes the root */
+		if ((level == 0) && (bhdr_par->entries == 0)){
+			amhdr->root.pagenum = left.pagenum;
+			if ((PF_UnpinPage(pfd, par.pagenum, FALSE) != PFE_OK)
+				|| (((err = PF_DisposePage(pfd, par.pagenum)) != PFE_OK) && (err != PFE_FREEMAPFULL))){
+				return AME_PF;
+			}
+			amhdr->numNodes--;
+			return AME_OK;
+		}
+		if (PF_UnpinPage(pfd, par.pagenum, TRUE) != PFE_OK){
+			return AME_PF;
+		}
+		return Btr_rebalance(AM_fd, value, par, level - 1);
+	}
+
+	if (((i > 0) ? nl : nr) > BTR_MINKEYS(amhdr->maxKeys)){
+		/* borrowing: the entry next to the node moves over from the neighbor */
+		if (leaf && (i > 0)){
+			memmove(base_r + entlen, base_r, nr * entlen);
+			memcpy(base_r, base_l + (nl - 1) * entlen, entlen);
+			memcpy(base_l + (nl - 1) * entlen, &rid_empty, sizeof(RECID));
+			memset(base_l + (nl - 1) * entlen + sizeof(RECID), 0, amhdr->keyLength);
+			Btr_leafMoveScans(AM_fd, right.pagenum, -1, amhdr->maxKeys, right.pagenum, 1);
+			Btr_leafMoveScans(AM_fd, left.pagenum, nl - 1, amhdr->maxKeys, right.pagenum, 1 - nl);
+			nl--;
+			nr++;
+		} else if (leaf){
+			memcpy(base_l + nl * entlen, base_r, entlen);
+			memmove(base_r, base_r + entlen, (nr - 1) * entlen);
+			memcpy(base_r + (nr - 1) * entlen, &rid_empty, sizeof(RECID));
+			memset(base_r + (nr - 1) * entlen + sizeof(RECID), 0, amhdr->keyLength);
+			Btr_leafMoveScans(AM_fd, right.pagenum, -1, 1, left.pagenum, nl);
+			Btr_leafMoveScans(AM_fd, right.pagenum, 1, amhdr->maxKeys, right.pagenum, -1);
+			nl++;
+			nr--;
+		} else if (i > 0){
+			/* the parent's key comes down to the node, the neighbor's last key goes up in its place */
+			memmove(base_r + entlen, base_r, nr * entlen + sizeof(RECID));
+			memcpy(base_r, base_l + nl * entlen, sizeof(RECID));
+			memcpy(base_r + sizeof(RECID), sep, amhdr->keyLength);
+			memcpy(sep, base_l + (nl - 1) * entlen + sizeof(RECID), amhdr->keyLength);
+			memset(base_l + (nl - 1) * entlen + sizeof(RECID), 0, amhdr->keyLength);
+			memcpy(base_l + nl * entlen, &rid_empty, sizeof(RECID));
+			nl--;
+			nr++;
+		} else {
+			/* the parent's key comes down to the node, the neighbor's first key goes up in its place */
+			memcpy(base_l + nl * entlen + sizeof(RECID), sep, amhdr->keyLength);
+			memcpy(base_l + (nl + 1) * entlen, base_r, sizeof(RECID));
+			memcpy(sep, base_r + sizeof(RECID), amhdr->keyLength);
+			memmove(base_r, base_r + entlen, (nr - 1) * entlen + sizeof(RECID));
+			memset(base_r + (nr - 1) * entlen + sizeof(RECID), 0, amhdr->keyLength);
+			memcpy(base_r + nr * entlen, &rid_empty, sizeof(RECID));
+			nl++;
+			nr--;
+		}
+		bhdr_l->entries = nl;
+		bhdr_r->entries = nr;
+
+		/* leaf nodes are separated anew by the first value on the right, cut short */
+		if (leaf){
+			key_l = (char *) calloc(amhdr->attrLength, sizeof(char));
+			key_r = (char *) calloc(amhdr->attrLength, sizeof(char));
+			if ((key_l == NULL) || (key_r == NULL)){
+				free(key_l);
+				free(key_r);
+				err = AME_NOMEM;
+			} else {
+				memcpy(key_l, base_l + (nl - 1) * entlen + sizeof(RECID), amhdr->keyLength);
+				memcpy(key_r, base_r + sizeof(RECID), amhdr->keyLength);
+				Btr_separator(AM_fd, key_l, key_r, key_r);
+				memcpy(sep, key_r, amhdr->keyLength);
+				free(key_l);
+				free(key_r);
+			}
+		}
+	}
+
+	if ((PF_UnpinPage(pfd, left.pagenum, TRUE) != PFE_OK) || (PF_UnpinPage(pfd, right.pagenum, TRUE) != PFE_OK)
+		|| (PF_UnpinPage(pfd, par.pagenum, TRUE) != PFE_OK)){
+		return AME_PF;
+	}
+	return err;
 }
 
 /*
 	deletes the specified value in the B+ tree
+	recursively called, recording the internal nodes gone through in the path of the AM index table as Btr_recInsert() does
 
 	*** parameters ***
 	int AM_fd - file descriptor of the AM index table
@@ -2191,69 +4408,79 @@ int Btr_recDelete(int AM_fd, char * value, RECID recId, RECID adr){
 			printf("Btr_recDelete failed: entries more than maxKeys??\n");
 			return AME_PF;
 		} else {
-			/* looking for the given entry */
-			for (i = 0; i < entries; i++){
-				if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
+			/* looking for the given entry, from the first key not smaller */
+			res = BTR_GT;
+			for (i = Btr_search(pbuf, NODE_LEAF, AM_fd, value, FALSE); i < entries; i++){
+				if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
 					printf("Btr_recDelete failed(looking for value): retrieving %d th value of current leaf node\n", i);
 					return err;
 				}
 
-				if ((res = Btr_valComp(value, tempValue, amhdr->attrType, amhdr->attrLength)) == BTR_LT){
+				if ((res = Btr_compare(AM_fd, value, tempValue)) == BTR_LT){
 					/* failed to find the value?? */
-					printf("Btr_recDelete failed: given value not found at a the leaf node?\n");
-					return AME_KEYNOTFOUND;
+					break;
 				} else if (res == BTR_EQ) {
 					/* check if recId is also the same */
-					/* if recId is different (when not DUPLICATE), raise error */
-					if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
+					/* if recId is different, raise error */
+					if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
 						printf("Btr_recDelete failed(looking for value): retrieving record ID \n");
 						return err;
 					}
+					/* a key with a posting list loses the record id from it, and the entry goes with the last one */
+					if (tempRid.recnum == NODE_POSTING){
+						if ((err = Btr_postRemove(AM_fd, tempRid.pagenum, recId)) == AME_EOF){
+							tempRid = recId;
+						} else {
+							if (err == AME_OK){
+								amhdr->numRecs--;
+								ait[AM_fd].hdrchanged = TRUE;
+							}
+							if (PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, FALSE) != PFE_OK){
+								printf("Btr_recDelete failed: PF_UnpinPage of adr\n");
+								return AME_PF;
+							}
+							return err;
+						}
+					}
 					if ((tempRid.pagenum == recId.pagenum) && (tempRid.recnum == recId.recnum)){
-						/* If this node is the same as scan.currentNode and recId <= scan.currentNode, scan.currentNode.recnum--. */
-						for (j = 0; j < MAXISCANS; j++) {
+						/* If this node is the same as scan.currentNode and this entry is not after it, scan.currentNode.recnum--. */
+						for (j = 0; j < AM_stab_size; j++) {
 							if (ast[j].valid == FALSE) continue;
 
-							printf("compare recnum %d, %d / %d, %d / %d, %d\n", tempRid.pagenum, tempRid.recnum, ast[j].current.pagenum, ast[j].current.recnum, ast[j].currentNode.pagenum, ast[j].currentNode.recnum);
+							printf("compare recnum %d, %d / %d, %d\n", adr.pagenum, i, ast[j].currentNode.pagenum, ast[j].currentNode.recnum);
 
-							if (ast[j].fd == AM_fd && tempRid.pagenum == ast[j].current.pagenum && tempRid.recnum <= ast[j].current.recnum) {
+							if (ast[j].fd == AM_fd && ast[j].currentNode.pagenum == adr.pagenum && i <= ast[j].currentNode.recnum) {
 								printf("minus recnum by 1\n");
-								ast[j].current.recnum--;
 								ast[j].currentNode.recnum--;
-
-								if (ast[j].current.recnum < 0) ast[j].current.recnum = 0;
-								if (ast[j].currentNode.recnum < 0) ast[j].currentNode.recnum = 0;
 							}
 						}
 
 						/* delete this entry, pull latter entries one cell left */
+						/* the slot after the last entry of a full leaf is the NEXT pointer, which must be kept */
 						for (j = i; j < entries; j++){
-							if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, (j+1), amhdr->maxKeys, &tempRid)) != AME_OK){
-								printf("Btr_recDelete failed: retrieving %d th ptr of current leaf node\n", (j+1));
-								return err;
-							}
-							if (j < entries - 1){
-								if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, (j+1), amhdr->maxKeys, tempValue)) != AME_OK){
-									printf("Btr_recDelete failed: retrieving %d th value of current leaf node\n", (j+1));
-									return err;
-								}
-							}
-
-							if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, &tempRid)) != AME_OK){
-								printf("Btr_recDelete failed: moving %d th ptr of current leaf node left\n", j);
-								return err;
-							}
 							if (j == (entries - 1)){
-								if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, value_empty)) != AME_OK){
+								if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->keyLength, j, amhdr->maxKeys, value_empty)) != AME_OK){
 									printf("Btr_recDelete failed: deleting %d th value of current leaf node left\n", j);
 									return err;
 								}
-								if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->attrLength, (j+1), amhdr->maxKeys, &rid_empty)) != AME_OK){
+								if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, j, amhdr->maxKeys, &rid_empty)) != AME_OK){
 									printf("Btr_recDelete failed: deleting %d th ptr of current leaf node left\n", j);
 									return err;
 								}
 							} else {
-								if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->attrLength, j, amhdr->maxKeys, tempValue)) != AME_OK){
+								if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, (j+1), amhdr->maxKeys, &tempRid)) != AME_OK){
+									printf("Btr_recDelete failed: retrieving %d th ptr of current leaf node\n", (j+1));
+									return err;
+								}
+								if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, (j+1), amhdr->maxKeys, tempValue)) != AME_OK){
+									printf("Btr_recDelete failed: retrieving %d th value of current leaf node\n", (j+1));
+									return err;
+								}
+								if ((err = Btr_setPtr(&pbuf, NODE_LEAF, amhdr->keyLength, j, amhdr->maxKeys, &tempRid)) != AME_OK){
+									printf("Btr_recDelete failed: moving %d th ptr of current leaf node left\n", j);
+									return err;
+								}
+								if ((err = Btr_setKey(&pbuf, NODE_LEAF, amhdr->keyLength, j, amhdr->maxKeys, tempValue)) != AME_OK){
 									printf("Btr_recDelete failed: moving %d th value of current leaf node left\n", j);
 									return err;
 								}
@@ -2266,9 +4493,8 @@ int Btr_recDelete(int AM_fd, char * value, RECID recId, RECID adr){
 							printf("cBtr_recDelete failed: PF_UnpinPage of adr\n");
 							return err;
 						}
-						return AME_OK;
-					} else if (bhdr->duplicate == TRUE){
-						continue;
+						/* a leaf node left less than half full borrows from or is merged with its neighbor */
+						return Btr_rebalance(AM_fd, value, adr, ait[AM_fd].depth - 1);
 					} else {
 						printf("Btr_recDelete failed(looking for value): value found, recId not matching\n");
 						if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
@@ -2285,18 +4511,12 @@ int Btr_recDelete(int AM_fd, char * value, RECID recId, RECID adr){
 			}
 
 			/* value not found, return error */
-			if ((res == BTR_EQ) && (bhdr->duplicate == TRUE)){
-				printf("Btr_recDelete failed: value found(duplicate), recId not matching\n");
-				return AME_RECNOTFOUND;
-			} else {
-				printf("Btr_recDelete failed: given value not found\n");
-				return AME_KEYNOTFOUND;
-			}
-			if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, TRUE)) != PFE_OK){
+			printf("Btr_recDelete failed: given value not found\n");
+			if((err = PF_UnpinPage(ait[AM_fd].pfd, adr.pagenum, FALSE)) != PFE_OK){
 				printf("aBtr_recDelete failed: PF_UnpinPage of adr\n");
 				return err;
 			}
-			return AME_OK;
+			return AME_KEYNOTFOUND;
 		}
 	} /* at internal node */
 	else {
@@ -2304,29 +4524,13 @@ int Btr_recDelete(int AM_fd, char * value, RECID recId, RECID adr){
 			printf("Btr_recDelete failed: entries more than maxKeys(internal node)??\n");
 			return AME_PF;
 		} else {
-			/* looking for a place to fit */
-			for (i = 0; i < entries; i++){
-				if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_recDelete failed(looking for fitting place): retrieving %d th value of current internal node\n", i);
-					return err;
-				}
-
-				if ((res = Btr_valComp(value, tempValue, amhdr->attrType, amhdr->attrLength)) == BTR_LT){
-					/* found way, get out of this for loop */
-					break;
-				} else if (res == BTR_EQ) {
-					/* scan further */
-					continue;
-				} else if (res == BTR_GT) {
-					/* scan further */
-					continue;
-				}
-			}
+			/* looking for a place to fit: the first key bigger than the value */
+			i = Btr_search(pbuf, NODE_INT, AM_fd, value, TRUE);
 			/* proceed to child nodes */
 			/* receiving pointer information */
 			tempRid2.pagenum = adr.pagenum;
 
-			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, &adr)) != AME_OK){
+			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, &adr)) != AME_OK){
 				printf("Btr_recDelete failed: receiving pointer for a child at a nonempty internal node\n");
 				return err;
 			}
@@ -2335,6 +4539,9 @@ int Btr_recDelete(int AM_fd, char * value, RECID recId, RECID adr){
 				printf("bBtr_recDelete failed: PF_UnpinPage of adr\n");
 				return err;
 			}
+			if ((err = Btr_pushPath(AM_fd, tempRid2)) != AME_OK){
+				return err;
+			}
 
 			return Btr_recDelete(AM_fd, value, recId, adr);
 		}
@@ -2362,13 +4569,22 @@ int AM_DeleteEntry(int AM_fd, char *value, RECID recId){
 		return AME_INVALIDPARA;
 	}
 
-	/* search begins at root node */
+	if (ait[AM_fd].hdr.method == AM_METHOD_HASH){
+		if ((err = Hash_delete(AM_fd, value, recId)) != AME_OK){
+			printf("AM_DeleteEntry failed: Hash_delete\n");
+			return err;
+		}
+		return AM_Commit(AM_fd);
+	}
+
+	/* search begins at root node, with an empty path */
+	ait[AM_fd].depth = 0;
 	if ((err = Btr_recDelete(AM_fd, value, recId, ait[AM_fd].hdr.root)) != AME_OK){
 		printf("AM_DeleteEntry failed: Btr_recDelete\n");
 		return err;
 	}
 
-	return AME_OK;
+	return AM_Commit(AM_fd);
 }
 
 /*
@@ -2381,7 +4597,7 @@ int AM_DeleteEntry(int AM_fd, char *value, RECID recId){
 
 	*** return values ***
 	RECID of the given value if successful
-	RECID containing NODE_NULLPTR(-1) if a problem occurred
+	RECID containing NODE_NULLPTR(-1) if the tree is empty, AMerrno set to AME_EOF, or a problem occurred
 */
 RECID Btr_getFirstValue(int fd, char ** record, RECID * nodeAdr){
 	int err;
@@ -2398,32 +4614,32 @@ RECID Btr_getFirstValue(int fd, char ** record, RECID * nodeAdr){
 	res.pagenum = NODE_NULLPTR;
 	res.recnum = NODE_NULLPTR;
 	/* retrieving root node information */
-	if ((err = Btr_getNode(&pbuf, fd, amhdr->root)) != AME_OK){
-		printf("Btr_getFirstValue failed: Btr_getNode\n");
+	if ((err = Btr_readNode(&pbuf, fd, amhdr->root)) != AME_OK){
+		printf("Btr_getFirstValue failed: Btr_readNode\n");
 		return res;
 	}
 	bhdr = (BtrHdr *) pbuf;
 
-	if((err = PF_UnpinPage(ait[fd].pfd, amhdr->root.pagenum, TRUE)) != PFE_OK){
+	if((err = Btr_releaseNode(fd, amhdr->root, pbuf)) != AME_OK){
 		printf("Btr_getFirstValue failed: PF_UnpinPage of root\n");
 		return res;
 	}
 	tempRid.pagenum = NODE_NULLPTR;
 	while(Btr_isLeaf(pbuf) != TRUE){
 		if (tempRid.pagenum != NODE_NULLPTR){
-			if((err = PF_UnpinPage(ait[fd].pfd, tempRid.pagenum, TRUE)) != PFE_OK){
+			if((err = Btr_releaseNode(fd, tempRid, pbuf)) != AME_OK){
 				printf("Btr_getFirstValue failed: PF_UnpinPage of root\n");
 				return res;
 			}
 		}
 		/* proceed to leftmost child nodes */
-		if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
+		if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
 			printf("Btr_getFirstValue failed: receiving pointer to a leftmost child node\n");
 			return res;
 		}
 
-		if ((err = Btr_getNode(&pbuf, fd, tempRid)) != AME_OK){
-			printf("Btr_getFirstValue failed: Btr_getNode to a leftmost child node\n");
+		if ((err = Btr_readNode(&pbuf, fd, tempRid)) != AME_OK){
+			printf("Btr_getFirstValue failed: Btr_readNode to a leftmost child node\n");
 			return res;
 		}
 	}
@@ -2434,15 +4650,15 @@ RECID Btr_getFirstValue(int fd, char ** record, RECID * nodeAdr){
 			nodeAdr->pagenum = tempRid.pagenum;
 			nodeAdr->recnum = 0;
 			/* retrieve the first value and pointer, since it is the smallest and first record */
-			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
+			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
 				printf("Btr_getFirstValue failed: receiving pointer of leaf node\n");
 				return res;
 			}
-			if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, *record)) != AME_OK){
+			if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, 0, amhdr->maxKeys, *record)) != AME_OK){
 				printf("Btr_getFirstValue failed: receiving key of leaf node\n");
 				return res;
 			}
-			if((err = PF_UnpinPage(ait[fd].pfd, nodeAdr->pagenum, TRUE)) != PFE_OK){
+			if((err = PF_UnpinPage(ait[fd].pfd, nodeAdr->pagenum, FALSE)) != PFE_OK){
 				printf("Btr_getFirstValue failed: PF_UnpinPage of root\n");
 				return res;
 			}
@@ -2451,18 +4667,19 @@ RECID Btr_getFirstValue(int fd, char ** record, RECID * nodeAdr){
 		} else {
 			tempRid2.pagenum = tempRid.pagenum;
 			tempRid2.recnum = tempRid.recnum;
-			if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, TRUE)) != PFE_OK){
+			if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, FALSE)) != PFE_OK){
 				printf("Btr_getFirstValue failed: PF_UnpinPage of leaf\n");
 				return res;
 			}
 			/* retrieve pointer to the NEXT leaf node, check validity */
-			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid)) != AME_OK){
+			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid)) != AME_OK){
 				printf("Btr_getFirstValue failed: receiving pointer to NEXT leaf node\n");
 				return res;
 			}
 			if (tempRid.pagenum == NODE_NULLPTR){
 				/* current leaf node is the last one, failed finding the first value */
 				printf("Btr_getFirstValue failed: entire B+ tree is empty\n");
+				AMerrno = AME_EOF;
 				return res;
 			} else {
 				/* move to the NEXT leaf node */
@@ -2505,11 +4722,12 @@ RECID Btr_getThisValue(int fd, RECID recId, char * record_in){
 	res.recnum = NODE_NULLPTR;
 
 	/* retrieving root node information */
-	if ((err = Btr_getNode(&pbuf, fd, amhdr->root)) != AME_OK){
-		printf("Btr_getThisValue failed: Btr_getNode\n");
+	if ((err = Btr_readNode(&pbuf, fd, amhdr->root)) != AME_OK){
+		printf("Btr_getThisValue failed: Btr_readNode\n");
 		return res;
 	}
 	bhdr = (BtrHdr *) pbuf;
+	tempRid = amhdr->root;
 
 	while(Btr_isLeaf(pbuf) != TRUE){
 
@@ -2520,56 +4738,41 @@ RECID Btr_getThisValue(int fd, RECID recId, char * record_in){
 			printf("Btr_getThisValue failed: entries more than maxKeys(internal node)??\n");
 			return res;
 		} else {
-			/* looking for a place to fit */
-			for (i = 0; i < entries; i++){
-				if ((err = Btr_getKey(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
-					printf("Btr_getThisValue failed(looking for fitting place): retrieving %d th value of current internal node\n", i);
-					return res;
-				}
-
-				if ((result = Btr_valComp(record_in, tempValue, amhdr->attrType, amhdr->attrLength)) == BTR_LT){
-					/* found way, get out of this for loop */
-					break;
-				} else if (result == BTR_EQ) {
-					/* scan further */
-					continue;
-				} else if (result == BTR_GT) {
-					/* scan further */
-					continue;
-				}
-			}
+			/* looking for a place to fit: the first key bigger than the value */
+			i = Btr_search(pbuf, NODE_INT, fd, record_in, TRUE);
 			/* proceed to child nodes */
 			/* receiving pointer information */
 			tempRid2.pagenum = tempRid.pagenum;
 			tempRid2.recnum = tempRid.recnum;
 
-			if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, TRUE)) != PFE_OK){
+			if((err = Btr_releaseNode(fd, tempRid2, pbuf)) != AME_OK){
 				printf("Btr_getThisValue failed: PF_UnpinPage of leaf\n");
 				return res;
 			}
-			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->attrLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
+			if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
 				printf("Btr_getThisValue failed: receiving pointer for a child node\n");
 				return res;
 			}
-			if ((err = Btr_getNode(&pbuf, fd, tempRid)) != AME_OK){
-				printf("Btr_getThisValue failed: Btr_getNode to a child node\n");
+			if ((err = Btr_readNode(&pbuf, fd, tempRid)) != AME_OK){
+				printf("Btr_getThisValue failed: Btr_readNode to a child node\n");
 				return res;
 			}
 		}
 	}
-	/* leaf node found, look for the value */
-	for (i = 0; i < entries; i++){
-		if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
+	/* leaf node found, look for the value from the first key not smaller */
+	entries = ((BtrHdr *) pbuf)->entries;
+	for (i = Btr_search(pbuf, NODE_LEAF, fd, record_in, FALSE); i < entries; i++){
+		if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, tempValue)) != AME_OK){
 			printf("Btr_getThisValue failed(looking for fitting place): retrieving %d th value of current internal node\n", i);
 			return res;
 		}
 
-		if ((result = Btr_valComp(record_in, tempValue, amhdr->attrType, amhdr->attrLength)) == BTR_LT){
+		if ((result = Btr_compare(fd, record_in, tempValue)) == BTR_LT){
 			/* value not found, exit */
 			break;
 		} else if (result == BTR_EQ) {
 			/* check if recId also coincides */
-			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, i, amhdr->maxKeys, &tempRec)) != AME_OK){
+			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, &tempRec)) != AME_OK){
 				printf("Btr_getThisValue failed: receiving pointer for a record\n");
 				return res;
 			}
@@ -2577,7 +4780,7 @@ RECID Btr_getThisValue(int fd, RECID recId, char * record_in){
 				tempRid2.pagenum = tempRid.pagenum;
 				tempRid2.recnum = tempRid.recnum;
 
-				if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, TRUE)) != PFE_OK){
+				if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, FALSE)) != PFE_OK){
 					printf("Btr_getThisValue failed: PF_UnpinPage of leaf\n");
 					return res;
 				}
@@ -2608,7 +4811,7 @@ RECID Btr_getThisValue(int fd, RECID recId, char * record_in){
 
 	*** return value ***
 	RECID of the next value if successful
-	RECID containing NODE_NULLPTR(-1) if a problem occurred
+	RECID containing NODE_NULLPTR(-1) if there is no next value, AMerrno set to AME_EOF, or a problem occurred
 */
 RECID Btr_getNextValue(int fd, char ** record_out, RECID * nodeAdr){
 	int err, i, j, entries;
@@ -2637,11 +4840,11 @@ RECID Btr_getNextValue(int fd, char ** record_out, RECID * nodeAdr){
 
 	/* another value in the same leaf node */
 	if (tempRid.recnum + 1 < bhdr->entries){
-		if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, tempRid.recnum + 1, amhdr->maxKeys, *record_out)) != AME_OK){
+		if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, tempRid.recnum + 1, amhdr->maxKeys, *record_out)) != AME_OK){
 			printf("Btr_getNextValue failed: retrieving %d th value of current leaf node\n", tempRid.recnum + 1);
 			return res;
 		}
-		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, tempRid.recnum + 1, amhdr->maxKeys, &tempRec)) != AME_OK){
+		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, tempRid.recnum + 1, amhdr->maxKeys, &tempRec)) != AME_OK){
 			printf("Btr_getNextValue failed: receiving pointer for a record\n");
 			return res;
 		}
@@ -2649,7 +4852,7 @@ RECID Btr_getNextValue(int fd, char ** record_out, RECID * nodeAdr){
 		tempRid2.pagenum = tempRid.pagenum;
 		tempRid2.recnum = tempRid.recnum;
 
-		if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, TRUE)) != PFE_OK){
+		if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, FALSE)) != PFE_OK){
 			printf("aBtr_getNextValue failed: PF_UnpinPage of leaf\n");
 			return res;
 		}
@@ -2661,18 +4864,19 @@ RECID Btr_getNextValue(int fd, char ** record_out, RECID * nodeAdr){
 		tempRid2.pagenum = tempRid.pagenum;
 		tempRid2.recnum = tempRid.recnum;
 
-		if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, TRUE)) != PFE_OK){
+		if((err = PF_UnpinPage(ait[fd].pfd, tempRid2.pagenum, FALSE)) != PFE_OK){
 			printf("bBtr_getNextValue failed: PF_UnpinPage of leaf\n");
 			return res;
 		}
 		/* retrieve pointer to the NEXT leaf node, check validity */
-		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid)) != AME_OK){
+		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid)) != AME_OK){
 			printf("Btr_getNextValue failed: receiving pointer to NEXT leaf node\n");
 			return res;
 		}
 		if (tempRid.pagenum == NODE_NULLPTR){
 			/* current leaf node is the last one, failed finding the first value */
 			printf("Btr_getNextValue failed: remaining B+ tree nodes are empty\n");
+			AMerrno = AME_EOF;
 			return res;
 		} else {
 
@@ -2688,15 +4892,15 @@ RECID Btr_getNextValue(int fd, char ** record_out, RECID * nodeAdr){
 			nodeAdr->pagenum = tempRid.pagenum;
 			nodeAdr->recnum = 0;
 			/* retrieve the first value and pointer, since it is the smallest and first record */
-			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
+			if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, 0, amhdr->maxKeys, &tempRid)) != AME_OK){
 				printf("Btr_getNextValue failed: receiving pointer of leaf node\n");
 				return res;
 			}
-			if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->attrLength, 0, amhdr->maxKeys, *record_out)) != AME_OK){
+			if ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, 0, amhdr->maxKeys, *record_out)) != AME_OK){
 				printf("Btr_getNextValue failed: receiving key of leaf node\n");
 				return res;
 			}
-			if((err = PF_UnpinPage(ait[fd].pfd, nodeAdr->pagenum, TRUE)) != PFE_OK){
+			if((err = PF_UnpinPage(ait[fd].pfd, nodeAdr->pagenum, FALSE)) != PFE_OK){
 				printf("cBtr_getNextValue failed: PF_UnpinPage of leaf\n");
 				return res;
 			}
@@ -2707,6 +4911,102 @@ RECID Btr_getNextValue(int fd, char ** record_out, RECID * nodeAdr){
 }
 
 
+/*
+	finds the first value in the B+ tree which is not smaller than (or, if strict, bigger than) the given value
+	the descent goes right on keys equal to the given value, as each value is kept once, right of the keys not bigger
+
+	*** parameters ***
+	int fd - file descriptor for the AM index table
+	char * value - value to seek
+	bool_t strict - TRUE if the value found must be bigger than the given value
+	char ** record - address of the space where the value found will be written at
+	RECID * nodeAdr - position of the value found in the B+ tree
+
+	*** return values ***
+	RECID of the value found if successful
+	RECID containing NODE_NULLPTR(-1) if there is no such value, AMerrno set to AME_EOF, or a problem occurred
+*/
+RECID Btr_seekValue(int fd, char * value, bool_t strict, char ** record, RECID * nodeAdr){
+	int err, i, entries;
+
+	RECID tempRid;
+	RECID tempRec;
+	RECID res;
+
+	char * pbuf;
+	AMhdr_str * amhdr = &(ait[fd].hdr);
+
+	res.pagenum = NODE_NULLPTR;
+	res.recnum = NODE_NULLPTR;
+
+	/* retrieving root node information */
+	tempRid = amhdr->root;
+	if ((err = Btr_readNode(&pbuf, fd, tempRid)) != AME_OK){
+		printf("Btr_seekValue failed: Btr_readNode\n");
+		return res;
+	}
+
+	/* the internal nodes on the way are mostly read from memory, the leaf from the buffer pool */
+	while (Btr_isLeaf(pbuf) != TRUE){
+		/* the first key bigger than the value leads the way */
+		i = Btr_search(pbuf, NODE_INT, fd, value, TRUE);
+
+		if((err = Btr_releaseNode(fd, tempRid, pbuf)) != AME_OK){
+			printf("Btr_seekValue failed: PF_UnpinPage of internal node\n");
+			return res;
+		}
+		if ((err = Btr_getPtr(&pbuf, NODE_INT, amhdr->keyLength, i, amhdr->maxKeys, &tempRid)) != AME_OK){
+			printf("Btr_seekValue failed: receiving pointer for a child node\n");
+			return res;
+		}
+		if ((err = Btr_readNode(&pbuf, fd, tempRid)) != AME_OK){
+			printf("Btr_seekValue failed: Btr_readNode to a child node\n");
+			return res;
+		}
+	}
+
+	/* at leaf node, look for the value, moving on to the NEXT leaf nodes if needed */
+	while (TRUE){
+		entries = ((BtrHdr *) pbuf)->entries;
+		i = Btr_search(pbuf, NODE_LEAF, fd, value, strict);
+
+		if (i < entries){
+			if (((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, &tempRec)) != AME_OK)
+				|| ((err = Btr_getKey(&pbuf, NODE_LEAF, amhdr->keyLength, i, amhdr->maxKeys, *record)) != AME_OK)){
+				printf("Btr_seekValue failed: receiving the entry found\n");
+				tempRec = res;
+			}
+			nodeAdr->pagenum = tempRid.pagenum;
+			nodeAdr->recnum = i;
+			if((err = PF_UnpinPage(ait[fd].pfd, tempRid.pagenum, FALSE)) != PFE_OK){
+				printf("Btr_seekValue failed: PF_UnpinPage of leaf\n");
+				tempRec = res;
+			}
+			return tempRec;
+		}
+
+		if((err = PF_UnpinPage(ait[fd].pfd, tempRid.pagenum, FALSE)) != PFE_OK){
+			printf("Btr_seekValue failed: PF_UnpinPage of leaf\n");
+			break;
+		}
+		/* retrieve pointer to the NEXT leaf node, check validity */
+		if ((err = Btr_getPtr(&pbuf, NODE_LEAF, amhdr->keyLength, LEAFIDX_NEXT, amhdr->maxKeys, &tempRid)) != AME_OK){
+			printf("Btr_seekValue failed: receiving pointer to NEXT leaf node\n");
+			break;
+		}
+		if (tempRid.pagenum == NODE_NULLPTR){
+			/* current leaf node is the last one, no such value */
+			AMerrno = AME_EOF;
+			break;
+		}
+		if ((err = Btr_getNode(&pbuf, fd, tempRid)) != AME_OK){
+			printf("Btr_seekValue failed: Btr_getNode to NEXT leaf node\n");
+			break;
+		}
+	}
+	return res;
+}
+
 /*
 	opens an AM scan table entry for a scan
 
@@ -2717,25 +5017,73 @@ RECID Btr_getNextValue(int fd, char ** record_out, RECID * nodeAdr){
 
 	*** return values ***
 	index of the AM scan table entry if successful
-	AME_SCANTABLEFULL if AM scan table is already full
+	AME_SCANTABLEFULL if AM scan table is full and cannot grow
 */
 int AM_OpenIndexScan(int AM_fd, int op, char *value){
+	return AM_OpenIndexScanAttrs(AM_fd, op, value, ait[AM_fd].hdr.nkeys);
+}
+
+/*
+	opens an AM scan table entry for a scan comparing the first key attributes of the entries only:
+	'value' gives the first 'nmatch' attributes, and the entries are compared with it
+	as their first 'nmatch' attributes are, one after another
+
+	*** parameters ***
+	int AM_fd - file descriptor for the AM index table
+	int op - comparison operator
+	char * value - value for comparison, its first 'nmatch' attributes only being read
+	int nmatch - number of key attributes compared, from 1 to all of them
+
+	*** return values ***
+	index of the AM scan table entry if successful
+	AME_INVALIDPARA if nmatch is not valid
+	AME_INVALIDOP if a hash index is to be scanned with another operator than EQ_OP on the whole key
+	AME_SCANTABLEFULL if AM scan table is full and cannot grow
+*/
+int AM_OpenIndexScanAttrs(int AM_fd, int op, char *value, int nmatch){
+	AMhdr_str * amhdr = &(ait[AM_fd].hdr);
 	int asd;
 
-	for (asd = 0; asd < MAXISCANS; asd++) {
-		if (ast[asd].valid == FALSE) {
-			ast[asd].valid = TRUE;
-			ast[asd].fd = AM_fd;
-			ast[asd].attrType = ait[AM_fd].hdr.attrType;
-			ast[asd].attrLength = ait[AM_fd].hdr.attrLength;
-			ast[asd].op = op;
-			ast[asd].value = value;
-			ast[asd].current.pagenum = AME_SCANOPEN;
-			ast[asd].current.recnum = AME_SCANOPEN;
-			return asd;
+	if ((nmatch < 1) || (nmatch > amhdr->nkeys)) {
+		return AME_INVALIDPARA;
+	}
+	/* a hash index only finds the entries equal to a whole key */
+	if ((ait[AM_fd].hdr.method == AM_METHOD_HASH) && ((op != EQ_OP) || (value == NULL) || (nmatch < amhdr->nkeys))) {
+		return AME_INVALIDOP;
+	}
+	if (AM_nfreesd == 0 && AM_GrowSTable() != AME_OK) {
+		return AME_SCANTABLEFULL;
+	}
+	asd = AM_freesd[--AM_nfreesd];
+
+	if ((ast[asd].found = (char *) malloc(amhdr->attrLength)) == NULL){
+		AM_freesd[AM_nfreesd++] = asd;
+		return AME_NOMEM;
+	}
+	/* a B+ tree scan on some of the attributes starts where the others are lowest, or highest past the value */
+	if ((amhdr->nattrs > 1) && (value != NULL) && (amhdr->method == AM_METHOD_BTREE)){
+		if ((ast[asd].seek = (char *) malloc(amhdr->attrLength)) == NULL){
+			free(ast[asd].found);
+			ast[asd].found = NULL;
+			AM_freesd[AM_nfreesd++] = asd;
+			return AME_NOMEM;
 		}
+		AM_padValue(amhdr, value, nmatch, op == GT_OP, ast[asd].seek);
 	}
-	return AME_SCANTABLEFULL;
+
+	ast[asd].valid = TRUE;
+	ast[asd].fd = AM_fd;
+	ast[asd].attrType = ait[AM_fd].hdr.attrType;
+	ast[asd].attrLength = ait[AM_fd].hdr.attrLength;
+	ast[asd].comp = ait[AM_fd].comp;
+	ast[asd].op = op;
+	ast[asd].value = value;
+	ast[asd].nmatch = nmatch;
+	ast[asd].current.pagenum = AME_SCANOPEN;
+	ast[asd].current.recnum = AME_SCANOPEN;
+	ast[asd].currentNode.pagenum = NODE_NULLPTR;
+	ast[asd].post.pagenum = NODE_NULLPTR;
+	return asd;
 }
 
 /*
@@ -2746,49 +5094,95 @@ int AM_OpenIndexScan(int AM_fd, int op, char *value){
 
 	*** return values ***
 	RECID of the next entry if successful
-	RECID containing NODE_NULLPTR(-1) if a problem occurred
+	RECID containing NODE_NULLPTR(-1) if there is no more entry or a problem occurred, AMerrno telling which
 */
 RECID AM_FindNextEntry(int scanDesc){
-	RECID recid = ast[scanDesc].current;
-	int op = ast[scanDesc].op;
-	char* value = ast[scanDesc].value;
-	char* record = (char *)calloc(ast[scanDesc].attrLength, sizeof(char));
-	char* record_temp = (char *)calloc(ast[scanDesc].attrLength, sizeof(char));
+	RECID recid;
+	int op;
+	char* value;
+	char* record;
+	char* record_temp;
 	int match = 0;
+	int result = BTR_EQ;
 
 	RECID rec_err;
-	RECID nodeAdr = ast[scanDesc].currentNode;
+	RECID nodeAdr;
 	rec_err.pagenum = NODE_NULLPTR;
 	rec_err.recnum = NODE_NULLPTR;
 
+	if (scanDesc < 0 || scanDesc >= AM_stab_size || ast[scanDesc].valid == FALSE){
+		AMerrno = AME_INVALIDSCANDESC;
+		return rec_err;
+	}
+	recid = ast[scanDesc].current;
+	op = ast[scanDesc].op;
+	value = ast[scanDesc].value;
+	nodeAdr = ast[scanDesc].currentNode;
+
+	if (ait[ast[scanDesc].fd].hdr.method == AM_METHOD_HASH) {
+		return Hash_findNext(scanDesc);
+	}
+	record = (char *)calloc(ast[scanDesc].attrLength, sizeof(char));
+	record_temp = (char *)calloc(ast[scanDesc].attrLength, sizeof(char));
+	if (record == NULL || record_temp == NULL){
+		free(record);
+		free(record_temp);
+		AMerrno = AME_NOMEM;
+		return rec_err;
+	}
+
+	/* the rest of the posting list of the current value comes first */
+	if (ast[scanDesc].post.pagenum != NODE_NULLPTR) {
+		recid = Btr_postNext(ast[scanDesc].fd, &(ast[scanDesc].post));
+		if (recid.pagenum != NODE_NULLPTR) {
+			ast[scanDesc].current = recid;
+			return recid;
+		}
+		recid = ast[scanDesc].current;
+	}
+
 	while(!match) {
 		printf("getNextValue: %d, %d / %d, %d\n", recid.pagenum, recid.recnum, nodeAdr.pagenum, nodeAdr.recnum);
 
+		if (recid.pagenum == AME_EOF) {
+			/* the scan already went past its bound */
+			AMerrno = AME_EOF;
+			return rec_err;
+		}
+
+		/* the B+ tree functions below tell the end of the tree with AME_EOF, any other problem leaves AME_PF */
+		AMerrno = AME_PF;
 		if (recid.pagenum == AME_SCANOPEN && recid.recnum == AME_SCANOPEN) {
-			recid = Btr_getFirstValue(ast[scanDesc].fd, &record, &nodeAdr);
+			/* EQ, GE and GT scans start at the first value to qualify */
+			if (value != NULL && (op == EQ_OP || op == GE_OP || op == GT_OP)) {
+				recid = Btr_seekValue(ast[scanDesc].fd, (ast[scanDesc].seek != NULL) ? ast[scanDesc].seek : value, op == GT_OP, &record, &nodeAdr);
+			} else {
+				recid = Btr_getFirstValue(ast[scanDesc].fd, &record, &nodeAdr);
+			}
 		}
 		else {
 			/* copy from record to record_temp */
 			if (memcpy(record_temp, record, ast[scanDesc].attrLength) == NULL){
 				printf("AM_FindNextEntry failed: memcpy from record to record_temp\n");
+				AMerrno = AME_UNIX;
 				return rec_err;
 			}
 			/* reset record */
 			if (memset(record, 0, ast[scanDesc].attrLength) == NULL){
 				printf("AM_FindNextEntry failed: memset to 'record'\n");
+				AMerrno = AME_UNIX;
 				return rec_err;
 			}
 			recid = Btr_getNextValue(ast[scanDesc].fd, &record, &nodeAdr);
 		}
 
-		if (recid.pagenum == -1) {
-			AMerrno = AME_EOF;
-			return recid;
+		if (recid.pagenum == NODE_NULLPTR) {
+			return rec_err;
 		}
 
 		if(value == NULL) match = 1;
-		else if (ast[scanDesc].attrType == 'c'){
-			int result = strncmp(record, value, ast[scanDesc].attrLength);
+		else {
+			result = AM_scanComp(scanDesc, record);
 
 			if (op == 1) match = result == 0;
 			else if (op == 2) match = result < 0;
@@ -2796,42 +5190,88 @@ RECID AM_FindNextEntry(int scanDesc){
 			else if (op == 4) match = result <= 0;
 			else if (op == 5) match = result >= 0;
 			else if (op == 6) match = result != 0;
-			else return rec_err;
-		} else if (ast[scanDesc].attrType == 'i'){
-
-			int src, dst;
-			if (memcpy(&src, record, ast[scanDesc].attrLength) == NULL || memcpy(&dst, value, ast[scanDesc].attrLength) == NULL) {
-                return rec_err;
-            }
-
-			if (op == 1) match = src == dst;
-			else if (op == 2) match = src < dst;
-            else if (op == 3) match = src > dst;
-            else if (op == 4) match = src <= dst;
-            else if (op == 5) match = src >= dst;
-            else if (op == 6) match = src != dst;
-            else return rec_err;
-		} else if (ast[scanDesc].attrType == 'f'){
-			float src, dst;
-			if (memcpy(&src, record, ast[scanDesc].attrLength) == NULL || memcpy(&dst, value, ast[scanDesc].attrLength) == NULL) {
-                return rec_err;
-            }
-
-			if (op == 1) match = src == dst;
-            else if (op == 2) match = src < dst;
-            else if (op == 3) match = src > dst;
-            else if (op == 4) match = src <= dst;
-            else if (op == 5) match = src >= dst;
-            else if (op == 6) match = src != dst;
-            else return rec_err;
-		} else return rec_err;
+			else {
+				AMerrno = AME_INVALIDOP;
+				return rec_err;
+			}
+		}
+
+		/* values come in order, so EQ, LT and LE scans end at the first value past the bound */
+		if (!match && value != NULL && (op == EQ_OP || op == LT_OP || op == LE_OP) && result != BTR_LT) {
+			ast[scanDesc].current.pagenum = AME_EOF;
+			ast[scanDesc].current.recnum = AME_EOF;
+			AMerrno = AME_EOF;
+			return rec_err;
+		}
+	}
+
+	/* a value with several record ids gives the first one of its posting list */
+	if (recid.recnum == NODE_POSTING) {
+		ast[scanDesc].post.pagenum = recid.pagenum;
+		ast[scanDesc].post.recnum = -1;
+		if ((recid = Btr_postNext(ast[scanDesc].fd, &(ast[scanDesc].post))).pagenum == NODE_NULLPTR) {
+			AMerrno = AME_PF;
+			return rec_err;
+		}
 	}
 
+	memcpy(ast[scanDesc].found, record, ast[scanDesc].attrLength);
 	ast[scanDesc].current = recid;
 	ast[scanDesc].currentNode = nodeAdr;
 	return recid;
 }
 
+/*
+	finds the next entry of a scan, and gives back its value,
+	so that the attributes kept in an index of several attributes can be read without the records
+
+	*** parameters ***
+	int scanDesc - scan descriptor of the index
+	char * value - points to where the value of the entry is written, as long as the index's values
+
+	*** return values ***
+	RECID of the next entry if successful
+	RECID containing NODE_NULLPTR(-1) if there is no more entry or a problem occurred, AMerrno telling which
+*/
+RECID AM_FindNextEntryValue(int scanDesc, char *value){
+	RECID recid = AM_FindNextEntry(scanDesc);
+
+	if (recid.pagenum != NODE_NULLPTR){
+		memcpy(value, ast[scanDesc].found, ast[scanDesc].attrLength);
+	}
+	return recid;
+}
+
+/*
+	finds the next entries of a scan, a batch at a time
+	the record ids come in the order of the index; HF_GetRecs() sorts them by page
+	and reads each page of the heap file once for all the records on it
+
+	*** parameters ***
+	int scanDesc - scan descriptor of the index
+	RECID * recIds - points to where the record ids of the entries found are written
+	int n - most number of entries found
+
+	*** return values ***
+	number of entries found, less than n once the scan is over
+	error codes (< 0) if a problem occurred
+*/
+int AM_FindNextEntries(int scanDesc, RECID * recIds, int n){
+	int i;
+
+	if (scanDesc < 0 || scanDesc >= AM_stab_size || ast[scanDesc].valid == FALSE){
+		return AME_INVALIDSCANDESC;
+	}
+	for (i = 0; i < n; i++){
+		recIds[i] = AM_FindNextEntry(scanDesc);
+		/* AM_FindNextEntry() sets AMerrno whenever it finds no entry */
+		if (recIds[i].pagenum == NODE_NULLPTR){
+			return (AMerrno == AME_EOF) ? i : AMerrno;
+		}
+	}
+	return n;
+}
+
 /*
 	closes the specified scan
 
@@ -2840,9 +5280,19 @@ RECID AM_FindNextEntry(int scanDesc){
 
 	*** return values ***
 	AME_OK when closing is finished
+	AME_INVALIDSCANDESC if the scan is not open
 */
 int AM_CloseIndexScan(int scanDesc){
+	if (scanDesc < 0 || scanDesc >= AM_stab_size || ast[scanDesc].valid == FALSE){
+		return AME_INVALIDSCANDESC;
+	}
+
 	ast[scanDesc].valid = FALSE;
+	free(ast[scanDesc].seek);
+	free(ast[scanDesc].found);
+	ast[scanDesc].seek = NULL;
+	ast[scanDesc].found = NULL;
+	AM_freesd[AM_nfreesd++] = scanDesc;
 	return AME_OK;
 }
 
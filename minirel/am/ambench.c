@@ -0,0 +1,154 @@
+/*
+ * Measures the latency of index lookups against the fan-out of the B+ tree.
+ * The fan-out of a node is set by the key length, so an index is built for
+ * each key length with the same number of keys, and equality lookups of
+ * random keys are timed on it.
+ *
+ * usage: ambench [number of keys [number of lookups]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "minirel.h"
+#include "pf.h"
+#include "hf.h"
+#include "am.h"
+
+#define FILE1       "benchrel"
+#define NKEYS       20000
+#define NLOOKUPS    20000
+#define BATCH       256
+
+/* key lengths benchmarked, at least 7 for strings; 0 stands for INT keys */
+int keylens[] = {0, 8, 32, 128, 255};
+#define NKEYLENS    (sizeof(keylens) / sizeof(keylens[0]))
+
+
+/**********************************************************/
+/* makekey:                                               */
+/* Writes the i-th key of the given length at 'key', so  */
+/* that keys compare in the order of their numbers.       */
+/**********************************************************/
+void makekey(char *key, int len, int i)
+{
+   char digits[16];
+
+   if (len == 0) {
+      memcpy(key, &i, sizeof(int));
+   } else {
+      sprintf(digits, "%07d", i);
+      memset(key, 'k', len);
+      memcpy(key + len - 7, digits, 7);
+   }
+}
+
+
+/**********************************************************/
+/* bench:                                                 */
+/* Builds an index of 'nkeys' keys of the given length    */
+/* and times 'nlookups' equality lookups on it.           */
+/**********************************************************/
+void bench(int len, int nkeys, int nlookups)
+{
+   int am_fd, sd, i, j, n, found, keylen;
+   char files_to_delete[80];
+   char *keys;
+   RECID *recids, recid;
+   clock_t start;
+   double elapsed;
+
+   keylen = (len == 0) ? sizeof(int) : len;
+   keys = (char *) malloc(nkeys * keylen);
+   recids = (RECID *) malloc(nkeys * sizeof(RECID));
+   if (keys == NULL || recids == NULL) {
+      printf("out of memory\n");
+      exit(1);
+   }
+
+   sprintf(files_to_delete, "rm -f %s*", FILE1);
+   system(files_to_delete);
+
+   if (AM_CreateIndex(FILE1, 1, len == 0 ? INT_TYPE : STRING_TYPE, keylen, FALSE) != AME_OK) {
+      AM_PrintError("Problem creating index");
+      exit(1);
+   }
+   if ((am_fd = AM_OpenIndex(FILE1, 1)) < 0) {
+      AM_PrintError("Problem opening index");
+      exit(1);
+   }
+
+   /* keys are inserted in random order */
+   for (i = 0; i < nkeys; i++) {
+      recids[i].pagenum = i;
+      recids[i].recnum = 0;
+   }
+   for (i = nkeys - 1; i > 0; i--) {
+      j = rand() % (i + 1);
+      recid = recids[i];
+      recids[i] = recids[j];
+      recids[j] = recid;
+   }
+   for (i = 0; i < nkeys; i++) {
+      makekey(keys + i * keylen, len, recids[i].pagenum);
+   }
+   for (i = 0; i < nkeys; i += BATCH) {
+      n = (nkeys - i < BATCH) ? nkeys - i : BATCH;
+      if (AM_InsertEntries(am_fd, keys + i * keylen, recids + i, n) != AME_OK) {
+         AM_PrintError("Problem inserting keys");
+         exit(1);
+      }
+   }
+
+   start = clock();
+   for (i = 0; i < nlookups; i++) {
+      j = rand() % nkeys;
+      if ((sd = AM_OpenIndexScan(am_fd, EQ_OP, keys + j * keylen)) < 0) {
+         AM_PrintError("Problem opening scan");
+         exit(1);
+      }
+      found = 0;
+      while ((recid = AM_FindNextEntry(sd)).pagenum >= 0) {
+         found += (recid.pagenum == recids[j].pagenum);
+      }
+      AM_CloseIndexScan(sd);
+      if (found != 1) {
+         printf("key %d found %d times\n", recids[j].pagenum, found);
+         exit(1);
+      }
+   }
+   elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+   printf("%-8s %6d %8d %10.2f\n", len == 0 ? "int" : "string", keylen,
+          (int) (PAGE_SIZE / (sizeof(RECID) + keylen)), elapsed * 1e6 / nlookups);
+
+   if (AM_CloseIndex(am_fd) != AME_OK) {
+      AM_PrintError("Problem closing index");
+      exit(1);
+   }
+   if (AM_DestroyIndex(FILE1, 1) != AME_OK) {
+      AM_PrintError("Problem destroying index");
+      exit(1);
+   }
+   free(keys);
+   free(recids);
+}
+
+
+int main(int argc, char *argv[])
+{
+   int nkeys = (argc > 1) ? atoi(argv[1]) : NKEYS;
+   int nlookups = (argc > 2) ? atoi(argv[2]) : NLOOKUPS;
+   unsigned int i;
+
+   AM_Init();
+   srand(1);
+
+   printf("%d keys, %d lookups\n", nkeys, nlookups);
+   printf("%-8s %6s %8s %10s\n", "type", "length", "fan-out", "usec/lookup");
+   for (i = 0; i < NKEYLENS; i++) {
+      bench(keylens[i], nkeys, nlookups);
+   }
+   return 0;
+}
@@ -18,18 +18,26 @@
 
 #define FILE1       "testrel"
 #define STRSIZE     32
-#define TOTALTESTS  3
+#define FILE2       "testrelc"
+#define FILE3       "testrelb"
+#define RECSIZE     16
+#define NRECS       200
+#define TOTALTESTS  7
 
 /* prototypes for all of the test functions */
 
 void amtest1(void);
 void amtest2(void);
 void amtest3(void);
+void amtest4(void);
+void amtest5(void);
+void amtest6(void);
+void amtest7(void);
 void cleanup(void);
 
 /* array of pointers to all of the test functions (used by main) */
 
-void (*tests[])() = {amtest1, amtest2, amtest3, cleanup};
+void (*tests[])() = {amtest1, amtest2, amtest3, amtest4, amtest5, amtest6, amtest7, cleanup};
 
 
 /**********************************************************/
@@ -284,6 +292,606 @@ void amtest3()
    printf("***** end amtest3 *****\n");
 }
 
+/*******************************************************/
+/* amtest4:                                            */
+/* Inserts a long value in the B+ Tree of amtest1      */
+/* while an index scan is open: it goes in at once,    */
+/* behind the scan, which goes on to the end. A new    */
+/* scan finds it.                                      */
+/*******************************************************/
+void amtest4()
+{
+   int am_fd, hf_fd;
+   int sd, n;
+   RECID recid;
+   char comp_value[STRSIZE];
+   char long_value[STRSIZE];
+
+   printf("***** Start amtest4 *****\n");
+   /* using amtest1() to generate file and index */
+   amtest1();
+
+   if ((hf_fd = HF_OpenFile(FILE1)) < 0) {
+      HF_PrintError("Problem opening");
+      exit(1);
+   }
+   if ((am_fd = AM_OpenIndex(FILE1,1)) < 0) {
+      AM_PrintError("Problem opening index");
+      exit(1);
+   }
+
+   memset(comp_value, '\0', STRSIZE);
+   sprintf(comp_value, "entry500");
+   memset(long_value, '\0', STRSIZE);
+   sprintf(long_value, "entry500 and a longer value");
+   recid = HF_InsertRec(hf_fd, long_value);
+   if (!HF_ValidRecId(hf_fd,recid)){
+      HF_PrintError("Problem inserting record in HF file");
+      exit(1);
+   }
+
+   if ((sd = AM_OpenIndexScan(am_fd, GE_OP, comp_value)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   for (n = 0; n < 10; n++) {
+      if (!HF_ValidRecId(hf_fd,AM_FindNextEntry(sd))) {
+         AM_PrintError("Problem finding next entry");
+         exit(1);
+      }
+   }
+   printf("inserting the long value under the scan: %d\n", AM_InsertEntry(am_fd, long_value, recid));
+   while (HF_ValidRecId(hf_fd,AM_FindNextEntry(sd)))
+      n++;
+   if (AMerrno != AME_EOF) {
+      AM_PrintError("Problem finding next entry");
+      exit(1);
+   }
+   printf("%d entries scanned from %s\n", n, comp_value);
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+
+   if ((sd = AM_OpenIndexScan(am_fd, GE_OP, comp_value)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   n = 0;
+   while (HF_ValidRecId(hf_fd,AM_FindNextEntry(sd)))
+      n++;
+   if (AMerrno != AME_EOF) {
+      AM_PrintError("Problem finding next entry");
+      exit(1);
+   }
+   printf("%d entries scanned from %s after the insertion\n", n, comp_value);
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+
+   if (AM_CloseIndex(am_fd) != AME_OK) {
+      AM_PrintError("Problem closing index file");
+      exit(1);
+   }
+   if (HF_CloseFile(hf_fd) != HFE_OK) {
+      HF_PrintError("Problem closing HF file");
+      exit(1);
+   }
+
+   printf("***** end amtest4 *****\n");
+}
+
+/*******************************************************/
+/* count_equal:                                        */
+/* Counts the entries of an index equal to a value,    */
+/* checking that each one is a record of the HF file.  */
+/*******************************************************/
+int count_equal(int am_fd, int hf_fd, char *value)
+{
+   int sd, n = 0;
+   char retrieved_value[STRSIZE];
+   RECID recid;
+
+   if ((sd = AM_OpenIndexScan(am_fd, EQ_OP, value)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   while (1)
+   {
+      recid = AM_FindNextEntry(sd);
+      if (!HF_ValidRecId(hf_fd,recid))
+         if (AMerrno == AME_EOF) break;
+      else
+      {
+         AM_PrintError("Problem finding next entry");
+         exit(1);
+      }
+      if (HF_GetThisRec(hf_fd, recid, retrieved_value) != HFE_OK){
+         HF_PrintError("Problem retrieving record");
+         exit(1);
+      }
+      if (strcmp(retrieved_value, value) != 0) {
+         printf("scan for %s found %s\n", value, retrieved_value);
+         exit(1);
+      }
+      n++;
+   }
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+   return n;
+}
+
+/*******************************************************/
+/* amtest5:                                            */
+/* Loads a hash index on the file of amtest1, looks up */
+/* every value with an equality scan, then inserts and */
+/* deletes entries of one value, deleting them during  */
+/* an index scan.                                      */
+/*******************************************************/
+void amtest5()
+{
+   int am_fd, hf_fd;
+   int sd, value, found, missing;
+   RECID recid;
+   char comp_value[STRSIZE];
+   char retrieved_value[STRSIZE];
+
+   printf("***** Start amtest5 *****\n");
+   /* using amtest1() to generate file */
+   amtest1();
+
+   if ((hf_fd = HF_OpenFile(FILE1)) < 0) {
+      HF_PrintError("Problem opening");
+      exit(1);
+   }
+   if (AM_CreateIndexMethod(FILE1, 2, STRING_TYPE, STRSIZE, FALSE, AM_METHOD_HASH) != AME_OK) {
+      AM_PrintError("Problem creating");
+      exit(1);
+   }
+   if ((am_fd = AM_OpenIndex(FILE1,2)) < 0) {
+      AM_PrintError("Problem opening index");
+      exit(1);
+   }
+   if (AM_BulkLoad(am_fd, hf_fd, 0, AM_FILLFACTOR) != AME_OK) {
+      AM_PrintError("Problem loading");
+      exit(1);
+   }
+
+   /* every value of the file is found once, and no other one */
+   found = 0;
+   missing = 0;
+   for (value = 10; value < 1000; value++) {
+      memset(comp_value, '\0', STRSIZE);
+      sprintf(comp_value, "entry%d", value);
+      if (value % 2 == 0)
+         found += count_equal(am_fd, hf_fd, comp_value);
+      else
+         missing += count_equal(am_fd, hf_fd, comp_value);
+   }
+   printf("%d values found, %d values not in the file found\n", found, missing);
+
+   memset(comp_value, '\0', STRSIZE);
+   sprintf(comp_value, "entry700");
+   printf("opening a LT scan on the hash index: %d\n", AM_OpenIndexScan(am_fd, LT_OP, comp_value));
+
+   /* a second record of the same value */
+   recid = HF_InsertRec(hf_fd, comp_value);
+   if (!HF_ValidRecId(hf_fd,recid)){
+      HF_PrintError("Problem inserting record in HF file");
+      exit(1);
+   }
+   if (AM_InsertEntry(am_fd, comp_value, recid) != AME_OK) {
+      AM_PrintError("Problem Inserting rec");
+      exit(1);
+   }
+   printf("%d entries of %s\n", count_equal(am_fd, hf_fd, comp_value), comp_value);
+
+   /* deleting the entries of the value during an index scan */
+   if ((sd = AM_OpenIndexScan(am_fd, EQ_OP, comp_value)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   while (1)
+   {
+      memset(retrieved_value, ' ', STRSIZE);
+      recid = AM_FindNextEntry(sd);
+      if (!HF_ValidRecId(hf_fd,recid))
+         if (AMerrno == AME_EOF) break;
+      else
+      {
+         AM_PrintError("Problem finding next entry");
+         exit(1);
+      }
+      if (HF_GetThisRec(hf_fd, recid, retrieved_value) != HFE_OK){
+         HF_PrintError("Problem retrieving record");
+         exit(1);
+      }
+      if (AM_DeleteEntry(am_fd, retrieved_value, recid) != AME_OK) {
+         AM_PrintError("Problem deleting entry");
+         exit(1);
+      }
+      else
+         printf("DELETING entry %s\n", retrieved_value);
+   }
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+   printf("%d entries of %s after the deletions\n", count_equal(am_fd, hf_fd, comp_value), comp_value);
+
+   if (AM_CloseIndex(am_fd) != AME_OK) {
+      AM_PrintError("Problem closing index file");
+      exit(1);
+   }
+   if (HF_CloseFile(hf_fd) != HFE_OK) {
+      HF_PrintError("Problem closing HF file");
+      exit(1);
+   }
+
+   printf("***** end amtest5 *****\n");
+}
+
+/*******************************************************/
+/* scan_prefix:                                        */
+/* Scans the index of amtest6 on its first attribute   */
+/* only, checking that the entries come in order, that */
+/* they satisfy the predicate, and that their values   */
+/* are the records of the HF file.                     */
+/*******************************************************/
+int scan_prefix(int am_fd, int hf_fd, int op, int dept, bool_t print)
+{
+   int sd, n = 0, cmp;
+   int prev[2], cur[2];
+   char value[RECSIZE];
+   char record[RECSIZE];
+   RECID recid;
+
+   if ((sd = AM_OpenIndexScanAttrs(am_fd, op, (char *)&dept, 1)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   while (1)
+   {
+      recid = AM_FindNextEntryValue(sd, value);
+      if (!HF_ValidRecId(hf_fd,recid))
+         if (AMerrno == AME_EOF) break;
+      else
+      {
+         AM_PrintError("Problem finding next entry");
+         exit(1);
+      }
+      if (HF_GetThisRec(hf_fd, recid, record) != HFE_OK){
+         HF_PrintError("Problem retrieving record");
+         exit(1);
+      }
+      memcpy(cur, value, 2 * sizeof(int));
+      if (memcmp(value, record, RECSIZE) != 0) {
+         printf("entry (%d, %d) is not the value of its record\n", cur[0], cur[1]);
+         exit(1);
+      }
+      cmp = (cur[0] > dept) - (cur[0] < dept);
+      if ((op == EQ_OP && cmp != 0) || (op == LT_OP && cmp >= 0) || (op == GT_OP && cmp <= 0)
+          || (op == LE_OP && cmp > 0) || (op == GE_OP && cmp < 0) || (op == NE_OP && cmp == 0)) {
+         printf("entry (%d, %d) does not satisfy the scan on %d\n", cur[0], cur[1], dept);
+         exit(1);
+      }
+      if (n > 0 && (cur[0] < prev[0] || (cur[0] == prev[0] && cur[1] <= prev[1]))) {
+         printf("entry (%d, %d) out of order\n", cur[0], cur[1]);
+         exit(1);
+      }
+      if (print)
+         printf("the retrieved value is (%d, %d, %s)\n", cur[0], cur[1], value + 2 * sizeof(int));
+      memcpy(prev, cur, 2 * sizeof(int));
+      n++;
+   }
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+   return n;
+}
+
+/*******************************************************/
+/* amtest6:                                            */
+/* Builds a B+ Tree on two key attributes of records   */
+/* (dept, id), keeping a name with them, and scans it  */
+/* on the first attribute only with each operator.     */
+/*******************************************************/
+void amtest6()
+{
+   int am_fd, hf_fd;
+   int sd, i, n;
+   int key[2];
+   char record[RECSIZE];
+   char value[RECSIZE];
+   char files_to_delete[80];
+   AM_ATTRDESC attrs[3];
+   RECID recid;
+
+   printf("***** Start amtest6 *****\n");
+   sprintf(files_to_delete, "rm -f %s*", FILE2);
+   system(files_to_delete);
+
+   if (HF_CreateFile(FILE2, RECSIZE) != HFE_OK) {
+      HF_PrintError("Problem creating HF file");
+      exit(1);
+   }
+   if ((hf_fd = HF_OpenFile(FILE2)) < 0) {
+      HF_PrintError("Problem opening");
+      exit(1);
+   }
+
+   /* keys (dept, id), and the name kept with them */
+   attrs[0].attrType = INT_TYPE;
+   attrs[0].attrLength = sizeof(int);
+   attrs[0].attrOffset = 0;
+   attrs[1].attrType = INT_TYPE;
+   attrs[1].attrLength = sizeof(int);
+   attrs[1].attrOffset = sizeof(int);
+   attrs[2].attrType = STRING_TYPE;
+   attrs[2].attrLength = RECSIZE - 2 * sizeof(int);
+   attrs[2].attrOffset = 2 * sizeof(int);
+   if (AM_CreateIndexAttrs(FILE2, 1, 3, attrs, 2, AM_METHOD_BTREE) != AME_OK) {
+      AM_PrintError("Problem creating");
+      exit(1);
+   }
+   if ((am_fd = AM_OpenIndex(FILE2,1)) < 0) {
+      AM_PrintError("Problem opening index");
+      exit(1);
+   }
+
+   /* the records go in out of order, 10 of them per dept */
+   for (i = 0; i < NRECS; i++) {
+      memset(record, '\0', RECSIZE);
+      key[1] = (i * 37) % NRECS;
+      key[0] = key[1] / 10;
+      memcpy(record, key, 2 * sizeof(int));
+      sprintf(record + 2 * sizeof(int), "name%d", key[1]);
+      recid = HF_InsertRec(hf_fd, record);
+      if (!HF_ValidRecId(hf_fd,recid)){
+         HF_PrintError("Problem inserting record in HF file");
+         exit(1);
+      }
+      if (AM_MakeValue(am_fd, record, 0, value) != RECSIZE) {
+         AM_PrintError("Problem making value");
+         exit(1);
+      }
+      if (AM_InsertEntry(am_fd, value, recid) != AME_OK) {
+         AM_PrintError("Problem Inserting rec");
+         exit(1);
+      }
+   }
+
+   printf("%d entries with dept = 7\n", scan_prefix(am_fd, hf_fd, EQ_OP, 7, TRUE));
+   printf("%d entries with dept < 2\n", scan_prefix(am_fd, hf_fd, LT_OP, 2, FALSE));
+   printf("%d entries with dept <= 0\n", scan_prefix(am_fd, hf_fd, LE_OP, 0, FALSE));
+   printf("%d entries with dept > 17\n", scan_prefix(am_fd, hf_fd, GT_OP, 17, FALSE));
+   printf("%d entries with dept >= 19\n", scan_prefix(am_fd, hf_fd, GE_OP, 19, FALSE));
+   printf("%d entries with dept <> 5\n", scan_prefix(am_fd, hf_fd, NE_OP, 5, FALSE));
+   printf("%d entries with dept = 20\n", scan_prefix(am_fd, hf_fd, EQ_OP, 20, FALSE));
+
+   /* the whole key still finds one entry */
+   key[0] = 7;
+   key[1] = 73;
+   if ((sd = AM_OpenIndexScanAttrs(am_fd, EQ_OP, (char *)key, 2)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   n = 0;
+   while (HF_ValidRecId(hf_fd,AM_FindNextEntryValue(sd, value)))
+      n++;
+   if (AMerrno != AME_EOF) {
+      AM_PrintError("Problem finding next entry");
+      exit(1);
+   }
+   printf("%d entries with (dept, id) = (7, 73): %s\n", n, value + 2 * sizeof(int));
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+   printf("opening a scan on 3 key attributes: %d\n", AM_OpenIndexScanAttrs(am_fd, EQ_OP, (char *)key, 3));
+
+   if (AM_CloseIndex(am_fd) != AME_OK) {
+      AM_PrintError("Problem closing index file");
+      exit(1);
+   }
+   if (HF_CloseFile(hf_fd) != HFE_OK) {
+      HF_PrintError("Problem closing HF file");
+      exit(1);
+   }
+
+   printf("***** end amtest6 *****\n");
+}
+
+/*******************************************************/
+/* scan_batch:                                         */
+/* Scans the index of amtest7 with an int predicate,   */
+/* checking that the entries come in order and that    */
+/* their values are those of the records of the file.  */
+/*******************************************************/
+int scan_batch(int am_fd, int hf_fd, int op, int key)
+{
+   int sd, n = 0, prev = 0, cur;
+   char record[RECSIZE];
+   RECID recid;
+
+   if ((sd = AM_OpenIndexScan(am_fd, op, (char *)&key)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   while (1)
+   {
+      recid = AM_FindNextEntryValue(sd, (char *)&cur);
+      if (!HF_ValidRecId(hf_fd,recid))
+         if (AMerrno == AME_EOF) break;
+      else
+      {
+         AM_PrintError("Problem finding next entry");
+         exit(1);
+      }
+      if (HF_GetThisRec(hf_fd, recid, record) != HFE_OK){
+         HF_PrintError("Problem retrieving record");
+         exit(1);
+      }
+      if (memcmp(record, (char *)&cur, sizeof(int)) != 0) {
+         printf("entry %d is not the value of its record\n", cur);
+         exit(1);
+      }
+      if (n > 0 && cur < prev) {
+         printf("entry %d out of order after %d\n", cur, prev);
+         exit(1);
+      }
+      prev = cur;
+      n++;
+   }
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+   return n;
+}
+
+/*******************************************************/
+/* scan_range:                                         */
+/* Scans the index of amtest7 from a value on, a batch */
+/* of entries at a time, reading the records of each   */
+/* batch with HF_GetRecs and checking each of them     */
+/* against HF_GetThisRec.                              */
+/*******************************************************/
+int scan_range(int am_fd, int hf_fd, int key)
+{
+   int sd, k, n, cur, total = 0;
+   char records[64 * RECSIZE];
+   char record[RECSIZE];
+   RECID recids[64];
+
+   if ((sd = AM_OpenIndexScan(am_fd, GE_OP, (char *)&key)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   do {
+      if ((n = AM_FindNextEntries(sd, recids, 64)) < 0) {
+         AM_PrintError("Problem finding next entries");
+         exit(1);
+      }
+      if (HF_GetRecs(hf_fd, recids, n, records) != HFE_OK) {
+         HF_PrintError("Problem retrieving the records of a batch");
+         exit(1);
+      }
+      for (k = 0; k < n; k++) {
+         if (HF_GetThisRec(hf_fd, recids[k], record) != HFE_OK) {
+            HF_PrintError("Problem retrieving record");
+            exit(1);
+         }
+         if (memcmp(records + k * RECSIZE, record, RECSIZE) != 0) {
+            printf("record %s of the batch is not %s\n", records + k * RECSIZE + sizeof(int), record + sizeof(int));
+            exit(1);
+         }
+         memcpy((char *)&cur, record, sizeof(int));
+         if (cur < key) {
+            printf("record %s is out of the range\n", record + sizeof(int));
+            exit(1);
+         }
+      }
+      total += n;
+   } while (n == 64);
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+   return total;
+}
+
+/*******************************************************/
+/* amtest7:                                            */
+/* Inserts records in batches, out of order and with   */
+/* each value four times, into an HF file and into a   */
+/* B+ Tree on their int value, splitting its leaves.   */
+/* The index is then scanned whole and value by value, */
+/* then over a range, a batch of records at a time.    */
+/*******************************************************/
+void amtest7()
+{
+   int am_fd, hf_fd;
+   int i, b, n, key, wrong;
+   char *records;
+   char values[2 * NRECS * sizeof(int)];
+   char files_to_delete[80];
+   RECID recids[2 * NRECS];
+
+   printf("***** Start amtest7 *****\n");
+   sprintf(files_to_delete, "rm -f %s*", FILE3);
+   system(files_to_delete);
+
+   if (HF_CreateFile(FILE3, RECSIZE) != HFE_OK) {
+      HF_PrintError("Problem creating HF file");
+      exit(1);
+   }
+   if ((hf_fd = HF_OpenFile(FILE3)) < 0) {
+      HF_PrintError("Problem opening");
+      exit(1);
+   }
+   if (AM_CreateIndex(FILE3, 1, INT_TYPE, sizeof(int), FALSE) != AME_OK) {
+      AM_PrintError("Problem creating");
+      exit(1);
+   }
+   if ((am_fd = AM_OpenIndex(FILE3,1)) < 0) {
+      AM_PrintError("Problem opening index");
+      exit(1);
+   }
+   if ((records = (char *) malloc(2 * NRECS * RECSIZE)) == NULL) {
+      printf("Problem allocating the batch\n");
+      exit(1);
+   }
+
+   /* the values 0 to 2 * NRECS - 1 go in out of order over 4 batches, each one 4 times */
+   for (b = 0; b < 4; b++) {
+      for (i = 0; i < 2 * NRECS; i++) {
+         key = ((b * 2 * NRECS + i) * 37) % (4 * NRECS) / 2;
+         memset(records + i * RECSIZE, '\0', RECSIZE);
+         memcpy(records + i * RECSIZE, (char *)&key, sizeof(int));
+         sprintf(records + i * RECSIZE + sizeof(int), "rec%d", b * 2 * NRECS + i);
+         memcpy(values + i * sizeof(int), (char *)&key, sizeof(int));
+      }
+      if (HF_InsertRecs(hf_fd, records, 2 * NRECS, recids) != HFE_OK) {
+         HF_PrintError("Problem inserting records in HF file");
+         exit(1);
+      }
+      if (AM_InsertEntries(am_fd, values, recids, 2 * NRECS) != AME_OK) {
+         AM_PrintError("Problem inserting the batch");
+         exit(1);
+      }
+   }
+   free(records);
+
+   key = 0;
+   printf("%d entries scanned in order\n", scan_batch(am_fd, hf_fd, GE_OP, key));
+   for (key = 0, wrong = 0; key < 2 * NRECS; key++) {
+      if ((n = scan_batch(am_fd, hf_fd, EQ_OP, key)) != 4) {
+         printf("%d entries with value %d\n", n, key);
+         wrong++;
+      }
+   }
+   printf("%d values found 4 times, %d not\n", 2 * NRECS - wrong, wrong);
+   key = NRECS;
+   printf("%d entries with value < %d\n", scan_batch(am_fd, hf_fd, LT_OP, key), key);
+   printf("%d entries with value >= %d read in batches\n", scan_range(am_fd, hf_fd, key), key);
+
+   if (AM_CloseIndex(am_fd) != AME_OK) {
+      AM_PrintError("Problem closing index file");
+      exit(1);
+   }
+   if (HF_CloseFile(hf_fd) != HFE_OK) {
+      HF_PrintError("Problem closing HF file");
+      exit(1);
+   }
+
+   printf("***** end amtest7 *****\n");
+}
+
 /*********************************************/
 /* cleanup:                                  */
 /* Gets rid of files generated by the tests  */
@@ -20,6 +20,9 @@ BFpage *LRU_tail = BF_INVALID;
 BFpage *Fr_head = BF_INVALID;
 int BF_cnt = BF_MINIMUM;
 
+/* forces the log up to a log sequence number, NULL unless a write-ahead log is in use */
+int (*BF_logforce)(long lsn) = NULL;
+
 /* BF_Init is initiate to use BF layer.
    First, initiate Hash Table, and secondly, make a Free List and LRU List
    When initiate, no page is existed in buffer pool, so all of BFpage are linked in Free List
@@ -77,6 +80,8 @@ int BF_AllocBuf(BFreq bq, PFpage **fpage) {
 		new_page->unixfd = bq.unixfd;
 		new_page->fd = bq.fd;
 		new_page->pageNum = bq.pagenum;
+		new_page->lsn = BF_LSN_NONE;
+		new_page->reclsn = BF_LSN_NONE;
 
 		/* insert the "new_page" */
 		if (insert_in_LRU(new_page) == BFE_OK){
@@ -140,6 +145,8 @@ int BF_GetBuf(BFreq bq, PFpage **fpage) {
 	new_page->unixfd = bq.unixfd;
 	new_page->fd = bq.fd;
 	new_page->pageNum = bq.pagenum;
+	new_page->lsn = BF_LSN_NONE;
+	new_page->reclsn = BF_LSN_NONE;
 
 	/* insert 'new_page' into buffer Pool, and point PFpage of 'new_page' by fpage */
 	if (insert_in_LRU(new_page) == BFE_OK) {
@@ -173,6 +180,7 @@ int BF_UnpinBuf(BFreq bq) {
 
 
 /* BF_TouchBuf makes the targeted page dirty, and moves the page on MRU area
+   With a write-ahead log, the page is held in Buffer Pool until BF_StampBuf tells its change was logged
    if targeted page is unpinned or isn't exist, return error message
 
    params: bq = the property of required page
@@ -192,6 +200,9 @@ int BF_TouchBuf(BFreq bq) {
 		}
 
 		dir_page->dirty = TRUE;
+		if (BF_logforce != NULL) {
+			dir_page->lsn = BF_LSN_PENDING;
+		}
 
 	/* relocate the touched page to MRU */
 		dir_page->prevpage->nextpage = dir_page->nextpage;
@@ -242,8 +253,11 @@ int BF_FlushBuf(int fd) {
 				return BFE_PAGEFIXED;
 			}
 
-			/* if 'Flushed_page' is dirty, write PFpage of it on the disk */
+			/* if 'Flushed_page' is dirty, write PFpage of it on the disk, after its log records */
 			if (Flushed_page->dirty == TRUE) {
+				if (BF_logforce != NULL && Flushed_page->lsn > BF_LSN_NONE && BF_logforce(Flushed_page->lsn) != BFE_OK) {
+					return BFE_UNIX;
+				}
 				if (pwrite(Flushed_page->unixfd, Flushed_page->fpage.pagebuf, PAGE_SIZE, PFHDR_SIZE + PAGE_SIZE * Flushed_page->pageNum) != PAGE_SIZE) {
 					printf("allocbuf: pwrite");
 					return BFE_UNIX;
@@ -269,6 +283,132 @@ int BF_FlushBuf(int fd) {
 }
 
 
+/* BF_DisposeBuf drops the targeted page from Buffer Pool without writing it back
+   It is used when the page itself is given back to the file, so its contents are no longer needed
+   If the page is not in Buffer Pool, nothing has to be done
+   If the page is pinned, return error message
+
+   params: bq = the property of required page
+   return: BFE_OK = complete, BFE_PAGEFIXED = target is pinned */
+
+int BF_DisposeBuf(BFreq bq) {
+	BFhash_entry* hash_page = NULL;
+	BFpage* disposed;
+
+	/* the page is not buffered, nothing to drop */
+	if (BF_SearchHash(bq.fd, bq.pagenum, &hash_page) != BFE_OK) {
+		return BFE_OK;
+	}
+	disposed = hash_page->bpage;
+
+	/* if 'disposed' is pinned, return error message */
+	if (disposed->count != 0) {
+		return BFE_PAGEFIXED;
+	}
+
+	/* delete from LRU List, without writing back even if it is dirty */
+	disposed->prevpage->nextpage = disposed->nextpage;
+	disposed->nextpage->prevpage = disposed->prevpage;
+	BF_DeleteHash(bq.fd, bq.pagenum, NULL);
+	BF_cnt--;
+
+	/* insert in Free List */
+	disposed->nextpage = Fr_head;
+	Fr_head = disposed;
+
+	return BFE_OK;
+}
+
+
+/* BF_StampBuf records the log sequence number of the latest logged change of the targeted page
+   The page can be written back again, once the log is forced up to 'lsn'
+
+   params: bq = the property of required page, lsn = log sequence number of the change
+   return: BFE_OK = complete, BFE_PAGENOTINBUF = target is not in BF */
+
+int BF_StampBuf(BFreq bq, long lsn) {
+	BFhash_entry* hash_page = NULL;
+
+	if (BF_SearchHash(bq.fd, bq.pagenum, &hash_page) != BFE_OK) {
+		return BFE_PAGENOTINBUF; /* ERROR: no requested page in Buffer Pool! */
+	}
+	hash_page->bpage->lsn = lsn;
+	if (hash_page->bpage->reclsn == BF_LSN_NONE) {
+		hash_page->bpage->reclsn = lsn;
+	}
+
+	return BFE_OK;
+}
+
+
+/* BF_DirtyPages fills the dirty page table with the pages of Buffer Pool whose logged changes are not written back
+   Each entry tells the first log record of these changes, the log is needed from there on to redo the page
+
+   params: dpt = array of at least BF_MAX_BUFS entries, filled in LRU order
+   return: number of entries filled */
+
+int BF_DirtyPages(BFdirty *dpt) {
+	BFpage* cur_page;
+	int n = 0;
+
+	for (cur_page = LRU_head->nextpage; cur_page != LRU_tail; cur_page = cur_page->nextpage) {
+		if (cur_page->dirty == TRUE && cur_page->reclsn > BF_LSN_NONE) {
+			dpt[n].fd = cur_page->fd;
+			dpt[n].unixfd = cur_page->unixfd;
+			dpt[n].pagenum = cur_page->pageNum;
+			dpt[n].reclsn = cur_page->reclsn;
+			n++;
+		}
+	}
+
+	return n;
+}
+
+
+/* BF_WriteBuf writes the targeted page back to the disk, keeping it in Buffer Pool as a clean page
+   The log is forced up to the page first; a page whose change is not logged yet is left dirty
+   Nothing is done if the page is not in Buffer Pool or is clean
+
+   params: bq = the property of required page
+   return: BFE_OK = complete, BFE_UNIX = the log could not be forced or the page written */
+
+int BF_WriteBuf(BFreq bq) {
+	BFhash_entry* hash_page = NULL;
+	BFpage* page;
+
+	if (BF_SearchHash(bq.fd, bq.pagenum, &hash_page) != BFE_OK) {
+		return BFE_OK;
+	}
+	page = hash_page->bpage;
+
+	if (page->dirty == FALSE || page->lsn == BF_LSN_PENDING) {
+		return BFE_OK;
+	}
+	if (BF_logforce != NULL && page->lsn > BF_LSN_NONE && BF_logforce(page->lsn) != BFE_OK) {
+		return BFE_UNIX;
+	}
+	if (pwrite(page->unixfd, page->fpage.pagebuf, PAGE_SIZE, PFHDR_SIZE + (off_t)PAGE_SIZE * page->pageNum) != PAGE_SIZE) {
+		return BFE_UNIX;
+	}
+	page->dirty = FALSE;
+	page->reclsn = BF_LSN_NONE;
+
+	return BFE_OK;
+}
+
+
+/* BF_SetLogForce sets the function forcing the log, which turns Buffer Pool into write-ahead logging
+   A dirty page is written back only after the log is forced up to its log sequence number,
+   and a page dirtied by an operation is not chosen as a victim before its change is logged
+   NULL turns it back into writing the pages without the log
+
+   params: force = function forcing the log up to a log sequence number, returning BFE_OK on success */
+
+void BF_SetLogForce(int (*force)(long lsn)) {
+	BF_logforce = force;
+}
+
+
 /* BF_ShowBuf shows the status of Buffer Pool */
 
 void BF_ShowBuf(void) {
@@ -327,8 +467,8 @@ int del_victim(void) {
 
 	BFpage* Unpinned = LRU_tail->prevpage;
 
-	/* find unpinned page and point it by 'Unpinned' */
-	while (Unpinned->count != 0) {
+	/* find unpinned page and point it by 'Unpinned', skipping pages whose change is not logged yet */
+	while (Unpinned->count != 0 || Unpinned->lsn == BF_LSN_PENDING) {
 
 		/* if there is not unpinned page, return error */
 		if (Unpinned == LRU_head) {
@@ -337,6 +477,11 @@ int del_victim(void) {
 		Unpinned = Unpinned->prevpage;
 	}
 
+	/* the log records of the page go to the disk first */
+	if (Unpinned->dirty == TRUE && BF_logforce != NULL && Unpinned->lsn > BF_LSN_NONE && BF_logforce(Unpinned->lsn) != BFE_OK) {
+		return BFE_UNIX;
+	}
+
 	/* unlink the page, pointed by 'Unpinned', in LRU */
 	Unpinned->prevpage->nextpage = Unpinned->nextpage;
 	Unpinned->nextpage->prevpage = Unpinned->prevpage;
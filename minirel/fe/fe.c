@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include <string.h>
 #include "minirel.h"
+#include "pf.h"
 #include "hf.h"
 #include "am.h"
 #include "fe.h"
@@ -14,6 +15,35 @@
 
 int FEerrno;
 
+/*
+ * When FE_USE_TABLESPACE is set, DBcreate() puts all the relations and
+ * indexes of a database in one tablespace file (see PF_CreateTablespace()).
+ * DBconnect() attaches the tablespace of any database which has one.
+ */
+#ifndef FE_USE_TABLESPACE
+#define FE_USE_TABLESPACE 0
+#endif
+#define TSNAME "tablespace"
+
+/*
+ * While connected, the changes to a database are logged in its write-ahead
+ * log (see PF_OpenLog()), which DBconnect() redoes after a crash. Unless
+ * FE_USE_WAL is 0, closing a relation does not write back its pages.
+ */
+#ifndef FE_USE_WAL
+#define FE_USE_WAL 1
+#endif
+#define WALNAME "wal"
+
+/*
+ * Page format of the relations created by CreateTable() (see
+ * HF_CreateFileFormat() and HF_CreateFilePax()); the catalogs keep
+ * fixed-size records.
+ */
+#ifndef FE_HF_FORMAT
+#define FE_HF_FORMAT HF_FORMAT_SLOTTED
+#endif
+
 bool_t initialized = FALSE;
 
 /* File descriptor and scan descriptors of relcat and attrcat. */
@@ -61,7 +91,7 @@ void DBcreate(char *dbname) {
     offsetof(ATTRDESCTYPE, attrtype),
     offsetof(ATTRDESCTYPE, indexed),
     offsetof(ATTRDESCTYPE, attrno)};
-    int attr_len[7] = {sizeof(char) * MAXNAME, sizeof(char) * MAXNAME, sizeof(int), sizeof(int), sizeof(int), sizeof(bool_t), sizeof(int)};
+    int attr_len[7] = {sizeof(char) * MAXNAME, sizeof(char) * MAXNAME, sizeof(int), sizeof(int), sizeof(int), sizeof(int), sizeof(int)};
     int attr_type[7] = {STRING_TYPE, STRING_TYPE, INT_TYPE, INT_TYPE, INT_TYPE, INT_TYPE, INT_TYPE};
 
     if (!initialized) FE_Init();
@@ -73,6 +103,16 @@ void DBcreate(char *dbname) {
         return;
     };
 
+    /* Create the tablespace holding the catalogs and relations. */
+    if (FE_USE_TABLESPACE) {
+        length = strlen(dbname) + strlen(TSNAME) + 2;
+        filename = (char *) malloc (sizeof(char) * length);
+        sprintf(filename, "%s/%s", dbname, TSNAME);
+
+        if (PF_CreateTablespace(filename) != PFE_OK || PF_AttachTablespace(filename, dbname) != PFE_OK) { free(filename); FEerrno = FEE_PF; return; }
+        free(filename);
+    }
+
     /* Create relcat. */
     length = strlen(dbname) + strlen(RELCATNAME) + 2;
     filename = (char *) malloc (sizeof(char) * length);
@@ -83,7 +123,10 @@ void DBcreate(char *dbname) {
     if ((fd = HF_OpenFile(filename)) < 0) { _dbcreate_unix(filename, -1); return; }
     free(filename);
 
+    /* the catalogs are keyed by relation name */
+    memset(&rel, 0, sizeof(rel));
     sprintf(rel.relname, RELCATNAME);
+    sprintf(rel.primattr, "relname");
     rel.relwid = RELDESCSIZE;
     rel.attrcnt = 5;
     rel.indexcnt = 0;
@@ -138,6 +181,9 @@ void DBcreate(char *dbname) {
     }
 
     if (HF_CloseFile(fd) != HFE_OK) { _dbcreate_unix(NULL, -1); return; }
+
+    /* DBconnect() attaches it again. */
+    if (FE_USE_TABLESPACE) PF_DetachTablespace(dbname);
 }
 
 void DBdestroy(char *dbname) {
@@ -161,12 +207,31 @@ void _connect_hf(void *pointer, int fd) {
 void DBconnect(char *dbname) {
     char *filename;
     int length;
+    struct stat stat_file;
 
     /* Save dbname. */
     db = (char *) malloc (sizeof(char) * strlen(dbname) + 1);
     /*strcpy(db, dbname);*/
     sprintf(db, "%s", dbname);
 
+    /* Open the log of the database, redoing it after a crash. */
+    if (FE_USE_WAL) {
+        length = strlen(dbname) + strlen(WALNAME) + 2;
+        filename = (char *) malloc (sizeof(char) * length);
+        sprintf(filename, "%s/%s", dbname, WALNAME);
+
+        if (PF_OpenLog(filename) != PFE_OK) { free(filename); FEerrno = FEE_PF; return; }
+        free(filename);
+    }
+
+    /* Attach the tablespace of the database, if it has one. */
+    length = strlen(dbname) + strlen(TSNAME) + 2;
+    filename = (char *) malloc (sizeof(char) * length);
+    sprintf(filename, "%s/%s", dbname, TSNAME);
+
+    if (stat(filename, &stat_file) == 0 && PF_AttachTablespace(filename, dbname) != PFE_OK) { free(filename); FEerrno = FEE_PF; return; }
+    free(filename);
+
     /* Open relcat. */
     length = strlen(dbname) + strlen(RELCATNAME) + 2;
     filename = (char *) malloc (sizeof(char) * length);
@@ -186,17 +251,35 @@ void DBconnect(char *dbname) {
 }
 
 void DBclose(char *dbname) {
-    free(db);
+    char *filename;
+    int length;
+    struct stat stat_file;
 
     if (HF_CloseFile(rfd) != HFE_OK || HF_CloseFile(afd) != HFE_OK) {
         FEerrno = FEE_HF;
     }
+
+    /* Close the log, writing back the pages, then detach the tablespace, if the database has one. */
+    if (FE_USE_WAL && PF_CloseLog() != PFE_OK) {
+        FEerrno = FEE_PF;
+    }
+
+    length = strlen(db) + strlen(TSNAME) + 2;
+    filename = (char *) malloc (sizeof(char) * length);
+    sprintf(filename, "%s/%s", db, TSNAME);
+
+    if (stat(filename, &stat_file) == 0 && PF_DetachTablespace(db) != PFE_OK) {
+        FEerrno = FEE_PF;
+    }
+    free(filename);
+    free(db);
 }
 
 int  CreateTable(char *relName, int numAttrs, ATTR_DESCR attrs[], char *primAttrName) {
     char *filename;
-    int i, j, len, attrErr;
+    int i, j, len, attrErr, hfErr;
     RECID recId[numAttrs + 1];
+    int attrLens[HF_PAX_MAXATTRS]; /* for a PAX file, which has no more attributes */
     RELDESCTYPE rel;
     ATTRDESCTYPE attr;
 
@@ -207,6 +290,9 @@ int  CreateTable(char *relName, int numAttrs, ATTR_DESCR attrs[], char *primAttr
         }
 
         len += attrs[i].attrLen;
+        if (i < HF_PAX_MAXATTRS) {
+            attrLens[i] = attrs[i].attrLen;
+        }
 
         for (j = i + 1; j < numAttrs; j++) {
             if (strcmp(attrs[i].attrName, attrs[j].attrName) == 0) {
@@ -217,16 +303,24 @@ int  CreateTable(char *relName, int numAttrs, ATTR_DESCR attrs[], char *primAttr
 
     filename = (char *) malloc (sizeof(char) * (strlen(db) + 1 + strlen(relName)));
     sprintf(filename, "%s/%s", db, relName);
-    if (HF_CreateFile(filename, len) != HFE_OK) {
+    if (FE_HF_FORMAT == HF_FORMAT_PAX && numAttrs <= HF_PAX_MAXATTRS) {
+        hfErr = HF_CreateFilePax(filename, numAttrs, attrLens);
+    } else {
+        hfErr = HF_CreateFileFormat(filename, len, FE_HF_FORMAT == HF_FORMAT_PAX ? HF_FORMAT_FIXED : FE_HF_FORMAT);
+    }
+    if (hfErr != HFE_OK) {
         free(filename);
         return FEE_HF;
     }
     free(filename);
 
+    memset(&rel, 0, sizeof(rel));
     sprintf(rel.relname, "%s", relName);
     rel.relwid = len;
     rel.attrcnt = numAttrs;
     rel.indexcnt = 0;
+    /* the primary attribute is the first one unless it is named */
+    strncpy(rel.primattr, primAttrName != NULL ? primAttrName : attrs[0].attrName, MAXNAME - 1);
 
     recId[0] = HF_InsertRec(rfd, (char *) &rel);
     if (!HF_ValidRecId(rfd, recId[0])) {
@@ -321,32 +415,36 @@ int  DestroyTable(char *relName) {
     return FEE_OK;
 }
 
-int HF_ReplaceRec (int fd, RECID recId, char *record, RECID *newRecId) {
-    RECID temp;
-
-    temp = HF_InsertRec(fd, record);
-    if (!HF_ValidRecId(fd, temp)) {
-        return HFE_INTERNAL;
-    }
-
-    if (HF_DeleteRec(fd, recId) != HFE_OK) {
-        HF_DeleteRec(fd, temp);
-        return HFE_INTERNAL;
-    }
-
-    if (newRecId) {
-        *newRecId = temp;
-    }
+int  BuildIndex(char *relName, char *attrName) {
+    return BuildIndexMethod(relName, attrName, AM_METHOD_BTREE);
+}
 
-    return HFE_OK;
+/* builds an index of the given access method, which attrcat records in 'indexed' */
+int  BuildIndexMethod(char *relName, char *attrName, int method) {
+    return BuildIndexAttrs(relName, 1, &attrName, method);
 }
 
-int  BuildIndex(char *relName, char *attrName) {
-    char *filename, *record, *value;
-    int fd, sd, found, attrIndex, ifd;
+/*
+ * builds an index on several attributes, whose keys are ordered by the first
+ * one, then by the next ones; attrcat records it in 'indexed' of the first
+ * attribute, whose number names the index, and DropIndex() of that attribute
+ * drops it
+ */
+int  BuildIndexAttrs(char *relName, int numAttrs, char *attrNames[], int method) {
+    char *filename;
+    int fd, sd, found, attrIndex, ifd, i, j;
     RELDESCTYPE rel;
-    ATTRDESCTYPE attr;
-    RECID recId, relRecId, attrRecId;
+    ATTRDESCTYPE attr, cur;
+    AM_ATTRDESC iattrs[AM_MAXATTRS];
+    RECID recId, attrRecId;
+
+    if (method != AM_METHOD_BTREE && method != AM_METHOD_HASH) return FEE_INTERNAL;
+    if (numAttrs < 1 || numAttrs > AM_MAXATTRS) return FEE_INCORRECTNATTRS;
+    for (i = 1; i < numAttrs; i++) {
+        for (j = 0; j < i; j++) {
+            if (strcmp(attrNames[i], attrNames[j]) == 0) return FEE_THISATTRTWICE;
+        }
+    }
 
     /* Update attrcat. */
     if ((sd = HF_OpenFileScan(afd, STRING_TYPE, MAXNAME, 0, EQ_OP, relName)) < 0) {
@@ -356,68 +454,76 @@ int  BuildIndex(char *relName, char *attrName) {
 
     found = 0;
     attrIndex = 0;
-    recId = HF_FindNextRec(sd, (char *) &attr);
+    recId = HF_FindNextRec(sd, (char *) &cur);
     while (HF_ValidRecId(afd, recId)) {
-        if (strcmp(attr.attrname, attrName) == 0) {
-            if (attr.indexed == TRUE) {
-                HF_CloseFileScan(sd);printf("here2\n"); exit(-1);
-                return FEE_ALREADYINDEXED;
-            }
-
-            attr.indexed = TRUE;
-
-            if (HF_ReplaceRec(afd, recId, (char *) &attr, &attrRecId) != HFE_OK) {
-                HF_CloseFileScan(sd);printf("here3\n"); exit(-1);
-                return FEE_HF;
+        for (i = 0; i < numAttrs; i++) {
+            if (strcmp(cur.attrname, attrNames[i]) == 0) {
+                iattrs[i].attrType = (char) cur.attrtype;
+                iattrs[i].attrLength = cur.attrlen;
+                iattrs[i].attrOffset = cur.offset;
+                if (i == 0) {
+                    attr = cur;
+                    attrRecId = recId;
+                }
+                found++;
             }
-
-            found = 1;
-            break;
         }
 
-        recId = HF_FindNextRec(sd, (char *) &attr);
+        recId = HF_FindNextRec(sd, (char *) &cur);
         attrIndex++;
     }
 
-    if (!found) {
+    if (found < numAttrs) {
         HF_CloseFileScan(sd);printf("here4\n"); exit(-1);
         return FEE_NOSUCHATTR;
     }
 
+    if (attr.indexed != FALSE) {
+        HF_CloseFileScan(sd);printf("here2\n"); exit(-1);
+        return FEE_ALREADYINDEXED;
+    }
+
+    attr.indexed = method;
+
+    if (HF_UpdateRec(afd, attrRecId, (char *) &attr) != HFE_OK) {
+        HF_CloseFileScan(sd);printf("here3\n"); exit(-1);
+        return FEE_HF;
+    }
+
     if (HF_CloseFileScan(sd) != HFE_OK) {
         attr.indexed = FALSE;printf("here5\n"); exit(-1);
-        HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        HF_UpdateRec(afd, attrRecId, (char *) &attr);
         return FEE_HF;
     }
 
     /* Update relcat. */
     if ((sd = HF_OpenFileScan(rfd, STRING_TYPE, MAXNAME, 0, EQ_OP, relName)) < 0) {
         attr.indexed = FALSE;printf("here6\n"); exit(-1);
-        HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        HF_UpdateRec(afd, attrRecId, (char *) &attr);
         return FEE_HF;
     }
 
     recId = HF_FindNextRec(sd, (char *) &rel);
     if (!HF_ValidRecId(rfd, recId)) {printf("here7\n"); exit(-1);
         /*attr.indexed = FALSE;
-        HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        HF_UpdateRec(afd, attrRecId, (char *) &attr);
         HF_CloseFileScan(sd);*/
         return FEE_HF;
     }
 
     rel.indexcnt++;
-    if (HF_ReplaceRec(rfd, recId, (char *) &rel, &relRecId) != HFE_OK) {
+    if (HF_UpdateRec(rfd, recId, (char *) &rel) != HFE_OK) {
         /*attr.indexed = FALSE;printf("here8\n"); exit(-1);
-        HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        HF_UpdateRec(afd, attrRecId, (char *) &attr);
         HF_CloseFileScan(sd);*/
         return FEE_HF;
     }
 
     if (HF_CloseFileScan(sd) != HFE_OK) {printf("here9\n"); exit(-1);
         /*attr.indexed = FALSE;
-        HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        HF_UpdateRec(afd, attrRecId, (char *) &attr);
         rel.indexcnt--;
-        HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);*/
+        HF_UpdateRec(rfd, recId, (char *) &rel);*/
         return FEE_HF;
     }
 
@@ -427,29 +533,18 @@ int  BuildIndex(char *relName, char *attrName) {
 
     if ((fd = HF_OpenFile(filename)) < 0) {
         attr.indexed = FALSE;printf("here11\n"); exit(-1);
-        /*HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        /*HF_UpdateRec(afd, attrRecId, (char *) &attr);
         rel.indexcnt--;
-        HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);
+        HF_UpdateRec(rfd, recId, (char *) &rel);
         free(filename);*/
         return FEE_HF;
     }
 
-    if ((sd = HF_OpenFileScan(fd, attr.attrtype, attr.attrlen, attr.offset, EQ_OP, NULL)) < 0) {
-        attr.indexed = FALSE;printf("here12\n"); exit(-1);
-        /*HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
-        rel.indexcnt--;
-        HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);
-        HF_CloseFile(fd);
-        free(filename);*/
-        return FEE_HF;
-    }
-
-    if (AM_CreateIndex(filename, attr.attrno, (char) attr.attrtype, attr.attrlen, FALSE) != AME_OK) {
+    if (AM_CreateIndexAttrs(filename, attr.attrno, numAttrs, iattrs, numAttrs, method) != AME_OK) {
         attr.indexed = FALSE;printf("here13\n"); exit(-1);
-        /*HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        /*HF_UpdateRec(afd, attrRecId, (char *) &attr);
         rel.indexcnt--;
-        HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);
-        HF_CloseFileScan(sd);
+        HF_UpdateRec(rfd, recId, (char *) &rel);
         HF_CloseFile(fd);
         free(filename);*/
         return FEE_AM;
@@ -457,44 +552,31 @@ int  BuildIndex(char *relName, char *attrName) {
 
     if ((ifd = AM_OpenIndex(filename, attr.attrno)) < 0) {printf("here15\n"); exit(-1);
         /*attr.indexed = FALSE;
-        HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
+        HF_UpdateRec(afd, attrRecId, (char *) &attr);
         rel.indexcnt--;
-        HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);
+        HF_UpdateRec(rfd, recId, (char *) &rel);
         AM_DestroyIndex(filename, attrIndex);
-        HF_CloseFileScan(sd);
         HF_CloseFile(fd);
         free(filename);*/
         return FEE_AM;
     }
 
-    record = (char *) malloc(sizeof(char) * rel.relwid);
-    value = (char *) malloc (sizeof(char) * attr.attrlen);
-
-    recId = HF_FindNextRec(sd, record);
-    while (HF_ValidRecId(fd, recId)) {
-        if (memcpy (value, record + attr.offset, attr.attrlen) == NULL) return FEE_UNIX;
-
-        if (AM_InsertEntry(ifd, value, recId) != AME_OK) {
-            attr.indexed = FALSE; printf("here16\n"); exit(-1);
-            /*HF_ReplaceRec(afd, attrRecId, (char *) &attr, NULL);
-            rel.indexcnt--;
-            HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);
-            AM_CloseIndex(ifd);
-            AM_DestroyIndex(filename, attrIndex);
-            HF_CloseFileScan(sd);
-            HF_CloseFile(fd);
-            free(filename);*/
-            return FEE_AM;
-        }
-
-        recId = HF_FindNextRec(sd, record);
+    /* the index is built from the sorted keys of the relation, from the leaves up */
+    if (AM_BulkLoad(ifd, fd, attr.offset, AM_FILLFACTOR) != AME_OK) {
+        attr.indexed = FALSE; printf("here16\n"); exit(-1);
+        /*HF_UpdateRec(afd, attrRecId, (char *) &attr);
+        rel.indexcnt--;
+        HF_UpdateRec(rfd, recId, (char *) &rel);
+        AM_CloseIndex(ifd);
+        AM_DestroyIndex(filename, attrIndex);
+        HF_CloseFile(fd);
+        free(filename);*/
+        return FEE_AM;
     }
 
     free(filename);
-    free(record);
-    free(value);
 
-    if (AM_CloseIndex(ifd) != AME_OK || HF_CloseFileScan(sd) != HFE_OK || HF_CloseFile(fd) != HFE_OK) {printf("here17\n"); exit(-1);
+    if (AM_CloseIndex(ifd) != AME_OK || HF_CloseFile(fd) != HFE_OK) {printf("here17\n"); exit(-1);
         return FEE_AM;
     }
 
@@ -517,8 +599,8 @@ void recoverIndex(char *relname) {
     recId = HF_FindNextRec(sd, (char *) &attr);
     while (HF_ValidRecId(afd, recId)) {
         if ((fd = AM_OpenIndex(filename, i)) >= 0) {
-            attr.indexed = TRUE;
-            HF_ReplaceRec(afd, recId, (char *) &attr, NULL);
+            attr.indexed = AM_IndexMethod(fd);
+            HF_UpdateRec(afd, recId, (char *) &attr);
             AM_CloseIndex(fd);
         }
 
@@ -534,7 +616,7 @@ int  DropIndex(char *relname, char *attrName) {
     int fd, sd, i, attrIndex, ifd, prevIndexcnt;
     RELDESCTYPE rel;
     ATTRDESCTYPE attr;
-    RECID recId, relRecId, attrRecId;
+    RECID recId;
 
     /* Update attrcat. */
     if ((sd = HF_OpenFileScan(afd, STRING_TYPE, MAXNAME, 0, EQ_OP, relname)) < 0) {
@@ -545,9 +627,9 @@ int  DropIndex(char *relname, char *attrName) {
     recId = HF_FindNextRec(sd, (char *) &attr);
     while (HF_ValidRecId(afd, recId)) {
         if (attrName == NULL) {
-            if (attr.indexed == TRUE) {
+            if (attr.indexed != FALSE) {
                 attr.indexed = FALSE;
-                if (HF_ReplaceRec(afd, recId, (char *) &attr, &attrRecId) != HFE_OK) {
+                if (HF_UpdateRec(afd, recId, (char *) &attr) != HFE_OK) {
                     HF_CloseFileScan(sd);printf("hello1\n"); exit(-1);
                     recoverIndex(relname);
                     return FEE_NOTINDEXED;
@@ -561,7 +643,7 @@ int  DropIndex(char *relname, char *attrName) {
 
             attr.indexed = FALSE;
 
-            if (HF_ReplaceRec(afd, recId, (char *) &attr, &attrRecId) != HFE_OK) {
+            if (HF_UpdateRec(afd, recId, (char *) &attr) != HFE_OK) {
                 HF_CloseFileScan(sd);printf("hello3\n"); exit(-1);
                 return FEE_HF;
             }
@@ -598,7 +680,7 @@ int  DropIndex(char *relname, char *attrName) {
         rel.indexcnt = 0;
     }
 
-    if (HF_ReplaceRec(rfd, recId, (char *) &rel, &relRecId) != HFE_OK) {
+    if (HF_UpdateRec(rfd, recId, (char *) &rel) != HFE_OK) {
         recoverIndex(relname);
         HF_CloseFileScan(sd);printf("hello7\n"); exit(-1);
         return FEE_HF;
@@ -607,7 +689,7 @@ int  DropIndex(char *relname, char *attrName) {
     if (HF_CloseFileScan(sd) != HFE_OK) {
         recoverIndex(relname);printf("hello8\n"); exit(-1);
         rel.indexcnt = prevIndexcnt;
-        HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);
+        HF_UpdateRec(rfd, recId, (char *) &rel);
         return FEE_HF;
     }
 
@@ -615,7 +697,7 @@ int  DropIndex(char *relname, char *attrName) {
     if ((sd = HF_OpenFileScan(afd, STRING_TYPE, MAXNAME, 0, EQ_OP, relname)) < 0) {
         recoverIndex(relname);printf("hello9\n"); exit(-1);
         rel.indexcnt = prevIndexcnt;
-        HF_ReplaceRec(rfd, relRecId, (char *) &rel, NULL);
+        HF_UpdateRec(rfd, recId, (char *) &rel);
         return FEE_HF;
     }
 
@@ -664,14 +746,17 @@ int findRel (char *relName, char *record) {
     return FEE_OK;
 }
 
+/* Number of records LoadTable() reads and inserts at a time. */
+#define LOAD_BATCH 256
+
 int  LoadTable(char *relName, char *fileName) {
-    size_t length;
+    size_t length, n, i;
     char *filename, *record, *value;
-    int fd, sd, id;
+    int fd, sd, id, vlen = 0;
     FILE *fp = fopen(fileName, "r");
     RELDESCTYPE rel;
     ATTRDESCTYPE attr;
-    RECID recId;
+    RECID recId, recIds[LOAD_BATCH];
 
     /* check load file. */
     if (fp == NULL) return FEE_UNIX;
@@ -698,20 +783,22 @@ int  LoadTable(char *relName, char *fileName) {
 
     if (attr.indexed) {
         if ((id = AM_OpenIndex (filename, attr.attrno)) < 0) return FEE_AM;
-        value = (char *) malloc (sizeof(char) * attr.attrlen);
+        value = (char *) malloc (sizeof(char) * AM_MAXVALUE * LOAD_BATCH);
     }
 
-    /* Insert records. */
-    record = (char *) malloc (sizeof(char) * rel.relwid);
-    while (fread(record, rel.relwid, 1, fp) == 1) {
+    /* Insert records, a batch at a time. */
+    record = (char *) malloc (sizeof(char) * rel.relwid * LOAD_BATCH);
+    while ((n = fread(record, rel.relwid, LOAD_BATCH, fp)) > 0) {
         /* Insert to HF file. */
-        recId = HF_InsertRec(fd, record);
-        if (!HF_ValidRecId(fd, recId)) return FEE_HF;
+        if (HF_InsertRecs(fd, record, n, recIds) != HFE_OK) return FEE_HF;
 
         /* Insert to AM file. */
         if (attr.indexed) {
-            if (memcpy (value, record + attr.offset, attr.attrlen) == NULL) return FEE_UNIX;
-            if (attr.indexed && AM_InsertEntry(id, value, recId) != AME_OK) return FEE_AM;
+            /* an index on several attributes takes them one after another */
+            for (i = 0; i < n; i++) {
+                vlen = AM_MakeValue(id, record + i * rel.relwid, attr.offset, value + i * vlen);
+            }
+            if (AM_InsertEntries(id, value, recIds, n) != AME_OK) return FEE_AM;
         }
     }
 
@@ -729,6 +816,80 @@ int  LoadTable(char *relName, char *fileName) {
     return FEE_OK;
 }
 
+/* Indexes of the relation being vacuumed, kept up to date by vacuum_move(). */
+int vacuum_nindex;
+int *vacuum_ifd, *vacuum_offset;
+
+int vacuum_move(int fd, RECID oldRecId, RECID newRecId, char *record) {
+    char value[AM_MAXVALUE];
+    int i;
+
+    for (i = 0; i < vacuum_nindex; i++) {
+        AM_MakeValue(vacuum_ifd[i], record, vacuum_offset[i], value);
+        if (AM_DeleteEntry(vacuum_ifd[i], value, oldRecId) != AME_OK) return FEE_AM;
+        if (AM_InsertEntry(vacuum_ifd[i], value, newRecId) != AME_OK) return FEE_AM;
+    }
+
+    return HFE_OK;
+}
+
+int  VacuumTable(char *relName) {
+    char *filename;
+    int fd, sd, i, err;
+    RELDESCTYPE rel;
+    ATTRDESCTYPE attr;
+    RECID recId;
+
+    if (findRel(relName, (char *) &rel) != FEE_OK) return FEE_NOSUCHREL;
+
+    filename = (char *) malloc (sizeof(char) * (strlen(db) + strlen(relName) + 2));
+    sprintf(filename, "%s/%s", db, relName);
+    vacuum_ifd = (int *) malloc (sizeof(int) * rel.attrcnt);
+    vacuum_offset = (int *) malloc (sizeof(int) * rel.attrcnt);
+    vacuum_nindex = 0;
+
+    /* Open the indexes, to be updated for the records moved. */
+    err = FEE_OK;
+    if ((sd = HF_OpenFileScan(afd, STRING_TYPE, MAXNAME, 0, EQ_OP, relName)) < 0) {
+        err = FEE_HF;
+    } else {
+        recId = HF_FindNextRec(sd, (char *) &attr);
+        while (HF_ValidRecId(afd, recId)) {
+            if (attr.indexed) {
+                if ((vacuum_ifd[vacuum_nindex] = AM_OpenIndex(filename, attr.attrno)) < 0) {
+                    err = FEE_AM;
+                    break;
+                }
+                vacuum_offset[vacuum_nindex++] = attr.offset;
+            }
+
+            recId = HF_FindNextRec(sd, (char *) &attr);
+        }
+
+        if (HF_CloseFileScan(sd) != HFE_OK && err == FEE_OK) err = FEE_HF;
+    }
+
+    /* Compact the HF file. */
+    if (err == FEE_OK) {
+        if ((fd = HF_OpenFile(filename)) < 0) {
+            err = FEE_HF;
+        } else {
+            if ((err = HF_CompactFile(fd, vacuum_move)) != HFE_OK && err != FEE_AM) err = FEE_HF;
+            if (HF_CloseFile(fd) != HFE_OK && err == FEE_OK) err = FEE_HF;
+        }
+    }
+
+    for (i = 0; i < vacuum_nindex; i++) {
+        if (AM_CloseIndex(vacuum_ifd[i]) != AME_OK && err == FEE_OK) err = FEE_AM;
+    }
+
+    free(vacuum_ifd);
+    free(vacuum_offset);
+    free(filename);
+
+    return err;
+}
+
 int  HelpTable(char *relName) {
     int sd, sda;
     RELDESCTYPE rel;
@@ -745,7 +906,7 @@ int  HelpTable(char *relName) {
         if ((sda = HF_OpenFileScan(afd, STRING_TYPE, MAXNAME, 0, EQ_OP, relName)) < 0) return FEE_HF;
         recId = HF_FindNextRec(sda, (char *) &attr);
         while (HF_ValidRecId(afd, recId)) {
-            printf ("| %s\t| %d\t| %d\t| %c\t| %s\t| %d\t|\n", attr.attrname, attr.offset, attr.attrlen, attr.attrtype, attr.indexed ? "yes" : "no", attr.attrno);
+            printf ("| %s\t| %d\t| %d\t| %c\t| %s\t| %d\t|\n", attr.attrname, attr.offset, attr.attrlen, attr.attrtype, attr.indexed == FALSE ? "no" : (attr.indexed == AM_METHOD_HASH ? "hash" : "yes"), attr.attrno);
             recId = HF_FindNextRec(sda, (char *) &attr);
         }
         printf ("+--------------+--------------+--------------+--------------+--------------+--------------+\n");
@@ -762,10 +923,11 @@ int  HelpTable(char *relName) {
 
 int  PrintTable(char *relName) {
     char *filename, *record;
-    int fd, sd;
+    int fd, sd, rsd;
     RELDESCTYPE rel;
     ATTRDESCTYPE attr;
     RECID recId;
+    HFview view;
 
     /* Find rel wid */
     if (findRel (relName, (char *) &rel) != FEE_OK) return FEE_HF;
@@ -774,8 +936,6 @@ int  PrintTable(char *relName) {
     sprintf(filename, "%s/%s", db, relName);
     printf("file: %s\n", filename);
 
-    record = (char *) malloc (sizeof(char) * rel.relwid);
-
     /* Print attr names. */
     printf ("Relation %s\n------------------------------------------------------------------------------------\n|", relName);
     if ((sd = HF_OpenFileScan(afd, STRING_TYPE, MAXNAME, 0, EQ_OP, relName)) < 0) return FEE_HF;
@@ -793,8 +953,12 @@ int  PrintTable(char *relName) {
     else if (strcmp(relName, ATTRCATNAME) == 0) fd = afd;
     else if ((fd = HF_OpenFile(filename)) < 0) return FEE_HF;
 
-    recId = HF_GetFirstRec(fd, record);
+    /* the records are read in place, in the pages of the relation */
+    if ((rsd = HF_OpenFileScan(fd, INT_TYPE, sizeof(int), 0, EQ_OP, NULL)) < 0) return FEE_HF;
+
+    recId = HF_FindNextView(rsd, &view);
     while (HF_ValidRecId(fd, recId)) {
+        record = view.record;
         printf ("|");
 
         if ((sd = HF_OpenFileScan(afd, STRING_TYPE, MAXNAME, 0, EQ_OP, relName)) < 0) return FEE_HF;
@@ -809,17 +973,18 @@ int  PrintTable(char *relName) {
             }
         }
 
-        if (HF_CloseFileScan(sd) != HFE_OK) return FEE_HF;
+        if (HF_CloseFileScan(sd) != HFE_OK || HF_ReleaseView(&view) != HFE_OK) return FEE_HF;
         printf ("\n");
 
-        recId = HF_GetNextRec(fd, recId, record);
+        recId = HF_FindNextView(rsd, &view);
     }
      printf("------------------------------------------------------------------------------------\n");
 
+    if (HF_CloseFileScan(rsd) != HFE_OK) return FEE_HF;
+
     if (fd != rfd && fd != afd && HF_CloseFile(fd) != HFE_OK) return FEE_HF;
 
-    /*if (record) free(record);
-    if (filename) free(filename);*/
+    /*if (filename) free(filename);*/
 
     return FEE_OK;
 }
@@ -3,8 +3,35 @@
 
 #include <minirel.h>
 
-#define AM_ITAB_SIZE    MAXOPENFILES    /* max number of AM files allowed */
-#define MAXISCANS       MAXOPENFILES    /* max number of AM scans allowed */
+#define AM_ITAB_SIZE    MAXOPENFILES    /* initial number of AM files allowed, grown on demand */
+#define MAXISCANS       MAXOPENFILES    /* initial number of AM scans allowed, grown on demand */
+
+/*
+ * access methods of an index, chosen when it is created:
+ * AM_METHOD_BTREE keeps the keys in order in a B+ tree, for any comparison,
+ * AM_METHOD_HASH spreads them over the buckets of a linear hashing table,
+ * scanned for equality only (EQ_OP with a value)
+ * an indexed attribute records the method in the catalog, FALSE meaning no index
+ */
+#define AM_METHOD_BTREE		1
+#define AM_METHOD_HASH		2
+
+/*
+ * attribute of an index made on several attributes (see AM_CreateIndexAttrs()):
+ * the values of such an index are the values of its attributes one after another,
+ * the key attributes first, then the included ones, which are only kept with the
+ * keys so that AM_FindNextEntryValue() gives them back without the records
+ * the keys are ordered by their first attribute, then by the second one, and so on,
+ * and a scan may match on the first ones only (see AM_OpenIndexScanAttrs())
+ */
+typedef struct {
+    char attrType;		/* type of the attribute			*/
+    int  attrLength;		/* length of the attribute			*/
+    int  attrOffset;		/* offset in the records, for AM_BulkLoad()	*/
+} AM_ATTRDESC;
+
+#define AM_MAXATTRS     8       /* attributes of an index */
+#define AM_MAXVALUE     512     /* bytes of the value of an index */
 
 
 /****************************************************************************
@@ -17,20 +44,33 @@
 void AM_Init		(void);
 int  AM_CreateIndex	(char *fileName, int indexNo, char attrType,
 			int attrLength, bool_t isUnique);
+int  AM_CreateIndexMethod(char *fileName, int indexNo, char attrType,
+			int attrLength, bool_t isUnique, int method);
+int  AM_CreateIndexAttrs(char *fileName, int indexNo, int nattrs,
+			AM_ATTRDESC *attrs, int nkeys, int method);
 int  AM_DestroyIndex	(char *fileName, int indexNo);
 int  AM_OpenIndex       (char *fileName, int indexNo);
 int  AM_CloseIndex      (int fileDesc);
+int  AM_IndexMethod	(int fileDesc);
+int  AM_IndexAttrs	(int fileDesc, AM_ATTRDESC *attrs, int *nkeys);
+int  AM_MakeValue	(int fileDesc, char *record, int attrOffset, char *value);
 int  AM_InsertEntry	(int fileDesc, char *value, RECID recId);
+int  AM_InsertEntries	(int fileDesc, char *values, RECID *recIds, int n);
+int  AM_BulkLoad	(int fileDesc, int HFfd, int attrOffset, int fillFactor);
 int  AM_DeleteEntry     (int fileDesc, char *value, RECID recId);
 int  AM_OpenIndexScan	(int fileDesc, int op, char *value);
+int  AM_OpenIndexScanAttrs(int fileDesc, int op, char *value, int nmatch);
 RECID AM_FindNextEntry	(int scanDesc);
+RECID AM_FindNextEntryValue(int scanDesc, char *value);
+int  AM_FindNextEntries(int scanDesc, RECID *recIds, int n);
 int  AM_CloseIndexScan	(int scanDesc);
 void AM_PrintError	(char *errString);
 
 /*
  * AM layer constants
  */
-#define AM_NERRORS      24      /* maximun number of AM  errors */
+#define AM_NERRORS      25      /* maximun number of AM  errors */
+#define AM_FILLFACTOR   90      /* percentage of a node filled by AM_BulkLoad() by default */
 
 /*
  * AM layer error codes
@@ -64,6 +104,7 @@ void AM_PrintError	(char *errString);
 #define         AME_TOOMANYRECSPERKEY   (-22)
 #define         AME_KEYNOTFOUND         (-23)
 #define         AME_DUPLICATEKEY        (-24)
+#define         AME_NOTEMPTY            (-25)
 
 /*
  * global error value
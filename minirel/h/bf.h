@@ -15,6 +15,24 @@
 */
 #define BF_HASH_TBL_SIZE 20
 
+/*
+* log sequence number of a page dirtied by an operation whose log records
+* are not yet written; such a page is not written back (see BF_SetLogForce)
+*/
+#define BF_LSN_NONE	0L
+#define BF_LSN_PENDING	(-1L)
+
+/*
+* entry of the dirty page table, listing the pages whose logged changes
+* are not written back yet (see BF_DirtyPages)
+*/
+typedef struct BFdirty {
+    int fd;                     /* PF file descriptor of the page          */
+    int unixfd;                 /* Unix file descriptor of the page        */
+    int pagenum;                /* page number of the page                 */
+    long reclsn;                /* first log record not written back       */
+} BFdirty;
+
 /*
 * prototypes for BF-layer functions
 */
@@ -24,6 +42,11 @@ int BF_GetBuf(BFreq bq, PFpage **fpage);
 int BF_UnpinBuf(BFreq bq);
 int BF_TouchBuf(BFreq bq);
 int BF_FlushBuf(int fd);
+int BF_DisposeBuf(BFreq bq);
+int BF_StampBuf(BFreq bq, long lsn);
+int BF_DirtyPages(BFdirty *dpt);
+int BF_WriteBuf(BFreq bq);
+void BF_SetLogForce(int (*force)(long lsn));
 void BF_ShowBuf(void);
 
 /*
@@ -44,7 +44,7 @@ typedef struct _attribute_desc {
     int  offset;		/* attribute offset in tuple		*/
     int  attrlen;		/* attribute length			*/
     int  attrtype;		/* attribute type			*/
-    bool_t  indexed;		/* if the field is indexed or not       */
+    int  indexed;		/* access method of the index, FALSE if none */
     int  attrno;		/* attr number (used in index name)	*/
 } ATTRDESCTYPE;
 
@@ -8,6 +8,8 @@ typedef struct BFpage {
     int            unixfd;      /* Unix file descriptor                    */
     int            fd;          /* PF file descriptor of this page         */
     int            pageNum;     /* page number of this page                */
+    long           lsn;         /* log record the page must not be written before, BF_LSN_PENDING if not yet logged */
+    long           reclsn;      /* first log record of the changes not written back yet, BF_LSN_NONE if none */
 } BFpage;
 
 int find_in_disk(BFreq bq, BFpage **bfpage);
@@ -37,33 +39,138 @@ int PF_GetNumPages(int fd, int * pagenum);
 
 #define PFTAB_INVALID NULL
 
+/* room left in the PF header for the headers of the upper layers (HF, AM) */
+#define PF_HDRREST_SIZE 1024
+
+/* size of the free page bitmap, taking up the rest of the header page */
+#define PF_FREEMAP_SIZE (PF_PAGE_SIZE - 3 * sizeof(int) - PF_HDRREST_SIZE)
+
 /* PF file header structure definition */
 typedef struct PFhdr_str {
 	int numpages; /* contains page number of the corresponding PF file */
-	char hdrrest[PF_PAGE_SIZE]; /* empty space, to be utilized later */
+	int numalloc; /* number of pages preallocated on disk, never less than numpages */
+	int numfree; /* number of disposed pages waiting to be reused */
+	int freehint; /* no page below this page number is free */
+	unsigned char freemap[PF_FREEMAP_SIZE]; /* bitmap of disposed pages, one bit per page */
+	char hdrrest[PF_HDRREST_SIZE]; /* empty space, to be utilized later */
 } PFhdr_str;
 
+/*
+ * PF tablespace: one Unix file holding many PF files as segments.
+ * Page -1 of the Unix file is the tablespace header, the pages after it
+ * hold the directory, the segment headers, the extent maps and the extents.
+ */
+
+#define PF_TS_MAGIC 0x50465453 /* "PFTS" */
+#define PF_TS_NAMELEN 56 /* longest segment name, including the trailing NUL */
+#define PF_TS_NCLASS 12 /* number of extent sizes, from PF_EXTENT_MIN up to PF_EXTENT_MAX */
+#define PF_TS_MAXDIR ((PAGE_SIZE - (5 + PF_TS_NCLASS) * sizeof(int)) / sizeof(int))
+#define PF_TS_MAXEXT (PAGE_SIZE / sizeof(int) - 1)
+
+/* tablespace header, at the beginning of the tablespace file */
+typedef struct PFts_hdr {
+	int magic; /* PF_TS_MAGIC */
+	int numpages; /* number of pages in the tablespace, not counting this header */
+	int extent; /* number of pages an extent grows up to */
+	int freepage; /* first of the chained free single pages, -1 if none */
+	int freeext[PF_TS_NCLASS]; /* first of the chained free extents of each size, -1 if none */
+	int ndirpages; /* number of directory pages */
+	int dirpage[PF_TS_MAXDIR]; /* page numbers of the directory pages */
+} PFts_hdr;
+
+/* directory entry of a segment */
+typedef struct PFts_dirent {
+	char name[PF_TS_NAMELEN]; /* name of the segment, empty if the entry is unused */
+	int hdrpage; /* page holding the PF file header of the segment */
+	int mappage; /* page holding the extent map of the segment */
+} PFts_dirent;
+
+#define PF_TS_DIRENTS (PAGE_SIZE / sizeof(PFts_dirent))
+
+/* extent map of a segment; extent k of the segment starts at page start[k] of the tablespace */
+typedef struct PFts_map {
+	int nextents; /* number of extents of the segment */
+	int start[PF_TS_MAXEXT]; /* first tablespace page of each extent */
+} PFts_map;
+
 /* PF file table element structure definition */
 typedef struct PFftab_ele {
 	bool_t valid; /* validity of this file table entry, TRUE if corresponding file is valid and open */
+	dev_t dev; /* device of this PF file. retrieved from UNIX inode */
 	ino_t inode; /* inode number of this PF file. retrieved from UNIX inode */
 	char *fname; /* file name */
 	int unixfd; /* UNIX file descriptor of the file */
 	PFhdr_str hdr; /* PF file header */
 	short hdrchanged; /* TRUE if PF file header was changed after it was allocated */
+	bool_t zombie; /* TRUE if the file was closed while its pages are kept in the buffer pool (write-ahead logging) */
+	PFhdr_str *loghdr; /* PF file header as it was last logged, NULL if not logged yet */
+	int tsid; /* tablespace holding this file as a segment, -1 if it is a Unix file of its own */
+	int hdrpage; /* tablespace page holding the header of the segment */
+	int mappage; /* tablespace page holding the extent map of the segment */
+	PFts_map *extmap; /* extent map of the segment */
 } PFftab_ele;
 
-/* pointer to the array of PF file table elements */
-PFftab_ele *pft;
+/*
+ * PF write-ahead log: records of the data written to the pages of the
+ * UNIX files, followed by a commit record at the end of each operation.
+ * Data written to a file before its operation commits is logged with the
+ * data it overwrites, which recovery puts back if the commit never came.
+ * The log sequence number (LSN) of a record is the log offset just after it.
+ */
+
+#define PF_LOG_MAGIC 0x50464c47 /* "PFLG" */
+#define PF_LOG_HDRSIZE 512 /* bytes taken by the log header */
+
+/* types of log records */
+#define PF_LOG_PAGE 1 /* data written at the beginning of a page of a UNIX file */
+#define PF_LOG_COMMIT 2 /* end of an operation, its records are redone on recovery */
+#define PF_LOG_DESTROY 3 /* UNIX file removed */
+#define PF_LOG_UNDO 4 /* data at the beginning of a page of a UNIX file, before it was overwritten ahead of the commit */
+
+/* log header, at the beginning of the log file */
+typedef struct PFlog_hdr {
+	int magic; /* PF_LOG_MAGIC */
+	long redo; /* LSN where recovery starts reading the log, that of the record just after this header */
+} PFlog_hdr;
+
+/* log record header, followed by the name of the UNIX file and the data */
+typedef struct PFlog_rec {
+	int type; /* PF_LOG_PAGE, PF_LOG_COMMIT, PF_LOG_DESTROY or PF_LOG_UNDO */
+	int page; /* page of the UNIX file, -1 for its header */
+	int namelen; /* length of the name of the UNIX file */
+	int datalen; /* number of bytes of data */
+	long lsn; /* LSN of this record */
+	unsigned int sum; /* checksum of the record, computed with this field zero */
+} PFlog_rec;
+
+/* pointer to the array of PF file table elements, grown on demand */
+extern PFftab_ele *pft;
+
+/* PF tablespace table element structure definition */
+typedef struct PFts_ele {
+	bool_t valid; /* TRUE if a tablespace is attached in this entry */
+	char *fname; /* name of the tablespace file */
+	char *prefix; /* prefix of the names of the files stored in the tablespace */
+	int unixfd; /* UNIX file descriptor of the tablespace file, shared by its segments */
+	dev_t dev; /* device of the tablespace file */
+	ino_t inode; /* inode number of the tablespace file */
+	PFts_hdr hdr; /* tablespace header */
+	PFts_dirent *dir; /* directory, PF_TS_DIRENTS entries per directory page */
+} PFts_ele;
 
 
 /*
  * HF file table.
  */
 
+#define HF_PAX_MAXATTRS 64        /* attributes of a PAX file at most */
+
 typedef struct {
     int RecSize;                 /* Record size */
     int RecPage;                 /* Number of records per page */
     int NumPg;                   /* Number of pages in file */
     int NumFrPgFile;             /* Number of free pages in the file */
+    int Format;                  /* Page format, HF_FORMAT_XXX */
+    int NumAttrs;                /* Number of attributes of a PAX record */
+    int AttrLen[HF_PAX_MAXATTRS]; /* Their lengths, in the record order */
 } HFHeader;
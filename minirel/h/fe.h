@@ -54,6 +54,15 @@ int  DestroyTable(char *relName);	/* name of relation to destroy	*/
 int  BuildIndex(char *relName,		/* relation name		*/
 		char *attrName);	/* name of attr to be indexed	*/
 
+int  BuildIndexMethod(char *relName,	/* relation name		*/
+		char *attrName,		/* name of attr to be indexed	*/
+		int method);		/* AM_METHOD_BTREE or _HASH	*/
+
+int  BuildIndexAttrs(char *relName,	/* relation name		*/
+		int numAttrs,		/* number of attributes		*/
+		char *attrNames[],	/* names of attrs, in key order	*/
+		int method);		/* AM_METHOD_BTREE or _HASH	*/
+
 int  DropIndex(char *relname,		/* relation name		*/
 		char *attrName);	/* name of indexed attribute	*/
 
@@ -64,6 +73,8 @@ int  LoadTable(char *relName,		/* name of target relation	*/
 
 int  HelpTable(char *relName);		/* name of relation		*/
 
+int  VacuumTable(char *relName);	/* name of relation to compact	*/
+
 /*
  * Prototypes for QU layer functions
  */
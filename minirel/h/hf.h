@@ -3,7 +3,19 @@
 
 #include <minirel.h>
 
-#define HF_FTAB_SIZE    MAXOPENFILES    /* max number of HF files allowed */
+#define HF_FTAB_SIZE    MAXOPENFILES    /* initial number of HF files allowed, grown on demand */
+
+/*
+ * page formats of a HF file, chosen when it is created:
+ * HF_FORMAT_FIXED stores the records at fixed places with a bitmap of the used ones,
+ * HF_FORMAT_SLOTTED stores them in variable-length tuples, runs of zero bytes
+ * left out, found through a slot directory at the beginning of the page,
+ * HF_FORMAT_PAX stores the values of each attribute together in the page,
+ * at fixed places with a bitmap of the used ones (see HF_CreateFilePax())
+ */
+#define HF_FORMAT_FIXED		0
+#define HF_FORMAT_SLOTTED	1
+#define HF_FORMAT_PAX		2
 /* #define MAXSCANS        MAXOPENFILES     max number of HF scans allowed */
 
 
@@ -11,25 +23,61 @@
  * hf.h: external interface definition for the HF layer
  ****************************************************************************/
 
+/*
+ * view of a record (see HF_GetThisView()): a record of a file of fixed pages
+ * is read in place in its buffer page, which stays pinned until the view is
+ * released; a record of a slotted or PAX page is read in a copy held by the view
+ */
+typedef struct HFview {
+    char *record;		/* the record, until the view is released */
+    int pfd;			/* PF file of the pinned page */
+    int pagenum;		/* pinned page, -1 if none */
+    char scratch[PAGE_SIZE];	/* copy of a record not read in place */
+} HFview;
+
+/*
+ * function called with the old and the new content of a record updated
+ * (see HF_SetUpdateHook()), returning HFE_OK to let the update be done
+ */
+typedef int (*HFupdate_hook)(int fileDesc, RECID recId, char *oldRecord, char *newRecord);
+
+/*
+ * function called with the old and the new record id of a record moved by
+ * HF_CompactFile(), returning HFE_OK to let the compaction go on
+ */
+typedef int (*HFmove_hook)(int fileDesc, RECID oldRecId, RECID newRecId, char *record);
+
 /*
  * prototypes for HF-layer functions
  */
 void 		HF_Init(void);
 int 		HF_CreateFile(char *fileName, int RecSize);
+int 		HF_CreateFileFormat(char *fileName, int RecSize, int format);
+int 		HF_CreateFilePax(char *fileName, int numAttrs, int *attrLens);
 int 		HF_DestroyFile(char *fileName);
 int 		HF_OpenFile(char *fileName);
 int		HF_CloseFile(int fileDesc);
 RECID		HF_InsertRec(int fileDesc, char *record);
+int		HF_InsertRecs(int fileDesc, char *records, int n, RECID *recIds);
 int	 	HF_DeleteRec(int fileDesc, RECID recId);
 RECID 		HF_GetFirstRec(int fileDesc, char *record);
 RECID		HF_GetNextRec(int fileDesc, RECID recId, char *record);
 int	 	HF_GetThisRec(int fileDesc, RECID recId, char *record);
+int		HF_GetRecs(int fileDesc, RECID *recIds, int n, char *records);
+int		HF_UpdateRec(int fileDesc, RECID recId, char *record);
+int		HF_UpdateRecRange(int fileDesc, RECID recId, int offset,
+				int length, char *data);
+int		HF_SetUpdateHook(int fileDesc, HFupdate_hook hook);
+int		HF_CompactFile(int fileDesc, HFmove_hook hook);
 int 		HF_OpenFileScan(int fileDesc, char attrType, int attrLength,
 				int attrOffset, int op, char *value);
 RECID		HF_FindNextRec(int scanDesc, char *record);
 int		HF_CloseFileScan(int scanDesc);
 void		HF_PrintError(char *errString);
 bool_t          HF_ValidRecId(int fileDesc, RECID recid);
+int		HF_GetThisView(int fileDesc, RECID recId, HFview *view);
+RECID		HF_FindNextView(int scanDesc, HFview *view);
+int		HF_ReleaseView(HFview *view);
 /*int             HF_HeaderInfo(int fileDesc, HFHeader *FileInfo);*/
 
 /******************************************************************************/
@@ -62,6 +110,7 @@ bool_t          HF_ValidRecId(int fileDesc, RECID recid);
 
 #define HFE_INVALIDSTATS        -20 /* meaningful only when STATS_XXX macros
                                        are in use */
+#define HFE_FORMAT              -21 /* Invalid page format */
 
 /******************************************************************************/
 /*	Data structure definition		  			      */
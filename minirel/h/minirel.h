@@ -33,8 +33,8 @@ typedef float  real;
 /*
  * configuration of system resources
  */
-#define MAXOPENFILES    20      /* maximum # of files open at one time  */
-#define MAXSCANS        20      /* maximum number of scans allowed */
+#define MAXOPENFILES    20      /* initial # of files open at one time, tables grow beyond it */
+#define MAXSCANS        20      /* initial number of scans allowed, tables grow beyond it */
 
 #ifndef PAGE_SIZE
 #define PAGE_SIZE		4096
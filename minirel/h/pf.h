@@ -6,10 +6,41 @@
  ****************************************************************************/
 
  /*
- * size of open file table
+ * initial size of open file table, doubled whenever it gets full
  */
 #define PF_FTAB_SIZE	20
 
+/*
+ * files grow by extents preallocated on disk; an extent doubles the file
+ * until it reaches the extent size, which is between 1MB and 64MB
+ */
+#define PF_EXTENT_MIN		8	/* pages of the first extent */
+#define PF_EXTENT_DEFAULT	256	/* 1MB */
+#define PF_EXTENT_MAX		16384	/* 64MB */
+
+/*
+ * maximum number of tablespaces attached at a time; a tablespace is one
+ * UNIX file holding the PF files whose names start with its prefix
+ */
+#define PF_TS_MAX	8
+
+/*
+ * write-ahead log group commit: the log is forced by the commit completing
+ * a group of PF_LOG_GROUP commits, or by the first commit after PF_LOG_DELAY
+ * milliseconds since the oldest commit not yet forced
+ */
+#define PF_LOG_GROUP		8
+#define PF_LOG_DELAY		10
+#define PF_LOG_BUFSIZE		(64 * PAGE_SIZE)	/* log buffer */
+
+/*
+ * fuzzy checkpoints: a checkpoint begins once the log has grown by
+ * PF_CKPT_LOGSIZE bytes since its redo point, then the commits forcing
+ * the log write back PF_CKPT_BATCH of its dirty pages each
+ */
+#define PF_CKPT_LOGSIZE		(16L * 1024 * 1024)
+#define PF_CKPT_BATCH		4
+
 /*
  * prototypes for PF-layer functions
  */
@@ -24,6 +55,17 @@ int  PF_GetNextPage	(int fd, int *pagenum, char **pagebuf);
 int  PF_GetThisPage	(int fd, int pagenum, char **pagebuf);
 int  PF_DirtyPage	(int fd, int pagenum);
 int  PF_UnpinPage	(int fd, int pagenum, int dirty);
+int  PF_DisposePage	(int fd, int pagenum);
+int  PF_TruncateFile	(int fd);
+int  PF_SetExtentSize	(int npages);
+int  PF_CreateTablespace	(char *filename);
+int  PF_AttachTablespace	(char *filename, char *prefix);
+int  PF_DetachTablespace	(char *prefix);
+int  PF_OpenLog		(char *filename);
+int  PF_CloseLog	(void);
+int  PF_Commit		(void);
+int  PF_SetGroupCommit	(int ncommits, int delay);
+int  PF_Checkpoint	(void);
 
 /*
  * PF-layer error codes
@@ -37,6 +79,11 @@ int  PF_UnpinPage	(int fd, int pagenum, int dirty);
 #define PFE_FILEOPEN		(-6)
 #define PFE_FILENOTOPEN		(-7)
 #define PFE_NOUSERS		(-8)
+#define PFE_FREEMAPFULL		(-9)
+#define PFE_INVALIDEXTENT	(-10)
+#define PFE_TSFULL		(-11)
+#define PFE_TSNOTATTACHED	(-12)
+#define PFE_INVALIDGROUP	(-13)
 
 /*
  * error in UNIX system call or library routine
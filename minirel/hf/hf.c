@@ -18,6 +18,8 @@ typedef struct  HFftab_ele {
     bool_t valid;
     HFHeader hfheader;
     int pfd;
+    int attroff[HF_PAX_MAXATTRS]; /* offsets of the attributes in a PAX record */
+    HFupdate_hook hook;          /* called on each record updated, NULL if none */
 } HFftab_ele;
 
 /* HF scan table element. */
@@ -32,8 +34,17 @@ typedef struct  HFstab_ele {
     RECID current;
 } HFstab_ele;
 
+/* HF file and scan tables, grown on demand. */
 HFftab_ele *hft = NULL;
 HFstab_ele *hst = NULL;
+int HF_ftab_size = 0;
+int HF_stab_size = 0;
+
+/* Stacks of unused file and scan descriptors, the most recently freed one on top. */
+int *HF_freefd = NULL;
+int HF_nfreefd = 0;
+int *HF_freesd = NULL;
+int HF_nfreesd = 0;
 
 int setFirstRec = 0;
 
@@ -49,37 +60,452 @@ int write_header(int pfd, HFHeader *hfheader) {
     return memcpy(pfte->hdr.hdrrest, hfheader, sizeof(HFHeader)) != NULL ? HFE_OK : HFE_INTERNAL;
 }
 
-/* Init HF layer variables. */
-void HF_Init() {
+/* Double the file table. It starts with HF_FTAB_SIZE entries.
+
+    return value: status code.
+*/
+int grow_ftab(void) {
     int i;
+    int newsize = HF_ftab_size == 0 ? HF_FTAB_SIZE : 2 * HF_ftab_size;
+    HFftab_ele *newtab;
+    int *newfree;
 
-    PF_Init();
+    if ((newtab = (HFftab_ele *)realloc(hft, newsize * sizeof(HFftab_ele))) == NULL) {
+        return HFE_FTABFULL;
+    }
+    hft = newtab;
+    if ((newfree = (int *)realloc(HF_freefd, newsize * sizeof(int))) == NULL) {
+        return HFE_FTABFULL;
+    }
+    HF_freefd = newfree;
 
-    hft = (HFftab_ele *)calloc(HF_FTAB_SIZE, sizeof(HFftab_ele));
-    for (i = 0; i < HF_FTAB_SIZE; i++) {
+    for (i = newsize - 1; i >= HF_ftab_size; i--) {
         hft[i].valid = FALSE;
         hft[i].hfheader.RecSize = 0;
         hft[i].hfheader.RecPage = 0;
         hft[i].hfheader.NumPg = 0;
+        HF_freefd[HF_nfreefd++] = i;
+    }
+    HF_ftab_size = newsize;
+
+    return HFE_OK;
+}
+
+/* Double the scan table. It starts with MAXSCANS entries.
+
+    return value: status code.
+*/
+int grow_stab(void) {
+    int i;
+    int newsize = HF_stab_size == 0 ? MAXSCANS : 2 * HF_stab_size;
+    HFstab_ele *newtab;
+    int *newfree;
+
+    if ((newtab = (HFstab_ele *)realloc(hst, newsize * sizeof(HFstab_ele))) == NULL) {
+        return HFE_STABFULL;
+    }
+    hst = newtab;
+    if ((newfree = (int *)realloc(HF_freesd, newsize * sizeof(int))) == NULL) {
+        return HFE_STABFULL;
     }
+    HF_freesd = newfree;
 
-    hst = (HFstab_ele *)calloc(MAXSCANS, sizeof(HFstab_ele));
-    for (i = 0; i < MAXSCANS; i++) {
+    for (i = newsize - 1; i >= HF_stab_size; i--) {
         hst[i].valid = FALSE;
+        HF_freesd[HF_nfreesd++] = i;
+    }
+    HF_stab_size = newsize;
+
+    return HFE_OK;
+}
+
+/* Header of a slotted page, followed by its slot directory. The tuples are
+   stored from the end of the page downwards. */
+typedef struct HFslot_hdr {
+    short nslots;                /* Number of slots in the directory */
+    short upper;                 /* Offset of the lowest tuple */
+} HFslot_hdr;
+
+/* Slot of a slotted page. A slot of length 0 is free. */
+typedef struct HFslot {
+    short offset;                /* Offset of the tuple in the page, with the HF_SLOT_XXX flags */
+    short length;                /* Length of the space of the tuple */
+} HFslot;
+
+#define HF_SLOT_STUB 0x4000      /* the tuple is the RECID where the record was moved to */
+#define HF_SLOT_MOVED 0x2000     /* the tuple is a record moved in, reached only through its stub */
+#define HF_SLOT_OFFSET 0x1FFF    /* the offset without the flags */
+#define HF_TUPLE_MIN ((int) sizeof(RECID)) /* shortest space of a tuple, where a stub fits */
+
+#define HF_RUN_MAX 128           /* longest run of a tuple control byte */
+#define HF_ZERORUN_MIN 3         /* shortest run of zero bytes left out of a tuple */
+
+/* Longest tuple a record may be packed into.
+    - recSize: size of the record.
+
+    return value: number of bytes.
+*/
+int tuple_maxlen(int recSize) {
+    return recSize + (recSize + HF_RUN_MAX - 1) / HF_RUN_MAX;
+}
+
+/* Pack a record into a tuple, leaving out its runs of zero bytes.
+   Each run starts with a control byte: below 0x80, the run has that many plus one
+   literal bytes following; from 0x80 on, it is that many minus 0x7F zero bytes.
+    - record: record to be packed.
+    - recSize: size of the record.
+    - tuple: where the tuple is written, of at least tuple_maxlen(recSize) bytes.
+
+    return value: length of the tuple.
+*/
+int pack_tuple(char *record, int recSize, char *tuple) {
+    int i = 0, len = 0, run, lit;
+
+    while (i < recSize) {
+        /* a run of zero bytes */
+        for (run = 0; i + run < recSize && run < HF_RUN_MAX && record[i + run] == 0; run++);
+        if (run >= HF_ZERORUN_MIN || i + run == recSize) {
+            tuple[len++] = (char) (0x80 + run - 1);
+            i += run;
+            continue;
+        }
+
+        /* literal bytes, up to the next run of zero bytes long enough */
+        lit = 0;
+        while (i + lit < recSize && lit < HF_RUN_MAX) {
+            for (run = 0; i + lit + run < recSize && run < HF_ZERORUN_MIN && record[i + lit + run] == 0; run++);
+            if (run == HF_ZERORUN_MIN || (run > 0 && i + lit + run == recSize)) break;
+            lit += run > 0 ? run : 1;
+        }
+        if (lit > HF_RUN_MAX) lit = HF_RUN_MAX;
+        tuple[len++] = (char) (lit - 1);
+        memcpy(tuple + len, record + i, lit);
+        len += lit;
+        i += lit;
+    }
+
+    return len;
+}
+
+/* Unpack a tuple into a record.
+    - tuple: tuple to be unpacked.
+    - len: length of the tuple.
+    - record: where the record is written.
+    - recSize: size of the record.
+*/
+void unpack_tuple(char *tuple, int len, char *record, int recSize) {
+    int t = 0, i = 0, run;
+    unsigned char c;
+
+    while (t < len && i < recSize) {
+        c = (unsigned char) tuple[t++];
+        if (c >= 0x80) {
+            run = c - 0x7F;
+            memset(record + i, 0, run);
+        } else {
+            run = c + 1;
+            memcpy(record + i, tuple + t, run);
+            t += run;
+        }
+        i += run;
+    }
+}
+
+/* Gather the tuples of a slotted page at the end of the page, leaving one block of free space.
+    - pagebuf: the page.
+*/
+void compact_page(char *pagebuf) {
+    HFslot_hdr *hdr = (HFslot_hdr *) pagebuf;
+    HFslot *slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+    char copy[PAGE_SIZE];
+    int i, upper = PAGE_SIZE;
+
+    memcpy(copy, pagebuf, PAGE_SIZE);
+    for (i = 0; i < hdr->nslots; i++) {
+        if (slots[i].length == 0) continue;
+        upper -= slots[i].length;
+        memcpy(pagebuf + upper, copy + (slots[i].offset & HF_SLOT_OFFSET), slots[i].length);
+        slots[i].offset = upper | (slots[i].offset & ~HF_SLOT_OFFSET);
+    }
+    hdr->upper = upper;
+}
+
+/* Put a tuple in a slot of a slotted page, over the tuple the slot may have. The tuple
+   is written in place if it fits there, and the page is compacted when its free space
+   is enough for the tuple but not in one block.
+    - pagebuf: the page.
+    - recnum: the slot, -1 for the lowest free slot or a new one.
+    - tuple: the tuple.
+    - len: length of the tuple.
+    - flags: HF_SLOT_XXX flags of the slot.
+
+    return value: the slot, -1 if the page is full.
+*/
+int slot_put(char *pagebuf, int recnum, char *tuple, int len, int flags) {
+    HFslot_hdr *hdr = (HFslot_hdr *) pagebuf;
+    HFslot *slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+    int space = len < HF_TUPLE_MIN ? HF_TUPLE_MIN : len;
+    int dir, used, offset, i;
+
+    if (recnum < 0) {
+        for (recnum = 0; recnum < hdr->nslots && slots[recnum].length != 0; recnum++);
+    }
+
+    /* in place of the tuple of the slot */
+    if (recnum < hdr->nslots && slots[recnum].length >= space) {
+        offset = slots[recnum].offset & HF_SLOT_OFFSET;
+        memcpy(pagebuf + offset, tuple, len);
+        slots[recnum].offset = offset | flags;
+        slots[recnum].length = space;
+        return recnum;
+    }
+
+    dir = sizeof(HFslot_hdr) + (recnum < hdr->nslots ? hdr->nslots : recnum + 1) * sizeof(HFslot);
+    for (used = 0, i = 0; i < hdr->nslots; i++) {
+        if (i != recnum) used += slots[i].length;
+    }
+    if (PAGE_SIZE - dir - used < space) {
+        return -1;
+    }
+
+    /* the directory may grow over the lowest tuple, so the page is compacted first */
+    if (recnum < hdr->nslots) slots[recnum].length = 0;
+    if (hdr->upper - dir < space) {
+        compact_page(pagebuf);
+    }
+    for (; hdr->nslots <= recnum; hdr->nslots++) slots[hdr->nslots].length = 0;
+
+    hdr->upper -= space;
+    memcpy(pagebuf + hdr->upper, tuple, len);
+    slots[recnum].offset = hdr->upper | flags;
+    slots[recnum].length = space;
+    return recnum;
+}
+
+/* Find where the record of a slot was moved to.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+    - recnum: place of the record.
+    - moved: set to the position of the record moved, or of pagenum -1 if it was not.
+*/
+void page_moved(HFftab_ele *hfte, char *pagebuf, int recnum, RECID *moved) {
+    HFslot_hdr *hdr = (HFslot_hdr *) pagebuf;
+    HFslot *slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+
+    moved->pagenum = -1;
+    moved->recnum = -1;
+    if (hfte->hfheader.Format == HF_FORMAT_SLOTTED && recnum < hdr->nslots && slots[recnum].length != 0 && (slots[recnum].offset & HF_SLOT_STUB)) {
+        memcpy(moved, pagebuf + (slots[recnum].offset & HF_SLOT_OFFSET), sizeof(RECID));
+    }
+}
+
+/* Make a newly allocated page an empty page of the file.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+*/
+void page_init(HFftab_ele *hfte, char *pagebuf) {
+    HFslot_hdr *hdr = (HFslot_hdr *) pagebuf;
+
+    if (hfte->hfheader.Format == HF_FORMAT_SLOTTED) {
+        hdr->nslots = 0;
+        hdr->upper = PAGE_SIZE;
+    } else {
+        memset(pagebuf + hfte->hfheader.RecSize * hfte->hfheader.RecPage, 0, (hfte->hfheader.RecPage + 7) / 8);
+    }
+}
+
+/* Number of places for records on a page.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+
+    return value: the places are numbered from 0 up to this number.
+*/
+int page_places(HFftab_ele *hfte, char *pagebuf) {
+    return hfte->hfheader.Format == HF_FORMAT_SLOTTED ? ((HFslot_hdr *) pagebuf)->nslots : hfte->hfheader.RecPage;
+}
+
+/* Test whether a record is stored at a place of a page.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+    - recnum: place of the record.
+
+    return value: TRUE if it is.
+*/
+bool_t page_used(HFftab_ele *hfte, char *pagebuf, int recnum) {
+    HFslot_hdr *hdr = (HFslot_hdr *) pagebuf;
+    HFslot *slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+    int recSize = hfte->hfheader.RecSize;
+
+    if (hfte->hfheader.Format == HF_FORMAT_SLOTTED) {
+        return recnum < hdr->nslots && slots[recnum].length != 0 && !(slots[recnum].offset & HF_SLOT_MOVED) ? TRUE : FALSE;
+    }
+    return (pagebuf[recSize * hfte->hfheader.RecPage + recnum / 8] >> (recnum % 8)) & 0x01 ? TRUE : FALSE;
+}
+
+/* Copy a record stored on a page out of it. A record moved to another page is read there.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+    - recnum: place of the record, which must be used.
+    - record: where the record is written.
+
+    return value: status code.
+*/
+int page_read(HFftab_ele *hfte, char *pagebuf, int recnum, char *record) {
+    HFslot *slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+    int recSize = hfte->hfheader.RecSize;
+    RECID moved;
+    char *movedbuf;
+    int i, len;
+
+    if (hfte->hfheader.Format == HF_FORMAT_SLOTTED) {
+        page_moved(hfte, pagebuf, recnum, &moved);
+        if (moved.pagenum >= 0) {
+            if (PF_GetThisPage(hfte->pfd, moved.pagenum, &movedbuf) != PFE_OK) {
+                return HFE_PF;
+            }
+            slots = (HFslot *) (movedbuf + sizeof(HFslot_hdr));
+            unpack_tuple(movedbuf + (slots[moved.recnum].offset & HF_SLOT_OFFSET), slots[moved.recnum].length, record, recSize);
+            return PF_UnpinPage(hfte->pfd, moved.pagenum, 0) == PFE_OK ? HFE_OK : HFE_PF;
+        }
+        unpack_tuple(pagebuf + (slots[recnum].offset & HF_SLOT_OFFSET), slots[recnum].length, record, recSize);
+    } else if (hfte->hfheader.Format == HF_FORMAT_PAX) {
+        for (i = 0; i < hfte->hfheader.NumAttrs; i++) {
+            len = hfte->hfheader.AttrLen[i];
+            memcpy(record + hfte->attroff[i], pagebuf + hfte->hfheader.RecPage * hfte->attroff[i] + len * recnum, len);
+        }
+    } else {
+        memcpy(record, pagebuf + recSize * recnum, recSize);
+    }
+    return HFE_OK;
+}
+
+/* Copy bytes of a record to its place on a page in the fixed or PAX format.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+    - recnum: place of the record.
+    - offset: offset of the bytes in the record.
+    - length: number of bytes.
+    - data: the bytes.
+*/
+void page_write(HFftab_ele *hfte, char *pagebuf, int recnum, int offset, int length, char *data) {
+    int i, len, from, to;
+
+    if (hfte->hfheader.Format == HF_FORMAT_PAX) {
+        for (i = 0; i < hfte->hfheader.NumAttrs; i++) {
+            len = hfte->hfheader.AttrLen[i];
+            from = offset > hfte->attroff[i] ? offset : hfte->attroff[i];
+            to = offset + length < hfte->attroff[i] + len ? offset + length : hfte->attroff[i] + len;
+            if (from < to) {
+                memcpy(pagebuf + hfte->hfheader.RecPage * hfte->attroff[i] + len * recnum + from - hfte->attroff[i], data + from - offset, to - from);
+            }
+        }
+    } else {
+        memcpy(pagebuf + hfte->hfheader.RecSize * recnum + offset, data, length);
+    }
+}
+
+/* Find an attribute of a record in a page, without copying the record out.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+    - recnum: place of the record.
+    - attrOffset: offset of the attribute in the record.
+    - attrLength: length of the attribute.
+
+    return value: pointer to the attribute, NULL if it is not stored as such in the page.
+*/
+char *page_attr(HFftab_ele *hfte, char *pagebuf, int recnum, int attrOffset, int attrLength) {
+    int i, len;
+
+    if (hfte->hfheader.Format == HF_FORMAT_FIXED) {
+        return pagebuf + hfte->hfheader.RecSize * recnum + attrOffset;
+    }
+    if (hfte->hfheader.Format == HF_FORMAT_PAX) {
+        for (i = 0; i < hfte->hfheader.NumAttrs; i++) {
+            len = hfte->hfheader.AttrLen[i];
+            if (attrOffset >= hfte->attroff[i] && attrOffset + attrLength <= hfte->attroff[i] + len) {
+                return pagebuf + hfte->hfheader.RecPage * hfte->attroff[i] + len * recnum + attrOffset - hfte->attroff[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Store a record on a page, at its first free place.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+    - record: record to be stored.
+    - flags: HF_SLOT_XXX flags of the slot of a slotted page.
+
+    return value: place of the record, -1 if the page is full.
+*/
+int page_insert(HFftab_ele *hfte, char *pagebuf, char *record, int flags) {
+    int recSize = hfte->hfheader.RecSize;
+    char tuple[PAGE_SIZE];
+    int recnum;
+
+    if (hfte->hfheader.Format == HF_FORMAT_SLOTTED) {
+        return slot_put(pagebuf, -1, tuple, pack_tuple(record, recSize, tuple), flags);
+    }
+
+    for (recnum = 0; recnum < hfte->hfheader.RecPage; recnum++) {
+        if (page_used(hfte, pagebuf, recnum) == FALSE) {
+            page_write(hfte, pagebuf, recnum, 0, recSize, record);
+            pagebuf[recSize * hfte->hfheader.RecPage + recnum / 8] |= 0x01 << (recnum % 8);
+            return recnum;
+        }
+    }
+    return -1;
+}
+
+/* Remove a record from a page. The free slots at the end of the directory are
+   dropped, and a slotted page left empty gets all its space back.
+    - hfte: HF file table element.
+    - pagebuf: the page.
+    - recnum: place of the record.
+
+    return value: TRUE if no record is left on the page.
+*/
+bool_t page_delete(HFftab_ele *hfte, char *pagebuf, int recnum) {
+    HFslot_hdr *hdr = (HFslot_hdr *) pagebuf;
+    HFslot *slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+    char *bitmap = pagebuf + hfte->hfheader.RecSize * hfte->hfheader.RecPage;
+    int byte;
+
+    if (hfte->hfheader.Format == HF_FORMAT_SLOTTED) {
+        if (recnum < hdr->nslots) {
+            /* the space of the lowest tuple is given back at once */
+            if (slots[recnum].length != 0 && (slots[recnum].offset & HF_SLOT_OFFSET) == hdr->upper) hdr->upper += slots[recnum].length;
+            slots[recnum].length = 0;
+        }
+        while (hdr->nslots > 0 && slots[hdr->nslots - 1].length == 0) hdr->nslots--;
+        if (hdr->nslots == 0) hdr->upper = PAGE_SIZE;
+        return hdr->nslots == 0 ? TRUE : FALSE;
+    }
+
+    bitmap[recnum / 8] &= 0xFF - (0x01 << (recnum % 8));
+    for (byte = 0; byte < (hfte->hfheader.RecPage + 7) / 8; byte++) {
+        if (bitmap[byte] != 0) return FALSE;
     }
+    return TRUE;
+}
+
+/* Init HF layer variables. */
+void HF_Init() {
+    PF_Init();
+
+    grow_ftab();
+    grow_stab();
 }
 
-/* Create new file with PF layer functions.
+/* Create a file with PF layer functions, and write its header.
     - fileName: name of the file.
-    - recSize: size of each record.
+    - hfheader: header, of which the number of records per page is filled here.
 
     return value: satus code.
 */
-int HF_CreateFile(char *fileName, int recSize) {
+int create_file(char *fileName, HFHeader *hfheader) {
     int pfd;
     double _recSize;
-    PFftab_ele *pfte = NULL;
-    HFHeader hfheader;
 
     if (PF_CreateFile(fileName) != PFE_OK) {
         return HFE_PF;
@@ -89,13 +515,17 @@ int HF_CreateFile(char *fileName, int recSize) {
         return HFE_PF;
     }
 
-    hfheader.RecSize = recSize;
-    _recSize = ((double) recSize) + 0.125;
-    hfheader.RecPage = ((double)PAGE_SIZE) / _recSize ;
-    /* printf("HF_CreateFile: %s, %d / (%d + 0.125) = %d\n", fileName,  PAGE_SIZE, recSize, hfheader.RecPage); */
-    hfheader.NumPg = 0;
+    if (hfheader->Format == HF_FORMAT_SLOTTED) {
+        /* a slot for every tuple of the shortest space */
+        hfheader->RecPage = (PAGE_SIZE - sizeof(HFslot_hdr)) / (sizeof(HFslot) + HF_TUPLE_MIN);
+    } else {
+        _recSize = ((double) hfheader->RecSize) + 0.125;
+        hfheader->RecPage = ((double)PAGE_SIZE) / _recSize ;
+    }
+    /* printf("HF_CreateFile: %s, %d / (%d + 0.125) = %d\n", fileName,  PAGE_SIZE, hfheader->RecSize, hfheader->RecPage); */
+    hfheader->NumPg = 0;
 
-    if (write_header(pfd, &hfheader) != HFE_OK) {
+    if (write_header(pfd, hfheader) != HFE_OK) {
         PF_CloseFile(pfd);
         return HFE_PF;
     }
@@ -103,6 +533,69 @@ int HF_CreateFile(char *fileName, int recSize) {
     return PF_CloseFile(pfd) == PFE_OK ? HFE_OK : HFE_PF;
 }
 
+/* Create new file with PF layer functions, of fixed-size records.
+    - fileName: name of the file.
+    - recSize: size of each record.
+
+    return value: satus code.
+*/
+int HF_CreateFile(char *fileName, int recSize) {
+    return HF_CreateFileFormat(fileName, recSize, HF_FORMAT_FIXED);
+}
+
+/* Create new file with PF layer functions, of the given page format.
+    - fileName: name of the file.
+    - recSize: size of each record.
+    - format: page format, HF_FORMAT_FIXED or HF_FORMAT_SLOTTED.
+
+    return value: satus code.
+*/
+int HF_CreateFileFormat(char *fileName, int recSize, int format) {
+    HFHeader hfheader;
+
+    if (format != HF_FORMAT_FIXED && format != HF_FORMAT_SLOTTED) {
+        return HFE_FORMAT;
+    }
+    if (recSize <= 0 || (format == HF_FORMAT_SLOTTED && (int) (sizeof(HFslot_hdr) + sizeof(HFslot)) + tuple_maxlen(recSize) > PAGE_SIZE)) {
+        return HFE_RECSIZE;
+    }
+
+    memset(&hfheader, 0, sizeof(HFHeader));
+    hfheader.RecSize = recSize;
+    hfheader.Format = format;
+    return create_file(fileName, &hfheader);
+}
+
+/* Create new file with PF layer functions, in the PAX format: the values of each
+   attribute are stored together in a page, so that a scan reads only the attributes
+   it compares.
+    - fileName: name of the file.
+    - numAttrs: number of attributes of a record, HF_PAX_MAXATTRS at most.
+    - attrLens: their lengths, in the order they have in a record.
+
+    return value: satus code.
+*/
+int HF_CreateFilePax(char *fileName, int numAttrs, int *attrLens) {
+    HFHeader hfheader;
+    int i;
+
+    if (numAttrs <= 0 || numAttrs > HF_PAX_MAXATTRS) {
+        return HFE_RECSIZE;
+    }
+
+    memset(&hfheader, 0, sizeof(HFHeader));
+    for (i = 0; i < numAttrs; i++) {
+        if (attrLens[i] <= 0) {
+            return HFE_ATTRLENGTH;
+        }
+        hfheader.AttrLen[i] = attrLens[i];
+        hfheader.RecSize += attrLens[i];
+    }
+    hfheader.NumAttrs = numAttrs;
+    hfheader.Format = HF_FORMAT_PAX;
+    return create_file(fileName, &hfheader);
+}
+
 /* Destroy a file.
     - fileName: name of the file.
 
@@ -120,28 +613,36 @@ int HF_DestroyFile(char *fileName) {
 int HF_OpenFile(char *fileName) {
     int hfd;
     int pfd;
+    int i, off;
+    HFftab_ele *hfte;
 
     if ((pfd = PF_OpenFile(fileName)) < 0) {
         return HFE_PF;
     }
 
-    for (hfd = 0; hfd < HF_FTAB_SIZE; hfd++) {
-        HFftab_ele *hfte = &(hft[hfd]);
-        if (hfte->valid == FALSE) {
-            if (memcpy(&(hfte->hfheader), pft[pfd].hdr.hdrrest, sizeof(HFHeader)) == NULL || hfte->hfheader.RecSize <= 0 || hfte->hfheader.RecPage <= 0) {
-                PF_CloseFile(pfd);
-                return HFE_PF;
-            }
-
-            hfte->valid = TRUE;
-            hfte->pfd = pfd;
+    if (HF_nfreefd == 0 && grow_ftab() != HFE_OK) {
+        PF_CloseFile(pfd);
+        return HFE_FTABFULL;
+    }
+    hfd = HF_freefd[HF_nfreefd - 1];
+    hfte = &(hft[hfd]);
 
-            return hfd;
-        }
+    if (memcpy(&(hfte->hfheader), pft[pfd].hdr.hdrrest, sizeof(HFHeader)) == NULL || hfte->hfheader.RecSize <= 0 || hfte->hfheader.RecPage <= 0
+            || (hfte->hfheader.Format != HF_FORMAT_FIXED && hfte->hfheader.Format != HF_FORMAT_SLOTTED && hfte->hfheader.Format != HF_FORMAT_PAX)) {
+        PF_CloseFile(pfd);
+        return HFE_PF;
+    }
+    for (i = 0, off = 0; i < hfte->hfheader.NumAttrs; i++) {
+        hfte->attroff[i] = off;
+        off += hfte->hfheader.AttrLen[i];
     }
 
-    PF_CloseFile(pfd);
-    return HFE_FTABFULL;
+    HF_nfreefd--;
+    hfte->valid = TRUE;
+    hfte->pfd = pfd;
+    hfte->hook = NULL;
+
+    return hfd;
 }
 
 /* Close a open file.
@@ -150,7 +651,12 @@ int HF_OpenFile(char *fileName) {
     return value: satus code.
 */
 int HF_CloseFile(int HFfd) {
-    int pfd = hft[HFfd].pfd;
+    int pfd;
+
+    if (HFfd < 0 || HFfd >= HF_ftab_size || hft[HFfd].valid == FALSE) {
+        return HFE_FD;
+    }
+    pfd = hft[HFfd].pfd;
 
     if (write_header(pfd, &(hft[HFfd].hfheader)) != HFE_OK) {
         /* printf("here\n"); */
@@ -166,111 +672,233 @@ int HF_CloseFile(int HFfd) {
     hft[HFfd].hfheader.RecSize = 0;
     hft[HFfd].hfheader.RecPage = 0;
     hft[HFfd].hfheader.NumPg = 0;
+    hft[HFfd].hook = NULL;
+    HF_freefd[HF_nfreefd++] = HFfd;
 
     return HFE_OK;
 }
 
-/* Insert a record to HF fd.
-    - HFfd: fd of HF layer.
+/* Get the page of a file after a page, pinned; a page is allocated when there is none.
+    - hfte: HF file table element.
+    - pagenum: the page to start after, -1 for the first one; set to the page.
+    - pagebuf: set to the page.
+    - limit: first page not to be used nor allocated, -1 for none.
+
+    return value: status code, HFE_EOF if no page is left below the limit.
+*/
+int next_page(HFftab_ele *hfte, int *pagenum, char **pagebuf, int limit) {
+    int err = PF_GetNextPage(hfte->pfd, pagenum, pagebuf);
+
+    if (err == PFE_OK && limit >= 0 && *pagenum >= limit) {
+        PF_UnpinPage(hfte->pfd, *pagenum, 0);
+        err = PFE_EOF;
+    }
+    if (err == PFE_OK) {
+        return HFE_OK;
+    } else if (err != PFE_EOF) {
+        return HFE_PF;
+    }
+
+    if (PF_AllocPage (hfte->pfd, pagenum, pagebuf) != PFE_OK) {
+        return HFE_PF;
+    }
+
+    /* only a page disposed before the limit may be taken */
+    if (limit >= 0 && *pagenum >= limit) {
+        if (PF_UnpinPage(hfte->pfd, *pagenum, 0) != PFE_OK || PF_DisposePage(hfte->pfd, *pagenum) != PFE_OK) {
+            return HFE_PF;
+        }
+        return HFE_EOF;
+    }
+    page_init(hfte, *pagebuf);
+
+    /* printf("allocating page %d\n", hfte->hfheader.NumPg); */
+    /* the page may be a disposed one reused by PF, so ask PF for the page count */
+    PF_GetNumPages(hfte->pfd, &(hfte->hfheader.NumPg));
+    write_header(hfte->pfd, &(hfte->hfheader));
+    return HFE_OK;
+}
+
+/* Store a record at the first place free for it in the file, allocating a page if none is.
+    - hfte: HF file table element.
     - record: pointer to record content.
+    - flags: HF_SLOT_XXX flags of the slot of a slotted page.
+    - limit: first page not to be used nor allocated, -1 for none.
 
-    return value: record id of inserted position.
+    return value: record id of inserted position, of recnum HFE_EOF if no page below the limit has room.
 */
-RECID HF_InsertRec(int HFfd, char *record) {
-    HFftab_ele *hfte = &(hft[HFfd]);
-    int recSize = hfte->hfheader.RecSize;
+RECID place_record(HFftab_ele *hfte, char *record, int flags, int limit) {
     RECID recid;
-    int pagenum, recnum;
+    int pagenum, recnum, err;
     char *pagebuf;
-    int byte, bit;
-    char map;
 
     recid.pagenum = -1;
     recid.recnum = HFE_PF;
 
     pagenum = -1;
-    while (1) {
-        int err = PF_GetNextPage(hfte->pfd, &pagenum, &pagebuf);
-
-        if (err == PFE_EOF) {
-            if (PF_AllocPage (hfte->pfd, &pagenum, &pagebuf) != PFE_OK || PF_UnpinPage(hfte->pfd, pagenum, 1) != PFE_OK) {
-                return recid;
+    while ((err = next_page(hfte, &pagenum, &pagebuf, limit)) == HFE_OK) {
+        if ((recnum = page_insert(hfte, pagebuf, record, flags)) >= 0) {
+            if (PF_UnpinPage(hfte->pfd, pagenum, 1) == PFE_OK) {
+                recid.pagenum = pagenum;
+                recid.recnum = recnum;
             }
 
-            /* printf("allocating page %d\n", hfte->hfheader.NumPg); */
-            hfte->hfheader.NumPg++;
-            pagenum--;
-            continue;
-        } else if (err != PFE_OK) {
             return recid;
         }
 
-        for (recnum = 0; recnum < hfte->hfheader.RecPage; recnum++) {
-            byte = recnum / 8;
-            bit = recnum % 8;
-
-            map = pagebuf[recSize * hfte->hfheader.RecPage + byte];
-
-            if (((map >> bit) & 0x01) == 0) {
-                if (memcpy(pagebuf + recSize * recnum, record, recSize) == NULL) {
-                    PF_UnpinPage(hfte->pfd, pagenum, 0);
-                    return recid;
-                }
-
-                /* printf("insert %s at %d, %d. map changes from %x, to %x\n", record, pagenum, recnum, map & 0xFF, map | (0x01 << bit)); */
-
-                pagebuf[recSize * hfte->hfheader.RecPage + byte] = map | (0x01 << bit);
-
-                if (PF_UnpinPage(hfte->pfd, pagenum, 1) == PFE_OK) {
-                    recid.pagenum = pagenum;
-                    recid.recnum = recnum;
-                }
-
-                return recid;
-            }
-        }
-
         if (PF_UnpinPage(hfte->pfd, pagenum, 0) != PFE_OK) {
             return recid;
         }
     }
+
+    recid.recnum = err;
+    return recid;
 }
 
-/* Delete a record.
-    - HFfd: fd of HF layer.
-    - recId: record id of which will be deleted.
+/* Remove the tuple at a position. A page left without any record is given back to PF.
+    - hfte: HF file table element.
+    - recId: position of the tuple.
 
     return value: status code.
 */
-int HF_DeleteRec(int HFfd, RECID recId) {
-    HFftab_ele *hfte = &(hft[HFfd]);
-    int recSize = hfte->hfheader.RecSize;
+int remove_tuple(HFftab_ele *hfte, RECID recId) {
     char *pagebuf;
-    int byte, bit;
-    char map;
+    bool_t empty;
 
     if (PF_GetThisPage(hfte->pfd, recId.pagenum, &pagebuf) != PFE_OK) {
         return HFE_PF;
     }
 
-    byte = recId.recnum / 8;
-    bit = recId.recnum % 8;
+    /* check whether any record is left on the page */
+    empty = page_delete(hfte, pagebuf, recId.recnum);
 
-    map = pagebuf[recSize * hfte->hfheader.RecPage + byte];
-    pagebuf[recSize * hfte->hfheader.RecPage + byte] = map & (0xFF - (0x01 << bit));
-
-    /* printf("delete %d, %d. map changes from %x, to %x\n", recId.pagenum, recId.recnum, map & 0xFF, map & (0xFF - (0x01 << bit))); */
+    if (PF_UnpinPage(hfte->pfd, recId.pagenum, 1) != PFE_OK) {
+        return HFE_PF;
+    }
 
-    return PF_UnpinPage(hfte->pfd, recId.pagenum, 1) == PFE_OK ? HFE_OK : HFE_PF;
+    /* the drained page is disposed, so that later insertions can reuse it */
+    if (empty == TRUE) {
+        if (PF_DisposePage(hfte->pfd, recId.pagenum) == PFE_OK) {
+            PF_GetNumPages(hfte->pfd, &(hfte->hfheader.NumPg));
+            write_header(hfte->pfd, &(hfte->hfheader));
+        }
+    }
+    return HFE_OK;
 }
 
-/* Get the first record of a file.
-    - HFfd: fd of HF layer.
-    - record: pointer where read content will be copied.
+/* Check a position a scan resumes after. Deleting the records the scan returned may have disposed of
+    the position's page, and of the last pages of the file with it, which only means that the scan is at its end.
+    - hfte: HF file table element.
+    - recId: position the scan resumes after.
 
-    return value: record id of which is found.
+    return value: HFE_OK, HFE_EOF if the position is past the last page, HFE_INVALIDRECORD if it is not a position.
 */
-RECID HF_GetFirstRec(int HFfd, char *record) {
+int resume_position(HFftab_ele *hfte, RECID recId) {
+    if (recId.pagenum < 0 || recId.recnum < 0 || recId.recnum >= hfte->hfheader.RecPage) {
+        return HFE_INVALIDRECORD;
+    }
+    if (recId.pagenum >= hfte->hfheader.NumPg) {
+        return HFE_EOF;
+    }
+    return HFE_OK;
+}
+
+/* Insert a record to HF fd.
+    - HFfd: fd of HF layer.
+    - record: pointer to record content.
+
+    return value: record id of inserted position.
+*/
+RECID HF_InsertRec(int HFfd, char *record) {
+    RECID recid;
+
+    recid = place_record(&(hft[HFfd]), record, 0, -1);
+
+    /* the insertion is committed to the log, if PF keeps one */
+    if (recid.pagenum >= 0 && PF_Commit() != PFE_OK) {
+        recid.pagenum = -1;
+        recid.recnum = HFE_PF;
+    }
+    return recid;
+}
+
+/* Insert records to HF fd. The pages are filled one after the other, each staying
+   pinned while records fit in it, and the insertions are committed together.
+    - HFfd: fd of HF layer.
+    - records: the records, one after the other.
+    - n: number of records.
+    - recIds: where the record ids of the records inserted are written, in their order.
+
+    return value: status code.
+*/
+int HF_InsertRecs(int HFfd, char *records, int n, RECID *recIds) {
+    HFftab_ele *hfte;
+    int pagenum, recnum, k, first, err;
+    char *pagebuf;
+
+    if (HFfd < 0 || HFfd >= HF_ftab_size || hft[HFfd].valid == FALSE) {
+        return HFE_FD;
+    }
+    hfte = &(hft[HFfd]);
+
+    pagenum = -1;
+    for (k = 0; k < n; ) {
+        if ((err = next_page(hfte, &pagenum, &pagebuf, -1)) != HFE_OK) {
+            return err;
+        }
+
+        for (first = k; k < n; k++) {
+            if ((recnum = page_insert(hfte, pagebuf, records + (long) hfte->hfheader.RecSize * k, 0)) < 0) break;
+            recIds[k].pagenum = pagenum;
+            recIds[k].recnum = recnum;
+        }
+
+        if (PF_UnpinPage(hfte->pfd, pagenum, k > first ? 1 : 0) != PFE_OK) {
+            return HFE_PF;
+        }
+    }
+
+    /* the insertions are committed to the log, if PF keeps one */
+    return PF_Commit() == PFE_OK ? HFE_OK : HFE_PF;
+}
+
+/* Delete a record, and the tuple it was moved to if it was.
+    - HFfd: fd of HF layer.
+    - recId: record id of which will be deleted.
+
+    return value: status code.
+*/
+int HF_DeleteRec(int HFfd, RECID recId) {
+    HFftab_ele *hfte = &(hft[HFfd]);
+    char *pagebuf;
+    RECID moved;
+
+    if (PF_GetThisPage(hfte->pfd, recId.pagenum, &pagebuf) != PFE_OK) {
+        return HFE_PF;
+    }
+    page_moved(hfte, pagebuf, recId.recnum, &moved);
+    if (PF_UnpinPage(hfte->pfd, recId.pagenum, 0) != PFE_OK) {
+        return HFE_PF;
+    }
+
+    if (moved.pagenum >= 0 && remove_tuple(hfte, moved) != HFE_OK) {
+        return HFE_PF;
+    }
+    if (remove_tuple(hfte, recId) != HFE_OK) {
+        return HFE_PF;
+    }
+
+    /* the deletion is committed to the log, if PF keeps one */
+    return PF_Commit() == PFE_OK ? HFE_OK : HFE_PF;
+}
+
+/* Get the first record of a file.
+    - HFfd: fd of HF layer.
+    - record: pointer where read content will be copied.
+
+    return value: record id of which is found.
+*/
+RECID HF_GetFirstRec(int HFfd, char *record) {
     RECID recid;
     recid.pagenum = 0;
     recid.recnum = 0;
@@ -288,24 +916,22 @@ RECID HF_GetFirstRec(int HFfd, char *record) {
 */
 RECID HF_GetNextRec(int HFfd, RECID recId, char *record) {
     HFftab_ele *hfte = &(hft[HFfd]);
-    int recSize = hfte->hfheader.RecSize;
     RECID recid;
-    int pagenum, recnum;
+    int pagenum, recnum, err;
     char *pagebuf;
-    int byte, bit;
-    char map;
 
     recid.pagenum = -1;
     recid.recnum = HFE_PF;
 
-    if (HF_ValidRecId(HFfd, recId) != TRUE) {
-        recid.recnum = HFE_INVALIDRECORD;
+    if ((err = resume_position(hfte, recId)) != HFE_OK) {
+        setFirstRec = 0;
+        recid.recnum = err;
         return recid;
     }
 
     pagenum = recId.pagenum - 1;
     while (1) {
-        int err = PF_GetNextPage(hfte->pfd, &pagenum, &pagebuf);
+        err = PF_GetNextPage(hfte->pfd, &pagenum, &pagebuf);
 
         if (err == PFE_EOF) {
             /* printf("here %d, %d\n", pagenum, recId.pagenum); */
@@ -326,19 +952,11 @@ RECID HF_GetNextRec(int HFfd, RECID recId, char *record) {
             recnum = 0;
         }
 
-        for (; recnum < hfte->hfheader.RecPage; recnum++) {
-            byte = recnum / 8;
-            bit = recnum % 8;
-
-            map = pagebuf[recSize * hfte->hfheader.RecPage + byte];
-
-            if (((map >> bit) & 0x01) == 1) {
-                if (memcpy(record, pagebuf + recSize * recnum, recSize) == NULL) {
-                    PF_UnpinPage(hfte->pfd, pagenum, 0);
-                    return recid;
-                }
+        for (; recnum < page_places(hfte, pagebuf); recnum++) {
+            if (page_used(hfte, pagebuf, recnum) == TRUE) {
+                err = page_read(hfte, pagebuf, recnum, record);
 
-                if (PF_UnpinPage(hfte->pfd, pagenum, 0) == PFE_OK) {
+                if (PF_UnpinPage(hfte->pfd, pagenum, 0) == PFE_OK && err == HFE_OK) {
                     recid.pagenum = pagenum;
                     recid.recnum = recnum;
                 }
@@ -362,10 +980,8 @@ RECID HF_GetNextRec(int HFfd, RECID recId, char *record) {
 */
 int HF_GetThisRec(int HFfd, RECID recId, char *record) {
     HFftab_ele *hfte = &(hft[HFfd]);
-    int recSize = hfte->hfheader.RecSize;
     char *pagebuf;
-    int byte, bit;
-    char map;
+    int err;
 
     if (HF_ValidRecId(HFfd, recId) != TRUE) {
         return HFE_INVALIDRECORD;
@@ -375,21 +991,443 @@ int HF_GetThisRec(int HFfd, RECID recId, char *record) {
         return HFE_PF;
     }
 
-    byte = recId.recnum / 8;
-    bit = recId.recnum % 8;
+    if (page_used(hfte, pagebuf, recId.recnum) == TRUE) {
+        err = page_read(hfte, pagebuf, recId.recnum, record);
 
-    map = pagebuf[recSize * hfte->hfheader.RecPage + byte];
-    if (((map >> bit) & 0x01) == 1) {
-        if (memcpy(record, pagebuf + recSize * recId.recnum, recSize) == NULL) {
-            PF_UnpinPage(hfte->pfd, recId.pagenum, 0);
+        return PF_UnpinPage(hfte->pfd, recId.pagenum, 0) == PFE_OK ? err : HFE_PF;
+    } else {
+        PF_UnpinPage(hfte->pfd, recId.pagenum, 0);
+        return HFE_EOF;
+    }
+}
+
+/* Order record ids by page, then by place in the page, for qsort(). */
+int recid_cmp(const void *a, const void *b) {
+    const RECID *x = (const RECID *) a;
+    const RECID *y = (const RECID *) b;
+
+    if (x->pagenum != y->pagenum) return x->pagenum < y->pagenum ? -1 : 1;
+    return (x->recnum > y->recnum) - (x->recnum < y->recnum);
+}
+
+/* Get the records at given positions, reading each page once. The record ids are
+   sorted by page, then by place in the page, so that the pages are read in the order
+   of the file however the ids were found (e.g. by an index scan, in key order).
+    - HFfd: fd of HF layer.
+    - recIds: record positions to read, sorted in place.
+    - n: number of records.
+    - records: where the records are written, one after the other, in the order of recIds once sorted.
+
+    return value: status code.
+*/
+int HF_GetRecs(int HFfd, RECID *recIds, int n, char *records) {
+    HFftab_ele *hfte;
+    int pagenum, k, err;
+    char *pagebuf;
+
+    if (HFfd < 0 || HFfd >= HF_ftab_size || hft[HFfd].valid == FALSE) {
+        return HFE_FD;
+    }
+    hfte = &(hft[HFfd]);
+
+    qsort(recIds, n, sizeof(RECID), recid_cmp);
+
+    pagenum = -1;
+    err = HFE_OK;
+    for (k = 0; k < n && err == HFE_OK; k++) {
+        if (HF_ValidRecId(HFfd, recIds[k]) != TRUE) {
+            err = HFE_INVALIDRECORD;
+            break;
+        }
+
+        /* the page of the previous record is kept pinned for the next ones on it */
+        if (recIds[k].pagenum != pagenum) {
+            if (pagenum >= 0 && PF_UnpinPage(hfte->pfd, pagenum, 0) != PFE_OK) {
+                return HFE_PF;
+            }
+            pagenum = recIds[k].pagenum;
+            if (PF_GetThisPage(hfte->pfd, pagenum, &pagebuf) != PFE_OK) {
+                return HFE_PF;
+            }
+        }
+
+        if (page_used(hfte, pagebuf, recIds[k].recnum) == TRUE) {
+            err = page_read(hfte, pagebuf, recIds[k].recnum, records + (long) hfte->hfheader.RecSize * k);
+        } else {
+            err = HFE_EOF;
+        }
+    }
+
+    if (pagenum >= 0 && PF_UnpinPage(hfte->pfd, pagenum, 0) != PFE_OK) {
+        return HFE_PF;
+    }
+    return err;
+}
+
+/* Write a changed record of a slotted page. A record which no longer fits its page is
+   moved to another one, leaving a stub with its new position in its slot, so that its
+   record id stays the same; a moved record is brought back when it fits its page again.
+    - hfte: HF file table element.
+    - recId: record position.
+    - record: the changed record.
+
+    return value: status code.
+*/
+int update_tuple(HFftab_ele *hfte, RECID recId, char *record) {
+    char tuple[PAGE_SIZE];
+    char *pagebuf;
+    RECID moved, newrid;
+    int len;
+
+    len = pack_tuple(record, hfte->hfheader.RecSize, tuple);
+
+    /* at home, over the record or its stub */
+    if (PF_GetThisPage(hfte->pfd, recId.pagenum, &pagebuf) != PFE_OK) {
+        return HFE_PF;
+    }
+    page_moved(hfte, pagebuf, recId.recnum, &moved);
+    if (slot_put(pagebuf, recId.recnum, tuple, len, 0) >= 0) {
+        if (PF_UnpinPage(hfte->pfd, recId.pagenum, 1) != PFE_OK) {
             return HFE_PF;
         }
+        return moved.pagenum >= 0 ? remove_tuple(hfte, moved) : HFE_OK;
+    }
+    if (PF_UnpinPage(hfte->pfd, recId.pagenum, 0) != PFE_OK) {
+        return HFE_PF;
+    }
 
-        return PF_UnpinPage(hfte->pfd, recId.pagenum, 0) == PFE_OK ? HFE_OK : HFE_PF;
-    } else {
+    /* where it was moved to */
+    if (moved.pagenum >= 0) {
+        if (PF_GetThisPage(hfte->pfd, moved.pagenum, &pagebuf) != PFE_OK) {
+            return HFE_PF;
+        }
+        if (slot_put(pagebuf, moved.recnum, tuple, len, HF_SLOT_MOVED) >= 0) {
+            return PF_UnpinPage(hfte->pfd, moved.pagenum, 1) == PFE_OK ? HFE_OK : HFE_PF;
+        }
+        if (PF_UnpinPage(hfte->pfd, moved.pagenum, 0) != PFE_OK) {
+            return HFE_PF;
+        }
+    }
+
+    /* to another page, the stub in its slot pointing to it */
+    newrid = place_record(hfte, record, HF_SLOT_MOVED, -1);
+    if (newrid.pagenum < 0) {
+        return HFE_PF;
+    }
+    if (moved.pagenum >= 0 && remove_tuple(hfte, moved) != HFE_OK) {
+        return HFE_PF;
+    }
+    if (PF_GetThisPage(hfte->pfd, recId.pagenum, &pagebuf) != PFE_OK) {
+        return HFE_PF;
+    }
+    slot_put(pagebuf, recId.recnum, (char *) &newrid, sizeof(RECID), HF_SLOT_STUB);
+    return PF_UnpinPage(hfte->pfd, recId.pagenum, 1) == PFE_OK ? HFE_OK : HFE_PF;
+}
+
+/* Change bytes of a record where it is.
+    - HFfd: fd of HF layer.
+    - recId: record position.
+    - offset: offset of the bytes in the record.
+    - length: number of bytes.
+    - data: the new bytes.
+
+    return value: status code.
+*/
+int update_record(int HFfd, RECID recId, int offset, int length, char *data) {
+    HFftab_ele *hfte = &(hft[HFfd]);
+    char oldrec[PAGE_SIZE], newrec[PAGE_SIZE];
+    char *pagebuf;
+    int err;
+
+    if (HF_ValidRecId(HFfd, recId) != TRUE) {
+        return HFE_INVALIDRECORD;
+    }
+    if (offset < 0 || offset >= hfte->hfheader.RecSize) {
+        return HFE_ATTROFFSET;
+    }
+    if (length <= 0 || offset + length > hfte->hfheader.RecSize) {
+        return HFE_ATTRLENGTH;
+    }
+
+    if (PF_GetThisPage(hfte->pfd, recId.pagenum, &pagebuf) != PFE_OK) {
+        return HFE_PF;
+    }
+    if (page_used(hfte, pagebuf, recId.recnum) == FALSE) {
         PF_UnpinPage(hfte->pfd, recId.pagenum, 0);
         return HFE_EOF;
     }
+
+    /* the whole record is needed only by the hook and by a slotted page */
+    if (hfte->hook != NULL || hfte->hfheader.Format == HF_FORMAT_SLOTTED) {
+        if ((err = page_read(hfte, pagebuf, recId.recnum, oldrec)) != HFE_OK) {
+            PF_UnpinPage(hfte->pfd, recId.pagenum, 0);
+            return err;
+        }
+        memcpy(newrec, oldrec, hfte->hfheader.RecSize);
+        memcpy(newrec + offset, data, length);
+
+        if (hfte->hook != NULL && (err = (*hfte->hook)(HFfd, recId, oldrec, newrec)) != HFE_OK) {
+            PF_UnpinPage(hfte->pfd, recId.pagenum, 0);
+            return err;
+        }
+    }
+
+    if (hfte->hfheader.Format == HF_FORMAT_SLOTTED) {
+        if (PF_UnpinPage(hfte->pfd, recId.pagenum, 0) != PFE_OK || (err = update_tuple(hfte, recId, newrec)) != HFE_OK) {
+            return HFE_PF;
+        }
+    } else {
+        page_write(hfte, pagebuf, recId.recnum, offset, length, data);
+        if (PF_UnpinPage(hfte->pfd, recId.pagenum, 1) != PFE_OK) {
+            return HFE_PF;
+        }
+    }
+
+    /* the update is committed to the log, if PF keeps one */
+    return PF_Commit() == PFE_OK ? HFE_OK : HFE_PF;
+}
+
+/* Update a record in place, keeping its record id; a record of a slotted page which
+   grows out of its page is moved, and found through its old record id still.
+    - HFfd: fd of HF layer.
+    - recId: record position.
+    - record: new content of the record.
+
+    return value: status code.
+*/
+int HF_UpdateRec(int HFfd, RECID recId, char *record) {
+    if (HFfd < 0 || HFfd >= HF_ftab_size || hft[HFfd].valid == FALSE) {
+        return HFE_FD;
+    }
+    return update_record(HFfd, recId, 0, hft[HFfd].hfheader.RecSize, record);
+}
+
+/* Update a range of bytes of a record in place, such as an attribute, keeping its record id.
+    - HFfd: fd of HF layer.
+    - recId: record position.
+    - offset: offset of the range in the record.
+    - length: length of the range.
+    - data: new content of the range.
+
+    return value: status code.
+*/
+int HF_UpdateRecRange(int HFfd, RECID recId, int offset, int length, char *data) {
+    if (HFfd < 0 || HFfd >= HF_ftab_size || hft[HFfd].valid == FALSE) {
+        return HFE_FD;
+    }
+    return update_record(HFfd, recId, offset, length, data);
+}
+
+/* Set the function called with the old and the new content of each record updated in
+   a file, before it is written, such as to maintain the indexes of the file; an update
+   is refused with the status it returns, if not HFE_OK.
+    - HFfd: fd of HF layer.
+    - hook: the function, NULL for none.
+
+    return value: status code.
+*/
+int HF_SetUpdateHook(int HFfd, HFupdate_hook hook) {
+    if (HFfd < 0 || HFfd >= HF_ftab_size || hft[HFfd].valid == FALSE) {
+        return HFE_FD;
+    }
+    hft[HFfd].hook = hook;
+    return HFE_OK;
+}
+
+/* Stub of a slotted file and the moved tuple it points to, kept by HF_CompactFile(). */
+typedef struct HFstub {
+    RECID home;                  /* the record id, where the stub is */
+    RECID target;                /* the moved tuple */
+} HFstub;
+
+/* Collect the stubs of a slotted file.
+    - hfte: HF file table element.
+    - stubs: set to the stubs, in an array to be freed.
+    - nstubs: set to the number of stubs.
+
+    return value: status code.
+*/
+int collect_stubs(HFftab_ele *hfte, HFstub **stubs, int *nstubs) {
+    HFslot_hdr *hdr;
+    HFslot *slots;
+    HFstub *grown;
+    char *pagebuf;
+    int pagenum, recnum, size = 0;
+
+    *stubs = NULL;
+    *nstubs = 0;
+    if (hfte->hfheader.Format != HF_FORMAT_SLOTTED) {
+        return HFE_OK;
+    }
+
+    pagenum = -1;
+    while (1) {
+        int err = PF_GetNextPage(hfte->pfd, &pagenum, &pagebuf);
+
+        if (err == PFE_EOF) {
+            return HFE_OK;
+        } else if (err != PFE_OK) {
+            return HFE_PF;
+        }
+
+        hdr = (HFslot_hdr *) pagebuf;
+        slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+        for (recnum = 0; recnum < hdr->nslots; recnum++) {
+            if (slots[recnum].length == 0 || !(slots[recnum].offset & HF_SLOT_STUB)) continue;
+
+            if (*nstubs == size) {
+                size = size == 0 ? 64 : size * 2;
+                if ((grown = (HFstub *) realloc(*stubs, size * sizeof(HFstub))) == NULL) {
+                    PF_UnpinPage(hfte->pfd, pagenum, 0);
+                    return HFE_INTERNAL;
+                }
+                *stubs = grown;
+            }
+            (*stubs)[*nstubs].home.pagenum = pagenum;
+            (*stubs)[*nstubs].home.recnum = recnum;
+            memcpy(&((*stubs)[*nstubs].target), pagebuf + (slots[recnum].offset & HF_SLOT_OFFSET), sizeof(RECID));
+            (*nstubs)++;
+        }
+
+        if (PF_UnpinPage(hfte->pfd, pagenum, 0) != PFE_OK) {
+            return HFE_PF;
+        }
+    }
+}
+
+/* Move a tuple of a file to a page before its own. A record gets a new record id, given to
+   the hook; a tuple moved in keeps the record id of its stub, which is pointed to its new place.
+    - HFfd: fd of HF layer.
+    - from: position of the tuple.
+    - stubs: the stubs of the file.
+    - nstubs: number of stubs.
+    - hook: function called with the old and the new record id of a record, NULL for none.
+
+    return value: status code, HFE_EOF if no page before has room for the tuple.
+*/
+int move_tuple(int HFfd, RECID from, HFstub *stubs, int nstubs, HFmove_hook hook) {
+    HFftab_ele *hfte = &(hft[HFfd]);
+    HFslot *slots;
+    char record[PAGE_SIZE];
+    char *pagebuf;
+    RECID to, moved;
+    int i, flags, err;
+
+    if (PF_GetThisPage(hfte->pfd, from.pagenum, &pagebuf) != PFE_OK) {
+        return HFE_PF;
+    }
+    slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+    flags = hfte->hfheader.Format == HF_FORMAT_SLOTTED ? slots[from.recnum].offset & HF_SLOT_MOVED : 0;
+    page_moved(hfte, pagebuf, from.recnum, &moved);
+    err = page_read(hfte, pagebuf, from.recnum, record);
+    if (PF_UnpinPage(hfte->pfd, from.pagenum, 0) != PFE_OK || err != HFE_OK) {
+        return HFE_PF;
+    }
+
+    to = place_record(hfte, record, flags, from.pagenum);
+    if (to.pagenum < 0) {
+        return to.recnum;
+    }
+
+    if (flags & HF_SLOT_MOVED) {
+        for (i = 0; i < nstubs; i++) {
+            if (stubs[i].target.pagenum == from.pagenum && stubs[i].target.recnum == from.recnum) break;
+        }
+        if (i == nstubs || PF_GetThisPage(hfte->pfd, stubs[i].home.pagenum, &pagebuf) != PFE_OK) {
+            return HFE_INTERNAL;
+        }
+        slot_put(pagebuf, stubs[i].home.recnum, (char *) &to, sizeof(RECID), HF_SLOT_STUB);
+        if (PF_UnpinPage(hfte->pfd, stubs[i].home.pagenum, 1) != PFE_OK) {
+            return HFE_PF;
+        }
+        stubs[i].target = to;
+    } else {
+        if (hook != NULL && (err = (*hook)(HFfd, from, to, record)) != HFE_OK) {
+            remove_tuple(hfte, to);
+            return err;
+        }
+        if (moved.pagenum >= 0 && remove_tuple(hfte, moved) != HFE_OK) {
+            return HFE_PF;
+        }
+    }
+
+    if (remove_tuple(hfte, from) != HFE_OK) {
+        return HFE_PF;
+    }
+
+    /* each move is committed to the log with the changes of the hook, if PF keeps one */
+    return PF_Commit() == PFE_OK ? HFE_OK : HFE_PF;
+}
+
+/* Compact a file while it is open: the records of its last pages are moved to the free places
+   of the pages before them, from the last page on until a record finds no room before its
+   page; the pages emptied are given back to PF and the file is truncated. A record moved
+   gets a new record id, given to the hook, such as to update the indexes of the file.
+   No scan of the file may be open.
+    - HFfd: fd of HF layer.
+    - hook: function called with the old and the new record id of each record moved,
+      before the record is removed from its old place, NULL for none; the compaction is
+      stopped with the status it returns, if not HFE_OK.
+
+    return value: status code.
+*/
+int HF_CompactFile(int HFfd, HFmove_hook hook) {
+    HFftab_ele *hfte;
+    HFslot *slots;
+    HFstub *stubs;
+    RECID from;
+    char *pagebuf;
+    int nstubs, numpg, places, err, i;
+    bool_t tuple;
+
+    if (HFfd < 0 || HFfd >= HF_ftab_size || hft[HFfd].valid == FALSE) {
+        return HFE_FD;
+    }
+    hfte = &(hft[HFfd]);
+    for (i = 0; i < HF_stab_size; i++) {
+        if (hst[i].valid == TRUE && hst[i].hfd == HFfd) return HFE_SCANOPEN;
+    }
+
+    if ((err = collect_stubs(hfte, &stubs, &nstubs)) != HFE_OK) {
+        free(stubs);
+        return err;
+    }
+
+    PF_GetNumPages(hfte->pfd, &numpg);
+    for (from.pagenum = numpg - 1, err = HFE_OK; from.pagenum > 0 && err == HFE_OK; from.pagenum--) {
+        from.recnum = 0;
+        while (err == HFE_OK) {
+            /* a page emptied was disposed */
+            if (PF_GetThisPage(hfte->pfd, from.pagenum, &pagebuf) != PFE_OK) break;
+
+            slots = (HFslot *) (pagebuf + sizeof(HFslot_hdr));
+            places = page_places(hfte, pagebuf);
+            for (tuple = FALSE; from.recnum < places; from.recnum++) {
+                if (hfte->hfheader.Format == HF_FORMAT_SLOTTED) tuple = slots[from.recnum].length != 0 ? TRUE : FALSE;
+                else tuple = page_used(hfte, pagebuf, from.recnum);
+                if (tuple == TRUE) break;
+            }
+            if (PF_UnpinPage(hfte->pfd, from.pagenum, 0) != PFE_OK) {
+                err = HFE_PF;
+            } else if (tuple == FALSE) {
+                break;
+            } else {
+                err = move_tuple(HFfd, from, stubs, nstubs, hook);
+            }
+        }
+    }
+    free(stubs);
+
+    /* no room left before the last pages is the end of the compaction */
+    if (err != HFE_OK && err != HFE_EOF) {
+        return err;
+    }
+
+    PF_GetNumPages(hfte->pfd, &(hfte->hfheader.NumPg));
+    if (write_header(hfte->pfd, &(hfte->hfheader)) != HFE_OK || PF_TruncateFile(hfte->pfd) != PFE_OK) {
+        return HFE_PF;
+    }
+    return PF_Commit() == PFE_OK ? HFE_OK : HFE_PF;
 }
 
 /* Open new file scan.
@@ -405,22 +1443,128 @@ int HF_GetThisRec(int HFfd, RECID recId, char *record) {
 int HF_OpenFileScan(int HFfd, char attrType, int attrLength, int attrOffset, int op, char *value) {
     int hsd;
 
-    for (hsd = 0; hsd < MAXSCANS; hsd++) {
-        if (hst[hsd].valid == FALSE) {
-            hst[hsd].valid = TRUE;
-            hst[hsd].hfd = HFfd;
-            hst[hsd].attrType = attrType;
-            hst[hsd].attrLength = attrLength;
-            hst[hsd].attrOffset = attrOffset;
-            hst[hsd].op = op;
-            hst[hsd].value = value;
-            hst[hsd].current.pagenum = -1;
-            hst[hsd].current.recnum = 0;
-            return hsd;
-        }
+    if (HF_nfreesd == 0 && grow_stab() != HFE_OK) {
+        return HFE_STABFULL;
     }
+    hsd = HF_freesd[--HF_nfreesd];
+
+    hst[hsd].valid = TRUE;
+    hst[hsd].hfd = HFfd;
+    hst[hsd].attrType = attrType;
+    hst[hsd].attrLength = attrLength;
+    hst[hsd].attrOffset = attrOffset;
+    hst[hsd].op = op;
+    hst[hsd].value = value;
+    hst[hsd].current.pagenum = -1;
+    hst[hsd].current.recnum = 0;
+    return hsd;
+}
 
-    return HFE_STABFULL;
+/* Compare an attribute with a value.
+    - attrType: type of the attribute.
+    - attrLength: length of the attribute.
+    - op: operation code like eq, le, so on.
+    - attr: pointer to the attribute.
+    - value: pointer to the value which it is compared to.
+
+    return value: 1 if the comparison holds, 0 if not, HFE_INTERNAL for an invalid type or operation.
+*/
+int compare_attr(char attrType, int attrLength, int op, char *attr, char *value) {
+    int result;
+
+    if (attrType == STRING_TYPE) {
+        result = strncmp(attr, value, attrLength);
+    } else if (attrType == INT_TYPE) {
+        int src, dst;
+        memcpy(&src, attr, attrLength);
+        memcpy(&dst, value, attrLength);
+        result = src < dst ? -1 : src > dst ? 1 : 0;
+    } else if (attrType == REAL_TYPE) {
+        float src, dst;
+        memcpy(&src, attr, attrLength);
+        memcpy(&dst, value, attrLength);
+        if (src != src || dst != dst) return op == NE_OP;
+        result = src < dst ? -1 : src > dst ? 1 : 0;
+    } else return HFE_INTERNAL;
+
+    if (op == EQ_OP) return result == 0;
+    else if (op == LT_OP) return result < 0;
+    else if (op == GT_OP) return result > 0;
+    else if (op == LE_OP) return result <= 0;
+    else if (op == GE_OP) return result >= 0;
+    else if (op == NE_OP) return result != 0;
+    else return HFE_INTERNAL;
+}
+
+/* Find the next record of a scan, leaving its page pinned. The attribute is compared
+   in the page where it can be, so that only the matching records are copied out.
+    - hste: scan table element.
+    - record: pointer where a record is copied if it must be for the comparison.
+    - pagebuf: set to the page of the record found.
+    - copied: set to TRUE if the record found was copied to 'record'.
+
+    return value: record position of which is found, its page pinned.
+*/
+RECID scan_next(HFstab_ele *hste, char *record, char **pagebuf, bool_t *copied) {
+    HFftab_ele *hfte = &(hft[hste->hfd]);
+    RECID recid;
+    int pagenum, recnum, match, err;
+    char *attr;
+
+    recid.pagenum = -1;
+    recid.recnum = HFE_PF;
+
+    if (hste->current.pagenum < 0) {
+        pagenum = -1;
+    } else if ((err = resume_position(hfte, hste->current)) != HFE_OK) {
+        recid.recnum = err;
+        return recid;
+    } else {
+        pagenum = hste->current.pagenum - 1;
+    }
+
+    while (1) {
+        err = PF_GetNextPage(hfte->pfd, &pagenum, pagebuf);
+
+        if (err == PFE_EOF) {
+            recid.recnum = HFE_EOF;
+            return recid;
+        } else if (err != PFE_OK) {
+            return recid;
+        }
+
+        recnum = pagenum == hste->current.pagenum ? hste->current.recnum + 1 : 0;
+        for (; recnum < page_places(hfte, *pagebuf); recnum++) {
+            if (page_used(hfte, *pagebuf, recnum) == FALSE) continue;
+
+            *copied = FALSE;
+            if (hste->value != NULL) {
+                if ((attr = page_attr(hfte, *pagebuf, recnum, hste->attrOffset, hste->attrLength)) == NULL) {
+                    if (page_read(hfte, *pagebuf, recnum, record) != HFE_OK) {
+                        PF_UnpinPage(hfte->pfd, pagenum, 0);
+                        return recid;
+                    }
+                    attr = record + hste->attrOffset;
+                    *copied = TRUE;
+                }
+                if ((match = compare_attr(hste->attrType, hste->attrLength, hste->op, attr, hste->value)) < 0) {
+                    PF_UnpinPage(hfte->pfd, pagenum, 0);
+                    recid.recnum = HFE_INTERNAL;
+                    return recid;
+                }
+                if (match == 0) continue;
+            }
+
+            recid.pagenum = pagenum;
+            recid.recnum = recnum;
+            hste->current = recid;
+            return recid;
+        }
+
+        if (PF_UnpinPage(hfte->pfd, pagenum, 0) != PFE_OK) {
+            return recid;
+        }
+    }
 }
 
 /* Get next record satisfies comparision expression.
@@ -430,76 +1574,130 @@ int HF_OpenFileScan(int HFfd, char attrType, int attrLength, int attrOffset, int
     return value: record position of which is found.
 */
 RECID HF_FindNextRec(int HFsd, char *record) {
-    RECID recid = hst[HFsd].current;
-    int op = hst[HFsd].op;
-    char *value = hst[HFsd].value;
-    int match = 0;
-    RECID rec_err;
-
-    rec_err.pagenum = -1;
-    rec_err.recnum = HFE_INTERNAL;
+    HFftab_ele *hfte = &(hft[hst[HFsd].hfd]);
+    RECID recid;
+    char *pagebuf;
+    bool_t copied;
+    int err;
 
+    recid = scan_next(&(hst[HFsd]), record, &pagebuf, &copied);
     if (recid.pagenum < 0) {
-        recid.pagenum = 0;
-        setFirstRec = 1;
-    }
-
-    while (!match) {
-        recid = HF_GetNextRec(hst[HFsd].hfd, recid, record);
-
-        if (recid.pagenum == -1) return recid;
-
-        if (value == NULL) match = 1;
-        else if (hst[HFsd].attrType == STRING_TYPE) {
-            int result = strncmp(record + hst[HFsd].attrOffset, value, hst[HFsd].attrLength);
-
-            if (op == 1) match = result == 0;
-            else if (op == 2) match = result < 0;
-            else if (op == 3) match = result > 0;
-            else if (op == 4) match = result <= 0;
-            else if (op == 5) match = result >= 0;
-            else if (op == 6) match = result != 0;
-            else return rec_err;
-        } else if (hst[HFsd].attrType == INT_TYPE) {
-            int src, dst;
-            if (memcpy(&src, record + hst[HFsd].attrOffset, hst[HFsd].attrLength) == NULL || memcpy(&dst, value, hst[HFsd].attrLength) == NULL) {
-                return rec_err;
-            }
+        return recid;
+    }
 
-            if (op == 1) match = src == dst;
-            else if (op == 2) match = src < dst;
-            else if (op == 3) match = src > dst;
-            else if (op == 4) match = src <= dst;
-            else if (op == 5) match = src >= dst;
-            else if (op == 6) match = src != dst;
-            else return rec_err;
-        } else if (hst[HFsd].attrType == REAL_TYPE) {
-            float src, dst;
-            if (memcpy(&src, record + hst[HFsd].attrOffset, hst[HFsd].attrLength) == NULL || memcpy(&dst, value, hst[HFsd].attrLength) == NULL) {
-                return rec_err;
-            }
+    err = copied == FALSE ? page_read(hfte, pagebuf, recid.recnum, record) : HFE_OK;
+    if (PF_UnpinPage(hfte->pfd, recid.pagenum, 0) != PFE_OK || err != HFE_OK) {
+        recid.pagenum = -1;
+        recid.recnum = HFE_PF;
+    }
+    return recid;
+}
+
+/* Make a view of a record on a pinned page. A record kept in one piece is read in
+   place, the page staying pinned; any other record is copied to the view's scratch.
+    - hfte: HF file table element.
+    - pagebuf: the page, pinned.
+    - recid: position of the record.
+    - copied: TRUE if the record is in the scratch already.
+    - view: the view.
+
+    return value: status code.
+*/
+int make_view(HFftab_ele *hfte, char *pagebuf, RECID recid, bool_t copied, HFview *view) {
+    view->pfd = hfte->pfd;
+    if (hfte->hfheader.Format == HF_FORMAT_FIXED) {
+        view->record = pagebuf + hfte->hfheader.RecSize * recid.recnum;
+        view->pagenum = recid.pagenum;
+        return HFE_OK;
+    }
+
+    view->record = view->scratch;
+    view->pagenum = -1;
+    if (copied == FALSE && page_read(hfte, pagebuf, recid.recnum, view->scratch) != HFE_OK) {
+        PF_UnpinPage(hfte->pfd, recid.pagenum, 0);
+        return HFE_PF;
+    }
+    return PF_UnpinPage(hfte->pfd, recid.pagenum, 0) == PFE_OK ? HFE_OK : HFE_PF;
+}
+
+/* Get a view of the record at given position, instead of a copy of it.
+   The view must be released by HF_ReleaseView().
+    - HFfd: fd of HF layer.
+    - recId: record position to read.
+    - view: where the view is made.
+
+    return value: status code.
+*/
+int HF_GetThisView(int HFfd, RECID recId, HFview *view) {
+    HFftab_ele *hfte = &(hft[HFfd]);
+    char *pagebuf;
+
+    view->pagenum = -1;
+    if (HF_ValidRecId(HFfd, recId) != TRUE) {
+        return HFE_INVALIDRECORD;
+    }
+
+    if (PF_GetThisPage(hfte->pfd, recId.pagenum, &pagebuf) != PFE_OK) {
+        return HFE_PF;
+    }
 
-            if (op == 1) match = src == dst;
-            else if (op == 2) match = src < dst;
-            else if (op == 3) match = src > dst;
-            else if (op == 4) match = src <= dst;
-            else if (op == 5) match = src >= dst;
-            else if (op == 6) match = src != dst;
-            else return rec_err;
-        } else return rec_err;
+    if (page_used(hfte, pagebuf, recId.recnum) == FALSE) {
+        PF_UnpinPage(hfte->pfd, recId.pagenum, 0);
+        return HFE_EOF;
     }
+    return make_view(hfte, pagebuf, recId, FALSE, view);
+}
 
-    hst[HFsd].current = recid;
+/* Get a view of the next record satisfies comparision expression, instead of a copy of it.
+   The view must be released by HF_ReleaseView() when a record is found.
+    - HFsd: scan descriptor.
+    - view: where the view is made.
+
+    return value: record position of which is found.
+*/
+RECID HF_FindNextView(int HFsd, HFview *view) {
+    HFftab_ele *hfte = &(hft[hst[HFsd].hfd]);
+    RECID recid;
+    char *pagebuf;
+    bool_t copied;
+
+    view->pagenum = -1;
+    recid = scan_next(&(hst[HFsd]), view->scratch, &pagebuf, &copied);
+    if (recid.pagenum >= 0 && make_view(hfte, pagebuf, recid, copied, view) != HFE_OK) {
+        recid.pagenum = -1;
+        recid.recnum = HFE_PF;
+    }
     return recid;
 }
 
+/* Release a view, unpinning the page it reads.
+    - view: the view.
+
+    return value: status code.
+*/
+int HF_ReleaseView(HFview *view) {
+    int pagenum = view->pagenum;
+
+    if (pagenum < 0) {
+        return HFE_OK;
+    }
+    view->pagenum = -1;
+    view->record = NULL;
+    return PF_UnpinPage(view->pfd, pagenum, 0) == PFE_OK ? HFE_OK : HFE_PF;
+}
+
 /* Close an open file scan.
     - HFsd: sd of HF layer.
 
     return value: status code.
 */
 int HF_CloseFileScan(int HFsd) {
+    if (HFsd < 0 || HFsd >= HF_stab_size || hst[HFsd].valid == FALSE) {
+        return HFE_SD;
+    }
+
     hst[HFsd].valid = FALSE;
+    HF_freesd[HF_nfreesd++] = HFsd;
     return HFE_OK;
 }
 
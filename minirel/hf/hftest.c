@@ -3,6 +3,7 @@
 #include <string.h>
 #include <sys/types.h>
 #include "minirel.h"
+#include "pf.h"
 #include "hf.h"
 
 #define RECSIZE 80
@@ -11,6 +12,8 @@
 #define RECORDVAL 77
 #define FILE1 "recfile"
 #define FILE2 "compfile"
+#define FILE3 "delfile"
+#define FILE4 "fmtfile"
 
 #ifndef offsetof
 #define offsetof(type, field)   ((size_t)&(((type *)0) -> field))
@@ -367,6 +370,708 @@ float_val),GE_OP,(char *)&value)) <0)
 
 }
 
+/*********************************************************/
+/* hftest4:                                              */
+/* Delete every record as it is returned, first by       */
+/* HF_GetFirstRec/HF_GetNextRec and then by a file scan. */
+/* The pages drained are given back to PF on the way,    */
+/* the last one as well, and both loops must still end   */
+/* with HFE_EOF.                                         */
+/*********************************************************/
+
+void hftest4()
+{
+  int i, n, fd, sd;
+  RECID recid;
+  char recbuf[RECSIZE];
+
+  unlink(FILE3);
+
+  if (HF_CreateFile(FILE3,RECSIZE) != HFE_OK)
+     HF_PrintError("Problem creating HF file.\n");
+  if ((fd = HF_OpenFile(FILE3)) < 0)
+     HF_PrintError("Problem opening HF file.\n");
+
+  for (i = 0; i < 2 * NUMBER; i++)
+  {
+     memset(recbuf,' ',RECSIZE);
+     sprintf(recbuf, "record%d", i);
+     recid = HF_InsertRec(fd, recbuf);
+     if (!HF_ValidRecId(fd,recid))
+     {
+        HF_PrintError("Problem inserting record.\n");
+        exit(1);
+     }
+     if (i == NUMBER - 1)
+     {
+        /* the first half is deleted by HF_GetNextRec, the other one by a scan */
+        printf("<< Delete the records returned by HF_GetNextRec >>\n");
+        n = 0;
+        recid = HF_GetFirstRec(fd, recbuf);
+        while (HF_ValidRecId(fd,recid))
+        {
+           if (HF_DeleteRec(fd, recid) != HFE_OK)
+           {
+              HF_PrintError("Problem deleting record.\n");
+              exit(1);
+           }
+           n++;
+           recid = HF_GetNextRec(fd, recid, recbuf);
+        }
+        printf("deleted %d records, HF_GetNextRec returned %d\n", n, recid.recnum);
+        recid = HF_GetFirstRec(fd, recbuf);
+        printf("HF_GetFirstRec on the emptied file returned %d\n", recid.recnum);
+     }
+  }
+
+  printf("<< Delete the records returned by a file scan >>\n");
+  if ((sd = HF_OpenFileScan(fd,STRING_TYPE,RECSIZE,0,EQ_OP,NULL)) < 0)
+  {
+     HF_PrintError("Problem opening scan\n.");
+     exit(1);
+  }
+  n = 0;
+  recid = HF_FindNextRec(sd, recbuf);
+  while (HF_ValidRecId(fd,recid))
+  {
+     if (HF_DeleteRec(fd, recid) != HFE_OK)
+     {
+        HF_PrintError("Problem deleting record.\n");
+        exit(1);
+     }
+     n++;
+     recid = HF_FindNextRec(sd, recbuf);
+  }
+  printf("deleted %d records, HF_FindNextRec returned %d\n", n, recid.recnum);
+
+  if (HF_CloseFileScan(sd) != HFE_OK) {
+     HF_PrintError("Problem closing scan.\n");
+     exit(1);
+  }
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  if (HF_DestroyFile(FILE3) != HFE_OK) {
+     HF_PrintError("Problem destroying the file.\n");
+     exit(1);
+  }
+}
+
+/*********************************************************/
+/* check_format:                                         */
+/* Insert NUMBER structured records into a file created  */
+/* with another page format, delete the odd numbered     */
+/* ones, and read the others back after reopening the    */
+/* file, one by one, by record id, and by a scan on      */
+/* their int values.                                     */
+/*********************************************************/
+
+void check_format(char *filename)
+{
+  int i, n, fd, sd, value;
+  RECID recid, recids[NUMBER];
+  struct rec_struct record;
+
+  if ((fd = HF_OpenFile(filename)) < 0) {
+     HF_PrintError("Problem opening file.\n");
+     exit(1);
+  }
+  for (i = 0; i < NUMBER; i++) {
+     memset(&record, 0, sizeof(record));
+     sprintf(record.string_val, "record string %d", i);
+     record.float_val = (float) i;
+     record.int_val = i;
+     recids[i] = HF_InsertRec(fd, (char *)&record);
+     if (!HF_ValidRecId(fd,recids[i])) {
+        HF_PrintError("Problem inserting record.\n");
+        exit(1);
+     }
+  }
+  for (i = 1; i < NUMBER; i += 2) {
+     if (HF_DeleteRec(fd, recids[i]) != HFE_OK) {
+        HF_PrintError("Problem deleting record.\n");
+        exit(1);
+     }
+  }
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+
+  if ((fd = HF_OpenFile(filename)) < 0) {
+     HF_PrintError("Problem opening file.\n");
+     exit(1);
+  }
+  n = 0;
+  recid = HF_GetFirstRec(fd, (char *)&record);
+  while (HF_ValidRecId(fd,recid)) {
+     if (record.int_val != 2 * n || record.float_val != (float) (2 * n)) {
+        printf("record %d read back as (%s, %f, %d)\n", 2 * n,
+		record.string_val, record.float_val, record.int_val);
+        exit(1);
+     }
+     n++;
+     recid = HF_GetNextRec(fd, recid, (char *)&record);
+  }
+  printf("%d records read back\n", n);
+
+  for (i = 0, n = 0; i < NUMBER; i += 2) {
+     if (HF_GetThisRec(fd, recids[i], (char *)&record) != HFE_OK || record.int_val != i) {
+        printf("record %d not found by its record id\n", i);
+        exit(1);
+     }
+     n++;
+  }
+  printf("%d records found by record id\n", n);
+
+  value = NUMBER / 2;
+  if ((sd = HF_OpenFileScan(fd,INT_TYPE,sizeof(int),offsetof(struct rec_struct,int_val),GE_OP,(char *)&value)) < 0) {
+     HF_PrintError("Problem opening scan\n.");
+     exit(1);
+  }
+  n = 0;
+  recid = HF_FindNextRec(sd, (char *)&record);
+  while (HF_ValidRecId(fd,recid)) {
+     n++;
+     recid = HF_FindNextRec(sd, (char *)&record);
+  }
+  printf("%d records scanned with int value >= %d\n", n, value);
+
+  if (HF_CloseFileScan(sd) != HFE_OK) {
+     HF_PrintError("Problem closing scan.\n");
+     exit(1);
+  }
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  if (HF_DestroyFile(filename) != HFE_OK) {
+     HF_PrintError("Problem destroying the file.\n");
+     exit(1);
+  }
+}
+
+/*********************************************************/
+/* hftest5:                                              */
+/* check_format on a file of slotted pages, where the    */
+/* records are kept in variable-length tuples.           */
+/*********************************************************/
+
+void hftest5()
+{
+  unlink(FILE4);
+  if (HF_CreateFileFormat(FILE4, sizeof(struct rec_struct), HF_FORMAT_SLOTTED) != HFE_OK) {
+     HF_PrintError("Problem creating HF file.\n");
+     exit(1);
+  }
+  check_format(FILE4);
+}
+
+/*********************************************************/
+/* hftest6:                                              */
+/* check_format on a file of PAX pages, where the values */
+/* of each attribute of struct rec_struct are kept       */
+/* together; the scan compares the int values in place.  */
+/*********************************************************/
+
+void hftest6()
+{
+  int attrLens[3];
+
+  attrLens[0] = STRSIZE;
+  attrLens[1] = sizeof(float);
+  attrLens[2] = sizeof(int);
+
+  unlink(FILE4);
+  if (HF_CreateFilePax(FILE4, 3, attrLens) != HFE_OK) {
+     HF_PrintError("Problem creating HF file.\n");
+     exit(1);
+  }
+  check_format(FILE4);
+}
+
+/*********************************************************/
+/* update_hook:                                          */
+/* Count the updates of hftest7, refusing the ones which */
+/* would make the int value negative.                    */
+/*********************************************************/
+
+int nupdates;
+
+int update_hook(int fd, RECID recid, char *oldrec, char *newrec)
+{
+  if (((struct rec_struct *)newrec)->int_val < 0)
+     return HFE_INVALIDRECORD;
+  nupdates++;
+  return HFE_OK;
+}
+
+/*********************************************************/
+/* update_rec:                                           */
+/* Make record i of hftest7, short or grown.             */
+/*********************************************************/
+
+void update_rec(int i, int grown, struct rec_struct *record)
+{
+  memset(record, 0, sizeof(*record));
+  if (grown)
+     memset(record->string_val, 'a' + i % 26, STRSIZE - 1);
+  else
+     sprintf(record->string_val, "short %d", i);
+  record->int_val = i;
+}
+
+/*********************************************************/
+/* check_updates:                                        */
+/* Read back the records of hftest7 by record id and by  */
+/* a scan, which must find each one once, at its record  */
+/* id, whether it was moved or not.                      */
+/*********************************************************/
+
+void check_updates(int fd, RECID *recids, int grown)
+{
+  int i, n;
+  RECID recid;
+  struct rec_struct record, expected;
+
+  for (i = 0; i < NUMBER; i++) {
+     update_rec(i, grown, &expected);
+     if (HF_GetThisRec(fd, recids[i], (char *)&record) != HFE_OK || record.int_val != i
+	 || strcmp(record.string_val, expected.string_val) != 0) {
+        printf("record %d not read back by its record id\n", i);
+        exit(1);
+     }
+  }
+  n = 0;
+  recid = HF_GetFirstRec(fd, (char *)&record);
+  while (HF_ValidRecId(fd,recid)) {
+     if (record.int_val < 0 || record.int_val >= NUMBER || recid.pagenum != recids[record.int_val].pagenum
+	 || recid.recnum != recids[record.int_val].recnum) {
+        printf("record %d scanned at (%d, %d)\n", record.int_val, recid.pagenum, recid.recnum);
+        exit(1);
+     }
+     n++;
+     recid = HF_GetNextRec(fd, recid, (char *)&record);
+  }
+  printf("%d records read back by record id, %d scanned\n", NUMBER, n);
+}
+
+/*********************************************************/
+/* hftest7:                                              */
+/* Update records of a slotted file in place. The short  */
+/* records first inserted fit on a page or two; grown,   */
+/* most of them are moved to other pages, a stub left in */
+/* their slots, and keep their record ids. Shrunk again, */
+/* they go back home.                                    */
+/*********************************************************/
+
+void hftest7()
+{
+  int i, n, fd, value;
+  float fvalue;
+  RECID recids[NUMBER];
+  struct rec_struct record;
+
+  unlink(FILE4);
+  if (HF_CreateFileFormat(FILE4, sizeof(struct rec_struct), HF_FORMAT_SLOTTED) != HFE_OK) {
+     HF_PrintError("Problem creating HF file.\n");
+     exit(1);
+  }
+  if ((fd = HF_OpenFile(FILE4)) < 0) {
+     HF_PrintError("Problem opening file.\n");
+     exit(1);
+  }
+  for (i = 0, n = 1; i < NUMBER; i++) {
+     update_rec(i, 0, &record);
+     recids[i] = HF_InsertRec(fd, (char *)&record);
+     if (!HF_ValidRecId(fd,recids[i])) {
+        HF_PrintError("Problem inserting record.\n");
+        exit(1);
+     }
+     if (i > 0 && recids[i].pagenum != recids[i - 1].pagenum) n++;
+  }
+  printf("%d short records inserted on %d page(s)\n", NUMBER, n);
+
+  nupdates = 0;
+  if (HF_SetUpdateHook(fd, update_hook) != HFE_OK) {
+     HF_PrintError("Problem setting the update hook.\n");
+     exit(1);
+  }
+  printf("<< Grow the records >>\n");
+  for (i = 0; i < NUMBER; i++) {
+     update_rec(i, 1, &record);
+     if (HF_UpdateRec(fd, recids[i], (char *)&record) != HFE_OK) {
+        HF_PrintError("Problem updating record.\n");
+        exit(1);
+     }
+  }
+  check_updates(fd, recids, 1);
+
+  /* a range of a moved record is updated where it was moved to */
+  value = -1;
+  printf("update refused by the hook: %d\n",
+	 HF_UpdateRecRange(fd, recids[NUMBER - 1], offsetof(struct rec_struct,int_val), sizeof(int), (char *)&value));
+  fvalue = 50.0;
+  if (HF_UpdateRecRange(fd, recids[NUMBER - 1], offsetof(struct rec_struct,float_val), sizeof(float), (char *)&fvalue) != HFE_OK
+      || HF_GetThisRec(fd, recids[NUMBER - 1], (char *)&record) != HFE_OK
+      || record.float_val != fvalue || record.int_val != NUMBER - 1) {
+     HF_PrintError("Problem updating a range of a record.\n");
+     exit(1);
+  }
+
+  printf("<< Shrink the records >>\n");
+  for (i = 0; i < NUMBER; i++) {
+     update_rec(i, 0, &record);
+     if (HF_UpdateRec(fd, recids[i], (char *)&record) != HFE_OK) {
+        HF_PrintError("Problem updating record.\n");
+        exit(1);
+     }
+  }
+  check_updates(fd, recids, 0);
+  printf("%d updates let through by the hook\n", nupdates);
+
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  if (HF_DestroyFile(FILE4) != HFE_OK) {
+     HF_PrintError("Problem destroying the file.\n");
+     exit(1);
+  }
+}
+
+/*********************************************************/
+/* move_hook:                                            */
+/* Follow the records moved by HF_CompactFile() in       */
+/* hftest8, keeping their record ids up to date like an  */
+/* index would, unless told to refuse the moves.         */
+/*********************************************************/
+
+RECID moved_recids[4 * NUMBER];
+int nmoves, refuse_moves;
+
+int move_hook(int fd, RECID oldrecid, RECID newrecid, char *record)
+{
+  int i;
+
+  if (refuse_moves)
+     return HFE_INTERNAL;
+  if (sscanf(record, "record%d", &i) != 1 || i < 0 || i >= 4 * NUMBER
+      || moved_recids[i].pagenum != oldrecid.pagenum || moved_recids[i].recnum != oldrecid.recnum) {
+     printf("unexpected move of (%d, %d)\n", oldrecid.pagenum, oldrecid.recnum);
+     exit(1);
+  }
+  moved_recids[i] = newrecid;
+  nmoves++;
+  return HFE_OK;
+}
+
+/*********************************************************/
+/* count_pages:                                          */
+/* Count the records of a file and the pages they are    */
+/* on, checking that each one is where the hook of       */
+/* hftest8 last saw it.                                  */
+/*********************************************************/
+
+int count_pages(int fd, int *npages)
+{
+  int i, n, lastpage;
+  RECID recid;
+  char recbuf[RECSIZE];
+
+  n = 0;
+  *npages = 0;
+  lastpage = -1;
+  recid = HF_GetFirstRec(fd, recbuf);
+  while (HF_ValidRecId(fd,recid)) {
+     if (sscanf(recbuf, "record%d", &i) != 1 || i % 4 != 0
+	 || moved_recids[i].pagenum != recid.pagenum || moved_recids[i].recnum != recid.recnum) {
+        printf("record %s found at (%d, %d)\n", recbuf, recid.pagenum, recid.recnum);
+        exit(1);
+     }
+     if (recid.pagenum != lastpage) (*npages)++;
+     lastpage = recid.pagenum;
+     n++;
+     recid = HF_GetNextRec(fd, recid, recbuf);
+  }
+  return n;
+}
+
+/*********************************************************/
+/* hftest8:                                              */
+/* Insert 4 * NUMBER records and keep one in four, then  */
+/* compact the file: the hook is given the new record id */
+/* of each record moved to the room freed before it.     */
+/*********************************************************/
+
+void hftest8()
+{
+  int i, n, fd, npages;
+  char recbuf[RECSIZE];
+
+  unlink(FILE4);
+  if (HF_CreateFile(FILE4, RECSIZE) != HFE_OK) {
+     HF_PrintError("Problem creating HF file.\n");
+     exit(1);
+  }
+  if ((fd = HF_OpenFile(FILE4)) < 0) {
+     HF_PrintError("Problem opening file.\n");
+     exit(1);
+  }
+  for (i = 0; i < 4 * NUMBER; i++) {
+     memset(recbuf, ' ', RECSIZE);
+     sprintf(recbuf, "record%d", i);
+     moved_recids[i] = HF_InsertRec(fd, recbuf);
+     if (!HF_ValidRecId(fd,moved_recids[i])) {
+        HF_PrintError("Problem inserting record.\n");
+        exit(1);
+     }
+  }
+  for (i = 0; i < 4 * NUMBER; i++) {
+     if (i % 4 != 0 && HF_DeleteRec(fd, moved_recids[i]) != HFE_OK) {
+        HF_PrintError("Problem deleting record.\n");
+        exit(1);
+     }
+  }
+  n = count_pages(fd, &npages);
+  printf("%d records on %d pages before the compaction\n", n, npages);
+
+  nmoves = 0;
+  refuse_moves = 1;
+  printf("compaction stopped by the hook: %d\n", HF_CompactFile(fd, move_hook));
+  n = count_pages(fd, &npages);
+  printf("%d records on %d pages\n", n, npages);
+
+  refuse_moves = 0;
+  if (HF_CompactFile(fd, move_hook) != HFE_OK) {
+     HF_PrintError("Problem compacting file.\n");
+     exit(1);
+  }
+  n = count_pages(fd, &npages);
+  printf("%d records moved, %d records on %d pages after the compaction\n", nmoves, n, npages);
+
+  for (i = 0; i < 4 * NUMBER; i += 4) {
+     if (HF_GetThisRec(fd, moved_recids[i], recbuf) != HFE_OK || atoi(recbuf + strlen("record")) != i) {
+        printf("record %d not found by its new record id\n", i);
+        exit(1);
+     }
+  }
+
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  if ((fd = HF_OpenFile(FILE4)) < 0) {
+     HF_PrintError("Problem opening file.\n");
+     exit(1);
+  }
+  n = count_pages(fd, &npages);
+  printf("%d records on %d pages after reopening\n", n, npages);
+
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  if (HF_DestroyFile(FILE4) != HFE_OK) {
+     HF_PrintError("Problem destroying the file.\n");
+     exit(1);
+  }
+}
+
+/*********************************************************/
+/* check_view:                                           */
+/* Check a view of record i of hftest9, read in place in */
+/* its page, then release it: the page must have been    */
+/* pinned by the view, once.                             */
+/*********************************************************/
+
+void check_view(int fd, RECID recid, HFview *view, int i)
+{
+  int pfd, pagenum;
+  struct rec_struct record;
+
+  if (view->pagenum != recid.pagenum || view->record == view->scratch) {
+     printf("record %d not viewed in place\n", i);
+     exit(1);
+  }
+  if (HF_GetThisRec(fd, recid, (char *)&record) != HFE_OK
+      || memcmp(view->record, (char *)&record, sizeof(record)) != 0 || record.int_val != i) {
+     printf("record %d viewed unlike its copy\n", i);
+     exit(1);
+  }
+  pfd = view->pfd;
+  pagenum = view->pagenum;
+  if (HF_ReleaseView(view) != HFE_OK || view->pagenum != -1) {
+     HF_PrintError("Problem releasing view.\n");
+     exit(1);
+  }
+  if (PF_UnpinPage(pfd, pagenum, FALSE) == PFE_OK) {
+     printf("page %d of record %d still pinned after the release\n", pagenum, i);
+     exit(1);
+  }
+}
+
+/*********************************************************/
+/* hftest9:                                              */
+/* Views of the records of a file of fixed pages, taken  */
+/* by record id and by a scan: each record is read in    */
+/* place in its page, pinned until the view is released. */
+/*********************************************************/
+
+void hftest9()
+{
+  int i, n, fd, sd, value;
+  RECID recid, recids[NUMBER];
+  HFview view;
+  struct rec_struct record;
+
+  unlink(FILE4);
+  if (HF_CreateFileFormat(FILE4, sizeof(struct rec_struct), HF_FORMAT_FIXED) != HFE_OK) {
+     HF_PrintError("Problem creating HF file.\n");
+     exit(1);
+  }
+  if ((fd = HF_OpenFile(FILE4)) < 0) {
+     HF_PrintError("Problem opening file.\n");
+     exit(1);
+  }
+  for (i = 0; i < NUMBER; i++) {
+     memset(&record, 0, sizeof(record));
+     sprintf(record.string_val, "record string %d", i);
+     record.float_val = (float) i;
+     record.int_val = i;
+     recids[i] = HF_InsertRec(fd, (char *)&record);
+     if (!HF_ValidRecId(fd,recids[i])) {
+        HF_PrintError("Problem inserting record.\n");
+        exit(1);
+     }
+  }
+
+  for (i = 0; i < NUMBER; i++) {
+     if (HF_GetThisView(fd, recids[i], &view) != HFE_OK) {
+        printf("record %d not viewed by its record id\n", i);
+        exit(1);
+     }
+     check_view(fd, recids[i], &view, i);
+  }
+  printf("%d records viewed in place by record id\n", NUMBER);
+
+  value = NUMBER / 2;
+  if ((sd = HF_OpenFileScan(fd,INT_TYPE,sizeof(int),offsetof(struct rec_struct,int_val),GE_OP,(char *)&value)) < 0) {
+     HF_PrintError("Problem opening scan\n.");
+     exit(1);
+  }
+  n = 0;
+  recid = HF_FindNextView(sd, &view);
+  while (HF_ValidRecId(fd,recid)) {
+     check_view(fd, recid, &view, value + n);
+     n++;
+     recid = HF_FindNextView(sd, &view);
+  }
+  printf("%d records viewed in place by the scan, HF_FindNextView returned %d\n", n, recid.recnum);
+  printf("releasing the view of no record: %d\n", HF_ReleaseView(&view));
+
+  if (HF_CloseFileScan(sd) != HFE_OK) {
+     HF_PrintError("Problem closing scan.\n");
+     exit(1);
+  }
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  if (HF_DestroyFile(FILE4) != HFE_OK) {
+     HF_PrintError("Problem destroying the file.\n");
+     exit(1);
+  }
+}
+
+/*********************************************************/
+/* hftest10:                                             */
+/* Insert NUMBER records one by one and delete the odd   */
+/* numbered ones, then insert 4 * NUMBER records in one  */
+/* batch: the batch fills the room freed on the first    */
+/* pages and goes on over new ones. A scan must find     */
+/* every record once, at the record id it was given.     */
+/*********************************************************/
+
+void hftest10()
+{
+  int i, n, fd, npages;
+  char recbuf[RECSIZE];
+  char *records;
+  RECID recid, recids[5 * NUMBER];
+
+  unlink(FILE4);
+  if (HF_CreateFile(FILE4, RECSIZE) != HFE_OK) {
+     HF_PrintError("Problem creating HF file.\n");
+     exit(1);
+  }
+  if ((fd = HF_OpenFile(FILE4)) < 0) {
+     HF_PrintError("Problem opening file.\n");
+     exit(1);
+  }
+  for (i = 0; i < NUMBER; i++) {
+     memset(recbuf, ' ', RECSIZE);
+     sprintf(recbuf, "record%d", i);
+     recids[i] = HF_InsertRec(fd, recbuf);
+     if (!HF_ValidRecId(fd,recids[i])) {
+        HF_PrintError("Problem inserting record.\n");
+        exit(1);
+     }
+  }
+  for (i = 1; i < NUMBER; i += 2) {
+     if (HF_DeleteRec(fd, recids[i]) != HFE_OK) {
+        HF_PrintError("Problem deleting record.\n");
+        exit(1);
+     }
+  }
+
+  if ((records = (char *) malloc(4 * NUMBER * RECSIZE)) == NULL) {
+     printf("Problem allocating the batch.\n");
+     exit(1);
+  }
+  for (i = 0; i < 4 * NUMBER; i++) {
+     memset(records + i * RECSIZE, ' ', RECSIZE);
+     sprintf(records + i * RECSIZE, "record%d", NUMBER + i);
+  }
+  if (HF_InsertRecs(fd, records, 4 * NUMBER, recids + NUMBER) != HFE_OK) {
+     HF_PrintError("Problem inserting the batch.\n");
+     exit(1);
+  }
+  free(records);
+  for (i = NUMBER, npages = 1; i < 5 * NUMBER; i++) {
+     if (!HF_ValidRecId(fd,recids[i])) {
+        printf("record %d given an invalid record id\n", i);
+        exit(1);
+     }
+     if (i > NUMBER && recids[i].pagenum != recids[i - 1].pagenum) npages++;
+  }
+  printf("%d records inserted in a batch over %d pages\n", 4 * NUMBER, npages);
+
+  n = 0;
+  recid = HF_GetFirstRec(fd, recbuf);
+  while (HF_ValidRecId(fd,recid)) {
+     i = atoi(recbuf + strlen("record"));
+     if (i < 0 || i >= 5 * NUMBER || (i < NUMBER && i % 2 != 0)
+         || recid.pagenum != recids[i].pagenum || recid.recnum != recids[i].recnum) {
+        printf("record %d scanned at (%d, %d)\n", i, recid.pagenum, recid.recnum);
+        exit(1);
+     }
+     n++;
+     recid = HF_GetNextRec(fd, recid, recbuf);
+  }
+  printf("%d records scanned, each at its record id\n", n);
+
+  if (HF_CloseFile(fd) != HFE_OK) {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  if (HF_DestroyFile(FILE4) != HFE_OK) {
+     HF_PrintError("Problem destroying the file.\n");
+     exit(1);
+  }
+}
+
 main()
 {
   HF_Init();
@@ -382,4 +1087,32 @@ main()
   printf("*** begin of hftest3 *** \n");
   hftest3();
   printf("*** end of hftest3 *** \n");
+
+  printf("*** begin of hftest4 *** \n");
+  hftest4();
+  printf("*** end of hftest4 *** \n");
+
+  printf("*** begin of hftest5 *** \n");
+  hftest5();
+  printf("*** end of hftest5 *** \n");
+
+  printf("*** begin of hftest6 *** \n");
+  hftest6();
+  printf("*** end of hftest6 *** \n");
+
+  printf("*** begin of hftest7 *** \n");
+  hftest7();
+  printf("*** end of hftest7 *** \n");
+
+  printf("*** begin of hftest8 *** \n");
+  hftest8();
+  printf("*** end of hftest8 *** \n");
+
+  printf("*** begin of hftest9 *** \n");
+  hftest9();
+  printf("*** end of hftest9 *** \n");
+
+  printf("*** begin of hftest10 *** \n");
+  hftest10();
+  printf("*** end of hftest10 *** \n");
 }
@@ -1,7 +1,10 @@
+#define _XOPEN_SOURCE 600 /* posix_fallocate() */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include "minirel.h"
@@ -23,6 +26,1111 @@
 #define PAGENUM_MINIMUM 0
 #define FILE_BEGINNING 0
 #define SAME_STRING 0
+#define PFHDR_SIZE PAGE_SIZE
+#define FALLOCATE_SUCCESS 0
+#define PAGENUM_INVALID (-1)
+#define TSID_INVALID (-1)
+#define FSYNC_SUCCESS 0
+#define LOGFD_INVALID (-1)
+#define PF_LOG_MAXPENDING (BF_MAX_BUFS / 2) /* pages an operation dirties before their images are spilled to the log */
+#define LSN_INVALID (-1L)
+#define RENAME_SUCCESS 0
+
+/* number of pages an extent grows up to */
+int PF_extent = PF_EXTENT_DEFAULT;
+
+/* PF file table, and its current number of entries */
+PFftab_ele *pft = NULL;
+int PF_ftab_size = 0;
+
+/* stack of the unused PF file descriptors, the most recently freed one on top */
+int *PF_freefd = NULL;
+int PF_nfreefd = 0;
+
+/* key of the open file hash table, identifying a UNIX file or a segment of a tablespace */
+typedef struct PFhash_key {
+	dev_t dev; /* device of the file */
+	ino_t inode; /* inode number of the file */
+	int page; /* header page of the segment, -1 for a UNIX file of its own */
+} PFhash_key;
+
+/* entry of the open file hash table */
+typedef struct PFhash_entry {
+	PFhash_key key; /* UNIX identity of the open file */
+	int fd; /* PF file descriptor of the open file */
+	UT_hash_handle hh; /* makes this structure hashable */
+} PFhash_entry;
+
+/* hash table of the open files, looked up by their UNIX identity */
+PFhash_entry *PF_hash = NULL;
+
+/* page dirtied by the operation in progress, to be logged when it commits */
+typedef struct PFlog_pending {
+	int fd; /* PF file descriptor of the file */
+	int page; /* page number in the UNIX file, -1 if only the file header may have changed */
+} PFlog_pending;
+
+/* page of a UNIX file spilled to the log by the operation in progress, the data it held on the disk logged for the undo */
+typedef struct PFspilled {
+	PFhash_key key; /* UNIX file, and page in it */
+	UT_hash_handle hh; /* makes this structure hashable */
+} PFspilled;
+
+/* write-ahead log (see PF_OpenLog()); the records after PF_logwritten wait in PF_logbuf */
+int PF_logfd = LOGFD_INVALID;
+char PF_logbuf[PF_LOG_BUFSIZE];
+int PF_logfill = 0; /* bytes of records in the log buffer */
+long PF_logwritten = 0; /* LSN up to which the log was written to the log file */
+long PF_logdurable = 0; /* LSN up to which the log was forced to the disk */
+int PF_logncommit = 0; /* commits not forced yet */
+struct timeval PF_logfirst; /* time of the oldest commit not forced yet */
+int PF_loggroup = PF_LOG_GROUP;
+int PF_logdelay = PF_LOG_DELAY;
+PFlog_pending PF_pending[PF_LOG_MAXPENDING];
+int PF_npending = 0;
+PFspilled *PF_spilled = NULL; /* pages spilled by the operation in progress */
+long PF_logbase = 0; /* LSN of the first record in the log file, written just after the log header */
+char *PF_logname = NULL; /* name of the log file */
+
+/* fuzzy checkpoint in progress (see ckpt_step()) */
+BFdirty PF_ckpt[BF_MAX_BUFS]; /* pages dirty when it began, in file and page order */
+int PF_nckpt = 0;
+int PF_ckptnext = 0; /* next of these pages to be written back */
+long PF_ckptbegin = LSN_INVALID; /* LSN where it began, the new redo point once it completes */
+
+/* tablespaces attached to the PF layer */
+PFts_ele pfts[PF_TS_MAX];
+
+/*
+	writes the records waiting in the log buffer to the log file, without forcing them to the disk
+
+	*** return values ***
+	PFE_UNIX - when pwrite() failed
+	PFE_OK - when the log buffer was written
+*/
+int log_write(void){
+	if (PF_logfill > 0) {
+		if (pwrite(PF_logfd, PF_logbuf, PF_logfill, PF_LOG_HDRSIZE + PF_logwritten - PF_logbase) != PF_logfill) {
+			return PFE_UNIX;
+		}
+		PF_logwritten += PF_logfill;
+		PF_logfill = 0;
+	}
+	return PFE_OK;
+}
+
+/*
+	forces the log to the disk up to the given LSN, with all the records before it
+	the buffer pool calls it before writing back a page (see BF_SetLogForce())
+
+	*** parameters ***
+	long lsn - LSN the log must be forced up to
+
+	*** return values ***
+	PFE_UNIX - when the log could not be written or forced
+	PFE_OK - when the log is on the disk up to 'lsn'
+*/
+int log_force(long lsn){
+	if (lsn <= PF_logdurable) {
+		return PFE_OK;
+	}
+	if (log_write() != PFE_OK || fsync(PF_logfd) != FSYNC_SUCCESS) {
+		return PFE_UNIX;
+	}
+	PF_logdurable = PF_logwritten;
+	PF_logncommit = 0;
+
+	return PFE_OK;
+}
+
+/*
+	checksum of a part of a log record, chained from the checksum of the parts before it
+
+	*** parameters ***
+	char * p - the bytes to be summed up
+	int len - number of bytes
+	unsigned int sum - checksum of the parts before
+
+	*** return value ***
+	checksum including the bytes
+*/
+unsigned int log_sum(char *p, int len, unsigned int sum){
+	int i;
+
+	for (i = 0; i < len; i++) {
+		sum = ((sum << 5) | (sum >> 27)) + (unsigned char)p[i];
+	}
+	return sum;
+}
+
+/*
+	appends a record to the log buffer, writing the buffer out first if the record does not fit
+
+	*** parameters ***
+	int type - PF_LOG_PAGE, PF_LOG_COMMIT, PF_LOG_DESTROY or PF_LOG_UNDO
+	char * fname - name of the UNIX file the record is about
+	int page - page of the UNIX file, -1 for its header
+	void * data - data written to the page
+	int len - number of bytes of data
+
+	*** return values ***
+	LSN of the record - when the record was appended
+	PFE_UNIX - when the log buffer could not be written out
+*/
+long log_append(int type, char *fname, int page, void *data, int len){
+	PFlog_rec rec;
+	int size = sizeof(PFlog_rec) + strlen(fname) + len;
+
+	if (PF_logfill + size > PF_LOG_BUFSIZE && log_write() != PFE_OK) {
+		return PFE_UNIX;
+	}
+
+	rec.type = type;
+	rec.page = page;
+	rec.namelen = strlen(fname);
+	rec.datalen = len;
+	rec.lsn = PF_logwritten + PF_logfill + size;
+	rec.sum = 0;
+	rec.sum = log_sum(data, len, log_sum(fname, rec.namelen, log_sum((char *)&rec, sizeof(PFlog_rec), 0)));
+
+	memcpy(PF_logbuf + PF_logfill, &rec, sizeof(PFlog_rec));
+	memcpy(PF_logbuf + PF_logfill + sizeof(PFlog_rec), fname, rec.namelen);
+	memcpy(PF_logbuf + PF_logfill + sizeof(PFlog_rec) + rec.namelen, data, len);
+	PF_logfill += size;
+
+	return rec.lsn;
+}
+
+/*
+	logs the data at the beginning of a page of a UNIX file, before it is overwritten ahead of the commit
+	of the operation in progress, so that recovery puts it back if the operation does not commit
+	the part of the page past the end of the file is logged as zeros
+
+	*** parameters ***
+	int unixfd - UNIX file descriptor of the file
+	char * fname - name of the UNIX file
+	int page - page of the UNIX file, -1 for its header
+	int len - number of bytes to be overwritten
+
+	*** return values ***
+	LSN of the record - when the record was appended
+	PFE_UNIX - when the page could not be read or the log buffer written out
+*/
+long log_undo(int unixfd, char *fname, int page, int len){
+	char data[PAGE_SIZE];
+
+	memset(data, 0, len);
+	if (pread(unixfd, data, len, PFHDR_SIZE + (off_t)PAGE_SIZE * page) < 0) {
+		return PFE_UNIX;
+	}
+	return log_append(PF_LOG_UNDO, fname, page, data, len);
+}
+
+/*
+	writes data at the beginning of a page of a UNIX file directly, logging it first if the log is open
+	used for the metadata which does not go through the buffer pool
+	the data the page held is logged as well, and the log is forced before the page is written,
+	so that recovery either redoes the write with its operation or puts the old data back
+
+	*** parameters ***
+	int unixfd - UNIX file descriptor of the file
+	char * fname - name of the UNIX file
+	int page - page of the UNIX file, -1 for its header
+	void * data - data to be written
+	int len - number of bytes of data
+
+	*** return values ***
+	PFE_HDRWRITE - when the data could not be logged or written
+	PFE_OK - when the data was written
+*/
+int write_through(int unixfd, char *fname, int page, void *data, int len){
+	long lsn;
+
+	if (PF_logfd != LOGFD_INVALID) {
+		if (log_undo(unixfd, fname, page, len) < 0 || (lsn = log_append(PF_LOG_PAGE, fname, page, data, len)) < 0
+				|| log_force(lsn) != PFE_OK) {
+			return PFE_HDRWRITE;
+		}
+	}
+	if (pwrite(unixfd, data, len, PFHDR_SIZE + (off_t)PAGE_SIZE * page) != len) {
+		return PFE_HDRWRITE;
+	}
+	return PFE_OK;
+}
+
+/*
+	name of the UNIX file holding the pages of a PF file, that is the tablespace file of a segment
+
+	*** parameters ***
+	int fd - PF file descriptor of the file
+
+	*** return value ***
+	name of the UNIX file
+*/
+char * disk_name(int fd){
+	return pft[fd].tsid == TSID_INVALID ? pft[fd].fname : pfts[pft[fd].tsid].fname;
+}
+
+/*
+	logs the images of the pending pages, stamped with their LSNs, and the file headers they changed,
+	then empties the pending list; the pages may be written back once the log is on the disk
+	when the operation is spilled before it commits, the data a page held on the disk is logged for the undo
+	before its first image, so that recovery can put it back if the operation never commits
+
+	*** parameters ***
+	bool_t spill - TRUE when the operation goes on, FALSE when it commits
+
+	*** return values ***
+	PFE_INVALIDPAGE - when a pending page is not in the buffer pool anymore
+	PFE_UNIX - when an error has occurred while logging
+	PFE_OK - when the pending pages were logged
+*/
+int log_images(bool_t spill){
+	BFreq bq;
+	PFpage *fpage;
+	PFspilled *spilled;
+	PFhash_key key;
+	long lsn;
+	int i, j, fd;
+
+	for (i = 0; i < PF_npending; i++) {
+		fd = PF_pending[i].fd;
+
+		/* the image of a dirtied page, stamped with its LSN */
+		if (PF_pending[i].page != PAGENUM_INVALID) {
+			bq.fd = fd;
+			bq.unixfd = pft[fd].unixfd;
+			bq.pagenum = PF_pending[i].page;
+			bq.dirty = FALSE;
+
+			memset(&key, 0, sizeof(PFhash_key));
+			key.dev = pft[fd].dev;
+			key.inode = pft[fd].inode;
+			key.page = bq.pagenum;
+			HASH_FIND(hh, PF_spilled, &key, sizeof(PFhash_key), spilled);
+			if (spill == TRUE && spilled == NULL) {
+				if ((spilled = (PFspilled *)malloc(sizeof(PFspilled))) == NULL
+						|| log_undo(bq.unixfd, disk_name(fd), bq.pagenum, PAGE_SIZE) < 0) {
+					free(spilled);
+					return PFE_UNIX;
+				}
+				spilled->key = key;
+				HASH_ADD(hh, PF_spilled, key, sizeof(PFhash_key), spilled);
+			}
+
+			if (BF_GetBuf(bq, &fpage) != BFE_OK) {
+				return PFE_INVALIDPAGE;
+			}
+			if ((lsn = log_append(PF_LOG_PAGE, disk_name(fd), bq.pagenum, fpage->pagebuf, PAGE_SIZE)) < 0
+					|| BF_StampBuf(bq, lsn) != BFE_OK || BF_UnpinBuf(bq) != BFE_OK) {
+				return PFE_UNIX;
+			}
+		}
+
+		/* the file header, once for each file, if it is not the same as the one logged last */
+		for (j = 0; j < i && PF_pending[j].fd != fd; j++);
+		if (j < i || pft[fd].hdrchanged != TRUE) continue;
+		if (pft[fd].loghdr != NULL && memcmp(pft[fd].loghdr, &(pft[fd].hdr), sizeof(PFhdr_str)) == 0) continue;
+
+		if (pft[fd].loghdr == NULL && (pft[fd].loghdr = (PFhdr_str *)malloc(sizeof(PFhdr_str))) == NULL) {
+			return PFE_UNIX;
+		}
+		memcpy(pft[fd].loghdr, &(pft[fd].hdr), sizeof(PFhdr_str));
+		if (log_append(PF_LOG_PAGE, disk_name(fd), pft[fd].hdrpage, &(pft[fd].hdr), sizeof(PFhdr_str)) < 0) {
+			return PFE_UNIX;
+		}
+	}
+	PF_npending = 0;
+
+	return PFE_OK;
+}
+
+/*
+	remembers that the operation in progress dirtied a page, so that it is logged when the operation commits
+	when too many pages are pending, their images are spilled to the log without a commit record,
+	so that the buffer pool may write them back while the operation goes on
+
+	*** parameters ***
+	int fd - PF file descriptor of the file
+	int page - page number in the UNIX file, -1 if only the file header may have changed
+
+	*** return values ***
+	PFE_UNIX - when the pending pages could not be spilled
+	PFE_OK - when the page is pending
+*/
+int log_pending(int fd, int page){
+	int i;
+
+	if (PF_logfd == LOGFD_INVALID) {
+		return PFE_OK;
+	}
+
+	for (i = 0; i < PF_npending; i++) {
+		if (PF_pending[i].fd == fd && PF_pending[i].page == page) {
+			return PFE_OK;
+		}
+	}
+	if (PF_npending == PF_LOG_MAXPENDING && log_images(TRUE) != PFE_OK) {
+		return PFE_UNIX;
+	}
+
+	PF_pending[PF_npending].fd = fd;
+	PF_pending[PF_npending].page = page;
+	PF_npending++;
+
+	return PFE_OK;
+}
+
+/*
+	forgets a pending page which was disposed, keeping its file header pending
+
+	*** parameters ***
+	int fd - PF file descriptor of the file
+	int page - page number in the UNIX file
+*/
+void log_forget(int fd, int page){
+	int i;
+
+	for (i = 0; i < PF_npending; i++) {
+		if (PF_pending[i].fd == fd && PF_pending[i].page == page) {
+			PF_pending[i].page = PAGENUM_INVALID;
+		}
+	}
+}
+
+/*
+	orders the entries of the checkpoint by file and page, for qsort()
+*/
+int ckpt_cmp(const void *a, const void *b){
+	const BFdirty *x = (const BFdirty *)a;
+	const BFdirty *y = (const BFdirty *)b;
+
+	if (x->unixfd != y->unixfd) return x->unixfd < y->unixfd ? -1 : 1;
+	if (x->pagenum != y->pagenum) return x->pagenum < y->pagenum ? -1 : 1;
+	return 0;
+}
+
+/*
+	begins a checkpoint at the end of the log, between two operations:
+	the pages dirty in the buffer pool are recorded, to be written back in file and page order
+*/
+void ckpt_begin(void){
+	PF_ckptbegin = PF_logwritten + PF_logfill;
+	PF_nckpt = BF_DirtyPages(PF_ckpt);
+	PF_ckptnext = 0;
+	qsort(PF_ckpt, PF_nckpt, sizeof(BFdirty), ckpt_cmp);
+}
+
+/*
+	completes the checkpoint once its pages are written back: the file headers logged last are written,
+	the files are forced to the disk, and the log is cut at the point where the checkpoint began,
+	which becomes the redo point of the log
+
+	*** return values ***
+	PFE_HDRWRITE - when a file header could not be written
+	PFE_UNIX - when an error has occurred while forcing the files or replacing the log
+	PFE_OK - when the checkpoint is complete
+*/
+int ckpt_end(void){
+	int fd, tsid, newfd, len;
+	long pos;
+	char *name;
+	char buf[PAGE_SIZE];
+	PFlog_hdr loghdr;
+
+	if (log_force(PF_logwritten + PF_logfill) != PFE_OK) {
+		return PFE_UNIX;
+	}
+
+	/* everything the log holds before the checkpoint goes to the files */
+	for (fd = 0; fd < PF_ftab_size; fd++) {
+		if ((pft[fd].valid != TRUE && pft[fd].zombie != TRUE) || pft[fd].loghdr == NULL) continue;
+		if (pwrite(pft[fd].unixfd, pft[fd].loghdr, sizeof(PFhdr_str), PFHDR_SIZE + (off_t)PAGE_SIZE * pft[fd].hdrpage) != sizeof(PFhdr_str)) {
+			return PFE_HDRWRITE;
+		}
+	}
+	for (fd = 0; fd < PF_ftab_size; fd++) {
+		if ((pft[fd].valid == TRUE || pft[fd].zombie == TRUE) && pft[fd].tsid == TSID_INVALID && fsync(pft[fd].unixfd) != FSYNC_SUCCESS) {
+			return PFE_UNIX;
+		}
+	}
+	for (tsid = 0; tsid < PF_TS_MAX; tsid++) {
+		if (pfts[tsid].valid == TRUE && fsync(pfts[tsid].unixfd) != FSYNC_SUCCESS) return PFE_UNIX;
+	}
+
+	/* the log from the checkpoint on is copied to a new log file, which replaces the old one */
+	name = (char *)malloc(strlen(PF_logname) + 6);
+	sprintf(name, "%s.ckpt", PF_logname);
+	if ((newfd = open(name, O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR)) == FOPEN_NOFILE) {
+		free(name);
+		return PFE_UNIX;
+	}
+	memset(buf, 0, PF_LOG_HDRSIZE);
+	loghdr.magic = PF_LOG_MAGIC;
+	loghdr.redo = PF_ckptbegin;
+	memcpy(buf, &loghdr, sizeof(PFlog_hdr));
+	len = pwrite(newfd, buf, PF_LOG_HDRSIZE, FILE_BEGINNING) == PF_LOG_HDRSIZE ? 0 : -1;
+	for (pos = PF_ckptbegin; pos < PF_logwritten && len >= 0; pos += len) {
+		len = PF_logwritten - pos < PAGE_SIZE ? (int)(PF_logwritten - pos) : PAGE_SIZE;
+		if (pread(PF_logfd, buf, len, PF_LOG_HDRSIZE + pos - PF_logbase) != len
+				|| pwrite(newfd, buf, len, PF_LOG_HDRSIZE + pos - PF_ckptbegin) != len) {
+			len = -1;
+		}
+	}
+	if (len < 0 || fsync(newfd) != FSYNC_SUCCESS || rename(name, PF_logname) != RENAME_SUCCESS) {
+		close(newfd);
+		remove(name);
+		free(name);
+		return PFE_UNIX;
+	}
+	free(name);
+	close(PF_logfd);
+	PF_logfd = newfd;
+	PF_logbase = PF_ckptbegin;
+
+	PF_ckptbegin = LSN_INVALID;
+	PF_nckpt = 0;
+	PF_ckptnext = 0;
+
+	return PFE_OK;
+}
+
+/*
+	writes back some pages of the checkpoint in progress, completing it after the last one
+
+	*** parameters ***
+	int npages - number of pages written back at most
+
+	*** return values ***
+	PFE_HDRWRITE, PFE_UNIX - when an error has occurred (see ckpt_end())
+	PFE_OK - when the pages were written back
+*/
+int ckpt_write(int npages){
+	BFreq bq;
+
+	for (; npages > 0 && PF_ckptnext < PF_nckpt; npages--, PF_ckptnext++) {
+		bq.fd = PF_ckpt[PF_ckptnext].fd;
+		bq.unixfd = PF_ckpt[PF_ckptnext].unixfd;
+		bq.pagenum = PF_ckpt[PF_ckptnext].pagenum;
+		bq.dirty = FALSE;
+		if (BF_WriteBuf(bq) != BFE_OK) {
+			return PFE_UNIX;
+		}
+	}
+	if (PF_ckptnext == PF_nckpt) {
+		return ckpt_end();
+	}
+	return PFE_OK;
+}
+
+/*
+	advances the fuzzy checkpoint after a commit, beginning one once the log has grown by PF_CKPT_LOGSIZE
+	the pages are written back a few at a time, and only by the commits which forced the log,
+	so that the checkpoint never forces the log on its own and the operations go on meanwhile
+
+	*** return values ***
+	PFE_HDRWRITE, PFE_UNIX - when an error has occurred (see ckpt_end())
+	PFE_OK - otherwise
+*/
+int ckpt_step(void){
+	if (PF_ckptbegin == LSN_INVALID) {
+		if (PF_logwritten + PF_logfill - PF_logbase < PF_CKPT_LOGSIZE) {
+			return PFE_OK;
+		}
+		ckpt_begin();
+	}
+	if (PF_logdurable != PF_logwritten + PF_logfill) {
+		return PFE_OK;
+	}
+	return ckpt_write(PF_CKPT_BATCH);
+}
+
+/*
+	closes a PF file for good: its buffer pages are written back and released,
+	the header is written back if it has changed, and the file table entry is freed
+	with the write-ahead log, the log goes to the disk first and the file is forced as well
+
+	*** parameters ***
+	int fd - PF file descriptor of the file, open or closed while the log is open
+
+	*** return values ***
+	PFE_PAGEFREE - when an error has occurred during BF_FlushBuf()
+	PFE_HDRWRITE - when an error has occurred while writing the header information back to the file
+	PFE_UNIX - when an error has occurred while forcing the log or the file, or closing the file
+	PFE_OK - when the file was closed
+*/
+int close_file(int fd){
+	PFhash_entry *entry = NULL;
+	PFhash_key key;
+
+	if (PF_logfd != LOGFD_INVALID && log_force(PF_logwritten + PF_logfill) != PFE_OK) {
+		return PFE_UNIX;
+	}
+
+	/* using BF_FlushBuf() to release all the buffer pages, writing dirty pages */
+	if (BF_FlushBuf(fd) != BFE_OK) {
+		printf("pagefree\n");
+		return PFE_PAGEFREE;
+	}
+
+	/* Write the file header back to file if ever changed */
+	if (pft[fd].hdrchanged == TRUE){
+		if (pwrite(pft[fd].unixfd, &pft[fd].hdr, sizeof(PFhdr_str), PFHDR_SIZE + (off_t)PAGE_SIZE * pft[fd].hdrpage)!= sizeof(PFhdr_str)){
+		printf("hdrwrite\n");
+			return PFE_HDRWRITE;
+		}
+	}
+
+	/* close the file using close(), freeing the file table entry */
+	/* the log may be truncated once the file is closed, so the file must be on the disk by then */
+	if (pft[fd].tsid == TSID_INVALID && ((PF_logfd != LOGFD_INVALID && fsync(pft[fd].unixfd) != FSYNC_SUCCESS) || close(pft[fd].unixfd) != CLOSE_SUCCESS)){
+		printf("unix");
+		return PFE_UNIX; /*  when close() fails and an error code is returned */
+	}
+	pft[fd].valid = FALSE;
+	pft[fd].zombie = FALSE;
+	free(pft[fd].fname);
+	pft[fd].fname = FNAME_INVALID;
+	free(pft[fd].extmap);
+	pft[fd].extmap = NULL;
+	free(pft[fd].loghdr);
+	pft[fd].loghdr = NULL;
+
+	/* remove the file from the open file hash table, freeing its descriptor */
+	memset(&key, 0, sizeof(PFhash_key));
+	key.dev = pft[fd].dev;
+	key.inode = pft[fd].inode;
+	key.page = pft[fd].hdrpage;
+	HASH_FIND(hh, PF_hash, &key, sizeof(PFhash_key), entry);
+	if (entry != NULL) {
+		HASH_DELETE(hh, PF_hash, entry);
+		free(entry);
+	}
+	PF_freefd[PF_nfreefd++] = fd;
+
+	return PFE_OK;
+}
+
+/*
+	looks up the open file table entry of the given file
+
+	*** parameters ***
+	dev_t dev - device of the UNIX file, retrieved by stat()
+	ino_t inode - inode number of the UNIX file, retrieved by stat()
+	int page - header page of the segment in a tablespace, -1 for a UNIX file of its own
+
+	*** return value ***
+	PF file descriptor of the file if it is open
+	PFE_FILENOTOPEN otherwise
+*/
+int PF_FindFile(dev_t dev, ino_t inode, int page){
+	PFhash_key key;
+	PFhash_entry *entry = NULL;
+
+	memset(&key, 0, sizeof(PFhash_key)); /* padding bytes are part of the key */
+	key.dev = dev;
+	key.inode = inode;
+	key.page = page;
+
+	HASH_FIND(hh, PF_hash, &key, sizeof(PFhash_key), entry);
+	return entry != NULL ? entry->fd : PFE_FILENOTOPEN;
+}
+
+/*
+	doubles the open file table, making more file descriptors available
+	the table starts with PF_FTAB_SIZE entries
+
+	*** return value ***
+	PFE_FTABFULL - when there is no memory to grow the table
+	PFE_OK - when the table was grown
+*/
+int PF_GrowTable(void){
+	int i;
+	int newsize = PF_ftab_size == 0 ? PF_FTAB_SIZE : 2 * PF_ftab_size;
+	PFftab_ele *newtab;
+	int *newfree;
+
+	if ((newtab = (PFftab_ele *)realloc(pft, newsize * sizeof(PFftab_ele))) == NULL) {
+		return PFE_FTABFULL;
+	}
+	pft = newtab;
+	if ((newfree = (int *)realloc(PF_freefd, newsize * sizeof(int))) == NULL) {
+		return PFE_FTABFULL;
+	}
+	PF_freefd = newfree;
+
+	/* initialize each new file table entry, pushing the highest descriptor first */
+	for (i = newsize - 1; i >= PF_ftab_size; i--){
+		pft[i].valid = FALSE;
+		pft[i].dev = 0;
+		pft[i].inode = INODE_INVALID;
+		pft[i].fname = FNAME_INVALID;
+		pft[i].unixfd = UNIXFD_INVALID;
+		pft[i].hdr.numpages = PFHDR_PNUM_INVALID;
+		pft[i].hdrchanged = PFHDR_HDRC_INVALID;
+		pft[i].zombie = FALSE;
+		pft[i].loghdr = NULL;
+		pft[i].tsid = TSID_INVALID;
+		pft[i].hdrpage = PAGENUM_INVALID;
+		pft[i].mappage = PAGENUM_INVALID;
+		pft[i].extmap = NULL;
+		PF_freefd[PF_nfreefd++] = i;
+	}
+	PF_ftab_size = newsize;
+
+	return PFE_OK;
+}
+
+/* free page bitmap of the PF header, one bit per page */
+#define PF_FREEMAP_PAGES (PF_FREEMAP_SIZE * 8)
+#define PF_ISFREE(hdr, p) ((p) < PF_FREEMAP_PAGES && ((hdr).freemap[(p) / 8] & (1 << ((p) % 8))))
+#define PF_SETFREE(hdr, p) ((hdr).freemap[(p) / 8] |= (1 << ((p) % 8)))
+#define PF_CLRFREE(hdr, p) ((hdr).freemap[(p) / 8] &= ~(1 << ((p) % 8)))
+
+
+/*
+	finds the attached tablespace a file belongs to
+	a file belongs to the tablespace attached with prefix 'p' if its name is "p/<segment name>"
+
+	*** parameters ***
+	char * filename - name of the file
+	char ** segname - address of the pointer where the segment name, within 'filename', is returned
+
+	*** return value ***
+	index of the tablespace if the file belongs to one
+	PFE_TSNOTATTACHED otherwise
+*/
+int ts_find(char *filename, char **segname){
+	int tsid;
+	int len;
+
+	for (tsid = 0; tsid < PF_TS_MAX; tsid++) {
+		if (pfts[tsid].valid == FALSE) continue;
+
+		len = strlen(pfts[tsid].prefix);
+		if (strncmp(filename, pfts[tsid].prefix, len) == SAME_STRING && filename[len] == '/') {
+			*segname = filename + len + 1;
+			return tsid;
+		}
+	}
+
+	return PFE_TSNOTATTACHED;
+}
+
+/*
+	looks up a segment in the directory of a tablespace
+
+	*** parameters ***
+	int tsid - index of the tablespace
+	char * segname - name of the segment
+
+	*** return value ***
+	pointer to the directory entry of the segment, NULL if there is no such segment
+*/
+PFts_dirent * ts_lookup(int tsid, char *segname){
+	int i;
+
+	for (i = 0; i < pfts[tsid].hdr.ndirpages * PF_TS_DIRENTS; i++) {
+		if (strncmp(pfts[tsid].dir[i].name, segname, PF_TS_NAMELEN) == SAME_STRING) {
+			return &(pfts[tsid].dir[i]);
+		}
+	}
+
+	return NULL;
+}
+
+/*
+	writes the tablespace header back to the tablespace file
+
+	*** parameters ***
+	int tsid - index of the tablespace
+
+	*** return value ***
+	PFE_HDRWRITE - when pwrite() failed
+	PFE_OK - when the header was written
+*/
+int ts_writehdr(int tsid){
+	return write_through(pfts[tsid].unixfd, pfts[tsid].fname, PAGENUM_INVALID, &(pfts[tsid].hdr), sizeof(PFts_hdr));
+}
+
+/*
+	writes the directory page holding the given directory entry back to the tablespace file
+
+	*** parameters ***
+	int tsid - index of the tablespace
+	PFts_dirent * dirent - directory entry which was changed
+
+	*** return value ***
+	PFE_HDRWRITE - when pwrite() failed
+	PFE_OK - when the directory page was written
+*/
+int ts_writedir(int tsid, PFts_dirent *dirent){
+	int dp = (dirent - pfts[tsid].dir) / PF_TS_DIRENTS;
+
+	return write_through(pfts[tsid].unixfd, pfts[tsid].fname, pfts[tsid].hdr.dirpage[dp], pfts[tsid].dir + dp * PF_TS_DIRENTS, PAGE_SIZE);
+}
+
+/*
+	size class of an extent; the extents of a segment double from PF_EXTENT_MIN pages up to the extent size of the tablespace
+
+	*** parameters ***
+	int tsid - index of the tablespace
+	int k - index of the extent in its segment
+	int * size - address of the int variable where the number of pages of the extent is returned
+
+	*** return value ***
+	size class of the extent, indexing the free extent chains
+*/
+int ts_class(int tsid, int k, int *size){
+	int class = 0;
+
+	*size = PF_EXTENT_MIN;
+	while (class < k && *size < pfts[tsid].hdr.extent) {
+		*size = *size * 2 < pfts[tsid].hdr.extent ? *size * 2 : pfts[tsid].hdr.extent;
+		class++;
+	}
+
+	return class;
+}
+
+/*
+	takes a run of pages from the tablespace, from the given free chain or from its end
+	the first int of a free run holds the first page of the next free run of the chain
+
+	*** parameters ***
+	int tsid - index of the tablespace
+	int * chain - address of the head of the free chain
+	int npages - number of pages of the run
+
+	*** return value ***
+	first page of the run if successful
+	PFE_UNIX - when an error has occurred in the UNIX system calls
+*/
+int ts_alloc(int tsid, int *chain, int npages){
+	int page = *chain;
+
+	if (page >= 0) {
+		if (pread(pfts[tsid].unixfd, chain, sizeof(int), PFHDR_SIZE + (off_t)PAGE_SIZE * page) != sizeof(int)) {
+			return PFE_UNIX;
+		}
+	} else {
+		page = pfts[tsid].hdr.numpages;
+		if (posix_fallocate(pfts[tsid].unixfd, PFHDR_SIZE + (off_t)PAGE_SIZE * page, (off_t)PAGE_SIZE * npages) != FALLOCATE_SUCCESS) {
+			return PFE_UNIX;
+		}
+		pfts[tsid].hdr.numpages += npages;
+	}
+
+	return ts_writehdr(tsid) == PFE_OK ? page : PFE_UNIX;
+}
+
+/*
+	gives a run of pages back to the given free chain of the tablespace
+
+	*** parameters ***
+	int tsid - index of the tablespace
+	int * chain - address of the head of the free chain
+	int page - first page of the run
+
+	*** return value ***
+	PFE_UNIX - when an error has occurred in the UNIX system calls
+	PFE_OK - when the run was freed
+*/
+int ts_free(int tsid, int *chain, int page){
+	if (write_through(pfts[tsid].unixfd, pfts[tsid].fname, page, chain, sizeof(int)) != PFE_OK) {
+		return PFE_UNIX;
+	}
+	*chain = page;
+
+	return ts_writehdr(tsid);
+}
+
+/*
+	translates a page number of a PF file into the page number within its UNIX file
+	the pages of a segment are found through its extent map; other files are left as they are
+
+	*** parameters ***
+	int fd - PF file descriptor of the file
+	int pagenum - page number in the PF file
+
+	*** return value ***
+	page number in the UNIX file
+*/
+int PF_DiskPage(int fd, int pagenum){
+	int k = 0;
+	int size = PF_EXTENT_MIN;
+	int tsid = pft[fd].tsid;
+
+	if (tsid < 0) {
+		return pagenum;
+	}
+
+	/* walk the growing extents, then jump over the ones of full size */
+	while (pagenum >= size && size < pfts[tsid].hdr.extent) {
+		pagenum -= size;
+		k++;
+		size = size * 2 < pfts[tsid].hdr.extent ? size * 2 : pfts[tsid].hdr.extent;
+	}
+	k += pagenum / size;
+
+	return pft[fd].extmap->start[k] + pagenum % size;
+}
+
+/*
+	creates an empty tablespace file named 'filename', which SHOULD NOT have already existed
+	the extents of its segments grow up to the current extent size (see PF_SetExtentSize())
+
+	*** parameters ***
+	char * filename - name of the tablespace file
+
+	*** return values ***
+	PFE_FILEOPEN - when the file with the given filename already exists
+	PFE_HDRWRITE - when an error has occurred while writing the tablespace header
+	PFE_UNIX - when an error has occurred during the system call open() or close()
+	PFE_OK - tablespace successfully created
+*/
+int  PF_CreateTablespace	(char *filename) {
+	int file_fd;
+	int i;
+	PFts_hdr tshdr;
+
+	/* Creating file, failing if it already exists */
+	if ((file_fd = open(filename, O_WRONLY|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR)) == FOPEN_NOFILE) {
+		return PFE_FILEOPEN;
+	}
+
+	/* writing the header of an empty tablespace */
+	memset(&tshdr, 0, sizeof(PFts_hdr));
+	tshdr.magic = PF_TS_MAGIC;
+	tshdr.numpages = PFHDR_PNUM_INIT;
+	tshdr.extent = PF_extent;
+	tshdr.freepage = PAGENUM_INVALID;
+	for (i = 0; i < PF_TS_NCLASS; i++) {
+		tshdr.freeext[i] = PAGENUM_INVALID;
+	}
+	if ((PF_logfd != LOGFD_INVALID && log_append(PF_LOG_PAGE, filename, PAGENUM_INVALID, &tshdr, sizeof(PFts_hdr)) < 0)
+			|| write(file_fd, &tshdr, sizeof(PFts_hdr)) != sizeof(PFts_hdr)) {
+		close(file_fd);
+		return PFE_HDRWRITE;
+	}
+
+	return close(file_fd) == CLOSE_SUCCESS ? PFE_OK : PFE_UNIX;
+}
+
+/*
+	attaches a tablespace file; from now on, PF files named "prefix/<name>" are segments of the tablespace
+	the tablespace header and directory are read in, and the tablespace file stays open until it is detached
+
+	*** parameters ***
+	char * filename - name of the tablespace file
+	char * prefix - prefix of the names of the PF files stored in the tablespace
+
+	*** return values ***
+	PFE_FILENOTOPEN - when the tablespace file could not be opened
+	PFE_FILEOPEN - when a tablespace is already attached with the same prefix
+	PFE_HDRREAD - when the tablespace header or directory could not be read, or the file is not a tablespace
+	PFE_TSFULL - when PF_TS_MAX tablespaces are already attached
+	PFE_OK - when the tablespace was attached
+*/
+int  PF_AttachTablespace	(char *filename, char *prefix) {
+	int tsid, dp;
+	int file_fd;
+	struct stat stat_file;
+	PFts_ele *tse = NULL;
+
+	for (tsid = 0; tsid < PF_TS_MAX; tsid++) {
+		if (pfts[tsid].valid == TRUE && strcmp(pfts[tsid].prefix, prefix) == SAME_STRING) {
+			return PFE_FILEOPEN;
+		} else if (pfts[tsid].valid == FALSE && tse == NULL) {
+			tse = &(pfts[tsid]);
+		}
+	}
+	if (tse == NULL) {
+		return PFE_TSFULL;
+	}
+
+	if ((file_fd = open(filename, O_RDWR)) == FOPEN_NOFILE || fstat(file_fd, &stat_file) != STAT_SUCCESS) {
+		return PFE_FILENOTOPEN;
+	}
+
+	/* read in the header and the directory of the tablespace */
+	if (read(file_fd, &(tse->hdr), sizeof(PFts_hdr)) != sizeof(PFts_hdr) || tse->hdr.magic != PF_TS_MAGIC) {
+		close(file_fd);
+		return PFE_HDRREAD;
+	}
+	tse->dir = (PFts_dirent *)malloc((tse->hdr.ndirpages + 1) * PAGE_SIZE);
+	for (dp = 0; dp < tse->hdr.ndirpages; dp++) {
+		if (pread(file_fd, tse->dir + dp * PF_TS_DIRENTS, PAGE_SIZE, PFHDR_SIZE + (off_t)PAGE_SIZE * tse->hdr.dirpage[dp]) != PAGE_SIZE) {
+			free(tse->dir);
+			close(file_fd);
+			return PFE_HDRREAD;
+		}
+	}
+
+	tse->valid = TRUE;
+	tse->prefix = (char *)calloc(strlen(prefix) + 1, sizeof(char));
+	strcpy(tse->prefix, prefix);
+	tse->fname = (char *)calloc(strlen(filename) + 1, sizeof(char));
+	strcpy(tse->fname, filename);
+	tse->unixfd = file_fd;
+	tse->dev = stat_file.st_dev;
+	tse->inode = stat_file.st_ino;
+
+	return PFE_OK;
+}
+
+/*
+	detaches the tablespace attached with the given prefix, closing the tablespace file
+	none of its segments may be open
+
+	*** parameters ***
+	char * prefix - prefix the tablespace was attached with
+
+	*** return values ***
+	PFE_TSNOTATTACHED - when no tablespace is attached with the prefix
+	PFE_FILEOPEN - when a segment of the tablespace is open
+	PFE_UNIX - when an error has occurred during the system call close()
+	PFE_OK - when the tablespace was detached
+*/
+int  PF_DetachTablespace	(char *prefix) {
+	int tsid, fd;
+
+	for (tsid = 0; tsid < PF_TS_MAX; tsid++) {
+		if (pfts[tsid].valid == TRUE && strcmp(pfts[tsid].prefix, prefix) == SAME_STRING) break;
+	}
+	if (tsid == PF_TS_MAX) {
+		return PFE_TSNOTATTACHED;
+	}
+
+	for (fd = 0; fd < PF_ftab_size; fd++) {
+		if (pft[fd].valid == TRUE && pft[fd].tsid == tsid) {
+			return PFE_FILEOPEN;
+		}
+	}
+
+	/* segments closed while the log is open are closed for good */
+	for (fd = 0; fd < PF_ftab_size; fd++) {
+		if (pft[fd].zombie == TRUE && pft[fd].tsid == tsid && close_file(fd) != PFE_OK) {
+			return PFE_UNIX;
+		}
+	}
+	if (PF_logfd != LOGFD_INVALID && fsync(pfts[tsid].unixfd) != FSYNC_SUCCESS) {
+		return PFE_UNIX;
+	}
+
+	pfts[tsid].valid = FALSE;
+	free(pfts[tsid].fname);
+	free(pfts[tsid].prefix);
+	free(pfts[tsid].dir);
+
+	return close(pfts[tsid].unixfd) == CLOSE_SUCCESS ? PFE_OK : PFE_UNIX;
+}
+
+/*
+	creates a segment in a tablespace: a header page, an extent map page and a directory entry
+	a directory page is added when the directory is full
+
+	*** parameters ***
+	int tsid - index of the tablespace
+	char * segname - name of the segment, which SHOULD NOT have already existed
+
+	*** return values ***
+	PFE_FILEOPEN - when the segment already exists
+	PFE_TSFULL - when the name is too long or the directory cannot grow
+	PFE_HDRWRITE - when an error has occurred while writing to the tablespace file
+	PFE_OK - segment successfully created
+*/
+int ts_create(int tsid, char *segname){
+	PFts_ele *tse = &(pfts[tsid]);
+	PFts_dirent *dirent;
+	PFhdr_str file_hdr;
+	PFts_map map;
+	int page;
+
+	if (ts_lookup(tsid, segname) != NULL) {
+		return PFE_FILEOPEN; /* segment already exists */
+	}
+	if (strlen(segname) >= PF_TS_NAMELEN) {
+		return PFE_TSFULL;
+	}
+
+	/* find an unused directory entry, adding a directory page if there is none */
+	if ((dirent = ts_lookup(tsid, "")) == NULL) {
+		if (tse->hdr.ndirpages == PF_TS_MAXDIR || (page = ts_alloc(tsid, &(tse->hdr.freepage), 1)) < 0) {
+			return PFE_TSFULL;
+		}
+		tse->dir = (PFts_dirent *)realloc(tse->dir, (tse->hdr.ndirpages + 2) * PAGE_SIZE);
+		dirent = tse->dir + tse->hdr.ndirpages * PF_TS_DIRENTS;
+		memset(dirent, 0, PAGE_SIZE);
+		tse->hdr.dirpage[tse->hdr.ndirpages++] = page;
+		if (ts_writehdr(tsid) != PFE_OK) {
+			return PFE_HDRWRITE;
+		}
+	}
+
+	/* the header and the empty extent map of the segment */
+	if ((dirent->hdrpage = ts_alloc(tsid, &(tse->hdr.freepage), 1)) < 0 || (dirent->mappage = ts_alloc(tsid, &(tse->hdr.freepage), 1)) < 0) {
+		return PFE_HDRWRITE;
+	}
+	memset(&file_hdr, 0, sizeof(PFhdr_str)); /* no page is free yet */
+	file_hdr.numpages = PFHDR_PNUM_INIT;
+	memset(&map, 0, sizeof(PFts_map));
+	if (write_through(tse->unixfd, tse->fname, dirent->hdrpage, &file_hdr, sizeof(PFhdr_str)) != PFE_OK
+			|| write_through(tse->unixfd, tse->fname, dirent->mappage, &map, sizeof(PFts_map)) != PFE_OK) {
+		return PFE_HDRWRITE;
+	}
+
+	strcpy(dirent->name, segname);
+	return ts_writedir(tsid, dirent);
+}
+
+/*
+	destroys a segment in a tablespace, giving its extents and pages back to the tablespace
+
+	*** parameters ***
+	int tsid - index of the tablespace
+	char * segname - name of the segment
+
+	*** return values ***
+	PFE_UNIX - when the segment does not exist or an error has occurred in the UNIX system calls
+	PFE_FILEOPEN - when the segment is open
+	PFE_OK - when the segment was successfully destroyed
+*/
+int ts_destroy(int tsid, char *segname){
+	PFts_ele *tse = &(pfts[tsid]);
+	PFts_dirent *dirent;
+	PFts_map map;
+	int k, size;
+	int fd;
+
+	if ((dirent = ts_lookup(tsid, segname)) == NULL) {
+		return PFE_UNIX;
+	}
+	if ((fd = PF_FindFile(tse->dev, tse->inode, dirent->hdrpage)) >= 0) {
+		if (pft[fd].zombie == FALSE) {
+			return PFE_FILEOPEN;
+		}
+		if (close_file(fd) != PFE_OK) { /* closed while the log is open, it is closed for good */
+			return PFE_UNIX;
+		}
+	}
+
+	/* give the extents back to the free chains of their sizes */
+	if (pread(tse->unixfd, &map, sizeof(PFts_map), PFHDR_SIZE + (off_t)PAGE_SIZE * dirent->mappage) != sizeof(PFts_map)) {
+		return PFE_UNIX;
+	}
+	for (k = 0; k < map.nextents; k++) {
+		if (ts_free(tsid, &(tse->hdr.freeext[ts_class(tsid, k, &size)]), map.start[k]) != PFE_OK) {
+			return PFE_UNIX;
+		}
+	}
+	if (ts_free(tsid, &(tse->hdr.freepage), dirent->mappage) != PFE_OK || ts_free(tsid, &(tse->hdr.freepage), dirent->hdrpage) != PFE_OK) {
+		return PFE_UNIX;
+	}
+
+	memset(dirent, 0, sizeof(PFts_dirent));
+	return ts_writedir(tsid, dirent) == PFE_OK ? PFE_OK : PFE_UNIX;
+}
 
 
 /*
@@ -37,15 +1145,18 @@
    PFE_EOF - if the given page number equals the value of 'numpages' of PF header,
    			indicating that EOF was reached
    PFE_INVALIDPAGE - if the value of given page number itself is inappropriate
+   PFE_PAGEFREE - if the page was disposed and is waiting to be reused
    PFE_OK - when the given file and its page number are both valid
  */
 int PF_IsValidPage(int fd, int pagenum){
-	if (pft[fd].valid == FALSE){ /* checking the validity of the file table entry itself */
+	if (fd < 0 || fd >= PF_ftab_size || pft[fd].valid == FALSE){ /* checking the validity of the file table entry itself */
 		return PFE_FD;
 	} else if (pft[fd].hdr.numpages == pagenum){ /* checking EOF */
 		return PFE_EOF;
 	} else if (pft[fd].hdr.numpages < pagenum || pagenum < PAGENUM_MINIMUM) { /* checking the validity of pagenum value */
 		return PFE_INVALIDPAGE;
+	} else if (PF_ISFREE(pft[fd].hdr, pagenum)) { /* checking whether the page was disposed */
+		return PFE_PAGEFREE;
 	}
 	/* Validity of the page verified */
 	return PFE_OK;
@@ -66,7 +1177,7 @@ int PF_IsValidPage(int fd, int pagenum){
  */
 int PF_GetNumPages(int fd, int* pagenum){
 	/* Check validity of the file table entry and its saved page number*/
-	if(pft[fd].valid == FALSE){
+	if(fd < 0 || fd >= PF_ftab_size || pft[fd].valid == FALSE){
 		return PFE_FD;
 	} else if (pft[fd].hdr.numpages < PFHDR_PNUM_INIT) {
 		return PFE_INVALIDPAGE;
@@ -82,19 +1193,8 @@ int PF_GetNumPages(int fd, int* pagenum){
 	initialize the PF layer - invoke BF_Init() & initialize the file table
 */
 void PF_Init		(void) {
-	int i;
 	BF_Init(); /* initialize the BF layer */
-	pft = (PFftab_ele *)calloc(PF_FTAB_SIZE, sizeof(PFftab_ele)); /* initialize the file table */
-
-	/* initialize each file table entry */
-	for (i = 0; i < PF_FTAB_SIZE; i++){
-		pft[i].valid = FALSE;
-		pft[i].inode = INODE_INVALID;
-		pft[i].fname = FNAME_INVALID;
-		pft[i].unixfd = UNIXFD_INVALID;
-		pft[i].hdr.numpages = PFHDR_PNUM_INVALID;
-		pft[i].hdrchanged = PFHDR_HDRC_INVALID;
-	}
+	PF_GrowTable(); /* initialize the file table */
 
 	return;
 }
@@ -112,12 +1212,20 @@ void PF_Init		(void) {
 	PFE_FILEOPEN - when the file with the given filename already exists
 	PFE_HDRWRITE - when an error has occurred while writing header to the file
 	PFE_UNIX - when an error has occurred during the system call close()
+	PFE_TSFULL - when the file belongs to a tablespace which cannot hold another segment
 	PFE_OK - file successfully created and closed
 */
 int  PF_CreateFile	(char *filename) {
 
     int file_fd; /* UNIX file descriptor returned from the system call open() */
 	PFhdr_str file_hdr; /* content of the header to be written on the created file */
+	int tsid;
+	char *segname;
+
+	/* a file of an attached tablespace is created as its segment */
+	if ((tsid = ts_find(filename, &segname)) >= 0) {
+		return ts_create(tsid, segname);
+	}
 
 	/* Checking whether the file already exists */
 	file_fd = open(filename, O_RDONLY);
@@ -128,8 +1236,10 @@ int  PF_CreateFile	(char *filename) {
 
 	/* Creating file, writing the header */
 	file_fd = open(filename, O_WRONLY|O_CREAT);
+	memset(&file_hdr, 0, sizeof(PFhdr_str)); /* no page is free yet */
 	file_hdr.numpages = PFHDR_PNUM_INIT;
-	if (write(file_fd, &file_hdr, sizeof(PFhdr_str)) != sizeof(PFhdr_str)){
+	if ((PF_logfd != LOGFD_INVALID && log_append(PF_LOG_PAGE, filename, PAGENUM_INVALID, &file_hdr, sizeof(PFhdr_str)) < 0)
+			|| write(file_fd, &file_hdr, sizeof(PFhdr_str)) != sizeof(PFhdr_str)){
 		return PFE_HDRWRITE;
 	}
 
@@ -157,25 +1267,36 @@ int  PF_CreateFile	(char *filename) {
 */
 int  PF_DestroyFile	(char *filename) {
 
-	int file_fd;
-	int i;
 	struct stat stat_file;
+	int tsid;
+	char *segname;
+	int fd;
+	long lsn;
+
+	/* a file of an attached tablespace is destroyed as its segment */
+	if ((tsid = ts_find(filename, &segname)) >= 0) {
+		return ts_destroy(tsid, segname);
+	}
 
  	/* Checking whether the file actually exists */
-	file_fd = open(filename, O_RDONLY);
-	if(file_fd == FOPEN_NOFILE){ printf("pf1\n");
+	if (stat(filename, &stat_file) != STAT_SUCCESS){ printf("pf1\n");
 		return PFE_UNIX;
 	}
-	close(file_fd);
 
-	/* checking whether there is an open file with the same filename */
-	for(i = 0; i < PF_FTAB_SIZE; i++){
-		if ((pft[i].fname != FNAME_INVALID) && (strcmp(pft[i].fname, filename) == SAME_STRING) && (pft[i].valid == TRUE)){printf("pf2\n");
+	/* checking whether the file is open; a file closed while the log is open is closed for good */
+	if ((fd = PF_FindFile(stat_file.st_dev, stat_file.st_ino, PAGENUM_INVALID)) >= 0){
+		if (pft[fd].zombie == FALSE) {printf("pf2\n");
 			return PFE_FILEOPEN;
 		}
+		if (close_file(fd) != PFE_OK) {
+			return PFE_UNIX;
+		}
 	}
 
-	/* destroying the file using the system call remove() */
+	/* destroying the file using the system call remove(), logged first so that recovery removes it as well */
+	if (PF_logfd != LOGFD_INVALID && ((lsn = log_append(PF_LOG_DESTROY, filename, PAGENUM_INVALID, NULL, 0)) < 0 || log_force(lsn) != PFE_OK)) {
+		return PFE_UNIX;
+	}
 	if (remove(filename) != REMOVE_SUCCESS){printf("pf3\n");
 		return PFE_UNIX; /* when remove() fails and an error code is returned */
 	}
@@ -186,6 +1307,7 @@ int  PF_DestroyFile	(char *filename) {
 
 /*
 	opens the file 'filename' using the system call open()
+	a file of an attached tablespace is opened as its segment instead, sharing the tablespace file
 	reads in the file header
 	fields in the file table entry filled accordingly
 
@@ -201,50 +1323,91 @@ int  PF_DestroyFile	(char *filename) {
 	PFE_FTABFULL - when the file table was full and failed to allocate an entry for the specified file
 */
 int  PF_OpenFile	(char *filename) {
-	int file_fd, i;
+	int file_fd;
 	int pft_idx;
 	struct stat stat_file;
+	PFhash_entry *entry;
+	int tsid;
+	char *segname;
+	PFts_dirent *dirent = NULL;
+	int hdrpage = PAGENUM_INVALID;
+	PFts_map *extmap = NULL;
+
+	if ((tsid = ts_find(filename, &segname)) >= 0) {
+		/* the segment is looked up in the directory of its tablespace */
+		if ((dirent = ts_lookup(tsid, segname)) == NULL) {
+			return PFE_FILENOTOPEN;
+		}
+		hdrpage = dirent->hdrpage;
+		stat_file.st_dev = pfts[tsid].dev;
+		stat_file.st_ino = pfts[tsid].inode;
+	} else if (stat(filename, &stat_file) != STAT_SUCCESS) { /* use system call stat() to retrieve UNIX file information */
+		return PFE_FILENOTOPEN;
+	}
 
-	/* checking whether there is an open file with the same filename */
-	for(i = 0; i < PF_FTAB_SIZE; i++) {
-		if ((pft[i].fname != FNAME_INVALID) && (strcmp(pft[i].fname, filename) == SAME_STRING) && (pft[i].valid == TRUE)) {
+	/* checking whether the same file is already open; a file closed while the log is open is taken back as it is */
+	if ((pft_idx = PF_FindFile(stat_file.st_dev, stat_file.st_ino, hdrpage)) >= 0) {
+		if (pft[pft_idx].zombie == FALSE) {
 			return PFE_FILEOPEN;
 		}
+		pft[pft_idx].zombie = FALSE;
+		pft[pft_idx].valid = TRUE;
+		return pft_idx;
 	}
 
-	/* Opens the file if exists */
-	file_fd = open(filename, O_RDWR);
-	if (file_fd == FOPEN_NOFILE) {
+	/* Opens the file if exists; a segment reads in its extent map from the open tablespace file */
+	if (tsid >= 0) {
+		file_fd = pfts[tsid].unixfd;
+		extmap = (PFts_map *)malloc(sizeof(PFts_map));
+		if (extmap == NULL || pread(file_fd, extmap, sizeof(PFts_map), PFHDR_SIZE + (off_t)PAGE_SIZE * dirent->mappage) != sizeof(PFts_map)) {
+			free(extmap);
+			return PFE_HDRREAD;
+		}
+	} else if ((file_fd = open(filename, O_RDWR)) == FOPEN_NOFILE) {
 		return PFE_FILENOTOPEN;
 	}
 
-	/* read in the file header, filling in the file table entry */
-	for (pft_idx = 0; pft_idx < PF_FTAB_SIZE; pft_idx++){
-		if (pft[pft_idx].valid == FALSE){
-			if(read(file_fd, &pft[pft_idx].hdr, sizeof(PFhdr_str)) != sizeof(PFhdr_str)){
-				close(file_fd);
-				return PFE_HDRREAD; /* when read() failed and an error code was returned */
-			}
-
-		    /* use system call stat() to retrieve UNIX file information */
-			if (stat(filename, &stat_file)!= STAT_SUCCESS){
-				return PFE_UNIX; /* when stat() fails */
-			}
-			pft[pft_idx].valid = TRUE;
-			pft[pft_idx].inode = stat_file.st_ino;
-			pft[pft_idx].fname = (char *)calloc(strlen(filename), sizeof(char));
-			strcpy(pft[pft_idx].fname, filename);
-			pft[pft_idx].unixfd = file_fd;
-			pft[pft_idx].hdrchanged = FALSE;
-
-			/* when successfull, return the index of the PF file table allocated for the opened file */
-			return pft_idx;
-		}
+	/* take a free file table entry, growing the table when none is left */
+	if ((PF_nfreefd == 0 && PF_GrowTable() != PFE_OK) || (entry = (PFhash_entry *)malloc(sizeof(PFhash_entry))) == NULL) {
+		if (tsid < 0) close(file_fd);
+		free(extmap);
+		return PFE_FTABFULL;
 	}
+	pft_idx = PF_freefd[PF_nfreefd - 1];
 
-	/* when the file table was full, use system call close() and return error code */
-	close(file_fd);
-	return PFE_FTABFULL;
+	/* read in the file header, filling in the file table entry */
+	if(pread(file_fd, &pft[pft_idx].hdr, sizeof(PFhdr_str), PFHDR_SIZE + (off_t)PAGE_SIZE * hdrpage) != sizeof(PFhdr_str)){
+		if (tsid < 0) close(file_fd);
+		free(extmap);
+		free(entry);
+		return PFE_HDRREAD; /* when read() failed and an error code was returned */
+	}
+	PF_nfreefd--;
+
+	pft[pft_idx].valid = TRUE;
+	pft[pft_idx].dev = stat_file.st_dev;
+	pft[pft_idx].inode = stat_file.st_ino;
+	pft[pft_idx].fname = (char *)calloc(strlen(filename) + 1, sizeof(char));
+	strcpy(pft[pft_idx].fname, filename);
+	pft[pft_idx].unixfd = file_fd;
+	pft[pft_idx].hdrchanged = FALSE;
+	pft[pft_idx].zombie = FALSE;
+	pft[pft_idx].loghdr = NULL;
+	pft[pft_idx].tsid = tsid >= 0 ? tsid : TSID_INVALID;
+	pft[pft_idx].hdrpage = hdrpage;
+	pft[pft_idx].mappage = dirent != NULL ? dirent->mappage : PAGENUM_INVALID;
+	pft[pft_idx].extmap = extmap;
+
+	/* register the file in the open file hash table */
+	memset(&(entry->key), 0, sizeof(PFhash_key));
+	entry->key.dev = stat_file.st_dev;
+	entry->key.inode = stat_file.st_ino;
+	entry->key.page = hdrpage;
+	entry->fd = pft_idx;
+	HASH_ADD(hh, PF_hash, key, sizeof(PFhash_key), entry);
+
+	/* when successfull, return the index of the PF file table allocated for the opened file */
+	return pft_idx;
 }
 
 /*
@@ -254,8 +1417,10 @@ int  PF_OpenFile	(char *filename) {
 		dirty pages written back to the file if any
 		all the buffer pages of a file must have been UNPINNED in order to be closed
 	if the file header has changed, written back to the file
-	file closed by using the system call close()
+	file closed by using the system call close(), unless it is a segment sharing its tablespace file
 	the file table entry corresponding to the file is INVALIDATED
+	while the write-ahead log is open, the operation in progress is committed instead and the file is kept
+	open with its buffer pages, to be taken back by PF_OpenFile() (see close_file())
 
 	*** parameters ***
 	int fd - PF file descriptor of the file to be closed
@@ -268,42 +1433,100 @@ int  PF_OpenFile	(char *filename) {
 	PFE_OK - when the specified file was successfully closed
 */
 int  PF_CloseFile	(int fd) {
-
 	/* Check if the file was ever opened */
-	if (pft[fd].valid == FALSE){
+	if (fd < 0 || fd >= PF_ftab_size || pft[fd].valid == FALSE){
 		printf("filenotopen\n");
 		return PFE_FILENOTOPEN;
 	}
 
-	/* using BF_FlushBuf() to release all the buffer pages, writing dirty pages */
-	if (BF_FlushBuf(fd) != BFE_OK) {
-		printf("pagefree\n");
-		return PFE_PAGEFREE;
+	/* with the write-ahead log, the pages stay in the buffer pool and the file stays open */
+	if (PF_logfd != LOGFD_INVALID) {
+		if (log_pending(fd, PAGENUM_INVALID) != PFE_OK || PF_Commit() != PFE_OK) {
+			return PFE_UNIX;
+		}
+		pft[fd].valid = FALSE;
+		pft[fd].zombie = TRUE;
+		return PFE_OK;
 	}
 
-	/* Write the file header back to file if ever changed */
-	if (pft[fd].hdrchanged == TRUE){
-		if (pwrite(pft[fd].unixfd, &pft[fd].hdr, sizeof(PFhdr_str), FILE_BEGINNING)!= sizeof(PFhdr_str)){
-		printf("hdrwrite\n");
-			return PFE_HDRWRITE;
+	return close_file(fd);
+}
+
+/*
+	preallocates the next extent of the file on disk using posix_fallocate()
+	the extent doubles the file until it reaches PF_extent pages, so that small files stay small
+	the space written by the appended pages is then contiguous and the file size changes seldom
+	on failure the file is left as it is, and the pages are appended one by one as they are written
+	a segment takes its next extent from its tablespace instead, recording it in its extent map
+
+	*** parameters ***
+	int fd - PF file descriptor of the file to be extended
+
+	*** return values ***
+	PFE_UNIX - when posix_fallocate() failed
+	PFE_OK - when the extent was preallocated
+*/
+int extend_file(int fd) {
+	int extent = pft[fd].hdr.numalloc;
+	int tsid = pft[fd].tsid;
+	PFts_map *extmap = pft[fd].extmap;
+	int class, start;
+
+	if (tsid != TSID_INVALID) {
+		class = ts_class(tsid, extmap->nextents, &extent);
+		if (extmap->nextents == PF_TS_MAXEXT || (start = ts_alloc(tsid, &(pfts[tsid].hdr.freeext[class]), extent)) < 0) {
+			return PFE_UNIX;
+		}
+		extmap->start[extmap->nextents++] = start;
+		if (write_through(pft[fd].unixfd, disk_name(fd), pft[fd].mappage, extmap, sizeof(PFts_map)) != PFE_OK) {
+			return PFE_UNIX;
 		}
+
+		pft[fd].hdr.numalloc += extent;
+		pft[fd].hdrchanged = TRUE;
+		return PFE_OK;
 	}
 
-	/* close the file using close(), freeing the file table entry */
-	if (close(pft[fd].unixfd) != CLOSE_SUCCESS){
-		printf("unix");
-		return PFE_UNIX; /*  when close() fails and an error code is returned */
+	if (extent < PF_EXTENT_MIN) {
+		extent = PF_EXTENT_MIN;
+	} else if (extent > PF_extent) {
+		extent = PF_extent;
 	}
-	pft[fd].valid = FALSE;
 
-	/* the file was closed successfully */
-    return PFE_OK;
+	if (posix_fallocate(pft[fd].unixfd, PFHDR_SIZE + (off_t)PAGE_SIZE * pft[fd].hdr.numalloc, (off_t)PAGE_SIZE * extent) != FALLOCATE_SUCCESS) {
+		return PFE_UNIX;
+	}
+
+	pft[fd].hdr.numalloc += extent;
+	pft[fd].hdrchanged = TRUE;
+	return PFE_OK;
+}
+
+/*
+	sets the size of the extents the files grow by
+
+	*** parameters ***
+	int npages - size of an extent in pages, between PF_EXTENT_DEFAULT (1MB) and PF_EXTENT_MAX (64MB)
+
+	*** return values ***
+	PFE_INVALIDEXTENT - when the size is out of range
+	PFE_OK - when the extent size was set
+*/
+int  PF_SetExtentSize	(int npages) {
+	if (npages < PF_EXTENT_DEFAULT || npages > PF_EXTENT_MAX) {
+		return PFE_INVALIDEXTENT;
+	}
+
+	PF_extent = npages;
+	return PFE_OK;
 }
 
 /*
-	new page appended to the end of the specified file
+	a page disposed by PF_DisposePage() is reused if there is any,
+	otherwise new page appended to the end of the specified file
 	allocates a buffer entry corresponding to the new page using BF_AllocBuf()
 	pageNum for the page being allocated determined from the information stored in the file header
+	the contents of the page are cleared to zero
 	page allocated PINNED and marked DIRTY using PF_DirtyPage()
 	file header updated accordingly
 
@@ -320,33 +1543,61 @@ int  PF_CloseFile	(int fd) {
 int  PF_AllocPage	(int fd, int *pagenum, char **pagebuf) {
 	BFreq bq;
 	PFpage * fpage = NULL;
+	int page;
+	int newpage; /* page number of the new page in the PF file */
 
 	/* Check if the file was ever opened, valid for allocating a new page */
-	if (pft[fd].valid == FALSE){
+	if (fd < 0 || fd >= PF_ftab_size || pft[fd].valid == FALSE){
 		return PFE_FILENOTOPEN;
 	}
 
 	/* determine pageNum by using the information in the file header */
+	/* the lowest disposed page is taken first, so that the file stays compact */
+	newpage = pft[fd].hdr.numpages;
+	if (pft[fd].hdr.numfree > 0) {
+		for (page = pft[fd].hdr.freehint; page < pft[fd].hdr.numpages; page++) {
+			if (pft[fd].hdr.freemap[page / 8] == 0) {
+				page += 7 - page % 8; /* no free page in this byte of the bitmap */
+			} else if (PF_ISFREE(pft[fd].hdr, page)) {
+				newpage = page;
+				break;
+			}
+		}
+	}
+
+	/* appending beyond the preallocated space, the file grows by an extent */
+	/* a segment has no page outside of its extents, so it cannot do without one */
+	if (newpage >= pft[fd].hdr.numalloc && extend_file(fd) != PFE_OK && pft[fd].tsid != TSID_INVALID) {
+		return PFE_INVALIDPAGE;
+	}
+
 	/* Allocate a buffer entry corresponding to the new page by using BF_AllocBuf */
+	bq.pagenum = PF_DiskPage(fd, newpage);
 	bq.fd = fd;
 	bq.unixfd = pft[fd].unixfd;
-	bq.pagenum = pft[fd].hdr.numpages;
 	bq.dirty = TRUE;
 	/* fpage = (PFpage *)malloc(sizeof(PFpage)); */
 
 	if (BF_AllocBuf(bq, &fpage) != BFE_OK){
 		return PFE_INVALIDPAGE;
 	}
+	memset(fpage->pagebuf, 0, PAGE_SIZE);
 
 	/* if successful, update the file header */
-	*pagenum = pft[fd].hdr.numpages; /* copy the index of allocated page to *pagenum */
+	*pagenum = newpage; /* copy the index of allocated page to *pagenum */
 	*pagebuf = fpage->pagebuf; /* assign the address of page content to given pointer */
-	pft[fd].hdr.numpages++;
+	if (newpage == pft[fd].hdr.numpages) {
+		pft[fd].hdr.numpages++;
+	} else {
+		PF_CLRFREE(pft[fd].hdr, newpage);
+		pft[fd].hdr.numfree--;
+		pft[fd].hdr.freehint = newpage + 1;
+	}
 	pft[fd].hdrchanged = TRUE;
 
 	/* PIN the page and mark DIRTY by using PF_DirtyPage */
 	/* the page is already pinned if BF_AllocBuf() was successful */
-	if (PF_DirtyPage(fd, bq.pagenum) != PFE_OK){
+	if (PF_DirtyPage(fd, newpage) != PFE_OK){
 		return PFE_INVALIDPAGE;
 	}
 
@@ -372,7 +1623,7 @@ int  PF_GetFirstPage	(int fd, int *pagenum, char **pagebuf) {
     return PF_GetNextPage (fd, pagenum, pagebuf);
 }
 
-/* Get next page of given fd and pagenum.
+/* Get next page of given fd and pagenum. Disposed pages are skipped.
 	- fd		: PF layer's file descripter to find.
 	- pagenum	: index of the current page. It's next page will be found and it's pagenumber will be assigned to it.
 	- pagebuf	: pointer of pointer where the the address of found page will be assigned.
@@ -381,13 +1632,18 @@ int  PF_GetFirstPage	(int fd, int *pagenum, char **pagebuf) {
 */
 int  PF_GetNextPage	(int fd, int *pagenum, char **pagebuf) {
 	int error;
-	/* Check next page exists. */
-	if ((error = PF_IsValidPage(fd, *pagenum + 1)) != PFE_OK) {
+	int next = *pagenum + 1;
+
+	/* Check next page exists, skipping over the disposed ones. */
+	while ((error = PF_IsValidPage(fd, next)) == PFE_PAGEFREE) {
+		next++;
+	}
+	if (error != PFE_OK) {
 		return error;
     }
 
 	/* If exists, call PF_GetThisPage with increased pagenum. */
-    *pagenum = *pagenum + 1;
+    *pagenum = next;
     return PF_GetThisPage (fd, *pagenum, pagebuf);
 }
 
@@ -410,7 +1666,7 @@ int  PF_GetThisPage	(int fd, int pagenum, char **pagebuf) {
 	/* Init BFreq. */
 	bq.fd = fd;
 	bq.unixfd = pft[fd].unixfd;
-	bq.pagenum = pagenum;
+	bq.pagenum = PF_DiskPage(fd, pagenum);
 
 	/* Call BF_GetBuf to get the page. */
 	if (BF_GetBuf(bq, &fpage) == BFE_OK) {
@@ -437,11 +1693,11 @@ int  PF_DirtyPage	(int fd, int pagenum) {
 
 	/* Init BFreq. */
     bq.fd = fd;
-    bq.pagenum = pagenum;
+    bq.pagenum = PF_DiskPage(fd, pagenum);
 
-	/* Call BF_TouchBuf to touch the page. */
+	/* Call BF_TouchBuf to touch the page, which is logged when the operation commits. */
     if (BF_TouchBuf(bq) == BFE_OK) {
-        return PFE_OK;
+        return log_pending(fd, bq.pagenum);
     } else {
         return PFE_NOUSERS;
     }
@@ -464,10 +1720,10 @@ int  PF_UnpinPage	(int fd, int pagenum, int dirty) {
 
 	/* Init BFreq. */
     bq.fd = fd;
-    bq.pagenum = pagenum;
+    bq.pagenum = PF_DiskPage(fd, pagenum);
 
 	if (dirty) {
-		if (BF_TouchBuf(bq) != BFE_OK) {
+		if (BF_TouchBuf(bq) != BFE_OK || log_pending(fd, bq.pagenum) != PFE_OK) {
 			return PFE_INVALIDPAGE;
 		}
 	}
@@ -479,3 +1735,483 @@ int  PF_UnpinPage	(int fd, int pagenum, int dirty) {
         return PFE_INVALIDPAGE;
     }
 }
+
+/*
+	gives the specified page back to the file so that PF_AllocPage() can reuse it
+	the page must be UNPINNED; its buffer is dropped without being written back
+	the page is recorded in the free page bitmap of the file header
+	if the disposed pages are at the end of the file, the file shrinks instead
+
+	*** parameters ***
+	int fd - PF file descriptor of the file owning the page
+	int pagenum - page number of the page to be disposed
+
+	*** return values ***
+	PFE_FD - when the file with the given PF file descriptor was not opened
+	PFE_INVALIDPAGE - when the given page number is out of range
+	PFE_PAGEFREE - when the page was already disposed
+	PFE_FREEMAPFULL - when the page is beyond the range the free page bitmap can record
+	PFE_NOUSERS - when the page is still pinned
+	PFE_OK - when the page was successfully disposed
+*/
+int  PF_DisposePage	(int fd, int pagenum) {
+	BFreq bq;
+	int error;
+
+	/* Check such page exists and is in use. */
+	if ((error = PF_IsValidPage(fd, pagenum)) != PFE_OK) {
+		return error == PFE_EOF ? PFE_INVALIDPAGE : error;
+	}
+	if (pagenum >= PF_FREEMAP_PAGES && pagenum != pft[fd].hdr.numpages - 1) {
+		return PFE_FREEMAPFULL;
+	}
+
+	/* drop the buffer of the page, its contents are of no use anymore */
+	bq.fd = fd;
+	bq.unixfd = pft[fd].unixfd;
+	bq.pagenum = PF_DiskPage(fd, pagenum);
+	if (BF_DisposeBuf(bq) != BFE_OK) {
+		return PFE_NOUSERS;
+	}
+	log_forget(fd, bq.pagenum);
+
+	/* record the page in the free page bitmap */
+	if (pagenum < PF_FREEMAP_PAGES) {
+		PF_SETFREE(pft[fd].hdr, pagenum);
+		pft[fd].hdr.numfree++;
+		if (pagenum < pft[fd].hdr.freehint) {
+			pft[fd].hdr.freehint = pagenum;
+		}
+	} else {
+		pft[fd].hdr.numpages--; /* the last page, beyond the bitmap */
+	}
+
+	/* free pages at the end of the file are cut off */
+	while (pft[fd].hdr.numpages > 0 && PF_ISFREE(pft[fd].hdr, pft[fd].hdr.numpages - 1)) {
+		pft[fd].hdr.numpages--;
+		PF_CLRFREE(pft[fd].hdr, pft[fd].hdr.numpages);
+		pft[fd].hdr.numfree--;
+	}
+	pft[fd].hdrchanged = TRUE;
+
+	/* the header changed, to be logged with the operation */
+	return log_pending(fd, PAGENUM_INVALID);
+}
+
+/*
+	gives back the disk space preallocated beyond the last page of the file, such as after
+	the pages at its end were disposed; a UNIX file is truncated, a segment gives its extents
+	beyond the last page back to the free chains of its tablespace
+	the file header is updated, and logged with the operation in progress
+
+	*** parameters ***
+	int fd - PF file descriptor of the file to be truncated
+
+	*** return values ***
+	PFE_FD - when the file with the given PF file descriptor was not opened
+	PFE_UNIX - when an error has occurred in the UNIX system calls
+	PFE_OK - when the file was truncated
+*/
+int  PF_TruncateFile	(int fd) {
+	int tsid, k, size, total;
+	PFts_map *extmap;
+
+	if (fd < 0 || fd >= PF_ftab_size || pft[fd].valid == FALSE) {
+		return PFE_FD;
+	}
+	if (pft[fd].hdr.numalloc <= pft[fd].hdr.numpages) {
+		return PFE_OK;
+	}
+
+	tsid = pft[fd].tsid;
+	if (tsid != TSID_INVALID) {
+		/* the extents holding the pages are kept, the ones after them freed from the last */
+		extmap = pft[fd].extmap;
+		for (k = 0, total = 0; total < pft[fd].hdr.numpages; k++) {
+			ts_class(tsid, k, &size);
+			total += size;
+		}
+		while (extmap->nextents > k) {
+			extmap->nextents--;
+			if (ts_free(tsid, &(pfts[tsid].hdr.freeext[ts_class(tsid, extmap->nextents, &size)]), extmap->start[extmap->nextents]) != PFE_OK) {
+				return PFE_UNIX;
+			}
+		}
+		if (write_through(pft[fd].unixfd, disk_name(fd), pft[fd].mappage, extmap, sizeof(PFts_map)) != PFE_OK) {
+			return PFE_UNIX;
+		}
+		pft[fd].hdr.numalloc = total;
+	} else {
+		if (ftruncate(pft[fd].unixfd, PFHDR_SIZE + (off_t)PAGE_SIZE * pft[fd].hdr.numpages) != 0) {
+			return PFE_UNIX;
+		}
+		pft[fd].hdr.numalloc = pft[fd].hdr.numpages;
+	}
+	pft[fd].hdrchanged = TRUE;
+
+	return log_pending(fd, PAGENUM_INVALID);
+}
+
+/*
+	commits the operation in progress: the pages it dirtied, since they were last spilled (see log_pending()),
+	are logged with the file headers it changed, followed by a commit record
+	the pages may then be written back once the log is on the disk
+	the log is forced by group commit: by the commit completing a group, or the first one after the delay
+	(see PF_SetGroupCommit()); forcing also happens whenever the buffer pool writes back a logged page
+	the fuzzy checkpoint advances with the commits (see ckpt_step())
+	does nothing unless the log is open
+
+	*** return values ***
+	PFE_INVALIDPAGE - when a pending page is not in the buffer pool anymore
+	PFE_UNIX - when an error has occurred while logging or checkpointing
+	PFE_HDRWRITE - when a file header could not be written by the checkpoint
+	PFE_OK - when the operation was committed
+*/
+int  PF_Commit		(void) {
+	PFspilled *spilled, *tmp;
+	struct timeval now;
+	long lsn;
+	int error;
+
+	if (PF_logfd == LOGFD_INVALID) {
+		return PFE_OK;
+	}
+
+	if ((error = log_images(FALSE)) != PFE_OK) {
+		return error;
+	}
+	if ((lsn = log_append(PF_LOG_COMMIT, "", PAGENUM_INVALID, NULL, 0)) < 0) {
+		return PFE_UNIX;
+	}
+	HASH_ITER(hh, PF_spilled, spilled, tmp) {
+		HASH_DELETE(hh, PF_spilled, spilled);
+		free(spilled);
+	}
+
+	/* group commit */
+	gettimeofday(&now, NULL);
+	if (PF_logncommit++ == 0) {
+		PF_logfirst = now;
+	}
+	if ((PF_logncommit >= PF_loggroup || (now.tv_sec - PF_logfirst.tv_sec) * 1000 + (now.tv_usec - PF_logfirst.tv_usec) / 1000 >= PF_logdelay)
+			&& log_force(lsn) != PFE_OK) {
+		return PFE_UNIX;
+	}
+
+	return ckpt_step();
+}
+
+/*
+	takes a checkpoint now: the operation in progress is committed, and the checkpoint in progress,
+	or else a new one, is completed at once, so that the log is cut where it began
+	recovery then only redoes the operations committed after it
+
+	*** return values ***
+	PFE_FILENOTOPEN - when the log is not open
+	PFE_HDRWRITE - when a file header could not be written
+	PFE_UNIX - when an error has occurred while logging, writing back the pages or replacing the log
+	PFE_OK - when the checkpoint was taken
+*/
+int  PF_Checkpoint	(void) {
+	if (PF_logfd == LOGFD_INVALID) {
+		return PFE_FILENOTOPEN;
+	}
+	if (PF_Commit() != PFE_OK) {
+		return PFE_UNIX;
+	}
+
+	if (PF_ckptbegin == LSN_INVALID) {
+		ckpt_begin();
+	}
+	if (log_force(PF_logwritten + PF_logfill) != PFE_OK) {
+		return PFE_UNIX;
+	}
+	return ckpt_write(PF_nckpt);
+}
+
+/*
+	sets how the commits are grouped before the log is forced
+
+	*** parameters ***
+	int ncommits - number of commits forced together, 1 to force every commit
+	int delay - milliseconds a commit waits at most for the others of its group
+
+	*** return values ***
+	PFE_INVALIDGROUP - when a parameter is out of range
+	PFE_OK - when group commit was set
+*/
+int  PF_SetGroupCommit	(int ncommits, int delay) {
+	if (ncommits < 1 || delay < 0) {
+		return PFE_INVALIDGROUP;
+	}
+
+	PF_loggroup = ncommits;
+	PF_logdelay = delay;
+	return PFE_OK;
+}
+
+/*
+	reads the record of the log found at the given LSN, checking that it is whole
+
+	*** parameters ***
+	int logfd - UNIX file descriptor of the log file
+	long redo - LSN of the record just after the log header
+	long pos - LSN where the record begins
+	PFlog_rec * rec - where the record header is read
+	char ** name - where the name of the UNIX file is returned, to be freed by the caller even for no record
+	char * data - where the data is read, PAGE_SIZE bytes at most
+
+	*** return values ***
+	TRUE - when a whole record was read
+	FALSE - at the end of the log, or at a torn or corrupt record
+*/
+bool_t log_read(int logfd, long redo, long pos, PFlog_rec *rec, char **name, char *data){
+	unsigned int sum;
+	long off = PF_LOG_HDRSIZE + pos - redo;
+
+	*name = NULL;
+	if (pread(logfd, rec, sizeof(PFlog_rec), off) != sizeof(PFlog_rec)
+			|| rec->namelen < 0 || rec->datalen < 0 || rec->datalen > PAGE_SIZE
+			|| rec->lsn != pos + (long)sizeof(PFlog_rec) + rec->namelen + rec->datalen) {
+		return FALSE;
+	}
+	*name = (char *)calloc(rec->namelen + 1, sizeof(char));
+	if (pread(logfd, *name, rec->namelen, off + sizeof(PFlog_rec)) != rec->namelen
+			|| pread(logfd, data, rec->datalen, off + sizeof(PFlog_rec) + rec->namelen) != rec->datalen) {
+		return FALSE;
+	}
+	sum = rec->sum;
+	rec->sum = 0;
+	return log_sum(data, rec->datalen, log_sum(*name, rec->namelen, log_sum((char *)rec, sizeof(PFlog_rec), 0))) == sum ? TRUE : FALSE;
+}
+
+/*
+	redoes the committed records of the log, from its redo point up to its last commit record
+	the data the operation left after it had written to the files ahead of its commit is put back first,
+	from its undo records in the reverse order of the log; then the data of each committed record
+	is written again to its UNIX file, in the order of the log
+	the records after the last commit record, or after a torn or corrupt record, belong to no committed operation
+
+	*** parameters ***
+	int logfd - UNIX file descriptor of the log file
+	long redo - LSN where the redo starts, that of the record just after the log header
+
+	*** return values ***
+	PFE_UNIX - when a file could not be written or forced
+	PFE_OK - when the log was redone
+*/
+int log_redo(int logfd, long redo){
+	PFlog_rec rec;
+	char data[PAGE_SIZE];
+	char *name = NULL;
+	char **names = NULL; /* files written by the redo, kept open until they are forced */
+	int *fds = NULL;
+	int nfiles = 0;
+	long *undo = NULL; /* LSNs of the undo records after the last commit record */
+	int nundo = 0, maxundo = 0;
+	long pos, end = redo;
+	int pass, i, k, file_fd;
+	int error = PFE_OK;
+
+	/* find the end of the last committed operation, and the undo records of the one left after it */
+	for (pos = redo; log_read(logfd, redo, pos, &rec, &name, data); pos = rec.lsn) {
+		free(name);
+		if (rec.type == PF_LOG_COMMIT) {
+			end = rec.lsn;
+			nundo = 0;
+		} else if (rec.type == PF_LOG_UNDO) {
+			if (nundo == maxundo) {
+				maxundo = maxundo == 0 ? PAGE_SIZE : 2 * maxundo;
+				undo = (long *)realloc(undo, maxundo * sizeof(long));
+			}
+			undo[nundo++] = pos;
+		}
+	}
+	free(name);
+	name = NULL;
+
+	/* pass 0 puts back the data of the undo records, the last one first, pass 1 writes the committed records */
+	for (pass = 0; pass < 2 && error == PFE_OK; pass++) {
+		for (k = nundo, pos = redo; error == PFE_OK; pos = rec.lsn) {
+			if (pass == 0) {
+				if (--k < 0) break;
+				pos = undo[k];
+			} else if (pos >= end) {
+				break;
+			}
+			free(name);
+			if (!log_read(logfd, redo, pos, &rec, &name, data)) {
+				error = PFE_UNIX;
+				break;
+			}
+
+			/* find the file among those written, opening it the first time; a file removed since needs no undo */
+			for (i = 0; i < nfiles && strcmp(names[i], name) != SAME_STRING; i++);
+
+			if (rec.type == PF_LOG_DESTROY) {
+				if (i < nfiles) {
+					close(fds[i]);
+					names[i][0] = '\0';
+				}
+				remove(name);
+			} else if ((pass == 0 && rec.type == PF_LOG_UNDO) || (pass == 1 && rec.type == PF_LOG_PAGE)) {
+				if (i == nfiles) {
+					if ((file_fd = open(name, pass == 0 ? O_RDWR : O_RDWR|O_CREAT, S_IRUSR|S_IWUSR)) == FOPEN_NOFILE) {
+						if (pass == 0) continue;
+						error = PFE_UNIX;
+						break;
+					}
+					names = (char **)realloc(names, (nfiles + 1) * sizeof(char *));
+					fds = (int *)realloc(fds, (nfiles + 1) * sizeof(int));
+					names[nfiles] = name;
+					fds[nfiles++] = file_fd;
+					name = NULL;
+				}
+				if (pwrite(fds[i], data, rec.datalen, PFHDR_SIZE + (off_t)PAGE_SIZE * rec.page) != rec.datalen) {
+					error = PFE_UNIX;
+					break;
+				}
+			}
+		}
+	}
+	free(name);
+	free(undo);
+
+	/* the redone files go to the disk before the log is emptied */
+	for (i = 0; i < nfiles; i++) {
+		if (names[i][0] != '\0' && (fsync(fds[i]) != FSYNC_SUCCESS || close(fds[i]) != CLOSE_SUCCESS)) {
+			error = PFE_UNIX;
+		}
+		free(names[i]);
+	}
+	free(names);
+	free(fds);
+
+	return error;
+}
+
+/*
+	opens the write-ahead log 'filename', creating it if it does not exist, and turns write-ahead logging on
+	the committed operations found in the log are redone first, bringing the files up to date after a crash,
+	and what an operation left uncommitted had written to the files is put back as it was
+	from then on, PF_Commit() logs the pages dirtied by each operation, the buffer pool writes a page
+	back only after its log records are on the disk, and closing a file does not write back its pages
+	checkpoints cut the log as it grows, so that recovery only redoes the operations committed since the last one
+	no file may be open, and no tablespace attached, when the log is opened
+
+	*** parameters ***
+	char * filename - name of the log file
+
+	*** return values ***
+	PFE_FILEOPEN - when a log is already open, or a file is open or a tablespace attached
+	PFE_FILENOTOPEN - when the log file could not be opened
+	PFE_HDRREAD - when the log header could not be read, or the file is not a log
+	PFE_HDRWRITE - when the emptied log could not be written
+	PFE_UNIX - when the redo failed
+	PFE_OK - when the log is open
+*/
+int  PF_OpenLog		(char *filename) {
+	int fd, tsid;
+	int error;
+	PFlog_hdr loghdr;
+	char hdrbuf[PF_LOG_HDRSIZE];
+
+	if (PF_logfd != LOGFD_INVALID) {
+		return PFE_FILEOPEN;
+	}
+	for (fd = 0; fd < PF_ftab_size; fd++) {
+		if (pft[fd].valid == TRUE) return PFE_FILEOPEN;
+	}
+	for (tsid = 0; tsid < PF_TS_MAX; tsid++) {
+		if (pfts[tsid].valid == TRUE) return PFE_FILEOPEN;
+	}
+
+	if ((fd = open(filename, O_RDWR|O_CREAT, S_IRUSR|S_IWUSR)) == FOPEN_NOFILE) {
+		return PFE_FILENOTOPEN;
+	}
+
+	/* redo the log left by a crash, a new log having no header yet */
+	memset(hdrbuf, 0, PF_LOG_HDRSIZE);
+	if (read(fd, hdrbuf, PF_LOG_HDRSIZE) == PF_LOG_HDRSIZE) {
+		memcpy(&loghdr, hdrbuf, sizeof(PFlog_hdr));
+		if (loghdr.magic != PF_LOG_MAGIC) {
+			close(fd);
+			return PFE_HDRREAD;
+		}
+		if ((error = log_redo(fd, loghdr.redo)) != PFE_OK) {
+			close(fd);
+			return error;
+		}
+	}
+
+	/* start over with an empty log */
+	loghdr.magic = PF_LOG_MAGIC;
+	loghdr.redo = PF_LOG_HDRSIZE;
+	memcpy(hdrbuf, &loghdr, sizeof(PFlog_hdr));
+	if (ftruncate(fd, 0) != 0 || pwrite(fd, hdrbuf, PF_LOG_HDRSIZE, FILE_BEGINNING) != PF_LOG_HDRSIZE || fsync(fd) != FSYNC_SUCCESS) {
+		close(fd);
+		return PFE_HDRWRITE;
+	}
+
+	PF_logname = (char *)malloc(strlen(filename) + 1);
+	strcpy(PF_logname, filename);
+	PF_logfd = fd;
+	PF_logbase = PF_LOG_HDRSIZE;
+	PF_logfill = 0;
+	PF_logwritten = PF_LOG_HDRSIZE;
+	PF_logdurable = PF_LOG_HDRSIZE;
+	PF_ckptbegin = LSN_INVALID;
+	PF_nckpt = 0;
+	PF_ckptnext = 0;
+	PF_logncommit = 0;
+	PF_npending = 0;
+	BF_SetLogForce(log_force);
+
+	return PFE_OK;
+}
+
+/*
+	closes the write-ahead log after a clean shutdown, turning write-ahead logging off
+	the operation in progress is committed, the files closed while the log was open are closed for good
+	and forced to the disk with the attached tablespaces, so that the log can be emptied
+	all the files must be closed
+
+	*** return values ***
+	PFE_FILENOTOPEN - when the log is not open
+	PFE_FILEOPEN - when a file is still open
+	PFE_UNIX - when an error has occurred while closing the files or the log
+	PFE_OK - when the log was closed
+*/
+int  PF_CloseLog	(void) {
+	int fd, tsid, logfd;
+
+	if (PF_logfd == LOGFD_INVALID) {
+		return PFE_FILENOTOPEN;
+	}
+	for (fd = 0; fd < PF_ftab_size; fd++) {
+		if (pft[fd].valid == TRUE) return PFE_FILEOPEN;
+	}
+
+	if (PF_Commit() != PFE_OK) {
+		return PFE_UNIX;
+	}
+	for (fd = 0; fd < PF_ftab_size; fd++) {
+		if (pft[fd].zombie == TRUE && close_file(fd) != PFE_OK) return PFE_UNIX;
+	}
+	for (tsid = 0; tsid < PF_TS_MAX; tsid++) {
+		if (pfts[tsid].valid == TRUE && fsync(pfts[tsid].unixfd) != FSYNC_SUCCESS) return PFE_UNIX;
+	}
+
+	/* everything logged is on the disk, the log is emptied */
+	BF_SetLogForce(NULL);
+	logfd = PF_logfd;
+	PF_logfd = LOGFD_INVALID;
+	PF_ckptbegin = LSN_INVALID;
+	free(PF_logname);
+	PF_logname = NULL;
+	if (ftruncate(logfd, PF_LOG_HDRSIZE) != 0 || fsync(logfd) != FSYNC_SUCCESS || close(logfd) != CLOSE_SUCCESS) {
+		return PFE_UNIX;
+	}
+
+	return PFE_OK;
+}
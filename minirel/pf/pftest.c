@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "minirel.h"
 #include "bf.h"
 #include "pf.h"
@@ -12,6 +14,12 @@
  * default files
  */
 #define FILE1	"file1"
+#define TSFILE	"tsfile"
+#define TSPREFIX	"ts"
+#define SEGMENT1	"ts/seg1"
+#define SEGMENT2	"ts/seg2"
+#define LOGFILE	"logfile"
+#define WALFILE	"walfile"
 
 /*
  * Open the file, allocate as many pages in the file as the buffer manager
@@ -176,6 +184,412 @@ void testpf1(void)
 */
 }
 
+/*
+ * write to the given pages of a file the values page number + 'base'
+ */
+void writepages(int fd, int npages, int base)
+{
+    int i, pagenum, value;
+    char *buf;
+
+    for (i = 0; i < npages; i++){
+	if (PF_AllocPage(fd,&pagenum,&buf) != PFE_OK){
+	    PF_PrintError("PF_AllocPage");
+	    exit(1);
+	}
+	value = pagenum + base;
+	memcpy(buf, (char *)&value, sizeof(int));
+	if (PF_UnpinPage(fd,pagenum,TRUE) != PFE_OK){
+	    PF_PrintError("unfix buffer");
+	    exit(1);
+	}
+    }
+}
+
+/*
+ * check that every page of a file holds the value page number + 'base',
+ * and return the number of pages
+ */
+int checkpages(int fd, int base)
+{
+    int i, error, pagenum, npages;
+    char *buf;
+
+    npages = 0;
+    pagenum = -1;
+    while ((error = PF_GetNextPage(fd,&pagenum,&buf)) == PFE_OK){
+	memcpy((char *)&i, buf, sizeof(int));
+	if (i != pagenum + base){
+	    printf("page %d holds %d instead of %d\n",pagenum,i,pagenum + base);
+	    exit(1);
+	}
+	npages++;
+	if (PF_UnpinPage(fd,pagenum,FALSE) != PFE_OK){
+	    PF_PrintError("unfix");
+	    exit(1);
+	}
+    }
+    if (error != PFE_EOF){
+	PF_PrintError("not eof");
+	exit(1);
+    }
+    return npages;
+}
+
+/*
+ * files stored as segments of a tablespace: two segments are written
+ * side by side, and read back after the tablespace is detached and
+ * attached again
+ */
+void testpf2(void)
+{
+    int fd1, fd2, error;
+
+    unlink(TSFILE);
+    if ((error = PF_CreateTablespace(TSFILE)) != PFE_OK){
+	printf("PF_CreateTablespace: %d\n",error);
+	exit(1);
+    }
+    if ((error = PF_AttachTablespace(TSFILE,TSPREFIX)) != PFE_OK){
+	printf("PF_AttachTablespace: %d\n",error);
+	exit(1);
+    }
+    printf("attaching %s again: %d\n", TSFILE, PF_AttachTablespace(TSFILE,TSPREFIX));
+
+    if (PF_CreateFile(SEGMENT1) != PFE_OK || PF_CreateFile(SEGMENT2) != PFE_OK){
+	PF_PrintError("create segment\n");
+	exit(1);
+    }
+    if ((fd1 = PF_OpenFile(SEGMENT1)) < 0 || (fd2 = PF_OpenFile(SEGMENT2)) < 0){
+	PF_PrintError("open segment\n");
+	exit(1);
+    }
+
+    /* the extents of the two segments are interleaved in the tablespace file */
+    writepages(fd1, 10, 1000);
+    writepages(fd2, 30, 2000);
+    writepages(fd1, 20, 1000);
+    printf("detaching with segments open: %d\n", PF_DetachTablespace(TSPREFIX));
+
+    if (PF_CloseFile(fd1) != PFE_OK || PF_CloseFile(fd2) != PFE_OK){
+	PF_PrintError("close segment\n");
+	exit(1);
+    }
+    printf("detaching: %d\n", PF_DetachTablespace(TSPREFIX));
+    printf("detaching again: %d\n", PF_DetachTablespace(TSPREFIX));
+    printf("opening %s while detached: %d\n", SEGMENT1, PF_OpenFile(SEGMENT1) >= 0);
+
+    if ((error = PF_AttachTablespace(TSFILE,TSPREFIX)) != PFE_OK){
+	printf("PF_AttachTablespace: %d\n",error);
+	exit(1);
+    }
+    if ((fd1 = PF_OpenFile(SEGMENT1)) < 0 || (fd2 = PF_OpenFile(SEGMENT2)) < 0){
+	PF_PrintError("open segment\n");
+	exit(1);
+    }
+    printf("%s: %d pages read back\n", SEGMENT1, checkpages(fd1, 1000));
+    printf("%s: %d pages read back\n", SEGMENT2, checkpages(fd2, 2000));
+    if (PF_CloseFile(fd1) != PFE_OK || PF_CloseFile(fd2) != PFE_OK){
+	PF_PrintError("close segment\n");
+	exit(1);
+    }
+
+    if (PF_DestroyFile(SEGMENT1) != PFE_OK || PF_DestroyFile(SEGMENT2) != PFE_OK){
+	PF_PrintError("destroy segment\n");
+	exit(1);
+    }
+    if (PF_DetachTablespace(TSPREFIX) != PFE_OK){
+	PF_PrintError("detach\n");
+	exit(1);
+    }
+    unlink(TSFILE);
+}
+
+/*
+ * run 'crash' in a child process which dies without closing the log,
+ * losing the pages the buffer pool held
+ */
+void crashtest(void (*crash)(void))
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    if ((pid = fork()) < 0){
+	PF_PrintError("fork\n");
+	exit(1);
+    }
+    if (pid == 0){
+	crash();
+	_exit(0);
+    }
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+	PF_PrintError("crashed child failed\n");
+	exit(1);
+    }
+}
+
+/*
+ * open the log, and count the pages of a file brought back by the redo
+ */
+void recover(char *fname, int base)
+{
+    int fd, error;
+
+    if ((error = PF_OpenLog(LOGFILE)) != PFE_OK){
+	printf("PF_OpenLog: %d\n",error);
+	exit(1);
+    }
+    if ((fd = PF_OpenFile(fname)) < 0){
+	PF_PrintError("open file\n");
+	exit(1);
+    }
+    printf("%s: %d pages read back after the redo\n", fname, checkpages(fd, base));
+    if (PF_CloseFile(fd) != PFE_OK || PF_CloseLog() != PFE_OK){
+	PF_PrintError("close\n");
+	exit(1);
+    }
+}
+
+/*
+ * writes 60 pages with the log open, committing every 20 of them,
+ * and dies with the pages still in the buffer pool
+ */
+void crash3(void)
+{
+    int i, fd;
+
+    if (PF_OpenLog(LOGFILE) != PFE_OK || PF_SetGroupCommit(1, 0) != PFE_OK){
+	_exit(1);
+    }
+    if (PF_CreateFile(WALFILE) != PFE_OK || (fd = PF_OpenFile(WALFILE)) < 0){
+	_exit(1);
+    }
+    for (i = 0; i < 3; i++){
+	writepages(fd, 20, 3000);
+	if (PF_Commit() != PFE_OK){
+	    _exit(1);
+	}
+    }
+    /* the file is kept open with its buffer pages, which are never written back */
+    if (PF_CloseFile(fd) != PFE_OK){
+	_exit(1);
+    }
+}
+
+/*
+ * write-ahead log: the pages committed before a crash are redone when the
+ * log is opened again
+ */
+void testpf3(void)
+{
+    unlink(LOGFILE);
+    unlink(WALFILE);
+
+    crashtest(crash3);
+    recover(WALFILE, 3000);
+
+    if (PF_DestroyFile(WALFILE) != PFE_OK){
+	PF_PrintError("destroy\n");
+	exit(1);
+    }
+    unlink(LOGFILE);
+}
+
+/*
+ * writes 30 pages with the log open and takes a checkpoint, then writes
+ * 30 pages more and dies with them in the buffer pool
+ */
+void crash4(void)
+{
+    int fd;
+
+    if (PF_OpenLog(LOGFILE) != PFE_OK || PF_SetGroupCommit(1, 0) != PFE_OK){
+	_exit(1);
+    }
+    if (PF_CreateFile(WALFILE) != PFE_OK || (fd = PF_OpenFile(WALFILE)) < 0){
+	_exit(1);
+    }
+    writepages(fd, 30, 4000);
+    if (PF_Checkpoint() != PFE_OK){
+	_exit(1);
+    }
+    writepages(fd, 30, 4000);
+    if (PF_Commit() != PFE_OK){
+	_exit(1);
+    }
+}
+
+/*
+ * checkpoints: the pages changed before a checkpoint are on the disk,
+ * so that only the ones committed after it are redone
+ */
+void testpf4(void)
+{
+    int fd;
+
+    unlink(LOGFILE);
+    unlink(WALFILE);
+
+    crashtest(crash4);
+
+    /* without the log, the file shows what the checkpoint wrote back */
+    if ((fd = PF_OpenFile(WALFILE)) < 0){
+	PF_PrintError("open file\n");
+	exit(1);
+    }
+    printf("%s: %d pages on the disk before the redo\n", WALFILE, checkpages(fd, 4000));
+    if (PF_CloseFile(fd) != PFE_OK){
+	PF_PrintError("close file\n");
+	exit(1);
+    }
+    recover(WALFILE, 4000);
+
+    if (PF_DestroyFile(WALFILE) != PFE_OK){
+	PF_PrintError("destroy\n");
+	exit(1);
+    }
+    unlink(LOGFILE);
+}
+
+/*
+ * writes 30 pages in a segment of a tablespace with the log open and
+ * takes a checkpoint, then destroys the segment, creates a second one
+ * in its extents and grows it by 10 pages, and dies before committing
+ */
+void crash5(void)
+{
+    int fd;
+
+    if (PF_OpenLog(LOGFILE) != PFE_OK || PF_SetGroupCommit(1, 0) != PFE_OK){
+	_exit(1);
+    }
+    if (PF_CreateTablespace(TSFILE) != PFE_OK || PF_AttachTablespace(TSFILE,TSPREFIX) != PFE_OK){
+	_exit(1);
+    }
+    if (PF_CreateFile(SEGMENT1) != PFE_OK || (fd = PF_OpenFile(SEGMENT1)) < 0){
+	_exit(1);
+    }
+    writepages(fd, 30, 5000);
+    if (PF_CloseFile(fd) != PFE_OK || PF_Checkpoint() != PFE_OK){
+	_exit(1);
+    }
+    if (PF_DestroyFile(SEGMENT1) != PFE_OK){
+	_exit(1);
+    }
+    if (PF_CreateFile(SEGMENT2) != PFE_OK || (fd = PF_OpenFile(SEGMENT2)) < 0){
+	_exit(1);
+    }
+    writepages(fd, 10, 6000);
+}
+
+/*
+ * the tablespace metadata written by an operation which did not commit
+ * is put back on recovery, even with no committed record of it left in
+ * the log: the first segment is back, the second one is gone, and the
+ * extents it took are free again for a new one
+ */
+void testpf5(void)
+{
+    int fd1, fd2, error;
+
+    unlink(LOGFILE);
+    unlink(TSFILE);
+
+    crashtest(crash5);
+
+    if ((error = PF_OpenLog(LOGFILE)) != PFE_OK){
+	printf("PF_OpenLog: %d\n",error);
+	exit(1);
+    }
+    if ((error = PF_AttachTablespace(TSFILE,TSPREFIX)) != PFE_OK){
+	printf("PF_AttachTablespace: %d\n",error);
+	exit(1);
+    }
+    printf("opening %s after the redo: %d\n", SEGMENT2, PF_OpenFile(SEGMENT2) >= 0);
+    if ((fd1 = PF_OpenFile(SEGMENT1)) < 0){
+	PF_PrintError("open segment\n");
+	exit(1);
+    }
+    printf("%s: %d pages read back after the redo\n", SEGMENT1, checkpages(fd1, 5000));
+
+    if (PF_CreateFile(SEGMENT2) != PFE_OK || (fd2 = PF_OpenFile(SEGMENT2)) < 0){
+	PF_PrintError("create segment\n");
+	exit(1);
+    }
+    writepages(fd2, 20, 7000);
+    printf("%s: %d pages read back\n", SEGMENT1, checkpages(fd1, 5000));
+    printf("%s: %d pages read back\n", SEGMENT2, checkpages(fd2, 7000));
+    if (PF_CloseFile(fd1) != PFE_OK || PF_CloseFile(fd2) != PFE_OK){
+	PF_PrintError("close segment\n");
+	exit(1);
+    }
+
+    if (PF_DestroyFile(SEGMENT1) != PFE_OK || PF_DestroyFile(SEGMENT2) != PFE_OK){
+	PF_PrintError("destroy segment\n");
+	exit(1);
+    }
+    if (PF_CloseLog() != PFE_OK || PF_DetachTablespace(TSPREFIX) != PFE_OK){
+	PF_PrintError("close\n");
+	exit(1);
+    }
+    unlink(TSFILE);
+    unlink(LOGFILE);
+}
+
+/*
+ * writes 20 pages with the log open, commits them and takes a checkpoint,
+ * then overwrites them and writes 40 pages more, and dies before committing
+ * the buffer pool cannot hold the pages of the operation, which are spilled
+ * to the log and written back on their way
+ */
+void crash6(void)
+{
+    int i, fd, value;
+    char *buf;
+
+    if (PF_OpenLog(LOGFILE) != PFE_OK || PF_SetGroupCommit(1, 0) != PFE_OK){
+	_exit(1);
+    }
+    if (PF_CreateFile(WALFILE) != PFE_OK || (fd = PF_OpenFile(WALFILE)) < 0){
+	_exit(1);
+    }
+    writepages(fd, 20, 8000);
+    if (PF_Commit() != PFE_OK || PF_Checkpoint() != PFE_OK){
+	_exit(1);
+    }
+    for (i = 0; i < 20; i++){
+	if (PF_GetThisPage(fd,i,&buf) != PFE_OK){
+	    _exit(1);
+	}
+	value = i + 9000;
+	memcpy(buf, (char *)&value, sizeof(int));
+	if (PF_UnpinPage(fd,i,TRUE) != PFE_OK){
+	    _exit(1);
+	}
+    }
+    writepages(fd, 40, 9000);
+}
+
+/*
+ * an operation dirtying more pages than the buffer pool holds is not
+ * committed on its way: after the crash, none of it is left
+ */
+void testpf6(void)
+{
+    unlink(LOGFILE);
+    unlink(WALFILE);
+
+    crashtest(crash6);
+    recover(WALFILE, 8000);
+
+    if (PF_DestroyFile(WALFILE) != PFE_OK){
+	PF_PrintError("destroy\n");
+	exit(1);
+    }
+    unlink(LOGFILE);
+}
+
 main()
 {
   /* initialize PF layer */
@@ -184,4 +598,24 @@ main()
   printf("\n************* Starting testpf1 *************\n");
   testpf1();
   printf("\n************* End testpf1 ******************\n");
+
+  printf("\n************* Starting testpf2 *************\n");
+  testpf2();
+  printf("\n************* End testpf2 ******************\n");
+
+  printf("\n************* Starting testpf3 *************\n");
+  testpf3();
+  printf("\n************* End testpf3 ******************\n");
+
+  printf("\n************* Starting testpf4 *************\n");
+  testpf4();
+  printf("\n************* End testpf4 ******************\n");
+
+  printf("\n************* Starting testpf5 *************\n");
+  testpf5();
+  printf("\n************* End testpf5 ******************\n");
+
+  printf("\n************* Starting testpf6 *************\n");
+  testpf6();
+  printf("\n************* End testpf6 ******************\n");
 }